@@ -6,6 +6,9 @@ PUSHD build
 glslc -o basic.vert.spv ../code/shaders/basic.vert
 glslc -o basic.frag.spv ../code/shaders/basic.frag
 
+cl -nologo -Febake.exe ../code/bake.c -Z7 -O2
+for %%F in (..\data\*.glb ..\data\*.gltf) do bake.exe %%F %%~nF.scene
+
 set INCLUDE=%VULKAN_SDK%/Include/;%INCLUDE%
 set LIB=%VULKAN_SDK%/Lib/;%LIB%
 
@@ -5,381 +5,2667 @@
 // checking is for our own sanity.
 
 // NOTE: Basic JSON parsing API.
-static string Find_Json_Array_By_Key(string Json, string Key);
-static int Json_Array_Count(string Array);
+static json_tape Tokenize_Json(arena *Arena, string Json);
+
+static int Json_First_Child(json_tape *Json, int Token);
+static int Json_Next(json_tape *Json, int Token);
+static int Json_Child_Count(json_tape *Json, int Token);
+static int Find_Json_Key(json_tape *Json, int Object, string Key);
+
+static int Json_Integer(json_tape *Json, int Token, int Default);
+static idx Json_Size(json_tape *Json, int Token, idx Default);
+static float Json_Float(json_tape *Json, int Token, float Default);
+static bool Json_Boolean(json_tape *Json, int Token, bool Default);
+static void Json_Floats(json_tape *Json, int Array, float *Result, float *Defaults, int Count);
+static string Json_String(json_tape *Json, int Token);
+
+static string Load_GLTF_Uri(string Uri, arena *Arena, arena Scratch, char *Path, string *File);
+static void Load_GLTF_Buffer_Uri(gltf_buffer *Buffer, string Uri, arena *Arena, arena Scratch, char *Path);
+static bool Decode_GLTF_Images(gltf_scene *Scene, int *Image_Views, string *Image_Uris, arena *Arena, arena Scratch, char *Path);
+static bool Build_GLTF_Draw_List(gltf_scene *Scene, arena *Arena, arena Scratch);
+static bool Resolve_Dense_GLTF_Accessors(gltf_scene *Scene, arena *Arena, arena Scratch, char *Path);
+static void Unload_Scene(gltf_scene *Scene);
+
+// NOTE: Accessor reading. Accessors can be read in their own component type,
+// or converted to floats or (for integer components) u32s. Missing components
+// read as zero, except for a fourth, which reads as one. Conversions need
+// scratch for a dense copy of the accessor.
+static bool Read_GLTF_Accessor(gltf_scene *Scene, gltf_accessor *Accessor, void *Destination,
+                               gltf_component_type Component_Type, int Component_Count, arena Scratch);
+
+static bool Fail_GLTF_Parse(gltf_scene *Scene, char *Path, char *Reason)
+{
+   Log("Failed to parse %s: %s.\n", Path, Reason);
+   Unload_Scene(Scene);
+   return(false);
+}
+
+// NOTE: glTF file parsing. Both .glb files and .gltf files with external or
+// embedded buffers are accepted, told apart by the .glb magic number. Returns
+// false, leaving the scene empty, if the file is malformed or doesn't fit in
+// the arenas. Everything sized by the file is allocated with Try_Allocate, so
+// running out of room marks the arenas exhausted rather than asserting.
+static bool Parse_GLTF(gltf_scene *Result, arena *Arena, arena Scratch, char *Path)
+{
+   // NOTE: The file is mapped rather than read. The JSON is tokenized in place
+   // and the binary chunk is used directly from the mapping, so nothing here
+   // copies the file contents.
+   string File = Map_Entire_File(Path);
+   if(!File.Data || !File.Length)
+   {
+      return(Fail_GLTF_Parse(Result, Path, "it couldn't be read"));
+   }
+   Result->File = File;
+
+   u8 *At = File.Data;
+   u8 *End = File.Data + File.Length;
+
+   string Json_Text = File;
+   string Glb_Binary = {0};
+
+   glb_header *Header = (glb_header *)At;
+   if(File.Length >= (idx)sizeof(*Header) && Header->Magic == GLB_MAGIC_NUMBER)
+   {
+      At += sizeof(*Header);
+
+      glb_chunk_header *Json_Header = (glb_chunk_header *)At;
+      if(At + sizeof(*Json_Header) > End || Json_Header->Chunk_Type != GLB_CHUNK_TYPE_JSON)
+      {
+         return(Fail_GLTF_Parse(Result, Path, "it's missing its JSON chunk"));
+      }
+      At += sizeof(*Json_Header);
+
+      if(Json_Header->Chunk_Length > (u64)(End - At))
+      {
+         return(Fail_GLTF_Parse(Result, Path, "its JSON chunk is cut off"));
+      }
+
+      Json_Text = (string){Json_Header->Chunk_Length, At};
+      At += Json_Text.Length;
+
+      // NOTE: The binary chunk is optional, for files whose buffers are all
+      // external.
+      if(At + sizeof(glb_chunk_header) <= End)
+      {
+         glb_chunk_header *Binary_Header = (glb_chunk_header *)At;
+         if(Binary_Header->Chunk_Type != GLB_CHUNK_TYPE_BINARY)
+         {
+            return(Fail_GLTF_Parse(Result, Path, "its second chunk isn't a binary chunk"));
+         }
+         At += sizeof(*Binary_Header);
+
+         if(Binary_Header->Chunk_Length > (u64)(End - At))
+         {
+            return(Fail_GLTF_Parse(Result, Path, "its binary chunk is cut off"));
+         }
+
+         Glb_Binary = (string){Binary_Header->Chunk_Length, At};
+         At += Glb_Binary.Length;
+      }
+   }
+
+   // NOTE: Tokenize the entire JSON chunk once up front. Everything below walks
+   // the resulting tape by index, so each token is visited a constant number
+   // of times regardless of how many accessors, views or meshes there are.
+   json_tape Tape = Tokenize_Json(&Scratch, Json_Text);
+   json_tape *Json = &Tape;
+
+   int Root = (Json->Count > JSON_ROOT_TOKEN) ? JSON_ROOT_TOKEN : 0;
+   if(!Root)
+   {
+      return(Fail_GLTF_Parse(Result, Path, "its JSON chunk could not be tokenized"));
+   }
+
+   // NOTE: Parse accessors.
+   int Json_Accessors = Find_Json_Key(Json, Root, S("accessors"));
+   Result->Accessor_Count = Json_Child_Count(Json, Json_Accessors);
+   Result->Accessors = Try_Allocate(Arena, gltf_accessor, Result->Accessor_Count);
+   if(!Result->Accessors)
+   {
+      return(Fail_GLTF_Parse(Result, Path, "it ran out of memory"));
+   }
+
+   int Json_Accessor = Json_First_Child(Json, Json_Accessors);
+   for(int Accessor_Index = 0; Accessor_Index < Result->Accessor_Count; ++Accessor_Index)
+   {
+      gltf_accessor *Accessor = Result->Accessors + Accessor_Index;
+
+      Accessor->Buffer_View    = Json_Integer(Json, Find_Json_Key(Json, Json_Accessor, S("bufferView")), -1);
+      Accessor->Offset         = Json_Integer(Json, Find_Json_Key(Json, Json_Accessor, S("byteOffset")), 0);
+      Accessor->Count          = Json_Integer(Json, Find_Json_Key(Json, Json_Accessor, S("count")), 0);
+      Accessor->Component_Type = Json_Integer(Json, Find_Json_Key(Json, Json_Accessor, S("componentType")), 0);
+      Accessor->Normalized     = Json_Boolean(Json, Find_Json_Key(Json, Json_Accessor, S("normalized")), false);
+      Accessor->Decode_Scale   = 1.0f;
+
+      string Name = Json_String(Json, Find_Json_Key(Json, Json_Accessor, S("type")));
+      for(int Type = 0; Type < GLTF_ACCESSOR_TYPE_COUNT; ++Type)
+      {
+         if(Strings_Are_Equal(Name, GLTF_Accessor_Type_Infos[Type].Name))
+         {
+            Accessor->Type = Type;
+            break;
+         }
+      }
+
+      switch(Accessor->Component_Type)
+      {
+         case GLTF_ACCESSOR_COMPONENT_S8:
+         case GLTF_ACCESSOR_COMPONENT_U8:
+         case GLTF_ACCESSOR_COMPONENT_S16:
+         case GLTF_ACCESSOR_COMPONENT_U16:
+         case GLTF_ACCESSOR_COMPONENT_U32:
+         case GLTF_ACCESSOR_COMPONENT_F32: break;
+
+         default: return(Fail_GLTF_Parse(Result, Path, "an accessor has an unknown component type"));
+      }
+      if(Accessor->Count < 0 || Accessor->Offset < 0)
+      {
+         return(Fail_GLTF_Parse(Result, Path, "an accessor has a negative count or offset"));
+      }
+
+      int Json_Sparse = Find_Json_Key(Json, Json_Accessor, S("sparse"));
+      if(Json_Sparse)
+      {
+         int Json_Indices = Find_Json_Key(Json, Json_Sparse, S("indices"));
+         int Json_Values = Find_Json_Key(Json, Json_Sparse, S("values"));
+
+         gltf_sparse *Sparse = &Accessor->Sparse;
+         Sparse->Count          = Json_Integer(Json, Find_Json_Key(Json, Json_Sparse, S("count")), 0);
+         Sparse->Indices_View   = Json_Integer(Json, Find_Json_Key(Json, Json_Indices, S("bufferView")), -1);
+         Sparse->Indices_Offset = Json_Integer(Json, Find_Json_Key(Json, Json_Indices, S("byteOffset")), 0);
+         Sparse->Index_Type     = Json_Integer(Json, Find_Json_Key(Json, Json_Indices, S("componentType")), 0);
+         Sparse->Values_View    = Json_Integer(Json, Find_Json_Key(Json, Json_Values, S("bufferView")), -1);
+         Sparse->Values_Offset  = Json_Integer(Json, Find_Json_Key(Json, Json_Values, S("byteOffset")), 0);
+
+         if(Sparse->Index_Type != GLTF_ACCESSOR_COMPONENT_U8 &&
+            Sparse->Index_Type != GLTF_ACCESSOR_COMPONENT_U16 &&
+            Sparse->Index_Type != GLTF_ACCESSOR_COMPONENT_U32)
+         {
+            return(Fail_GLTF_Parse(Result, Path, "a sparse accessor's indices aren't unsigned integers"));
+         }
+         if(Sparse->Count < 0 || Sparse->Indices_Offset < 0 || Sparse->Values_Offset < 0)
+         {
+            return(Fail_GLTF_Parse(Result, Path, "a sparse accessor has a negative count or offset"));
+         }
+      }
+
+      Json_Accessor = Json_Next(Json, Json_Accessor);
+   }
+
+   // NOTE: Parse buffer views.
+   int Json_Buffer_Views = Find_Json_Key(Json, Root, S("bufferViews"));
+   Result->Buffer_View_Count = Json_Child_Count(Json, Json_Buffer_Views);
+   Result->Buffer_Views = Try_Allocate(Arena, gltf_buffer_view, Result->Buffer_View_Count);
+   if(!Result->Buffer_Views)
+   {
+      return(Fail_GLTF_Parse(Result, Path, "it ran out of memory"));
+   }
+
+   int Json_Buffer_View = Json_First_Child(Json, Json_Buffer_Views);
+   for(int Buffer_View_Index = 0; Buffer_View_Index < Result->Buffer_View_Count; ++Buffer_View_Index)
+   {
+      gltf_buffer_view *Buffer_View = Result->Buffer_Views + Buffer_View_Index;
+      Buffer_View->Buffer = Json_Integer(Json, Find_Json_Key(Json, Json_Buffer_View, S("buffer")), 0);
+      Buffer_View->Offset = Json_Size(Json, Find_Json_Key(Json, Json_Buffer_View, S("byteOffset")), 0);
+      Buffer_View->Length = Json_Size(Json, Find_Json_Key(Json, Json_Buffer_View, S("byteLength")), 0);
+      Buffer_View->Stride = Json_Integer(Json, Find_Json_Key(Json, Json_Buffer_View, S("byteStride")), 0);
+
+      Json_Buffer_View = Json_Next(Json, Json_Buffer_View);
+   }
+
+   // NOTE: Parse buffers. A buffer without a uri is the .glb binary chunk.
+   int Json_Buffers = Find_Json_Key(Json, Root, S("buffers"));
+   Result->Buffer_Count = Json_Child_Count(Json, Json_Buffers);
+   Result->Buffers = Try_Allocate(Arena, gltf_buffer, Result->Buffer_Count);
+   if(!Result->Buffers)
+   {
+      return(Fail_GLTF_Parse(Result, Path, "it ran out of memory"));
+   }
+
+   int Json_Buffer = Json_First_Child(Json, Json_Buffers);
+   for(int Buffer_Index = 0; Buffer_Index < Result->Buffer_Count; ++Buffer_Index)
+   {
+      gltf_buffer *Buffer = Result->Buffers + Buffer_Index;
+      Buffer->Length = Json_Size(Json, Find_Json_Key(Json, Json_Buffer, S("byteLength")), 0);
+
+      int Json_Uri = Find_Json_Key(Json, Json_Buffer, S("uri"));
+      if(!Json_Uri)
+      {
+         Buffer->Data = Glb_Binary.Data;
+         if(!Glb_Binary.Data || Glb_Binary.Length < Buffer->Length)
+         {
+            return(Fail_GLTF_Parse(Result, Path, "a buffer is larger than the binary chunk"));
+         }
+      }
+      else
+      {
+         Load_GLTF_Buffer_Uri(Buffer, Json_String(Json, Json_Uri), Arena, Scratch, Path);
+         if(!Buffer->Data)
+         {
+            return(Fail_GLTF_Parse(Result, Path, "a buffer could not be loaded"));
+         }
+      }
+
+      Json_Buffer = Json_Next(Json, Json_Buffer);
+   }
+
+   // NOTE: Parse images. Their sources are only decoded once the materials
+   // have said how each one is used.
+   int Json_Images = Find_Json_Key(Json, Root, S("images"));
+   Result->Image_Count = Json_Child_Count(Json, Json_Images);
+   Result->Images = Try_Allocate(Arena, gltf_image, Result->Image_Count);
+
+   int *Image_Views = Try_Allocate(&Scratch, int, Result->Image_Count);
+   string *Image_Uris = Try_Allocate(&Scratch, string, Result->Image_Count);
+   if(!Result->Images || !Image_Views || !Image_Uris)
+   {
+      return(Fail_GLTF_Parse(Result, Path, "it ran out of memory"));
+   }
+
+   int Json_Image = Json_First_Child(Json, Json_Images);
+   for(int Image_Index = 0; Image_Index < Result->Image_Count; ++Image_Index)
+   {
+      Image_Views[Image_Index] = Json_Integer(Json, Find_Json_Key(Json, Json_Image, S("bufferView")), -1);
+      Image_Uris[Image_Index] = Json_String(Json, Find_Json_Key(Json, Json_Image, S("uri")));
+
+      Json_Image = Json_Next(Json, Json_Image);
+   }
+
+   // NOTE: Parse samplers. Filters the file leaves out stay 0, so the renderer
+   // can pick its own.
+   int Json_Samplers = Find_Json_Key(Json, Root, S("samplers"));
+   Result->Sampler_Count = Json_Child_Count(Json, Json_Samplers);
+   Result->Samplers = Try_Allocate(Arena, gltf_sampler, Result->Sampler_Count);
+   if(!Result->Samplers)
+   {
+      return(Fail_GLTF_Parse(Result, Path, "it ran out of memory"));
+   }
+
+   int Json_Sampler = Json_First_Child(Json, Json_Samplers);
+   for(int Sampler_Index = 0; Sampler_Index < Result->Sampler_Count; ++Sampler_Index)
+   {
+      gltf_sampler *Sampler = Result->Samplers + Sampler_Index;
+      Sampler->Mag_Filter = Json_Integer(Json, Find_Json_Key(Json, Json_Sampler, S("magFilter")), 0);
+      Sampler->Min_Filter = Json_Integer(Json, Find_Json_Key(Json, Json_Sampler, S("minFilter")), 0);
+      Sampler->Wrap_S     = Json_Integer(Json, Find_Json_Key(Json, Json_Sampler, S("wrapS")), GLTF_WRAP_REPEAT);
+      Sampler->Wrap_T     = Json_Integer(Json, Find_Json_Key(Json, Json_Sampler, S("wrapT")), GLTF_WRAP_REPEAT);
+
+      Json_Sampler = Json_Next(Json, Json_Sampler);
+   }
+
+   // NOTE: Parse textures.
+   int Json_Textures = Find_Json_Key(Json, Root, S("textures"));
+   Result->Texture_Count = Json_Child_Count(Json, Json_Textures);
+   Result->Textures = Try_Allocate(Arena, gltf_texture, Result->Texture_Count);
+   if(!Result->Textures)
+   {
+      return(Fail_GLTF_Parse(Result, Path, "it ran out of memory"));
+   }
+
+   int Json_Texture = Json_First_Child(Json, Json_Textures);
+   for(int Texture_Index = 0; Texture_Index < Result->Texture_Count; ++Texture_Index)
+   {
+      gltf_texture *Texture = Result->Textures + Texture_Index;
+      Texture->Image   = Json_Integer(Json, Find_Json_Key(Json, Json_Texture, S("source")), -1);
+      Texture->Sampler = Json_Integer(Json, Find_Json_Key(Json, Json_Texture, S("sampler")), -1);
+
+      if(Texture->Image >= Result->Image_Count)
+      {
+         Log("Texture %d in %s refers to a missing image.\n", Texture_Index, Path);
+         Texture->Image = -1;
+      }
+      if(Texture->Sampler >= Result->Sampler_Count)
+      {
+         Log("Texture %d in %s refers to a missing sampler.\n", Texture_Index, Path);
+         Texture->Sampler = -1;
+      }
+
+      Json_Texture = Json_Next(Json, Json_Texture);
+   }
+
+   // NOTE: Parse materials, marking how each of their images is used along the
+   // way. Images used more than one way keep the last usage.
+   int Json_Materials = Find_Json_Key(Json, Root, S("materials"));
+   Result->Material_Count = Json_Child_Count(Json, Json_Materials);
+   Result->Materials = Try_Allocate(Arena, gltf_material, Result->Material_Count);
+   if(!Result->Materials)
+   {
+      return(Fail_GLTF_Parse(Result, Path, "it ran out of memory"));
+   }
+
+   int Json_Material = Json_First_Child(Json, Json_Materials);
+   for(int Material_Index = 0; Material_Index < Result->Material_Count; ++Material_Index)
+   {
+      gltf_material *Material = Result->Materials + Material_Index;
+
+      float Default_Base_Color[4] = {1, 1, 1, 1};
+      int Json_PBR = Find_Json_Key(Json, Json_Material, S("pbrMetallicRoughness"));
+      Json_Floats(Json, Find_Json_Key(Json, Json_PBR, S("baseColorFactor")), Material->Base_Color_Factor, Default_Base_Color, 4);
+
+      struct {int *Texture; int Json_Parent; string Key; gltf_image_usage Usage;} Slots[] =
+      {
+         {&Material->Base_Color_Texture,         Json_PBR,      S("baseColorTexture"),         GLTF_IMAGE_USAGE_COLOR},
+         {&Material->Metallic_Roughness_Texture, Json_PBR,      S("metallicRoughnessTexture"), GLTF_IMAGE_USAGE_DATA},
+         {&Material->Normal_Texture,             Json_Material, S("normalTexture"),            GLTF_IMAGE_USAGE_NORMAL},
+         {&Material->Occlusion_Texture,          Json_Material, S("occlusionTexture"),         GLTF_IMAGE_USAGE_DATA},
+         {&Material->Emissive_Texture,           Json_Material, S("emissiveTexture"),          GLTF_IMAGE_USAGE_COLOR},
+      };
+
+      for(int Slot_Index = 0; Slot_Index < Array_Count(Slots); ++Slot_Index)
+      {
+         int Json_Info = Find_Json_Key(Json, Slots[Slot_Index].Json_Parent, Slots[Slot_Index].Key);
+         int Texture = Json_Integer(Json, Find_Json_Key(Json, Json_Info, S("index")), -1);
+         if(Texture >= Result->Texture_Count)
+         {
+            Log("Material %d in %s refers to a missing texture.\n", Material_Index, Path);
+            Texture = -1;
+         }
+
+         *Slots[Slot_Index].Texture = Texture;
+         if(Texture >= 0 && Result->Textures[Texture].Image >= 0)
+         {
+            Result->Images[Result->Textures[Texture].Image].Usage = Slots[Slot_Index].Usage;
+         }
+      }
+
+      Json_Material = Json_Next(Json, Json_Material);
+   }
+
+   if(!Decode_GLTF_Images(Result, Image_Views, Image_Uris, Arena, Scratch, Path))
+   {
+      return(Fail_GLTF_Parse(Result, Path, "it ran out of memory"));
+   }
+
+   // NOTE: Parse meshes. Primitives from every mesh are packed into one flat
+   // table, and each mesh just refers to its own range of it.
+   int Json_Meshes = Find_Json_Key(Json, Root, S("meshes"));
+   Result->Mesh_Count = Json_Child_Count(Json, Json_Meshes);
+   Result->Meshes = Try_Allocate(Arena, gltf_mesh, Result->Mesh_Count);
+   if(!Result->Meshes)
+   {
+      return(Fail_GLTF_Parse(Result, Path, "it ran out of memory"));
+   }
+
+   Result->Primitive_Count = 0;
+   for(int Json_Mesh = Json_First_Child(Json, Json_Meshes); Json_Mesh; Json_Mesh = Json_Next(Json, Json_Mesh))
+   {
+      Result->Primitive_Count += Json_Child_Count(Json, Find_Json_Key(Json, Json_Mesh, S("primitives")));
+   }
+   Result->Primitives = Try_Allocate(Arena, gltf_primitive, Result->Primitive_Count);
+   if(!Result->Primitives)
+   {
+      return(Fail_GLTF_Parse(Result, Path, "it ran out of memory"));
+   }
+
+   int Primitive_Offset = 0;
+   int Json_Mesh = Json_First_Child(Json, Json_Meshes);
+   for(int Mesh_Index = 0; Mesh_Index < Result->Mesh_Count; ++Mesh_Index)
+   {
+      gltf_mesh *Mesh = Result->Meshes + Mesh_Index;
+
+      int Json_Primitives = Find_Json_Key(Json, Json_Mesh, S("primitives"));
+      Mesh->Primitive_Count = Json_Child_Count(Json, Json_Primitives);
+      Mesh->Primitives = Result->Primitives + Primitive_Offset;
+      Primitive_Offset += Mesh->Primitive_Count;
+
+      int Json_Primitive = Json_First_Child(Json, Json_Primitives);
+      for(int Primitive_Index = 0; Primitive_Index < Mesh->Primitive_Count; ++Primitive_Index)
+      {
+         gltf_primitive *Primitive = Mesh->Primitives + Primitive_Index;
+         Primitive->Indices = Json_Integer(Json, Find_Json_Key(Json, Json_Primitive, S("indices")), -1);
+         Primitive->Mode    = Json_Integer(Json, Find_Json_Key(Json, Json_Primitive, S("mode")), GLTF_PRIMITIVE_MODE_TRIANGLES);
+
+         Primitive->Material = Json_Integer(Json, Find_Json_Key(Json, Json_Primitive, S("material")), -1);
+         if(Primitive->Material >= Result->Material_Count)
+         {
+            Log("A primitive of mesh %d in %s refers to a missing material.\n", Mesh_Index, Path);
+            Primitive->Material = -1;
+         }
+
+         int Json_Attributes = Find_Json_Key(Json, Json_Primitive, S("attributes"));
+         Primitive->Position   = Json_Integer(Json, Find_Json_Key(Json, Json_Attributes, S("POSITION")), -1);
+         Primitive->Normal     = Json_Integer(Json, Find_Json_Key(Json, Json_Attributes, S("NORMAL")), -1);
+         Primitive->Texcoord_0 = Json_Integer(Json, Find_Json_Key(Json, Json_Attributes, S("TEXCOORD_0")), -1);
+         Primitive->Texcoord_1 = Json_Integer(Json, Find_Json_Key(Json, Json_Attributes, S("TEXCOORD_1")), -1);
+         Primitive->Color_0    = Json_Integer(Json, Find_Json_Key(Json, Json_Attributes, S("COLOR_0")), -1);
+         Primitive->Color_1    = Json_Integer(Json, Find_Json_Key(Json, Json_Attributes, S("COLOR_1")), -1);
+
+         Json_Primitive = Json_Next(Json, Json_Primitive);
+      }
+
+      Json_Mesh = Json_Next(Json, Json_Mesh);
+   }
+
+   if(!Resolve_Dense_GLTF_Accessors(Result, Arena, Scratch, Path))
+   {
+      return(Fail_GLTF_Parse(Result, Path, "it ran out of memory"));
+   }
+
+   // NOTE: Parse nodes.
+   int Json_Nodes = Find_Json_Key(Json, Root, S("nodes"));
+   gltf_nodes *Nodes = &Result->Nodes;
+   Nodes->Count  = Json_Child_Count(Json, Json_Nodes);
+   Nodes->Mesh   = Try_Allocate(Arena, int, Nodes->Count);
+   Nodes->Parent = Try_Allocate(Arena, int, Nodes->Count);
+   Nodes->Local  = Try_Allocate(Arena, matrix4, Nodes->Count);
+   Nodes->World  = Try_Allocate(Arena, matrix4, Nodes->Count);
+   if(!Nodes->Mesh || !Nodes->Parent || !Nodes->Local || !Nodes->World)
+   {
+      return(Fail_GLTF_Parse(Result, Path, "it ran out of memory"));
+   }
+
+   for(int Node_Index = 0; Node_Index < Nodes->Count; ++Node_Index)
+   {
+      Nodes->Parent[Node_Index] = -1;
+   }
+
+   int Json_Node = Json_First_Child(Json, Json_Nodes);
+   for(int Node_Index = 0; Node_Index < Nodes->Count; ++Node_Index)
+   {
+      Nodes->Mesh[Node_Index] = Json_Integer(Json, Find_Json_Key(Json, Json_Node, S("mesh")), -1);
+      if(Nodes->Mesh[Node_Index] >= Result->Mesh_Count)
+      {
+         Log("Node %d in %s refers to a missing mesh.\n", Node_Index, Path);
+         Nodes->Mesh[Node_Index] = -1;
+      }
+
+      int Json_Matrix = Find_Json_Key(Json, Json_Node, S("matrix"));
+      if(Json_Matrix)
+      {
+         // NOTE: glTF matrices are column-major, same as ours.
+         matrix4 Identity_Matrix = Identity();
+         Json_Floats(Json, Json_Matrix, Nodes->Local[Node_Index].Elements, Identity_Matrix.Elements, 16);
+      }
+      else
+      {
+         float Default_T[3] = {0, 0, 0};
+         float Default_R[4] = {0, 0, 0, 1};
+         float Default_S[3] = {1, 1, 1};
+
+         vec3 T, S;
+         vec4 R;
+         Json_Floats(Json, Find_Json_Key(Json, Json_Node, S("translation")), &T.X, Default_T, 3);
+         Json_Floats(Json, Find_Json_Key(Json, Json_Node, S("rotation")), &R.X, Default_R, 4);
+         Json_Floats(Json, Find_Json_Key(Json, Json_Node, S("scale")), &S.X, Default_S, 3);
+
+         Nodes->Local[Node_Index] = Translate_Rotate_Scale(T, R, S);
+      }
+
+      int Json_Children = Find_Json_Key(Json, Json_Node, S("children"));
+      for(int Json_Child = Json_First_Child(Json, Json_Children); Json_Child; Json_Child = Json_Next(Json, Json_Child))
+      {
+         int Child = Json_Integer(Json, Json_Child, -1);
+         if(Child < 0 || Child >= Nodes->Count || Child == Node_Index || Nodes->Parent[Child] != -1)
+         {
+            Log("Node %d in %s has an invalid child %d.\n", Node_Index, Path, Child);
+         }
+         else
+         {
+            Nodes->Parent[Child] = Node_Index;
+         }
+      }
+
+      Json_Node = Json_Next(Json, Json_Node);
+   }
+
+   // NOTE: Parse scenes.
+   int Json_Scenes = Find_Json_Key(Json, Root, S("scenes"));
+   Result->Default_Scene = Json_Integer(Json, Find_Json_Key(Json, Root, S("scene")), 0);
+   Result->Scene_Count = Json_Child_Count(Json, Json_Scenes);
+   Result->Scenes = Try_Allocate(Arena, gltf_scene_roots, Result->Scene_Count);
+   if(!Result->Scenes)
+   {
+      return(Fail_GLTF_Parse(Result, Path, "it ran out of memory"));
+   }
+
+   int Json_Scene = Json_First_Child(Json, Json_Scenes);
+   for(int Scene_Index = 0; Scene_Index < Result->Scene_Count; ++Scene_Index)
+   {
+      gltf_scene_roots *Scene = Result->Scenes + Scene_Index;
+
+      int Json_Roots = Find_Json_Key(Json, Json_Scene, S("nodes"));
+      Scene->Roots = Try_Allocate(Arena, int, Json_Child_Count(Json, Json_Roots));
+      if(!Scene->Roots)
+      {
+         return(Fail_GLTF_Parse(Result, Path, "it ran out of memory"));
+      }
+      for(int Json_Root = Json_First_Child(Json, Json_Roots); Json_Root; Json_Root = Json_Next(Json, Json_Root))
+      {
+         int Node = Json_Integer(Json, Json_Root, -1);
+         if(Node >= 0 && Node < Nodes->Count && Nodes->Parent[Node] == -1)
+         {
+            Scene->Roots[Scene->Root_Count++] = Node;
+         }
+         else
+         {
+            Log("Scene %d in %s has an invalid root node %d.\n", Scene_Index, Path, Node);
+         }
+      }
+
+      Json_Scene = Json_Next(Json, Json_Scene);
+   }
+
+   if(!Build_GLTF_Draw_List(Result, Arena, Scratch))
+   {
+      return(Fail_GLTF_Parse(Result, Path, "it ran out of memory"));
+   }
+
+   return(true);
+}
+
+static bool Build_GLTF_Draw_List(gltf_scene *Scene, arena *Arena, arena Scratch)
+{
+   // NOTE: Compute world transforms for every node, then emit one draw for
+   // each primitive of each mesh instance reachable from the default scene. If
+   // the file has no scenes, every mesh is drawn once at the origin instead.
+   // Returns false if the arenas run out of room.
+   gltf_nodes *Nodes = &Scene->Nodes;
+
+   int *Child_Offsets = Try_Allocate(&Scratch, int, Nodes->Count + 1);
+   int *Children = Try_Allocate(&Scratch, int, Nodes->Count + 1);
+   int *Child_Cursors = Try_Allocate(&Scratch, int, Nodes->Count + 1);
+   bool *Drawn = Try_Allocate(&Scratch, bool, Nodes->Count + 1);
+   int *Order = Try_Allocate(&Scratch, int, Nodes->Count + 1);
+   if(!Child_Offsets || !Children || !Child_Cursors || !Drawn || !Order)
+   {
+      return(false);
+   }
+
+   // NOTE: Bucket children by parent so that the traversal below is linear.
+   for(int Node = 0; Node < Nodes->Count; ++Node)
+   {
+      if(Nodes->Parent[Node] >= 0)
+      {
+         Child_Offsets[Nodes->Parent[Node] + 1]++;
+      }
+   }
+   for(int Node = 0; Node < Nodes->Count; ++Node)
+   {
+      Child_Offsets[Node + 1] += Child_Offsets[Node];
+   }
+   for(int Node = 0; Node < Nodes->Count; ++Node)
+   {
+      int Parent = Nodes->Parent[Node];
+      if(Parent >= 0)
+      {
+         Children[Child_Offsets[Parent] + Child_Cursors[Parent]++] = Node;
+      }
+   }
+
+   gltf_scene_roots *Default = 0;
+   if(Scene->Default_Scene >= 0 && Scene->Default_Scene < Scene->Scene_Count)
+   {
+      Default = Scene->Scenes + Scene->Default_Scene;
+   }
+
+   for(int Root_Index = 0; Default && Root_Index < Default->Root_Count; ++Root_Index)
+   {
+      Drawn[Default->Roots[Root_Index]] = true;
+   }
+
+   // NOTE: Visit nodes parent-first from every root, so each world transform
+   // is computed once from its parent's. Nodes caught in a parent cycle are
+   // never reached, so they're never drawn.
+   int Order_Count = 0;
+   for(int Root = 0; Root < Nodes->Count; ++Root)
+   {
+      if(Nodes->Parent[Root] == -1)
+      {
+         Nodes->World[Root] = Nodes->Local[Root];
+
+         int Begin = Order_Count;
+         Order[Order_Count++] = Root;
+         while(Begin < Order_Count)
+         {
+            int Node = Order[Begin++];
+            for(int Child_Index = Child_Offsets[Node]; Child_Index < Child_Offsets[Node + 1]; ++Child_Index)
+            {
+               int Child = Children[Child_Index];
+               Nodes->World[Child] = Multiply_Matrix4(Nodes->World[Node], Nodes->Local[Child]);
+               Drawn[Child] = Drawn[Node];
+               Order[Order_Count++] = Child;
+            }
+         }
+      }
+   }
+
+   if(Order_Count != Nodes->Count)
+   {
+      Log("Some nodes are part of a cycle and will not be drawn.\n");
+   }
+
+   // NOTE: Count, then fill the draw list.
+   Scene->Draw_Count = 0;
+   if(Default)
+   {
+      for(int Order_Index = 0; Order_Index < Order_Count; ++Order_Index)
+      {
+         int Node = Order[Order_Index];
+         if(Drawn[Node] && Nodes->Mesh[Node] >= 0)
+         {
+            Scene->Draw_Count += Scene->Meshes[Nodes->Mesh[Node]].Primitive_Count;
+         }
+      }
+   }
+   else
+   {
+      Scene->Draw_Count = Scene->Primitive_Count;
+   }
+
+   Scene->Draws = Try_Allocate(Arena, gltf_draw, Scene->Draw_Count);
+   if(!Scene->Draws)
+   {
+      return(false);
+   }
+
+   int Draw_Index = 0;
+   if(Default)
+   {
+      for(int Order_Index = 0; Order_Index < Order_Count; ++Order_Index)
+      {
+         int Node = Order[Order_Index];
+         if(Drawn[Node] && Nodes->Mesh[Node] >= 0)
+         {
+            gltf_mesh *Mesh = Scene->Meshes + Nodes->Mesh[Node];
+            int First_Primitive = (int)(Mesh->Primitives - Scene->Primitives);
+            for(int Primitive_Index = 0; Primitive_Index < Mesh->Primitive_Count; ++Primitive_Index)
+            {
+               gltf_draw *Draw = Scene->Draws + Draw_Index++;
+               Draw->Primitive = First_Primitive + Primitive_Index;
+               Draw->Node = Node;
+            }
+         }
+      }
+   }
+   else
+   {
+      for(int Primitive_Index = 0; Primitive_Index < Scene->Primitive_Count; ++Primitive_Index)
+      {
+         gltf_draw *Draw = Scene->Draws + Draw_Index++;
+         Draw->Primitive = Primitive_Index;
+         Draw->Node = -1;
+      }
+   }
+   Assert(Draw_Index == Scene->Draw_Count);
+
+   return(true);
+}
+
+static inline int Decode_Base64_Digit(u8 Character)
+{
+   int Result = -1;
+   if(Character >= 'A' && Character <= 'Z') Result = Character - 'A';
+   else if(Character >= 'a' && Character <= 'z') Result = Character - 'a' + 26;
+   else if(Character >= '0' && Character <= '9') Result = Character - '0' + 52;
+   else if(Character == '+' || Character == '-') Result = 62;
+   else if(Character == '/' || Character == '_') Result = 63;
+
+   return(Result);
+}
+
+static inline int Decode_Hex_Digit(u8 Character)
+{
+   int Result = -1;
+   if(Character >= '0' && Character <= '9') Result = Character - '0';
+   else if(Character >= 'a' && Character <= 'f') Result = Character - 'a' + 10;
+   else if(Character >= 'A' && Character <= 'F') Result = Character - 'A' + 10;
+
+   return(Result);
+}
+
+static char *Get_GLTF_Uri_Path(string Uri, arena *Scratch, char *Path)
+{
+   // NOTE: Resolves a percent-encoded uri that isn't a data: uri against the
+   // directory of the file at Path. Returns null if Scratch runs out of room.
+   idx Directory_Length = 0;
+   for(idx Index = 0; Path[Index]; ++Index)
+   {
+      if(Path[Index] == '/' || Path[Index] == '\\')
+      {
+         Directory_Length = Index + 1;
+      }
+   }
+
+   char *Result = Try_Allocate(Scratch, char, Directory_Length + Uri.Length + 1);
+   if(Result)
+   {
+      Copy_Memory(Result, Path, Directory_Length);
+
+      idx Length = Directory_Length;
+      for(idx Index = 0; Index < Uri.Length; ++Index)
+      {
+         u8 Character = Uri.Data[Index];
+         if(Character == '%' && Index + 2 < Uri.Length &&
+            Decode_Hex_Digit(Uri.Data[Index + 1]) >= 0 && Decode_Hex_Digit(Uri.Data[Index + 2]) >= 0)
+         {
+            Character = (u8)(16*Decode_Hex_Digit(Uri.Data[Index + 1]) + Decode_Hex_Digit(Uri.Data[Index + 2]));
+            Index += 2;
+         }
+         Result[Length++] = (char)Character;
+      }
+      Result[Length] = 0;
+   }
+
+   return(Result);
+}
+
+static string Load_GLTF_Uri(string Uri, arena *Arena, arena Scratch, char *Path, string *File)
+{
+   // NOTE: data: uris embed their contents as base64, which is decoded into
+   // the arena. Anything else is a percent-encoded path relative to the file
+   // being parsed, which is mapped and returned in File as well, so the caller
+   // can unmap it. The result is empty if the uri can't be loaded, or the
+   // arenas run out of room.
+   string Result = {0};
+   *File = (string){0};
+
+   if(Has_Prefix_Then_Remove(&Uri, S("data:")))
+   {
+      cut Header = Cut(Uri, ',');
+      if(Header.Found && Has_Suffix(Header.Before, S(";base64")))
+      {
+         u8 *Data = Try_Allocate(Arena, u8, Header.After.Length*3/4 + 1);
+         idx Length = 0;
+         if(!Data)
+         {
+            return(Result);
+         }
+
+         u32 Bits = 0;
+         int Bit_Count = 0;
+         for(idx Index = 0; Index < Header.After.Length; ++Index)
+         {
+            int Digit = Decode_Base64_Digit(Header.After.Data[Index]);
+            if(Digit >= 0)
+            {
+               Bits = (Bits << 6) | (u32)Digit;
+               Bit_Count += 6;
+               if(Bit_Count >= 8)
+               {
+                  Bit_Count -= 8;
+                  Data[Length++] = (u8)(Bits >> Bit_Count);
+               }
+            }
+         }
+
+         Result.Data = Data;
+         Result.Length = Length;
+      }
+      else
+      {
+         Log("Data uris in %s have to be base64 encoded.\n", Path);
+      }
+   }
+   else
+   {
+      char *Full_Path = Get_GLTF_Uri_Path(Uri, &Scratch, Path);
+      if(!Full_Path)
+      {
+         return(Result);
+      }
+
+      *File = Map_Entire_File(Full_Path);
+      Result = *File;
+   }
+
+   return(Result);
+}
+
+static void Load_GLTF_Buffer_Uri(gltf_buffer *Buffer, string Uri, arena *Arena, arena Scratch, char *Path)
+{
+   // NOTE: Data is left null if the buffer can't be loaded or is shorter than
+   // its byteLength.
+   string File;
+   string Data = Load_GLTF_Uri(Uri, Arena, Scratch, Path, &File);
+   if(Data.Data && Data.Length < Buffer->Length)
+   {
+      Log("A buffer in %s is shorter than its byteLength.\n", Path);
+      if(File.Data)
+      {
+         Unmap_Entire_File(File.Data, File.Length);
+      }
+   }
+   else if(Data.Data)
+   {
+      Buffer->Data = Data.Data;
+      Buffer->File = File;
+   }
+}
+
+// NOTE: Accessor reading happens in up to three passes over the data, each of
+// which streams through memory once: elements are gathered out of their view
+// at its stride, sparse elements are substituted, then components are
+// converted. The gather and convert kernels use SSE2 on any x64 target and a
+// scalar loop everywhere else.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define GLTF_ACCESSOR_SSE2 1
+#endif
+
+static u8 *Get_GLTF_View_Data(gltf_scene *Scene, int View_Index, idx Offset, idx Count, idx Element_Size, idx *Stride)
+{
+   // NOTE: Returns the first element of a range of a buffer view, or null if
+   // the range doesn't fit in the view and its buffer. Stride is set to
+   // the view's stride, or the element size if it's tightly packed.
+   u8 *Result = 0;
+   if(View_Index >= 0 && View_Index < Scene->Buffer_View_Count && Offset >= 0)
+   {
+      gltf_buffer_view View = Scene->Buffer_Views[View_Index];
+      *Stride = View.Stride ? View.Stride : Element_Size;
+
+      idx Size = Count ? (Count - 1)*(*Stride) + Element_Size : 0;
+      gltf_buffer *Buffer = (View.Buffer >= 0 && View.Buffer < Scene->Buffer_Count) ? Scene->Buffers + View.Buffer : 0;
+      if(Buffer && Buffer->Data && View.Offset >= 0 && Offset + Size <= View.Length && View.Offset + View.Length <= Buffer->Length)
+      {
+         Result = Buffer->Data + View.Offset + Offset;
+      }
+   }
+
+   return(Result);
+}
+
+static void Gather_GLTF_Elements(u8 *To, u8 *From, idx Count, idx Element_Size, idx Stride)
+{
+   if(Stride == Element_Size)
+   {
+      Copy_Memory(To, From, Count*Element_Size);
+   }
+#if GLTF_ACCESSOR_SSE2
+   else if(Element_Size <= 16 && Stride >= 16)
+   {
+      // NOTE: Elements are moved as a whole 16 bytes. Reads stay within each
+      // element's stride, and the excess written spills into the slots of the
+      // elements after it, which are written later. Only the last few, whose
+      // spill would run past the end, are copied exactly.
+      idx Tail = Minimum(Count, (16 + Element_Size - 1) / Element_Size);
+      idx Index = 0;
+      for(; Index < Count - Tail; ++Index)
+      {
+         __m128i Element = _mm_loadu_si128((__m128i *)(From + Index*Stride));
+         _mm_storeu_si128((__m128i *)(To + Index*Element_Size), Element);
+      }
+      for(; Index < Count; ++Index)
+      {
+         Copy_Memory(To + Index*Element_Size, From + Index*Stride, Element_Size);
+      }
+   }
+   else if(Element_Size <= 8 && Stride >= 8)
+   {
+      idx Tail = Minimum(Count, (8 + Element_Size - 1) / Element_Size);
+      idx Index = 0;
+      for(; Index < Count - Tail; ++Index)
+      {
+         __m128i Element = _mm_loadl_epi64((__m128i *)(From + Index*Stride));
+         _mm_storel_epi64((__m128i *)(To + Index*Element_Size), Element);
+      }
+      for(; Index < Count; ++Index)
+      {
+         Copy_Memory(To + Index*Element_Size, From + Index*Stride, Element_Size);
+      }
+   }
+#endif
+   else
+   {
+      for(idx Index = 0; Index < Count; ++Index)
+      {
+         Copy_Memory(To + Index*Element_Size, From + Index*Stride, Element_Size);
+      }
+   }
+}
+
+static inline float Read_GLTF_Component(u8 *From, gltf_component_type Type, bool Normalized)
+{
+   // NOTE: Normalized conversions follow the glTF spec, so signed values are
+   // clamped to -1 rather than reaching slightly past it. They multiply by the
+   // reciprocal to match the SIMD kernel bit for bit.
+   float Result = 0;
+   switch(Type)
+   {
+      case GLTF_ACCESSOR_COMPONENT_S8:  { Result = *(s8 *)From;  if(Normalized) Result = Maximum(Result * (1.0f / 127.0f), -1.0f); } break;
+      case GLTF_ACCESSOR_COMPONENT_U8:  { Result = *From;        if(Normalized) Result = Result * (1.0f / 255.0f); } break;
+      case GLTF_ACCESSOR_COMPONENT_S16: { s16 Value; Copy_Memory(&Value, From, 2); Result = Value; if(Normalized) Result = Maximum(Result * (1.0f / 32767.0f), -1.0f); } break;
+      case GLTF_ACCESSOR_COMPONENT_U16: { u16 Value; Copy_Memory(&Value, From, 2); Result = Value; if(Normalized) Result = Result * (1.0f / 65535.0f); } break;
+      case GLTF_ACCESSOR_COMPONENT_U32: { u32 Value; Copy_Memory(&Value, From, 4); Result = (float)Value; } break;
+      case GLTF_ACCESSOR_COMPONENT_F32: { Copy_Memory(&Result, From, 4); } break;
+      default: { Invalid_Code_Path; } break;
+   }
+
+   return(Result);
+}
+
+static inline u32 Read_GLTF_Integer_Component(u8 *From, gltf_component_type Type)
+{
+   u32 Result = 0;
+   switch(Type)
+   {
+      case GLTF_ACCESSOR_COMPONENT_U8:  { Result = *From; } break;
+      case GLTF_ACCESSOR_COMPONENT_U16: { u16 Value; Copy_Memory(&Value, From, 2); Result = Value; } break;
+      case GLTF_ACCESSOR_COMPONENT_U32: { Copy_Memory(&Result, From, 4); } break;
+      default: { Invalid_Code_Path; } break;
+   }
+
+   return(Result);
+}
+
+#if GLTF_ACCESSOR_SSE2
+static inline void Store_GLTF_Floats(float *To, __m128i Values, __m128 Scale, __m128 Lower)
+{
+   _mm_storeu_ps(To, _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(Values), Scale), Lower));
+}
+#endif
+
+static void Convert_GLTF_Components(float *To, u8 *From, idx Count, gltf_component_type Type, bool Normalized)
+{
+   // NOTE: Converts Count tightly packed components to floats.
+   idx Size = Get_GLTF_Type_Size(GLTF_ACCESSOR_TYPE_SCALAR, Type);
+   idx Index = 0;
+
+   if(Type == GLTF_ACCESSOR_COMPONENT_F32)
+   {
+      Copy_Memory(To, From, Count*Size);
+      Index = Count;
+   }
+#if GLTF_ACCESSOR_SSE2
+   else if(Type != GLTF_ACCESSOR_COMPONENT_U32)
+   {
+      // NOTE: Integers are widened to 32 bits by interleaving them with zeros,
+      // or with themselves and shifting arithmetically when they're signed.
+      bool Signed = (Type == GLTF_ACCESSOR_COMPONENT_S8 || Type == GLTF_ACCESSOR_COMPONENT_S16);
+      float Range = (Type == GLTF_ACCESSOR_COMPONENT_S8) ? 127.0f : (Type == GLTF_ACCESSOR_COMPONENT_U8) ? 255.0f :
+                    (Type == GLTF_ACCESSOR_COMPONENT_S16) ? 32767.0f : 65535.0f;
+
+      __m128 Scale = _mm_set1_ps(Normalized ? 1.0f / Range : 1.0f);
+      __m128 Lower = _mm_set1_ps((Normalized && Signed) ? -1.0f : -65536.0f);
+      __m128i Zero = _mm_setzero_si128();
+
+      if(Size == 1)
+      {
+         for(; Index + 16 <= Count; Index += 16)
+         {
+            __m128i Bytes = _mm_loadu_si128((__m128i *)(From + Index));
+            __m128i Lo = Signed ? _mm_srai_epi16(_mm_unpacklo_epi8(Bytes, Bytes), 8) : _mm_unpacklo_epi8(Bytes, Zero);
+            __m128i Hi = Signed ? _mm_srai_epi16(_mm_unpackhi_epi8(Bytes, Bytes), 8) : _mm_unpackhi_epi8(Bytes, Zero);
+
+            __m128i Words[2] = {Lo, Hi};
+            for(int Half = 0; Half < 2; ++Half)
+            {
+               __m128i W = Words[Half];
+               __m128i A = _mm_srai_epi32(_mm_unpacklo_epi16(W, W), 16);
+               __m128i B = _mm_srai_epi32(_mm_unpackhi_epi16(W, W), 16);
+               Store_GLTF_Floats(To + Index + 8*Half + 0, A, Scale, Lower);
+               Store_GLTF_Floats(To + Index + 8*Half + 4, B, Scale, Lower);
+            }
+         }
+      }
+      else
+      {
+         for(; Index + 8 <= Count; Index += 8)
+         {
+            __m128i Words = _mm_loadu_si128((__m128i *)(From + 2*Index));
+            __m128i A = Signed ? _mm_srai_epi32(_mm_unpacklo_epi16(Words, Words), 16) : _mm_unpacklo_epi16(Words, Zero);
+            __m128i B = Signed ? _mm_srai_epi32(_mm_unpackhi_epi16(Words, Words), 16) : _mm_unpackhi_epi16(Words, Zero);
+            Store_GLTF_Floats(To + Index + 0, A, Scale, Lower);
+            Store_GLTF_Floats(To + Index + 4, B, Scale, Lower);
+         }
+      }
+   }
+#endif
+
+   for(; Index < Count; ++Index)
+   {
+      To[Index] = Read_GLTF_Component(From + Index*Size, Type, Normalized);
+   }
+}
+
+static bool Read_GLTF_Accessor(gltf_scene *Scene, gltf_accessor *Accessor, void *Destination,
+                               gltf_component_type Component_Type, int Component_Count, arena Scratch)
+{
+   // NOTE: Returns false, leaving Destination partly written, if any of the
+   // accessor's data is outside of its buffer, a sparse index is out of range
+   // or a conversion doesn't fit in Scratch.
+   bool Result = true;
+
+   idx Count = Accessor->Count;
+   int Source_Component_Count = GLTF_Accessor_Type_Infos[Accessor->Type].Component_Count;
+   idx Element_Size = Get_GLTF_Type_Size(Accessor->Type, Accessor->Component_Type);
+
+   bool Same_Format = (Component_Type == Accessor->Component_Type && Component_Count == Source_Component_Count);
+   Assert(Same_Format || Component_Type == GLTF_ACCESSOR_COMPONENT_F32 || Component_Type == GLTF_ACCESSOR_COMPONENT_U32);
+
+   u8 *Dense = Same_Format ? (u8 *)Destination : Try_Allocate(&Scratch, u8, Count*Element_Size);
+   if(!Dense)
+   {
+      return(false);
+   }
+
+   if(Accessor->Buffer_View >= 0)
+   {
+      idx Stride;
+      u8 *From = Get_GLTF_View_Data(Scene, Accessor->Buffer_View, Accessor->Offset, Count, Element_Size, &Stride);
+      if(From)
+      {
+         Gather_GLTF_Elements(Dense, From, Count, Element_Size, Stride);
+      }
+      else
+      {
+         Result = false;
+      }
+   }
+   else
+   {
+      Zero_Memory(Dense, Count*Element_Size);
+   }
+
+   gltf_sparse *Sparse = &Accessor->Sparse;
+   if(Result && Sparse->Count > 0)
+   {
+      idx Index_Size = Get_GLTF_Type_Size(GLTF_ACCESSOR_TYPE_SCALAR, Sparse->Index_Type);
+      idx Indices_Stride, Values_Stride;
+      u8 *Indices = Get_GLTF_View_Data(Scene, Sparse->Indices_View, Sparse->Indices_Offset, Sparse->Count, Index_Size, &Indices_Stride);
+      u8 *Values = Get_GLTF_View_Data(Scene, Sparse->Values_View, Sparse->Values_Offset, Sparse->Count, Element_Size, &Values_Stride);
+
+      Result = (Indices && Values);
+      for(idx Sparse_Index = 0; Result && Sparse_Index < Sparse->Count; ++Sparse_Index)
+      {
+         u32 Index = Read_GLTF_Integer_Component(Indices + Sparse_Index*Index_Size, Sparse->Index_Type);
+         if(Index < (u32)Count)
+         {
+            Copy_Memory(Dense + Index*Element_Size, Values + Sparse_Index*Element_Size, Element_Size);
+         }
+         else
+         {
+            Result = false;
+         }
+      }
+   }
+
+   if(Result && !Same_Format)
+   {
+      if(Component_Type == GLTF_ACCESSOR_COMPONENT_F32)
+      {
+         float *To = (float *)Destination;
+         if(Component_Count == Source_Component_Count)
+         {
+            Convert_GLTF_Components(To, Dense, Count*Component_Count, Accessor->Component_Type, Accessor->Normalized);
+         }
+         else
+         {
+            float *Converted = Try_Allocate(&Scratch, float, Count*Source_Component_Count);
+            if(!Converted)
+            {
+               return(false);
+            }
+            Convert_GLTF_Components(Converted, Dense, Count*Source_Component_Count, Accessor->Component_Type, Accessor->Normalized);
+
+            for(idx Index = 0; Index < Count; ++Index)
+            {
+               for(int Component = 0; Component < Component_Count; ++Component)
+               {
+                  To[Index*Component_Count + Component] = (Component < Source_Component_Count)
+                     ? Converted[Index*Source_Component_Count + Component]
+                     : (Component == 3) ? 1.0f : 0.0f;
+               }
+            }
+         }
+      }
+      else
+      {
+         u32 *To = (u32 *)Destination;
+         idx Component_Size = Element_Size / Source_Component_Count;
+         for(idx Index = 0; Index < Count; ++Index)
+         {
+            for(int Component = 0; Component < Component_Count; ++Component)
+            {
+               To[Index*Component_Count + Component] = (Component < Source_Component_Count)
+                  ? Read_GLTF_Integer_Component(Dense + Index*Element_Size + Component*Component_Size, Accessor->Component_Type)
+                  : (Component == 3) ? 1 : 0;
+            }
+         }
+      }
+   }
+
+   return(Result);
+}
+
+static bool Resolve_Dense_GLTF_Accessors(gltf_scene *Scene, arena *Arena, arena Scratch, char *Path)
+{
+   // NOTE: The renderer binds accessors straight out of their buffers, so
+   // sparse accessors (and accessors without a view) are read into dense
+   // copies in an extra buffer, each with a view of its own. 8-bit indices
+   // need VK_EXT_index_type_uint8, which we don't require, so those accessors
+   // are copied out the same way and widened to 16 bits. Returns false if the
+   // arenas run out of room.
+   bool *Widen = Try_Allocate(&Scratch, bool, Scene->Accessor_Count);
+   if(!Widen)
+   {
+      return(false);
+   }
+
+   for(int Primitive_Index = 0; Primitive_Index < Scene->Primitive_Count; ++Primitive_Index)
+   {
+      int Indices = Scene->Primitives[Primitive_Index].Indices;
+      if(Indices >= 0 && Indices < Scene->Accessor_Count &&
+         Scene->Accessors[Indices].Component_Type == GLTF_ACCESSOR_COMPONENT_U8 &&
+         Scene->Accessors[Indices].Type == GLTF_ACCESSOR_TYPE_SCALAR)
+      {
+         Widen[Indices] = true;
+      }
+   }
+
+   int Dense_Count = 0;
+   idx Extra_Size = 0;
+   for(int Accessor_Index = 0; Accessor_Index < Scene->Accessor_Count; ++Accessor_Index)
+   {
+      gltf_accessor *Accessor = Scene->Accessors + Accessor_Index;
+      if(Accessor->Sparse.Count > 0 || Accessor->Buffer_View < 0 || Widen[Accessor_Index])
+      {
+         gltf_component_type Component_Type = Widen[Accessor_Index] ? GLTF_ACCESSOR_COMPONENT_U16 : Accessor->Component_Type;
+
+         Dense_Count++;
+         Extra_Size += Align_Offset(Accessor->Count * Get_GLTF_Type_Size(Accessor->Type, Component_Type), 4);
+      }
+   }
+
+   if(Dense_Count)
+   {
+      gltf_buffer *Buffers = Try_Allocate(Arena, gltf_buffer, Scene->Buffer_Count + 1);
+      u8 *Dense_Data = Try_Allocate(Arena, u8, Extra_Size);
+      gltf_buffer_view *Buffer_Views = Try_Allocate(Arena, gltf_buffer_view, Scene->Buffer_View_Count + Dense_Count);
+      if(!Buffers || !Dense_Data || !Buffer_Views)
+      {
+         return(false);
+      }
+
+      Copy_Memory(Buffers, Scene->Buffers, Scene->Buffer_Count*sizeof(*Buffers));
+
+      gltf_buffer *Dense = Buffers + Scene->Buffer_Count;
+      Dense->Length = Extra_Size;
+      Dense->Data = Dense_Data;
+
+      Copy_Memory(Buffer_Views, Scene->Buffer_Views, Scene->Buffer_View_Count*sizeof(*Buffer_Views));
+
+      // NOTE: Reads still go through the original buffers and views, which the
+      // copies leave intact.
+      int View_Count = Scene->Buffer_View_Count;
+      idx Offset = 0;
+      for(int Accessor_Index = 0; Accessor_Index < Scene->Accessor_Count; ++Accessor_Index)
+      {
+         gltf_accessor *Accessor = Scene->Accessors + Accessor_Index;
+         if(Accessor->Sparse.Count > 0 || Accessor->Buffer_View < 0 || Widen[Accessor_Index])
+         {
+            bool Read;
+            idx Size;
+            if(Widen[Accessor_Index])
+            {
+               arena Index_Scratch = Scratch;
+               u32 *Indices = Try_Allocate(&Index_Scratch, u32, Accessor->Count);
+               if(!Indices)
+               {
+                  return(false);
+               }
+               Read = Read_GLTF_Accessor(Scene, Accessor, Indices, GLTF_ACCESSOR_COMPONENT_U32, 1, Index_Scratch);
+
+               u16 *Widened = (u16 *)(Dense->Data + Offset);
+               for(idx Index = 0; Read && Index < Accessor->Count; ++Index)
+               {
+                  Widened[Index] = (u16)Indices[Index];
+               }
+
+               Accessor->Component_Type = GLTF_ACCESSOR_COMPONENT_U16;
+               Size = Accessor->Count * sizeof(u16);
+            }
+            else
+            {
+               int Component_Count = GLTF_Accessor_Type_Infos[Accessor->Type].Component_Count;
+               Read = Read_GLTF_Accessor(Scene, Accessor, Dense->Data + Offset, Accessor->Component_Type, Component_Count, Scratch);
+               Size = Accessor->Count * Get_GLTF_Type_Size(Accessor->Type, Accessor->Component_Type);
+            }
+
+            if(!Read)
+            {
+               Log("Accessor %d in %s couldn't be read and will be zeros.\n", Accessor_Index, Path);
+               Zero_Memory(Dense->Data + Offset, Size);
+            }
+
+            gltf_buffer_view *View = Buffer_Views + View_Count;
+            View->Buffer = Scene->Buffer_Count;
+            View->Offset = Offset;
+            View->Length = Size;
+
+            Accessor->Buffer_View = View_Count++;
+            Accessor->Offset = 0;
+            Zero_Struct(&Accessor->Sparse);
+
+            Offset += Align_Offset(Size, 4);
+         }
+      }
+
+      Scene->Buffers = Buffers;
+      Scene->Buffer_Count++;
+      Scene->Buffer_Views = Buffer_Views;
+      Scene->Buffer_View_Count = View_Count;
+   }
+
+   return(true);
+}
+
+static bool Decode_GLTF_Images(gltf_scene *Scene, int *Image_Views, string *Image_Uris, arena *Arena, arena Scratch, char *Path)
+{
+   // NOTE: Every image's source is found and measured first, so that they can
+   // all be decoded straight into one packed allocation. Images that can't be
+   // decoded are left with GLTF_IMAGE_FORMAT_NONE. Returns false if the packed
+   // allocation doesn't fit.
+   string *Sources = Try_Allocate(&Scratch, string, Scene->Image_Count);
+   string *Files = Try_Allocate(&Scratch, string, Scene->Image_Count);
+   if(!Sources || !Files)
+   {
+      return(false);
+   }
+
+   idx Total_Size = 0;
+   for(int Image_Index = 0; Image_Index < Scene->Image_Count; ++Image_Index)
+   {
+      gltf_image *Image = Scene->Images + Image_Index;
+      string Source = {0};
+
+      int View_Index = Image_Views[Image_Index];
+      if(View_Index >= 0 && View_Index < Scene->Buffer_View_Count)
+      {
+         idx Stride;
+         idx Length = Scene->Buffer_Views[View_Index].Length;
+         Source.Data = Get_GLTF_View_Data(Scene, View_Index, 0, 1, Length, &Stride);
+         Source.Length = Source.Data ? Length : 0;
+      }
+      else if(Image_Uris[Image_Index].Length)
+      {
+         Source = Load_GLTF_Uri(Image_Uris[Image_Index], Arena, Scratch, Path, Files + Image_Index);
+      }
+
+      int Width, Height;
+      if(Get_Image_Size(Source, &Width, &Height))
+      {
+         Image->Format = GLTF_IMAGE_FORMAT_RGBA8;
+         Image->Width = Width;
+         Image->Height = Height;
+         Image->Mip_Count = Get_GLTF_Mip_Count(Width, Height);
+         Image->Offset = Total_Size;
+         Image->Size = Get_GLTF_Mip_Chain_Size(Image->Format, Width, Height, Image->Mip_Count);
+
+         Sources[Image_Index] = Source;
+         Total_Size += Image->Size;
+      }
+      else if(Source.Length >= 2 && Source.Data[0] == 0xFF && Source.Data[1] == 0xD8)
+      {
+         Log("Image %d in %s is a JPEG, which can't be decoded yet.\n", Image_Index, Path);
+      }
+      else
+      {
+         Log("Image %d in %s couldn't be loaded.\n", Image_Index, Path);
+      }
+   }
+
+   Scene->Image_Data = Try_Allocate(Arena, u8, Total_Size);
+   Scene->Image_Data_Size = Scene->Image_Data ? Total_Size : 0;
+
+   for(int Image_Index = 0; Image_Index < Scene->Image_Count; ++Image_Index)
+   {
+      gltf_image *Image = Scene->Images + Image_Index;
+      if(Scene->Image_Data && Image->Format == GLTF_IMAGE_FORMAT_RGBA8)
+      {
+         u8 *Pixels = Scene->Image_Data + Image->Offset;
+         bool Srgb = (Image->Usage == GLTF_IMAGE_USAGE_COLOR);
+         if(!Decode_PNG(Sources[Image_Index], Pixels, Scratch) ||
+            !Build_Image_Mips(Pixels, Image->Width, Image->Height, Image->Mip_Count, Srgb, Scratch))
+         {
+            Log("Image %d in %s couldn't be decoded.\n", Image_Index, Path);
+            Image->Format = GLTF_IMAGE_FORMAT_NONE;
+         }
+      }
+
+      if(Files[Image_Index].Data)
+      {
+         Unmap_Entire_File(Files[Image_Index].Data, Files[Image_Index].Length);
+      }
+   }
+
+   return(Scene->Image_Data != 0);
+}
+
+static string Lay_Out_Baked_Scene(gltf_scene *Scene, baked_scene_tables *Tables, arena *Output)
+{
+   // NOTE: Makes Output just large enough for the file and copies every table
+   // into it. Only the binary data is left for the caller to fill in, with each
+   // buffer view's data going at Binary_Offset plus the offset assigned to it
+   // here. The caller frees Output once the file is written.
+   baked_scene_header Header = {0};
+   Header.Magic = BAKED_SCENE_MAGIC_NUMBER;
+   Header.Version = BAKED_SCENE_VERSION;
+   Header.Alignment = BAKED_SCENE_ALIGNMENT;
+   Header.Source_Stamp = Tables->Source_Stamp;
+
+   u64 Offset = sizeof(Header);
+
+   Header.Mesh_Count = Scene->Mesh_Count;
+   Header.Mesh_Offset = (u32)Offset;
+   Offset = Align_Offset(Offset + Header.Mesh_Count*sizeof(baked_mesh), 8);
+
+   Header.Primitive_Count = Scene->Primitive_Count;
+   Header.Primitive_Offset = (u32)Offset;
+   Offset = Align_Offset(Offset + Header.Primitive_Count*sizeof(gltf_primitive), 8);
+
+   Header.Accessor_Count = Scene->Accessor_Count;
+   Header.Accessor_Offset = (u32)Offset;
+   Offset = Align_Offset(Offset + Header.Accessor_Count*sizeof(gltf_accessor), 8);
+
+   Header.Buffer_View_Count = Tables->Buffer_View_Count;
+   Header.Buffer_View_Offset = (u32)Offset;
+   Offset = Align_Offset(Offset + Header.Buffer_View_Count*sizeof(gltf_buffer_view), 8);
+
+   Header.Node_Count = Scene->Nodes.Count;
+   Header.Node_Mesh_Offset = (u32)Offset;
+   Offset = Align_Offset(Offset + Header.Node_Count*sizeof(int), 8);
+   Header.Node_Parent_Offset = (u32)Offset;
+   Offset = Align_Offset(Offset + Header.Node_Count*sizeof(int), 8);
+   Header.Node_Local_Offset = (u32)Offset;
+   Offset = Align_Offset(Offset + Header.Node_Count*sizeof(matrix4), 8);
+   Header.Node_World_Offset = (u32)Offset;
+   Offset = Align_Offset(Offset + Header.Node_Count*sizeof(matrix4), 8);
+
+   Header.Draw_Count = Scene->Draw_Count;
+   Header.Draw_Offset = (u32)Offset;
+   Offset = Align_Offset(Offset + Header.Draw_Count*sizeof(gltf_draw), 8);
+
+   Header.Meshlet_Count = Tables->Meshlet_Count;
+   Header.Meshlet_Offset = (u32)Offset;
+   Offset = Align_Offset(Offset + Header.Meshlet_Count*sizeof(gltf_meshlet), 8);
+   Header.Meshlet_Vertex_Count = Tables->Meshlet_Vertex_Count;
+   Header.Meshlet_Vertex_Offset = (u32)Offset;
+   Offset = Align_Offset(Offset + Header.Meshlet_Vertex_Count*sizeof(u32), 8);
+   Header.Meshlet_Triangle_Count = Tables->Meshlet_Triangle_Count;
+   Header.Meshlet_Triangle_Offset = (u32)Offset;
+   Offset = Align_Offset(Offset + Header.Meshlet_Triangle_Count*3, 8);
+
+   Header.Lod_Count = Tables->Lod_Count;
+   Header.Lod_Offset = (u32)Offset;
+   Offset = Align_Offset(Offset + Header.Lod_Count*sizeof(gltf_lod), 8);
+
+   Header.Material_Count = Scene->Material_Count;
+   Header.Material_Offset = (u32)Offset;
+   Offset = Align_Offset(Offset + Header.Material_Count*sizeof(gltf_material), 8);
+   Header.Texture_Count = Scene->Texture_Count;
+   Header.Texture_Offset = (u32)Offset;
+   Offset = Align_Offset(Offset + Header.Texture_Count*sizeof(gltf_texture), 8);
+   Header.Sampler_Count = Scene->Sampler_Count;
+   Header.Sampler_Offset = (u32)Offset;
+   Offset = Align_Offset(Offset + Header.Sampler_Count*sizeof(gltf_sampler), 8);
+   Header.Image_Count = Scene->Image_Count;
+   Header.Image_Offset = (u32)Offset;
+   Offset = Align_Offset(Offset + Header.Image_Count*sizeof(gltf_image), BAKED_SCENE_ALIGNMENT);
+
+   Header.Binary_Offset = Offset;
+   for(int View_Index = 0; View_Index < Tables->Buffer_View_Count; ++View_Index)
+   {
+      gltf_buffer_view *View = Tables->Buffer_Views + View_Index;
+      Header.Binary_Size = Align_Offset(Header.Binary_Size, BAKED_SCENE_ALIGNMENT);
+      View->Buffer = 0;
+      View->Offset = (idx)Header.Binary_Size;
+      Header.Binary_Size += View->Length;
+   }
+
+   Header.Image_Data_Offset = Align_Offset(Header.Binary_Offset + Header.Binary_Size, BAKED_SCENE_ALIGNMENT);
+   Header.Image_Data_Size = Tables->Image_Data_Size;
+   Header.File_Size = Header.Image_Data_Offset + Header.Image_Data_Size;
+
+   Make_Arena(Output, Header.File_Size);
+   u8 *Base = Allocate(Output, u8, Header.File_Size);
+
+   Copy_Memory(Base, &Header, sizeof(Header));
+
+   baked_mesh *Meshes = (baked_mesh *)(Base + Header.Mesh_Offset);
+   for(int Mesh_Index = 0; Mesh_Index < Scene->Mesh_Count; ++Mesh_Index)
+   {
+      gltf_mesh *Mesh = Scene->Meshes + Mesh_Index;
+      Meshes[Mesh_Index].First_Primitive = (u32)(Mesh->Primitives - Scene->Primitives);
+      Meshes[Mesh_Index].Primitive_Count = Mesh->Primitive_Count;
+   }
+   Copy_Memory(Base + Header.Primitive_Offset, Tables->Primitives, Header.Primitive_Count*sizeof(gltf_primitive));
+   Copy_Memory(Base + Header.Accessor_Offset, Tables->Accessors, Header.Accessor_Count*sizeof(gltf_accessor));
+   Copy_Memory(Base + Header.Buffer_View_Offset, Tables->Buffer_Views, Header.Buffer_View_Count*sizeof(gltf_buffer_view));
+
+   Copy_Memory(Base + Header.Node_Mesh_Offset, Scene->Nodes.Mesh, Header.Node_Count*sizeof(int));
+   Copy_Memory(Base + Header.Node_Parent_Offset, Scene->Nodes.Parent, Header.Node_Count*sizeof(int));
+   Copy_Memory(Base + Header.Node_Local_Offset, Scene->Nodes.Local, Header.Node_Count*sizeof(matrix4));
+   Copy_Memory(Base + Header.Node_World_Offset, Scene->Nodes.World, Header.Node_Count*sizeof(matrix4));
+   Copy_Memory(Base + Header.Draw_Offset, Scene->Draws, Header.Draw_Count*sizeof(gltf_draw));
+   Copy_Memory(Base + Header.Meshlet_Offset, Tables->Meshlets, Header.Meshlet_Count*sizeof(gltf_meshlet));
+   Copy_Memory(Base + Header.Meshlet_Vertex_Offset, Tables->Meshlet_Vertices, Header.Meshlet_Vertex_Count*sizeof(u32));
+   Copy_Memory(Base + Header.Meshlet_Triangle_Offset, Tables->Meshlet_Triangles, Header.Meshlet_Triangle_Count*3);
+   Copy_Memory(Base + Header.Lod_Offset, Tables->Lods, Header.Lod_Count*sizeof(gltf_lod));
+   Copy_Memory(Base + Header.Material_Offset, Scene->Materials, Header.Material_Count*sizeof(gltf_material));
+   Copy_Memory(Base + Header.Texture_Offset, Scene->Textures, Header.Texture_Count*sizeof(gltf_texture));
+   Copy_Memory(Base + Header.Sampler_Offset, Scene->Samplers, Header.Sampler_Count*sizeof(gltf_sampler));
+   Copy_Memory(Base + Header.Image_Offset, Tables->Images, Header.Image_Count*sizeof(gltf_image));
+   Copy_Memory(Base + Header.Image_Data_Offset, Tables->Image_Data, Header.Image_Data_Size);
+
+   string Result = {(idx)Header.File_Size, Base};
+   return(Result);
+}
+
+// NOTE: Baked scene loading. Nothing is parsed here: the tables are used in
+// place from the loaded file, and only the meshes need their primitive pointers
+// patched up. Returns false if the file is missing, was baked by a different
+// version, or (for a nonzero Source_Stamp) was baked from a different version
+// of its source, in which case the caller should fall back to Parse_GLTF.
+static bool Baked_Table_Fits(string File, u64 Offset, u64 Count, u64 Size)
+{
+   bool Result = (Offset <= (u64)File.Length && Count <= ((u64)File.Length - Offset) / Size);
+   return(Result);
+}
+
+static bool Load_Baked_Scene(gltf_scene *Result, arena *Arena, char *Path, u64 Source_Stamp)
+{
+   bool Loaded = false;
+
+   string File = Map_Entire_File(Path);
+   baked_scene_header *Header = (baked_scene_header *)File.Data;
+
+   if(!File.Data || File.Length < (idx)sizeof(*Header))
+   {
+      Log("Failed to load baked scene %s.\n", Path);
+   }
+   else if(Header->Magic != BAKED_SCENE_MAGIC_NUMBER || Header->Version != BAKED_SCENE_VERSION)
+   {
+      Log("Failed to load %s: it was not baked by this version (found %u, expected %u).\n",
+          Path, Header->Version, BAKED_SCENE_VERSION);
+   }
+   else if(Source_Stamp && Header->Source_Stamp != Source_Stamp)
+   {
+      Log("Skipping %s: its source has changed since it was baked.\n", Path);
+   }
+   else if(Header->File_Size != (u64)File.Length ||
+           !Baked_Table_Fits(File, Header->Mesh_Offset, Header->Mesh_Count, sizeof(baked_mesh)) ||
+           !Baked_Table_Fits(File, Header->Primitive_Offset, Header->Primitive_Count, sizeof(gltf_primitive)) ||
+           !Baked_Table_Fits(File, Header->Accessor_Offset, Header->Accessor_Count, sizeof(gltf_accessor)) ||
+           !Baked_Table_Fits(File, Header->Buffer_View_Offset, Header->Buffer_View_Count, sizeof(gltf_buffer_view)) ||
+           !Baked_Table_Fits(File, Header->Node_Mesh_Offset, Header->Node_Count, sizeof(int)) ||
+           !Baked_Table_Fits(File, Header->Node_Parent_Offset, Header->Node_Count, sizeof(int)) ||
+           !Baked_Table_Fits(File, Header->Node_Local_Offset, Header->Node_Count, sizeof(matrix4)) ||
+           !Baked_Table_Fits(File, Header->Node_World_Offset, Header->Node_Count, sizeof(matrix4)) ||
+           !Baked_Table_Fits(File, Header->Draw_Offset, Header->Draw_Count, sizeof(gltf_draw)) ||
+           !Baked_Table_Fits(File, Header->Meshlet_Offset, Header->Meshlet_Count, sizeof(gltf_meshlet)) ||
+           !Baked_Table_Fits(File, Header->Meshlet_Vertex_Offset, Header->Meshlet_Vertex_Count, sizeof(u32)) ||
+           !Baked_Table_Fits(File, Header->Meshlet_Triangle_Offset, Header->Meshlet_Triangle_Count, 3) ||
+           !Baked_Table_Fits(File, Header->Lod_Offset, Header->Lod_Count, sizeof(gltf_lod)) ||
+           !Baked_Table_Fits(File, Header->Material_Offset, Header->Material_Count, sizeof(gltf_material)) ||
+           !Baked_Table_Fits(File, Header->Texture_Offset, Header->Texture_Count, sizeof(gltf_texture)) ||
+           !Baked_Table_Fits(File, Header->Sampler_Offset, Header->Sampler_Count, sizeof(gltf_sampler)) ||
+           !Baked_Table_Fits(File, Header->Image_Offset, Header->Image_Count, sizeof(gltf_image)) ||
+           !Baked_Table_Fits(File, Header->Binary_Offset, Header->Binary_Size, 1) ||
+           !Baked_Table_Fits(File, Header->Image_Data_Offset, Header->Image_Data_Size, 1))
+   {
+      Log("Failed to load %s: its tables do not fit in the file.\n", Path);
+   }
+   else
+   {
+      Loaded = true;
+
+      gltf_primitive *Primitives = (gltf_primitive *)(File.Data + Header->Primitive_Offset);
+      baked_mesh *Baked_Meshes = (baked_mesh *)(File.Data + Header->Mesh_Offset);
+
+      Result->Primitive_Count = Header->Primitive_Count;
+      Result->Primitives = Primitives;
+
+      Result->Mesh_Count = Header->Mesh_Count;
+      Result->Meshes = Try_Allocate(Arena, gltf_mesh, Result->Mesh_Count);
+      Result->Buffers = Try_Allocate(Arena, gltf_buffer, 1);
+      if(!Result->Meshes || !Result->Buffers)
+      {
+         Log("Failed to load %s: it ran out of memory.\n", Path);
+         Loaded = false;
+      }
+
+      for(int Mesh_Index = 0; Loaded && Mesh_Index < Result->Mesh_Count; ++Mesh_Index)
+      {
+         baked_mesh *Baked_Mesh = Baked_Meshes + Mesh_Index;
+         if(Baked_Mesh->First_Primitive > Header->Primitive_Count ||
+            Baked_Mesh->Primitive_Count > Header->Primitive_Count - Baked_Mesh->First_Primitive)
+         {
+            Log("Failed to load %s: mesh %d references missing primitives.\n", Path, Mesh_Index);
+            Loaded = false;
+            break;
+         }
+
+         gltf_mesh *Mesh = Result->Meshes + Mesh_Index;
+         Mesh->Primitive_Count = Baked_Mesh->Primitive_Count;
+         Mesh->Primitives = Primitives + Baked_Mesh->First_Primitive;
+      }
+
+      Result->Accessor_Count = Header->Accessor_Count;
+      Result->Accessors = (gltf_accessor *)(File.Data + Header->Accessor_Offset);
+
+      Result->Buffer_View_Count = Header->Buffer_View_Count;
+      Result->Buffer_Views = (gltf_buffer_view *)(File.Data + Header->Buffer_View_Offset);
+
+      // NOTE: Baked scenes have a single buffer, which is the binary data.
+      if(Loaded)
+      {
+         Result->Buffer_Count = 1;
+         Result->Buffers[0].Length = Header->Binary_Size;
+         Result->Buffers[0].Data = File.Data + Header->Binary_Offset;
+      }
+
+      Result->Nodes.Count = Header->Node_Count;
+      Result->Nodes.Mesh = (int *)(File.Data + Header->Node_Mesh_Offset);
+      Result->Nodes.Parent = (int *)(File.Data + Header->Node_Parent_Offset);
+      Result->Nodes.Local = (matrix4 *)(File.Data + Header->Node_Local_Offset);
+      Result->Nodes.World = (matrix4 *)(File.Data + Header->Node_World_Offset);
+
+      Result->Draw_Count = Header->Draw_Count;
+      Result->Draws = (gltf_draw *)(File.Data + Header->Draw_Offset);
+
+      Result->Meshlet_Count = Header->Meshlet_Count;
+      Result->Meshlets = (gltf_meshlet *)(File.Data + Header->Meshlet_Offset);
+      Result->Meshlet_Vertex_Count = Header->Meshlet_Vertex_Count;
+      Result->Meshlet_Vertices = (u32 *)(File.Data + Header->Meshlet_Vertex_Offset);
+      Result->Meshlet_Triangle_Count = Header->Meshlet_Triangle_Count;
+      Result->Meshlet_Triangles = File.Data + Header->Meshlet_Triangle_Offset;
+
+      Result->Lod_Count = Header->Lod_Count;
+      Result->Lods = (gltf_lod *)(File.Data + Header->Lod_Offset);
+
+      Result->Material_Count = Header->Material_Count;
+      Result->Materials = (gltf_material *)(File.Data + Header->Material_Offset);
+      Result->Texture_Count = Header->Texture_Count;
+      Result->Textures = (gltf_texture *)(File.Data + Header->Texture_Offset);
+      Result->Sampler_Count = Header->Sampler_Count;
+      Result->Samplers = (gltf_sampler *)(File.Data + Header->Sampler_Offset);
+      Result->Image_Count = Header->Image_Count;
+      Result->Images = (gltf_image *)(File.Data + Header->Image_Offset);
+      Result->Image_Data_Size = Header->Image_Data_Size;
+      Result->Image_Data = File.Data + Header->Image_Data_Offset;
+
+      for(int View_Index = 0; Loaded && View_Index < Result->Buffer_View_Count; ++View_Index)
+      {
+         gltf_buffer_view *View = Result->Buffer_Views + View_Index;
+         if(View->Buffer != 0 || View->Offset < 0 || View->Length < 0 || (u64)(View->Offset + View->Length) > Header->Binary_Size)
+         {
+            Log("Failed to load %s: buffer view %d is outside of the binary data.\n", Path, View_Index);
+            Loaded = false;
+         }
+      }
+
+      for(int Accessor_Index = 0; Loaded && Accessor_Index < Result->Accessor_Count; ++Accessor_Index)
+      {
+         gltf_accessor *Accessor = Result->Accessors + Accessor_Index;
+         if(Accessor->Buffer_View < 0 || Accessor->Buffer_View >= Result->Buffer_View_Count || Accessor->Sparse.Count != 0)
+         {
+            Log("Failed to load %s: accessor %d was not baked into a dense view.\n", Path, Accessor_Index);
+            Loaded = false;
+         }
+         else if(Accessor->Type < 0 || Accessor->Type >= GLTF_ACCESSOR_TYPE_COUNT ||
+                 (Accessor->Component_Type != GLTF_ACCESSOR_COMPONENT_S8 && Accessor->Component_Type != GLTF_ACCESSOR_COMPONENT_U8 &&
+                  Accessor->Component_Type != GLTF_ACCESSOR_COMPONENT_S16 && Accessor->Component_Type != GLTF_ACCESSOR_COMPONENT_U16 &&
+                  Accessor->Component_Type != GLTF_ACCESSOR_COMPONENT_U32 && Accessor->Component_Type != GLTF_ACCESSOR_COMPONENT_F32))
+         {
+            Log("Failed to load %s: accessor %d has an unknown type.\n", Path, Accessor_Index);
+            Loaded = false;
+         }
+         else
+         {
+            // NOTE: Every element has to fit in the accessor's view.
+            idx Stride;
+            idx Element_Size = Get_GLTF_Type_Size(Accessor->Type, Accessor->Component_Type);
+            if(Accessor->Count < 0 || !Get_GLTF_View_Data(Result, Accessor->Buffer_View, Accessor->Offset, Accessor->Count, Element_Size, &Stride))
+            {
+               Log("Failed to load %s: accessor %d is outside of its buffer view.\n", Path, Accessor_Index);
+               Loaded = false;
+            }
+         }
+      }
+
+      for(int Primitive_Index = 0; Loaded && Primitive_Index < Result->Primitive_Count; ++Primitive_Index)
+      {
+         gltf_primitive *Primitive = Primitives + Primitive_Index;
+         int Accessors[] = {Primitive->Position, Primitive->Normal, Primitive->Texcoord_0, Primitive->Texcoord_1,
+                            Primitive->Color_0, Primitive->Color_1, Primitive->Indices};
+         bool Missing_Accessor = false;
+         for(int Slot = 0; Slot < Array_Count(Accessors); ++Slot)
+         {
+            Missing_Accessor |= (Accessors[Slot] < -1 || Accessors[Slot] >= Result->Accessor_Count);
+         }
+
+         if(Missing_Accessor)
+         {
+            Log("Failed to load %s: primitive %d references a missing accessor.\n", Path, Primitive_Index);
+            Loaded = false;
+         }
+         else if(Primitive->Material < -1 || Primitive->Material >= Result->Material_Count)
+         {
+            Log("Failed to load %s: primitive %d references a missing material.\n", Path, Primitive_Index);
+            Loaded = false;
+         }
+         else if(Primitive->First_Meshlet < 0 || Primitive->Meshlet_Count < 0 ||
+            Primitive->Meshlet_Count > Result->Meshlet_Count - Primitive->First_Meshlet)
+         {
+            Log("Failed to load %s: primitive %d references missing meshlets.\n", Path, Primitive_Index);
+            Loaded = false;
+         }
+         else if(Primitive->First_Lod < 0 || Primitive->Lod_Count < 0 ||
+                 Primitive->Lod_Count > Result->Lod_Count - Primitive->First_Lod ||
+                 (Primitive->Lod_Count > 0 && Primitive->Indices < 0))
+         {
+            Log("Failed to load %s: primitive %d references missing levels of detail.\n", Path, Primitive_Index);
+            Loaded = false;
+         }
+         else
+         {
+            // NOTE: Every level has to be a range of the primitive's indices.
+            for(int Lod_Index = 0; Lod_Index < Primitive->Lod_Count; ++Lod_Index)
+            {
+               gltf_lod *Lod = Result->Lods + Primitive->First_Lod + Lod_Index;
+               u32 Index_Count = (u32)Result->Accessors[Primitive->Indices].Count;
+               if(Lod->First_Index > Index_Count || Lod->Index_Count > Index_Count - Lod->First_Index)
+               {
+                  Log("Failed to load %s: primitive %d has a level of detail outside of its indices.\n", Path, Primitive_Index);
+                  Loaded = false;
+                  break;
+               }
+            }
+         }
+      }
+
+      for(int Draw_Index = 0; Loaded && Draw_Index < Result->Draw_Count; ++Draw_Index)
+      {
+         gltf_draw *Draw = Result->Draws + Draw_Index;
+         if(Draw->Primitive < 0 || Draw->Primitive >= Result->Primitive_Count ||
+            Draw->Node < -1 || Draw->Node >= Result->Nodes.Count)
+         {
+            Log("Failed to load %s: draw %d references a missing primitive or node.\n", Path, Draw_Index);
+            Loaded = false;
+         }
+      }
+
+      for(int Node_Index = 0; Loaded && Node_Index < Result->Nodes.Count; ++Node_Index)
+      {
+         int Mesh = Result->Nodes.Mesh[Node_Index];
+         int Parent = Result->Nodes.Parent[Node_Index];
+         if(Mesh < -1 || Mesh >= Result->Mesh_Count || Parent < -1 || Parent >= Result->Nodes.Count || Parent == Node_Index)
+         {
+            Log("Failed to load %s: node %d references a missing mesh or parent.\n", Path, Node_Index);
+            Loaded = false;
+         }
+      }
+
+      for(int Material_Index = 0; Loaded && Material_Index < Result->Material_Count; ++Material_Index)
+      {
+         gltf_material *Material = Result->Materials + Material_Index;
+         int Textures[] = {Material->Base_Color_Texture, Material->Metallic_Roughness_Texture, Material->Normal_Texture,
+                           Material->Occlusion_Texture, Material->Emissive_Texture};
+         for(int Slot = 0; Slot < Array_Count(Textures); ++Slot)
+         {
+            if(Textures[Slot] < -1 || Textures[Slot] >= Result->Texture_Count)
+            {
+               Log("Failed to load %s: material %d references a missing texture.\n", Path, Material_Index);
+               Loaded = false;
+               break;
+            }
+         }
+      }
+
+      for(int Texture_Index = 0; Loaded && Texture_Index < Result->Texture_Count; ++Texture_Index)
+      {
+         gltf_texture *Texture = Result->Textures + Texture_Index;
+         if(Texture->Image < -1 || Texture->Image >= Result->Image_Count ||
+            Texture->Sampler < -1 || Texture->Sampler >= Result->Sampler_Count)
+         {
+            Log("Failed to load %s: texture %d references a missing image or sampler.\n", Path, Texture_Index);
+            Loaded = false;
+         }
+      }
+
+      for(int Image_Index = 0; Loaded && Image_Index < Result->Image_Count; ++Image_Index)
+      {
+         gltf_image *Image = Result->Images + Image_Index;
+         if(Image->Format < GLTF_IMAGE_FORMAT_NONE || Image->Format > GLTF_IMAGE_FORMAT_BC7 ||
+            (Image->Format != GLTF_IMAGE_FORMAT_NONE &&
+            (Image->Width <= 0 || Image->Height <= 0 || Image->Offset < 0 ||
+             Image->Mip_Count < 1 || Image->Mip_Count > Get_GLTF_Mip_Count(Image->Width, Image->Height) ||
+             Image->Size != Get_GLTF_Mip_Chain_Size(Image->Format, Image->Width, Image->Height, Image->Mip_Count) ||
+             (u64)(Image->Offset + Image->Size) > Header->Image_Data_Size)))
+         {
+            Log("Failed to load %s: image %d is outside of the image data.\n", Path, Image_Index);
+            Loaded = false;
+         }
+      }
+
+      for(int Meshlet_Index = 0; Loaded && Meshlet_Index < Result->Meshlet_Count; ++Meshlet_Index)
+      {
+         gltf_meshlet *Meshlet = Result->Meshlets + Meshlet_Index;
+         if(Meshlet->Vertex_Offset > Header->Meshlet_Vertex_Count ||
+            Meshlet->Vertex_Count > Header->Meshlet_Vertex_Count - Meshlet->Vertex_Offset ||
+            Meshlet->Triangle_Offset > Header->Meshlet_Triangle_Count ||
+            Meshlet->Triangle_Count > Header->Meshlet_Triangle_Count - Meshlet->Triangle_Offset)
+         {
+            Log("Failed to load %s: meshlet %d references missing vertices or triangles.\n", Path, Meshlet_Index);
+            Loaded = false;
+         }
+      }
+
+      Result->File = File;
+   }
+
+   if(!Loaded)
+   {
+      if(File.Data)
+      {
+         Unmap_Entire_File(File.Data, File.Length);
+      }
+      Zero_Struct(Result);
+   }
+
+   return(Loaded);
+}
+
+static void Unload_Scene(gltf_scene *Scene)
+{
+   // NOTE: The tables allocated from the arena are released along with it,
+   // only the file mappings need to be handled explicitly. Scenes that failed
+   // partway through parsing may not have their buffers yet.
+   for(int Buffer_Index = 0; Scene->Buffers && Buffer_Index < Scene->Buffer_Count; ++Buffer_Index)
+   {
+      gltf_buffer *Buffer = Scene->Buffers + Buffer_Index;
+      if(Buffer->File.Data)
+      {
+         Unmap_Entire_File(Buffer->File.Data, Buffer->File.Length);
+      }
+   }
+   if(Scene->File.Data)
+   {
+      Unmap_Entire_File(Scene->File.Data, Scene->File.Length);
+   }
+   Zero_Struct(Scene);
+}
+
+static bool Get_Baked_Scene_Path(char *Result, idx Size, char *Path)
+{
+   // NOTE: "make bake" writes "data/name.glb" (or "data/name.gltf") to
+   // "name.scene" in the renderer's working directory, so only the file name
+   // of the source is kept.
+   char *Name = Get_File_Name(Path);
+
+   string Stem = {(idx)strlen(Name), (u8 *)Name};
+   if(!Has_Suffix_Then_Remove(&Stem, S(".glb")))
+   {
+      Has_Suffix_Then_Remove(&Stem, S(".gltf"));
+   }
+
+   string Extension = S(".scene");
+   bool Fits = (Stem.Length + Extension.Length < Size);
+   if(Fits)
+   {
+      Copy_Memory(Result, Stem.Data, Stem.Length);
+      Copy_Memory(Result + Stem.Length, Extension.Data, Extension.Length);
+      Result[Stem.Length + Extension.Length] = 0;
+   }
+
+   return(Fits);
+}
 
-static string Find_Json_Object_By_Key(string Json, string Key);
-static string Next_Json_Object(string Json);
+static u64 Hash_GLTF_Uri_Files(u64 Hash, string Source, arena Scratch, char *Path, bool Contents)
+{
+   // NOTE: Hashes every external file the uris in Source refer to into Hash,
+   // so that editing a .bin or an image next to a .gltf changes the result.
+   // Files are hashed by their contents if Contents is set, and otherwise by
+   // just their size and modification time. Uris are found by scanning the
+   // JSON for "uri" keys rather than parsing it, which at worst hashes in a
+   // file that isn't used.
+   u64 Result = Hash;
+
+   string Json = Source;
+   glb_header *Header = (glb_header *)Source.Data;
+   if(Source.Length >= (idx)(sizeof(*Header) + sizeof(glb_chunk_header)) && Header->Magic == GLB_MAGIC_NUMBER)
+   {
+      glb_chunk_header *Json_Header = (glb_chunk_header *)(Header + 1);
+      Json.Data = (u8 *)(Json_Header + 1);
+      Json.Length = Minimum((idx)Json_Header->Chunk_Length, Source.Length - (idx)(sizeof(*Header) + sizeof(*Json_Header)));
+   }
+
+   string Key = S("\"uri\"");
+   u8 *End = Json.Data + Json.Length;
+   for(u8 *At = Json.Data; At < End; ++At)
+   {
+      if(Has_Prefix(Span_String(At, End), Key))
+      {
+         At += Key.Length;
+         while(At < End && (*At == ' ' || *At == '\t' || *At == '\r' || *At == '\n' || *At == ':'))
+         {
+            At++;
+         }
+
+         if(At < End && *At == '"')
+         {
+            string Uri = {0, ++At};
+            while(At < End && *At != '"')
+            {
+               At += (*At == '\\') ? 2 : 1;
+            }
+            At = Minimum(At, End);
+            Uri.Length = At - Uri.Data;
+
+            char *Uri_Path = Has_Prefix(Uri, S("data:")) ? 0 : Get_GLTF_Uri_Path(Uri, &Scratch, Path);
+            if(Uri_Path && Contents)
+            {
+               string File = Map_Entire_File(Uri_Path);
+               if(File.Data)
+               {
+                  Result = Hash_String(File, Result);
+                  Unmap_Entire_File(File.Data, File.Length);
+               }
+            }
+            else if(Uri_Path)
+            {
+               u64 Stamp[2] = {0};
+               Get_File_Stamp(Uri_Path, Stamp + 0, Stamp + 1);
+               Result = Hash_String((string){sizeof(Stamp), (u8 *)Stamp}, Result);
+            }
+         }
+      }
+   }
+
+   return(Result);
+}
+
+static u64 Get_GLTF_Source_Stamp(char *Path, arena Scratch)
+{
+   // NOTE: Identifies the current version of the file at Path, and the files
+   // it refers to, by their sizes and modification times. The baker stores it
+   // in each baked scene so the loader can tell when the source has changed
+   // since. Zero means the file doesn't exist, and matches anything.
+   u64 Result = 0;
+
+   u64 Stamp[2];
+   if(Get_File_Stamp(Path, Stamp + 0, Stamp + 1))
+   {
+      Result = Hash_String((string){sizeof(Stamp), (u8 *)Stamp}, 0);
 
-static int Find_Json_Integer_By_Key(string Json, string Key);
-static string Find_Json_String_By_Key(string Json, string Key);
+      string Source = Map_Entire_File(Path);
+      if(Source.Data)
+      {
+         Result = Hash_GLTF_Uri_Files(Result, Source, Scratch, Path, false);
+         Unmap_Entire_File(Source.Data, Source.Length);
+      }
+      Result += (Result == 0);
+   }
 
-#define JSON_KEY(Literal) S("\"" Literal "\"")
+   return(Result);
+}
 
-// NOTE: GLB file parsing.
-static void Parse_GLB(gltf_scene *Result, arena *Arena, arena Scratch, char *Path)
+static void Get_Cached_Scene_Path(char *Result, u64 Hash)
 {
-   string File = Read_Entire_File(Path);
-   Assert(File.Length && File.Data);
+   // NOTE: Writes SCENE_CACHE_DIRECTORY "/" followed by 16 hex digits of the
+   // hash and ".scene", so Result needs room for 64 characters.
+   string Directory = S(SCENE_CACHE_DIRECTORY "/");
+   string Extension = S(".scene");
+   Copy_Memory(Result, Directory.Data, Directory.Length);
+   Result += Directory.Length;
+
+   for(int Digit = 0; Digit < 16; ++Digit)
+   {
+      *Result++ = "0123456789abcdef"[(Hash >> (60 - 4*Digit)) & 0xF];
+   }
 
-   u8 *At = File.Data;
-   u8 *End = File.Data + File.Length;
+   Copy_Memory(Result, Extension.Data, Extension.Length);
+   Result[Extension.Length] = 0;
+}
 
-   glb_header *Header = (glb_header *)At;
-   if(Header->Magic != GLB_MAGIC_NUMBER)
+static bool Write_Cached_Scene(gltf_scene *Scene, char *Path, arena Scratch)
+{
+   // NOTE: A parsed scene is already in the form the renderer uploads, so its
+   // buffer views are copied into the binary data as they are, interleaving and
+   // all, and its decoded images go in unchanged. Views that no accessor reads
+   // (like the ones images were decoded from) are left empty.
+
+   // NOTE: Running out of scratch here only skips the cache entry. It doesn't
+   // count against the load, which has already parsed the scene.
+   Scratch.Exhausted = 0;
+
+   bool *Used = Try_Allocate(&Scratch, bool, Scene->Buffer_View_Count);
+   gltf_buffer_view *Views = Try_Allocate(&Scratch, gltf_buffer_view, Scene->Buffer_View_Count);
+   if(!Used || !Views)
    {
-      Log("Failed to parse %s: it's not a real glb file.\n", Path);
-      Invalid_Code_Path;
+      return(false);
    }
-   At += sizeof(*Header);
 
-   glb_chunk_header *Json_Header = (glb_chunk_header *)At;
-   if(Json_Header->Chunk_Type != GLB_CHUNK_TYPE_JSON)
+   bool Result = true;
+   for(int Accessor_Index = 0; Accessor_Index < Scene->Accessor_Count; ++Accessor_Index)
    {
-      Log("Failed to parse %s: it's missing its JSON chunk.\n", Path);
-      Invalid_Code_Path;
+      gltf_accessor *Accessor = Scene->Accessors + Accessor_Index;
+      if(Accessor->Buffer_View >= 0 && Accessor->Buffer_View < Scene->Buffer_View_Count && Accessor->Sparse.Count == 0)
+      {
+         Used[Accessor->Buffer_View] = true;
+      }
+      else
+      {
+         Result = false;
+      }
    }
-   At += sizeof(*Json_Header);
-
-   string Json = Copy_String(&Scratch, At, Json_Header->Chunk_Length);
-   At += Json.Length;
 
-   glb_chunk_header *Binary_Header = (glb_chunk_header *)At;
-   if(Binary_Header->Chunk_Type != GLB_CHUNK_TYPE_BINARY)
+   for(int View_Index = 0; View_Index < Scene->Buffer_View_Count; ++View_Index)
    {
-      Log("Failed to parse %s: it's missing its binary chunk.\n", Path);
-      Invalid_Code_Path;
+      if(Used[View_Index])
+      {
+         Views[View_Index] = Scene->Buffer_Views[View_Index];
+      }
    }
-   At += sizeof(*Binary_Header);
 
-   Result->Binary_Size = Binary_Header->Chunk_Length;
-   Result->Binary_Data = Allocate(Arena, u8, Result->Binary_Size);
-   Copy_Memory(Result->Binary_Data, At, Result->Binary_Size);
-
-   At += Result->Binary_Size;
-
-   // NOTE: Parse accessors.
-   string Json_Accessors = Find_Json_Array_By_Key(Json, JSON_KEY("accessors"));
-   if(Json_Accessors.Length)
+   if(Result)
    {
-      Result->Accessor_Count = Json_Array_Count(Json_Accessors);
-      Result->Accessors = Allocate(Arena, gltf_accessor, Result->Accessor_Count);
-
-      for(int Accessor_Index = 0; Accessor_Index < Result->Accessor_Count; ++Accessor_Index)
+      baked_scene_tables Tables = {0};
+      Tables.Primitives = Scene->Primitives;
+      Tables.Accessors = Scene->Accessors;
+      Tables.Buffer_View_Count = Scene->Buffer_View_Count;
+      Tables.Buffer_Views = Views;
+      Tables.Images = Scene->Images;
+      Tables.Image_Data_Size = Scene->Image_Data_Size;
+      Tables.Image_Data = Scene->Image_Data;
+
+      arena Output = {0};
+      string File = Lay_Out_Baked_Scene(Scene, &Tables, &Output);
+      u8 *Binary = File.Data + ((baked_scene_header *)File.Data)->Binary_Offset;
+
+      for(int View_Index = 0; Result && View_Index < Scene->Buffer_View_Count; ++View_Index)
       {
-         gltf_accessor *Accessor = Result->Accessors + Accessor_Index;
-
-         Accessor->Buffer_View    = Find_Json_Integer_By_Key(Json_Accessors, JSON_KEY("bufferView"));
-         Accessor->Offset         = Find_Json_Integer_By_Key(Json_Accessors, JSON_KEY("byteOffset"));
-         Accessor->Count          = Find_Json_Integer_By_Key(Json_Accessors, JSON_KEY("count"));
-         Accessor->Component_Type = Find_Json_Integer_By_Key(Json_Accessors, JSON_KEY("componentType"));
-
-         string Name = Find_Json_String_By_Key(Json_Accessors, JSON_KEY("type"));
-         for(int Type = 0; Type < GLTF_ACCESSOR_TYPE_COUNT; ++Type)
+         gltf_buffer_view *View = Views + View_Index;
+         if(Used[View_Index])
          {
-            if(Strings_Are_Equal(Name, GLTF_Accessor_Type_Infos[Type].Name))
+            idx Stride;
+            u8 *From = Get_GLTF_View_Data(Scene, View_Index, 0, 1, View->Length, &Stride);
+            if(From)
             {
-               Accessor->Type = Type;
-               break;
+               Copy_Memory(Binary + View->Offset, From, View->Length);
+            }
+            else
+            {
+               Result = false;
             }
          }
-
-         Json_Accessors = Next_Json_Object(Json_Accessors);
       }
+
+      // NOTE: Entries are named by what they were made from, so one that
+      // already exists (written by another load in the meantime, or one that
+      // was found but didn't fit) holds the same scene and is left alone.
+      // Replacing it would fail on Windows anyway while a scene has it mapped.
+      u64 Size, Modified;
+      Result = Result && Make_Directory(SCENE_CACHE_DIRECTORY) &&
+         (Get_File_Stamp(Path, &Size, &Modified) || Write_Entire_File(Path, File.Data, File.Length));
+      Free_Arena(&Output);
    }
 
-   // NOTE: Parse buffer views.
-   string Json_Buffer_Views = Find_Json_Array_By_Key(Json, JSON_KEY("bufferViews"));
-   if(Json_Buffer_Views.Length)
+   return(Result);
+}
+
+static void Load_Cached_GLTF(gltf_scene *Result, arena *Arena, arena Scratch, char *Path)
+{
+   // NOTE: Loads the cache entry for the current contents of Path (and the
+   // files it refers to) if there is one, and otherwise parses it and writes
+   // one for next time.
+   char Cache_Path[64];
+   bool Cacheable = false;
+
+   string Source = Map_Entire_File(Path);
+   if(Source.Data)
    {
-      Result->Buffer_View_Count = Json_Array_Count(Json_Buffer_Views);
-      Result->Buffer_Views = Allocate(Arena, gltf_buffer_view, Result->Buffer_View_Count);
+      // NOTE: The versions are hashed in as well, so entries written by older
+      // importers are simply never found again. External files are hashed by
+      // their contents like the source itself, so touching one without
+      // changing it still finds the same entry.
+      u64 Hash = Hash_String(Source, ((u64)BAKED_SCENE_VERSION << 32) | SCENE_CACHE_VERSION);
+      Get_Cached_Scene_Path(Cache_Path, Hash_GLTF_Uri_Files(Hash, Source, Scratch, Path, true));
+      Unmap_Entire_File(Source.Data, Source.Length);
+      Cacheable = true;
+   }
 
-      for(int Buffer_View_Index = 0; Buffer_View_Index < Result->Buffer_View_Count; ++Buffer_View_Index)
-      {
-         gltf_buffer_view *Buffer_View = Result->Buffer_Views + Buffer_View_Index;
-         Buffer_View->Buffer = Find_Json_Integer_By_Key(Json_Buffer_Views, JSON_KEY("buffer"));
-         Buffer_View->Offset = Find_Json_Integer_By_Key(Json_Buffer_Views, JSON_KEY("byteOffset"));
-         Buffer_View->Length = Find_Json_Integer_By_Key(Json_Buffer_Views, JSON_KEY("byteLength"));
-         Buffer_View->Stride = Find_Json_Integer_By_Key(Json_Buffer_Views, JSON_KEY("byteStride"));
+   if(!Cacheable || !Load_Baked_Scene(Result, Arena, Cache_Path, 0))
+   {
+      // NOTE: Scenes that failed to parse aren't cached, so fixing the file
+      // (or whatever it refers to) is enough to try again. Neither are scenes
+      // that ran out of room partway, since they may be missing images.
+      bool Parsed = Parse_GLTF(Result, Arena, Scratch, Path);
+      bool Exhausted = (Arena->Exhausted && *Arena->Exhausted);
 
-         Json_Buffer_Views = Next_Json_Object(Json_Buffer_Views);
+      if(Parsed && !Exhausted && Cacheable && Result->Draw_Count > 0 && Write_Cached_Scene(Result, Cache_Path, Scratch))
+      {
+         Log("Cached %s as %s.\n", Path, Cache_Path);
       }
    }
+}
+
+static void Load_GLTF_Scene(gltf_scene *Result, arena *Arena, arena Scratch, char *Path)
+{
+   // NOTE: Baked versions of a scene are preferred when "make bake" has
+   // produced them, then the cache, and only then the source itself. A baked
+   // version is skipped once its source has been edited, so that edits show up
+   // (and hot reload works) without baking again.
+   char Baked_Path[256];
+   if(!Get_Baked_Scene_Path(Baked_Path, sizeof(Baked_Path), Path) ||
+      !Load_Baked_Scene(Result, Arena, Baked_Path, Get_GLTF_Source_Stamp(Path, Scratch)))
+   {
+      Load_Cached_GLTF(Result, Arena, Scratch, Path);
+   }
+}
+
+static gltf_scene *Load_Sized_GLTF_Scene(arena *Arena, char *Path)
+{
+   // NOTE: Loads Path into a new arena of its own, which holds the returned
+   // scene as well. Scratch is made alongside it and freed afterwards. Both
+   // start out sized from the file and double whenever the load runs out of
+   // room, since decoded images and dense accessors can be much larger than
+   // the file itself. A scene that still doesn't fit at the largest size comes
+   // back empty.
+   idx Size = GLTF_LOAD_ARENA_MINIMUM;
+   string File = Map_Entire_File(Path);
+   if(File.Data)
+   {
+      Size = Clamp(GLTF_LOAD_ARENA_SCALE*File.Length, GLTF_LOAD_ARENA_MINIMUM, GLTF_LOAD_ARENA_MAXIMUM);
+      Unmap_Entire_File(File.Data, File.Length);
+   }
 
-   // NOTE: Parse buffers.
-   string Json_Buffers = Find_Json_Array_By_Key(Json, JSON_KEY("buffers"));
-   if(Json_Buffers.Length)
+   gltf_scene *Result = 0;
+   while(!Result)
    {
-      Result->Buffer_Count = Json_Array_Count(Json_Buffers);
-      Result->Buffers = Allocate(Arena, gltf_buffer, Result->Buffer_Count);
+      bool Exhausted = false;
+      arena Scratch = {0};
+      Make_Arena(Arena, Size);
+      Make_Arena(&Scratch, Size);
+      Arena->Exhausted = &Exhausted;
+      Scratch.Exhausted = &Exhausted;
+
+      Result = Allocate(Arena, gltf_scene, 1);
+      Load_GLTF_Scene(Result, Arena, Scratch, Path);
 
-      for(int Buffer_Index = 0; Buffer_Index < Result->Buffer_Count; ++Buffer_Index)
+      Free_Arena(&Scratch);
+      Arena->Exhausted = 0;
+
+      if(Exhausted)
       {
-         gltf_buffer *Buffer = Result->Buffers + Buffer_Index;
-         Buffer->Length = Find_Json_Integer_By_Key(Json_Buffers, JSON_KEY("byteLength"));
+         Unload_Scene(Result);
+         if(Size < GLTF_LOAD_ARENA_MAXIMUM)
+         {
+            Free_Arena(Arena);
+            Size = Minimum(2*Size, GLTF_LOAD_ARENA_MAXIMUM);
+            Result = 0;
 
-         Json_Buffers = Next_Json_Object(Json_Buffers);
+            Log("Loading %s again with %lld MB arenas.\n", Path, (long long)(Size / Megabytes(1)));
+         }
+         else
+         {
+            Log("Failed to load %s: it needs more than %lld MB.\n", Path, (long long)(Size / Megabytes(1)));
+         }
       }
    }
 
-   // NOTE: Parse meshes.
-   string Json_Meshes = Find_Json_Array_By_Key(Json, JSON_KEY("meshes"));
-   if(Json_Meshes.Length)
+   return(Result);
+}
+
+static WORK_QUEUE_CALLBACK(Do_GLTF_Load_Work)
+{
+   gltf_loader *Loader = Data;
+
+   // NOTE: Keep claiming loads until none are left, so the work spreads evenly
+   // across threads however many paths were requested.
+   u32 Load_Index;
+   while((Load_Index = Atomic_Add_U32(&Loader->Next_Load, 1)) < (u32)Loader->Load_Count)
    {
-      Result->Mesh_Count = Json_Array_Count(Json_Meshes);
-      Result->Meshes = Allocate(Arena, gltf_mesh, Json_Meshes.Length);
+      gltf_load *Load = Loader->Loads + Load_Index;
 
-      for(int Mesh_Index = 0; Mesh_Index < Result->Mesh_Count; ++Mesh_Index)
-      {
-         gltf_mesh *Mesh = Result->Meshes + Mesh_Index;
+      Load->Scene = Load_Sized_GLTF_Scene(&Load->Arena, Load->Path);
 
-         string Json_Primitives = Find_Json_Array_By_Key(Json_Meshes, JSON_KEY("primitives"));
-         if(Json_Primitives.Length)
-         {
-            Mesh->Primitive_Count = Json_Array_Count(Json_Primitives);
-            Mesh->Primitives = Allocate(Arena, gltf_primitive, Mesh->Primitive_Count);
+      u32 Completion_Index = Atomic_Add_U32(&Loader->Completion_Write, 1);
+      Atomic_Store_U32(Loader->Completions + Completion_Index, Load_Index + 1);
+   }
+}
 
-            for(int Primitive_Index = 0; Primitive_Index < Mesh->Primitive_Count; ++Primitive_Index)
-            {
-               gltf_primitive *Primitive = Mesh->Primitives + Primitive_Index;
-               Primitive->Indices = Find_Json_Integer_By_Key(Json_Primitives, JSON_KEY("indices"));
+static void Begin_GLTF_Loads(gltf_loader *Loader, platform_work_queue *Queue, arena *Arena, char **Paths, int Path_Count)
+{
+   Loader->Queue = Queue;
+   Loader->Load_Count = Path_Count;
+   Loader->Loads = Allocate(Arena, gltf_load, Path_Count);
+   Loader->Completions = Allocate(Arena, u32, Path_Count);
 
-               string Json_Attributes = Find_Json_Object_By_Key(Json_Primitives, JSON_KEY("attributes"));
-               if(Json_Attributes.Length)
-               {
-                  Primitive->Position   = Find_Json_Integer_By_Key(Json_Attributes, JSON_KEY("POSITION"));
-                  Primitive->Normal     = Find_Json_Integer_By_Key(Json_Attributes, JSON_KEY("NORMAL"));
-                  Primitive->Texcoord_0 = Find_Json_Integer_By_Key(Json_Attributes, JSON_KEY("TEXCOORD_0"));
-                  Primitive->Texcoord_1 = Find_Json_Integer_By_Key(Json_Attributes, JSON_KEY("TEXCOORD_1"));
-                  Primitive->Color_0    = Find_Json_Integer_By_Key(Json_Attributes, JSON_KEY("COLOR_0"));
-                  Primitive->Color_1    = Find_Json_Integer_By_Key(Json_Attributes, JSON_KEY("COLOR_1"));
-               }
+   for(int Path_Index = 0; Path_Index < Path_Count; ++Path_Index)
+   {
+      Loader->Loads[Path_Index].Path = Paths[Path_Index];
+   }
 
-               Json_Primitives = Next_Json_Object(Json_Primitives);
-            }
-         }
+   int Job_Count = Minimum(Path_Count, Get_Work_Queue_Thread_Count(Queue));
+   for(int Job_Index = 0; Job_Index < Job_Count; ++Job_Index)
+   {
+      Add_Work_Queue_Entry(Queue, Do_GLTF_Load_Work, Loader);
+   }
+}
+
+static gltf_load *Next_Completed_GLTF_Load(gltf_loader *Loader)
+{
+   // NOTE: Returns 0 when every load that has finished so far has already been
+   // returned. This never waits on the workers.
+   gltf_load *Result = 0;
+   if(Loader->Completion_Read < (u32)Loader->Load_Count)
+   {
+      u32 Completion = Atomic_Load_U32(Loader->Completions + Loader->Completion_Read);
+      if(Completion)
+      {
+         Result = Loader->Loads + (Completion - 1);
+         Loader->Completion_Read++;
       }
    }
 
-   Free_Entire_File(File.Data, File.Length);
+   return(Result);
 }
 
-// NOTE: Below is a basic JSON parsing implementation. This is the bare minimum
-// parsing we need to pull data from a trusted GLB file. It prioritizes
-// simplicity, does not handle basic edge cases of JSON, and is not particularly
-// fast. At some point we'll probably move it to a build step to pack GLB assets
-// into our own binary format.
-
-static string Find_Json_By_Key(string Json, string Key)
+static void End_GLTF_Loads(gltf_loader *Loader)
 {
-   // NOTE: Return the remainder of the JSON string following the first
-   // encountered instance of the requested key (so an empty string if the key
-   // isn't found). The caller is responsible for pulling the data out/trimming
-   // the excess.
-
-   cut Keys = {0};
-   Keys.After = Json;
+   // NOTE: Wait for any loads still in flight before releasing what they load
+   // into.
+   if(Loader->Queue)
+   {
+      Complete_All_Work(Loader->Queue);
+   }
 
-   while(Keys.After.Length)
+   for(int Load_Index = 0; Load_Index < Loader->Load_Count; ++Load_Index)
    {
-      Keys = Cut(Keys.After, ':');
-      if(Has_Suffix(Keys.Before, Key))
+      gltf_load *Load = Loader->Loads + Load_Index;
+      if(Load->Scene)
       {
-         break;
+         Unload_Scene(Load->Scene);
       }
+      Free_Arena(&Load->Arena);
    }
 
-   string Result = Keys.After;
+   Zero_Struct(Loader);
+}
+
+// NOTE: Below is a basic JSON parsing implementation. This is the bare minimum
+// parsing we need to pull data from a trusted GLB file. It still does not
+// validate much of anything. Shipping assets should go through the bake step
+// (code/bake.c) instead, which packs them into our own binary format.
+//
+// Parsing happens in two stages. The first stage classifies the text 64 bytes
+// at a time into bitmasks (quotes, backslashes, operators, whitespace), resolves
+// escapes and string interiors with bit arithmetic, and emits the positions of
+// every structural character. The second stage only visits those positions to
+// build the token tape, and lookups walk sibling links on that tape rather
+// than rescanning text.
+
+// NOTE: The first stage uses AVX2 when the compiler targets it (e.g. -mavx2),
+// SSE2 on any x64 target, and a scalar loop everywhere else. All three produce
+// identical masks. Brackets are matched by folding '[' and ']' onto '{' and '}'
+// with the 0x20 bit, and any byte at or below a space counts as whitespace,
+// since JSON doesn't allow raw control characters outside of strings anyway.
+#if defined(__AVX2__)
+#  include <immintrin.h>
+#  define JSON_STAGE_ONE_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define JSON_STAGE_ONE_SSE2 1
+#endif
+
+#if _MSC_VER
+#  include <intrin.h>
+#endif
+
+#define JSON_BLOCK_SIZE 64
+
+typedef struct {
+   u64 Quote;
+   u64 Backslash;
+   u64 Bracket;
+   u64 Delimiter; // NOTE: Colons, commas and whitespace.
+} json_block_masks;
+
+// NOTE: Structurals are indexed one chunk of text at a time into a small
+// buffer that stays in cache, and the second stage consumes each chunk before
+// the next is indexed. Nothing proportional to the length of the text is ever
+// written besides the tape itself.
+#define JSON_INDEX_CHUNK_SIZE 4096
+
+typedef struct {
+   u64 Previous_Escaped;
+   u64 Previous_In_String;
+   u64 Previous_Scalar;
+} json_indexer;
+
+static inline u32 Count_Trailing_Zeros_64(u64 Value)
+{
+#if _MSC_VER
+   unsigned long Result;
+   _BitScanForward64(&Result, Value);
+   return((u32)Result);
+#else
+   return((u32)__builtin_ctzll(Value));
+#endif
+}
+
+#if JSON_STAGE_ONE_AVX2
+static inline u64 Json_Mask_32(__m256i Lo, __m256i Hi)
+{
+   u64 Lo_Bits = (u32)_mm256_movemask_epi8(Lo);
+   u64 Hi_Bits = (u32)_mm256_movemask_epi8(Hi);
+
+   u64 Result = Lo_Bits | (Hi_Bits << 32);
    return(Result);
 }
 
-static string Find_Json_Array_By_Key(string Json, string Key)
+static inline __m256i Json_Classify_32(__m256i Bytes, __m256i *Quote, __m256i *Backslash, __m256i *Bracket)
 {
-   // NOTE: Return a string containing the contents of a JSON array with the
-   // specified key. The result does not include the enclosing brackets.
+   __m256i Folded = _mm256_or_si256(Bytes, _mm256_set1_epi8(0x20));
+   *Quote = _mm256_cmpeq_epi8(Bytes, _mm256_set1_epi8('"'));
+   *Backslash = _mm256_cmpeq_epi8(Bytes, _mm256_set1_epi8('\\'));
+   *Bracket = _mm256_or_si256(_mm256_cmpeq_epi8(Folded, _mm256_set1_epi8('{')),
+                              _mm256_cmpeq_epi8(Folded, _mm256_set1_epi8('}')));
+
+   __m256i Whitespace = _mm256_cmpeq_epi8(_mm256_min_epu8(Bytes, _mm256_set1_epi8(' ')), Bytes);
+   __m256i Result = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(Bytes, _mm256_set1_epi8(':')),
+                                                    _mm256_cmpeq_epi8(Bytes, _mm256_set1_epi8(','))),
+                                    Whitespace);
+   return(Result);
+}
 
-   // NOTE: This function assumes the key is unique - the same key in a nested
-   // object earlier in the JSON string will interfere with this lookup.
+static json_block_masks Classify_Json_Block(u8 *Block)
+{
+   __m256i Quote[2], Backslash[2], Bracket[2], Delimiter[2];
+   for(int Half = 0; Half < 2; ++Half)
+   {
+      __m256i Bytes = _mm256_loadu_si256((__m256i *)(Block + 32*Half));
+      Delimiter[Half] = Json_Classify_32(Bytes, Quote + Half, Backslash + Half, Bracket + Half);
+   }
 
-   string Result = {0};
+   json_block_masks Result;
+   Result.Quote = Json_Mask_32(Quote[0], Quote[1]);
+   Result.Backslash = Json_Mask_32(Backslash[0], Backslash[1]);
+   Result.Bracket = Json_Mask_32(Bracket[0], Bracket[1]);
+   Result.Delimiter = Json_Mask_32(Delimiter[0], Delimiter[1]);
 
-   string Array = Find_Json_By_Key(Json, Key);
-   if(Array.Length && Has_Prefix_Then_Remove(&Array, S("[")))
+   return(Result);
+}
+#elif JSON_STAGE_ONE_SSE2
+static json_block_masks Classify_Json_Block(u8 *Block)
+{
+   json_block_masks Result = {0};
+   for(int Chunk_Index = 0; Chunk_Index < 4; ++Chunk_Index)
    {
-      u8 *Pos = Array.Data;
-      u8 *End = Array.Data + Array.Length;
+      __m128i Bytes = _mm_loadu_si128((__m128i *)(Block + 16*Chunk_Index));
+      __m128i Folded = _mm_or_si128(Bytes, _mm_set1_epi8(0x20));
+
+      __m128i Quote = _mm_cmpeq_epi8(Bytes, _mm_set1_epi8('"'));
+      __m128i Backslash = _mm_cmpeq_epi8(Bytes, _mm_set1_epi8('\\'));
+      __m128i Bracket = _mm_or_si128(_mm_cmpeq_epi8(Folded, _mm_set1_epi8('{')),
+                                     _mm_cmpeq_epi8(Folded, _mm_set1_epi8('}')));
+
+      __m128i Whitespace = _mm_cmpeq_epi8(_mm_min_epu8(Bytes, _mm_set1_epi8(' ')), Bytes);
+      __m128i Delimiter = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(Bytes, _mm_set1_epi8(':')),
+                                                    _mm_cmpeq_epi8(Bytes, _mm_set1_epi8(','))),
+                                       Whitespace);
+
+      int Shift = 16 * Chunk_Index;
+      Result.Quote |= (u64)(u16)_mm_movemask_epi8(Quote) << Shift;
+      Result.Backslash |= (u64)(u16)_mm_movemask_epi8(Backslash) << Shift;
+      Result.Bracket |= (u64)(u16)_mm_movemask_epi8(Bracket) << Shift;
+      Result.Delimiter |= (u64)(u16)_mm_movemask_epi8(Delimiter) << Shift;
+   }
 
-      bool In_String = false;
-      int Brackets = 1;
-      while(Pos < End && Pos[0] && Brackets > 0)
+   return(Result);
+}
+#else
+static json_block_masks Classify_Json_Block(u8 *Block)
+{
+   json_block_masks Result = {0};
+   for(int Index = 0; Index < JSON_BLOCK_SIZE; ++Index)
+   {
+      u64 Bit = (u64)1 << Index;
+      switch(Block[Index])
       {
-         if(Pos[0] == '"' && (Pos == Array.Data || Pos[-1] != '\\'))
-         {
-            In_String = !In_String;
-         }
-         else if(!In_String)
-         {
-            if     (Pos[0] == '[') Brackets++;
-            else if(Pos[0] == ']') Brackets--;
-         }
-         Pos++;
-      }
+         case '"':  { Result.Quote |= Bit; } break;
+         case '\\': { Result.Backslash |= Bit; } break;
 
-      if(Brackets != 0)
-      {
-         Log("JSON array %.*s was not bracketed properly.\n", (int)Key.Length, Key.Data);
+         case '{': case '}': case '[': case ']': {
+            Result.Bracket |= Bit;
+         } break;
+
+         case ':': case ',': {
+            Result.Delimiter |= Bit;
+         } break;
       }
-      else
+
+      if(Block[Index] <= ' ')
       {
-         Result = Span_String(Array.Data, Pos-1); // NOTE: Don't include trailing bracket.
+         Result.Delimiter |= Bit;
       }
    }
-
    return(Result);
 }
+#endif
 
-static string Find_Json_Object_By_Key(string Json, string Key)
+static inline u64 Find_Escaped_Characters(u64 Backslash, u64 *Previous_Escaped)
 {
-   // NOTE: Return a string containing the contents of a JSON object with the
-   // specified key. The result does not include the enclosing braces.
+   // NOTE: Returns the characters preceded by an odd-length run of backslashes.
+   // Runs are allowed to cross block boundaries through Previous_Escaped.
+   u64 Even_Bits = 0x5555555555555555ULL;
 
-   // NOTE: This function assumes the key is unique - the same key in a nested
-   // object earlier in the JSON string will interfere with this lookup.
+   Backslash &= ~*Previous_Escaped;
+   u64 Follows_Escape = (Backslash << 1) | *Previous_Escaped;
+   u64 Odd_Sequence_Starts = Backslash & ~Even_Bits & ~Follows_Escape;
 
-   string Result = {0};
+   u64 Sequences_Starting_On_Even_Bits = Odd_Sequence_Starts + Backslash;
+   *Previous_Escaped = (Sequences_Starting_On_Even_Bits < Odd_Sequence_Starts);
 
-   string Object = Find_Json_By_Key(Json, Key);
-   if(Object.Length && Has_Prefix_Then_Remove(&Object, S("{")))
+   u64 Invert_Mask = Sequences_Starting_On_Even_Bits << 1;
+
+   u64 Result = (Even_Bits ^ Invert_Mask) & Follows_Escape;
+   return(Result);
+}
+
+static inline u64 Prefix_Xor(u64 Bits)
+{
+   // NOTE: Each output bit is the parity of all input bits at or below it,
+   // which turns a mask of quotes into a mask of string interiors.
+   Bits ^= Bits << 1;
+   Bits ^= Bits << 2;
+   Bits ^= Bits << 4;
+   Bits ^= Bits << 8;
+   Bits ^= Bits << 16;
+   Bits ^= Bits << 32;
+   return(Bits);
+}
+
+static u32 Index_Json_Structurals(json_indexer *Indexer, string Json, idx Begin, idx End, u32 *Positions)
+{
+   // NOTE: Writes the offsets of every bracket and brace outside of strings,
+   // both quotes of every string, and the first character of every other
+   // scalar (numbers, true, false, null) in [Begin, End). Colons and commas are
+   // classified so that scalars end at them, but they carry no information for
+   // the tape and are not emitted. Begin must be a multiple of the block size,
+   // and Positions must have room for End - Begin entries.
+
+   u32 Result = 0;
+   for(idx Offset = Begin; Offset < End; Offset += JSON_BLOCK_SIZE)
    {
-      u8 *Pos = Object.Data;
-      u8 *End = Object.Data + Object.Length;
+      u8 *Block = Json.Data + Offset;
 
-      bool In_String = false;
-      int Braces = 1;
-      while(Pos < End && Pos[0] && Braces > 0)
+      // NOTE: The final partial block is copied into padding so the SIMD loads
+      // never read past the end of the text.
+      u8 Padded[JSON_BLOCK_SIZE];
+      idx Remaining = Json.Length - Offset;
+      if(Remaining < JSON_BLOCK_SIZE)
       {
-         if(Pos[0] == '"' && (Pos == Object.Data || Pos[-1] != '\\'))
-         {
-            In_String = !In_String;
-         }
-         else if(!In_String)
-         {
-            if     (Pos[0] == '{') Braces++;
-            else if(Pos[0] == '}') Braces--;
-         }
-         Pos++;
+         memset(Padded, ' ', sizeof(Padded));
+         Copy_Memory(Padded, Block, Remaining);
+         Block = Padded;
       }
 
-      if(Braces != 0)
-      {
-         Log("JSON objects %.*s was not braced properly.\n", (int)Key.Length, Key.Data);
-      }
-      else
+      json_block_masks Masks = Classify_Json_Block(Block);
+
+      u64 Escaped = Find_Escaped_Characters(Masks.Backslash, &Indexer->Previous_Escaped);
+      u64 Quote = Masks.Quote & ~Escaped;
+
+      u64 In_String = Prefix_Xor(Quote) ^ Indexer->Previous_In_String;
+      Indexer->Previous_In_String = (u64)((s64)In_String >> 63);
+
+      u64 Scalar = ~(Masks.Bracket | Masks.Delimiter | Quote | In_String);
+      u64 Scalar_Start = Scalar & ~((Scalar << 1) | Indexer->Previous_Scalar);
+      Indexer->Previous_Scalar = Scalar >> 63;
+
+      u64 Structural = (Masks.Bracket & ~In_String) | Quote | Scalar_Start;
+      while(Structural)
       {
-         Result = Span_String(Object.Data, Pos-1); // NOTE: Don't include trailing bracket.
+         Positions[Result++] = (u32)(Offset + Count_Trailing_Zeros_64(Structural));
+         Structural &= Structural - 1;
       }
    }
 
    return(Result);
 }
 
-static int Json_Array_Count(string Array)
+static inline bool Is_Json_Delimiter(u8 Character)
 {
-   // NOTE: Count the number of items in the provided JSON string. Array is
-   // assumed to be a comma-delimited list of elements (no enclosing brackets),
-   // or an empty string.
-
-   int Result = 0;
-   if(Array.Length)
-   {
-      u8 *Pos = Array.Data;
-      u8 *End = Array.Data + Array.Length;
+   // NOTE: Matches the first stage, which treats anything at or below a space
+   // as whitespace.
+   bool Result = (Character <= ' ' || Character == ',' || Character == ':' ||
+                  Character == ']' || Character == '}');
+   return(Result);
+}
 
-      bool In_String = false;
-      int Braces = 0;
-      int Brackets = 0;
+typedef struct {
+   int Token;
+   int Last_Child;
+   bool Expect_Value;
+} json_scope;
 
-      Result = 1;
-      while(Pos < End && Pos[0])
+static int Push_Json_Token(json_tape *Tape, json_scope *Scope, json_token_type Type, u8 *Begin)
+{
+   // NOTE: The tape is not zeroed ahead of time, so every field is written.
+   int Result = Tape->Count++;
+   json_token *Token = Tape->Tokens + Result;
+
+   Token->Type = Type;
+   Token->Span.Data = Begin;
+   Token->Span.Length = 0;
+   Token->Parent = 0;
+   Token->Next = 0;
+   Token->Child_Count = 0;
+
+   if(Scope)
+   {
+      json_token *Container = Tape->Tokens + Scope->Token;
+      if(Container->Type == JSON_TOKEN_OBJECT && Scope->Expect_Value)
+      {
+         // NOTE: Values inside objects are the only child of their key.
+         Token->Parent = Scope->Last_Child;
+         Tape->Tokens[Scope->Last_Child].Child_Count = 1;
+         Scope->Expect_Value = false;
+      }
+      else
       {
-         if(Pos[0] == '"' && (Pos == Array.Data || Pos[-1] != '\\'))
+         Token->Parent = Scope->Token;
+         if(Scope->Last_Child)
          {
-            In_String = !In_String;
+            Tape->Tokens[Scope->Last_Child].Next = Result;
          }
-         else if(!In_String)
+         Scope->Last_Child = Result;
+         Container->Child_Count++;
+
+         if(Container->Type == JSON_TOKEN_OBJECT)
          {
-            switch(Pos[0])
-            {
-               case '{': { Braces++;   } break;
-               case '}': { Braces--;   } break;
-               case '[': { Brackets++; } break;
-               case ']': { Brackets--; } break;
-               case ',': {
-                  // NOTE: This assumes no trailing commas.
-                  if(Braces == 0 && Brackets == 0)
-                  {
-                     Result++;
-                  }
-               } break;
-            }
+            Scope->Expect_Value = true;
          }
-         Pos++;
       }
    }
 
    return(Result);
 }
 
-static string Next_Json_Object(string Json)
+static json_tape Tokenize_Json(arena *Arena, string Json)
 {
-   string Result = {0};
-   if(Has_Prefix_Then_Remove(&Json, S("{")))
+   // NOTE: The tape grows in place at the top of the arena, so nothing else may
+   // allocate from it while tokenizing. Every token begins at exactly one
+   // structural, so each chunk's index bounds how much room its tokens need.
+   // Running out of room fails the tokenization rather than the program.
+   json_tape Result = {0};
+   Result.Tokens = (json_token *)(Arena->Base + Arena->Used);
+
+   bool Failed = !Arena_Has_Room(Arena, sizeof(json_token));
+   if(!Failed)
+   {
+      // NOTE: Reserve the null token.
+      Push_Json_Token(&Result, 0, JSON_TOKEN_NULL_TOKEN, 0);
+   }
+
+   json_scope Stack[JSON_MAX_DEPTH];
+   int Depth = 0;
+
+   u8 *End = Json.Data + Json.Length;
+
+   // NOTE: An opening quote at the end of a chunk is carried over to the front
+   // of the next one, since its closing quote hasn't been indexed yet.
+   json_indexer Indexer = {0};
+   u32 Positions[JSON_INDEX_CHUNK_SIZE + 1];
+   u32 Carried = 0;
+
+   for(idx Chunk = 0; !Failed && Chunk < Json.Length; Chunk += JSON_INDEX_CHUNK_SIZE)
    {
-      u8 *Pos = Json.Data;
-      u8 *End = Json.Data + Json.Length;
+      idx Chunk_End = Minimum(Chunk + JSON_INDEX_CHUNK_SIZE, Json.Length);
+      u32 Count = Carried + Index_Json_Structurals(&Indexer, Json, Chunk, Chunk_End, Positions + Carried);
+      Carried = 0;
 
-      bool In_String = false;
-      int Braces = 1;
+      if(!Arena_Has_Room(Arena, (Result.Count + (idx)Count) * (idx)sizeof(json_token)))
+      {
+         Log("JSON needs more than the %lld bytes of scratch available.\n", (long long)(Arena->Size - Arena->Used));
+         Failed = true;
+      }
 
-      while(Pos < End && Pos[0] && Braces > 0)
+      for(u32 Index = 0; !Failed && Index < Count; ++Index)
       {
-         if(Pos[0] == '"' && (Pos == Json.Data || Pos[-1] != '\\'))
-         {
-            In_String = !In_String;
-         }
-         else if(!In_String)
+         json_scope *Scope = (Depth > 0) ? Stack + (Depth - 1) : 0;
+         u8 *Pos = Json.Data + Positions[Index];
+
+         switch(Pos[0])
          {
-            if     (Pos[0] == '{') Braces++;
-            else if(Pos[0] == '}') Braces--;
+            case '{':
+            case '[': {
+               json_token_type Type = (Pos[0] == '{') ? JSON_TOKEN_OBJECT : JSON_TOKEN_ARRAY;
+               int Token = Push_Json_Token(&Result, Scope, Type, Pos);
+               if(Depth == JSON_MAX_DEPTH)
+               {
+                  Log("JSON nesting exceeded the maximum depth of %d.\n", JSON_MAX_DEPTH);
+                  Failed = true;
+               }
+               else
+               {
+                  json_scope New_Scope = {Token, 0, false};
+                  Stack[Depth++] = New_Scope;
+               }
+            } break;
+
+            case '}':
+            case ']': {
+               json_token_type Type = (Pos[0] == '}') ? JSON_TOKEN_OBJECT : JSON_TOKEN_ARRAY;
+               if(!Scope || Result.Tokens[Scope->Token].Type != Type)
+               {
+                  Log("JSON container was not closed properly.\n");
+                  Failed = true;
+               }
+               else
+               {
+                  json_token *Container = Result.Tokens + Scope->Token;
+                  Container->Span = Span_String(Container->Span.Data, Pos + 1);
+                  Depth--;
+               }
+            } break;
+
+            case '"': {
+               // NOTE: The first stage emits both quotes of every string, so the
+               // closing quote is always the next structural.
+               if(Index + 1 < Count)
+               {
+                  int Token = Push_Json_Token(&Result, Scope, JSON_TOKEN_STRING, Pos + 1);
+                  Result.Tokens[Token].Span = Span_String(Pos + 1, Json.Data + Positions[Index + 1]);
+                  Index++;
+               }
+               else
+               {
+                  Positions[0] = Positions[Index];
+                  Carried = 1;
+               }
+            } break;
+
+            default: {
+               // NOTE: Scalars are short, so just scan for their end.
+               u8 *Next = Pos;
+               while(Next < End && !Is_Json_Delimiter(Next[0]))
+               {
+                  Next++;
+               }
+
+               json_token_type Type = JSON_TOKEN_NUMBER;
+               if     (Pos[0] == 't') Type = JSON_TOKEN_TRUE;
+               else if(Pos[0] == 'f') Type = JSON_TOKEN_FALSE;
+               else if(Pos[0] == 'n') Type = JSON_TOKEN_NULL;
+
+               int Token = Push_Json_Token(&Result, Scope, Type, Pos);
+               Result.Tokens[Token].Span = Span_String(Pos, Next);
+            } break;
          }
-         Pos++;
       }
+   }
 
-      if(Braces != 0)
-      {
-         Log("JSON object was not braced properly.\n");
-      }
-      else
+   if(!Failed && (Carried || Indexer.Previous_In_String))
+   {
+      Log("JSON string was not quoted properly.\n");
+      Failed = true;
+   }
+
+   if(Failed || Depth != 0 || Result.Count <= 1)
+   {
+      Log("JSON could not be tokenized.\n");
+      Result.Count = 0;
+   }
+   else
+   {
+      Arena->Used += Result.Count * sizeof(json_token);
+   }
+
+   return(Result);
+}
+
+static int Json_First_Child(json_tape *Json, int Token)
+{
+   // NOTE: Tokens are stored in document order, so the first child always
+   // immediately follows its parent.
+   int Result = (Token > 0 && Token < Json->Count && Json->Tokens[Token].Child_Count) ? Token + 1 : 0;
+   return(Result);
+}
+
+static int Json_Next(json_tape *Json, int Token)
+{
+   int Result = (Token > 0 && Token < Json->Count) ? Json->Tokens[Token].Next : 0;
+   return(Result);
+}
+
+static int Json_Child_Count(json_tape *Json, int Token)
+{
+   int Result = (Token > 0 && Token < Json->Count) ? Json->Tokens[Token].Child_Count : 0;
+   return(Result);
+}
+
+static int Find_Json_Key(json_tape *Json, int Object, string Key)
+{
+   // NOTE: Return the index of the value associated with the requested key in
+   // the specified object, or 0 if the key isn't a direct member. Only the
+   // object's own keys are visited, so nested objects can no longer interfere
+   // with the lookup.
+
+   int Result = 0;
+   if(Object > 0 && Object < Json->Count && Json->Tokens[Object].Type == JSON_TOKEN_OBJECT)
+   {
+      for(int Member = Json_First_Child(Json, Object); Member; Member = Json_Next(Json, Member))
       {
-         if(Pos[0] == ',')
+         if(Strings_Are_Equal(Json->Tokens[Member].Span, Key))
          {
-            Pos++;
+            Result = Json_First_Child(Json, Member);
+            break;
          }
-         Result = Span_String(Pos, Json.Data+Json.Length);
       }
    }
 
    return(Result);
 }
 
-static int Find_Json_Integer_By_Key(string Json, string Key)
+static int Json_Integer(json_tape *Json, int Token, int Default)
 {
-   int Result = 0;
+   int Result = Default;
 
-   string Integer = Find_Json_By_Key(Json, Key);
-   if(Integer.Length)
+   if(Token > 0 && Token < Json->Count && Json->Tokens[Token].Type == JSON_TOKEN_NUMBER)
    {
+      string Integer = Json->Tokens[Token].Span;
       int Sign = (Has_Prefix_Then_Remove(&Integer, S("-"))) ? -1 : 1;
 
       u8 *Pos = Integer.Data;
@@ -398,38 +2684,90 @@ static int Find_Json_Integer_By_Key(string Json, string Key)
    return(Result);
 }
 
-static string Find_Json_String_By_Key(string Json, string Key)
+static idx Json_Size(json_tape *Json, int Token, idx Default)
 {
-   string Result = {0};
+   // NOTE: Byte offsets and lengths of external buffers can pass 2GB, so they
+   // are read at full width.
+   idx Result = Default;
 
-   string String = Find_Json_By_Key(Json, Key);
-   if(String.Length && Has_Prefix_Then_Remove(&String, S("\"")))
+   if(Token > 0 && Token < Json->Count && Json->Tokens[Token].Type == JSON_TOKEN_NUMBER)
    {
-      u8 *Pos = String.Data;
-      u8 *End = Json.Data + Json.Length;
+      string Integer = Json->Tokens[Token].Span;
 
-      bool In_String = true;
-      while(Pos < End && Pos[0] && In_String)
+      idx Value = 0;
+      for(idx Index = 0; Index < Integer.Length && Integer.Data[Index] >= '0' && Integer.Data[Index] <= '9'; ++Index)
       {
-         if(Pos[0] == '"' && (Pos == Json.Data || Pos[-1] != '\\'))
-         {
-            In_String = false;
-         }
-         else
-         {
-            Pos++;
-         }
+         Value = (Value * 10) + (Integer.Data[Index] - '0');
       }
+      Result = Value;
+   }
+
+   return(Result);
+}
+
+static float Json_Float(json_tape *Json, int Token, float Default)
+{
+   float Result = Default;
+
+   if(Token > 0 && Token < Json->Count && Json->Tokens[Token].Type == JSON_TOKEN_NUMBER)
+   {
+      // NOTE: Numbers aren't null terminated in place, so copy them out for
+      // strtod. Anything longer than the buffer isn't a sensible float anyway.
+      string Number = Json->Tokens[Token].Span;
 
-      if(In_String)
+      char Buffer[64];
+      if(Number.Length < (idx)sizeof(Buffer))
       {
-         Log("JSON string was not quoted properly.\n");
+         Copy_Memory(Buffer, Number.Data, Number.Length);
+         Buffer[Number.Length] = 0;
+         Result = (float)strtod(Buffer, 0);
       }
-      else
+   }
+
+   return(Result);
+}
+
+static bool Json_Boolean(json_tape *Json, int Token, bool Default)
+{
+   bool Result = Default;
+   if(Token > 0 && Token < Json->Count)
+   {
+      json_token_type Type = Json->Tokens[Token].Type;
+      if(Type == JSON_TOKEN_TRUE || Type == JSON_TOKEN_FALSE)
       {
-         Result = Span_String(String.Data, String.Data + (Pos-String.Data));
+         Result = (Type == JSON_TOKEN_TRUE);
       }
+   }
+
+   return(Result);
+}
+
+static void Json_Floats(json_tape *Json, int Array, float *Result, float *Defaults, int Count)
+{
+   // NOTE: Fill Result from a JSON array of numbers, falling back to Defaults
+   // entirely if the array is missing or the wrong length.
+   if(Json_Child_Count(Json, Array) == Count && Json->Tokens[Array].Type == JSON_TOKEN_ARRAY)
+   {
+      int Element = Json_First_Child(Json, Array);
+      for(int Index = 0; Index < Count; ++Index)
+      {
+         Result[Index] = Json_Float(Json, Element, Defaults[Index]);
+         Element = Json_Next(Json, Element);
+      }
+   }
+   else
+   {
+      Copy_Memory(Result, Defaults, Count*sizeof(*Result));
+   }
+}
 
+static string Json_String(json_tape *Json, int Token)
+{
+   // NOTE: Escape sequences are left as-is in the returned string.
+   string Result = {0};
+   if(Token > 0 && Token < Json->Count && Json->Tokens[Token].Type == JSON_TOKEN_STRING)
+   {
+      Result = Json->Tokens[Token].Span;
    }
 
    return(Result);
@@ -1,5 +1,40 @@
 /* (c) copyright 2025 Lawrence D. Kern /////////////////////////////////////// */
 
+// NOTE: JSON token tape produced by Tokenize_Json. Tokens are stored in
+// document order, so the first child of any object, array or key is always the
+// token immediately following it. Object children are keys, and each key has
+// exactly one child: its value. Index 0 is reserved as a null token so that
+// lookups can return 0 for "not found".
+
+typedef enum {
+   JSON_TOKEN_NULL_TOKEN,
+   JSON_TOKEN_OBJECT,
+   JSON_TOKEN_ARRAY,
+   JSON_TOKEN_STRING,
+   JSON_TOKEN_NUMBER,
+   JSON_TOKEN_TRUE,
+   JSON_TOKEN_FALSE,
+   JSON_TOKEN_NULL,
+
+   JSON_TOKEN_COUNT,
+} json_token_type;
+
+typedef struct {
+   json_token_type Type;
+   string Span; // NOTE: Strings exclude their quotes, containers include their delimiters.
+   int Parent;
+   int Next;    // NOTE: Next sibling within the parent, or 0.
+   int Child_Count;
+} json_token;
+
+typedef struct {
+   int Count;
+   json_token *Tokens;
+} json_tape;
+
+#define JSON_ROOT_TOKEN 1
+#define JSON_MAX_DEPTH 128
+
 #define GLB_MAGIC_NUMBER      0x46546C67 // glTF
 #define GLB_CHUNK_TYPE_JSON   0x4E4F534A // JSON
 #define GLB_CHUNK_TYPE_BINARY 0x004E4942 // BIN
@@ -56,15 +91,44 @@ static gltf_accessor_type_info GLTF_Accessor_Type_Infos[GLTF_ACCESSOR_TYPE_COUNT
    [GLTF_ACCESSOR_TYPE_MAT4]   = {S("MAT4"),  16},
 };
 
+// NOTE: Sparse accessors replace Count of their elements, whose indices are
+// read from one view and whose values from another. Neither view may have a
+// stride. The elements that aren't replaced come from the accessor's own view,
+// or are zero if it doesn't have one.
+typedef struct {
+   int Count; // NOTE: Zero when the accessor isn't sparse.
+   int Indices_View;
+   int Indices_Offset;
+   gltf_component_type Index_Type;
+   int Values_View;
+   int Values_Offset;
+} gltf_sparse;
+
 typedef struct {
-   int Buffer_View;
+   int Buffer_View; // NOTE: -1 for sparse accessors that start out as zeros.
    int Offset;
    int Count;
    gltf_component_type Component_Type;
    gltf_accessor_type Type;
+
+   // NOTE: Normalized integers read as [0, 1] (or [-1, 1] when signed) rather
+   // than their integer value, per KHR_mesh_quantization.
+   bool Normalized;
+
+   // NOTE: Positions quantized by the baker decode as Offset + Scale*Value.
+   // Everything else has an offset of zero and a scale of one.
+   float Decode_Offset[3];
+   float Decode_Scale;
+
+   // NOTE: Parse_GLTF resolves sparse accessors into dense ones, so only code
+   // reading an accessor before that needs to look at this.
+   gltf_sparse Sparse;
 } gltf_accessor;
 
+#define GLTF_PRIMITIVE_MODE_TRIANGLES 4
+
 typedef struct {
+   // NOTE: Accessor indices, or -1 if the primitive doesn't have the attribute.
    int Position;
    int Normal;
    int Texcoord_0;
@@ -72,28 +136,248 @@ typedef struct {
    int Color_0;
    int Color_1;
    int Indices;
+
+   int Mode;
+
+   // NOTE: Range of gltf_scene.Meshlets covering the primitive's triangles.
+   int First_Meshlet;
+   int Meshlet_Count;
+
+   // NOTE: Range of gltf_scene.Lods, finest first. Primitives without a chain
+   // draw their whole index accessor.
+   int First_Lod;
+   int Lod_Count;
+
+   // NOTE: Bounding sphere in model space, for choosing a level of detail.
+   float Center[3];
+   float Radius;
+
+   int Material; // NOTE: -1 for the default material.
 } gltf_primitive;
 
+// NOTE: Levels of detail are built by the baker by simplifying a primitive.
+// Every level indexes the primitive's full vertex accessors, and their indices
+// are stored one after the other in the primitive's index accessor, so a level
+// is drawn by just drawing a range of it. Error is how far the level's surface
+// strays from the original, in model space units.
+#define MAX_LOD_COUNT 8
+
+typedef struct {
+   u32 First_Index;
+   u32 Index_Count;
+   float Error;
+} gltf_lod;
+
+// NOTE: Meshlets are small clusters of a primitive's triangles, built by the
+// baker as the unit of cluster culling. Each one lists the primitive vertices
+// it uses in gltf_scene.Meshlet_Vertices, and its triangles as triples of u8
+// indices into that list in gltf_scene.Meshlet_Triangles.
+#define MAX_MESHLET_VERTEX_COUNT 64
+#define MAX_MESHLET_TRIANGLE_COUNT 124
+
+typedef struct {
+   u32 Vertex_Offset;
+   u32 Triangle_Offset; // NOTE: In triangles, so 3 bytes each.
+   u32 Vertex_Count;
+   u32 Triangle_Count;
+
+   // NOTE: Bounding sphere in the primitive's model space.
+   float Center[3];
+   float Radius;
+
+   // NOTE: Every triangle faces away from a camera at Position when
+   // dot(normalize(Cone_Apex - Position), Cone_Axis) >= Cone_Cutoff. A cutoff
+   // of 1 means the triangles face too many ways to be culled together.
+   float Cone_Apex[3];
+   float Cone_Axis[3];
+   float Cone_Cutoff;
+} gltf_meshlet;
+
 typedef struct {
    int Primitive_Count;
-   gltf_primitive *Primitives;
+   gltf_primitive *Primitives; // NOTE: Points into gltf_scene.Primitives.
 } gltf_mesh;
 
+// NOTE: Nodes are stored as parallel arrays, since transform updates only ever
+// walk the matrices and drawing only ever needs the world transforms.
+typedef struct {
+   int Count;
+   int *Mesh;       // NOTE: -1 if the node has no mesh.
+   int *Parent;     // NOTE: -1 for root nodes.
+   matrix4 *Local;
+   matrix4 *World;
+} gltf_nodes;
+
+typedef struct {
+   int Root_Count;
+   int *Roots;
+} gltf_scene_roots;
+
+typedef struct {
+   int Primitive;   // NOTE: Index into gltf_scene.Primitives.
+   int Node;        // NOTE: Node providing the world transform, or -1 for identity.
+} gltf_draw;
+
 typedef struct {
    int Buffer;
-   int Offset;
-   int Length;
+   idx Offset; // NOTE: External buffers can be larger than 2GB.
+   idx Length;
    int Stride;
 } gltf_buffer_view;
 
+// NOTE: A buffer's data is the binary chunk of a .glb, an external file named
+// by its uri, or an arena copy decoded from a data: uri. External files are
+// mapped rather than read, so only the parts actually used are ever paged in.
 typedef struct {
-   int Length;
+   idx Length;
+   u8 *Data;
+   string File; // NOTE: The mapping of an external file, if the buffer has one.
 } gltf_buffer;
 
+// NOTE: Images are decoded when a scene is parsed, so the renderer only ever
+// sees raw or block compressed texels. Only the baker produces block
+// compressed images, which store rows of 4x4 texel blocks: 8 bytes per block
+// for BC1 and 16 for the others.
+//
+// Every image carries its full mip chain, finest level first, with each level
+// packed straight after the one before it. Each level halves the last one's
+// size, rounding down, until both sides reach 1.
+typedef enum {
+   GLTF_IMAGE_FORMAT_NONE, // NOTE: The image couldn't be decoded.
+   GLTF_IMAGE_FORMAT_RGBA8,
+   GLTF_IMAGE_FORMAT_BC1,
+   GLTF_IMAGE_FORMAT_BC3,
+   GLTF_IMAGE_FORMAT_BC5,
+   GLTF_IMAGE_FORMAT_BC7,
+} gltf_image_format;
+
+// NOTE: How the materials use an image, which decides its color space and
+// what it can be compressed to.
+typedef enum {
+   GLTF_IMAGE_USAGE_DATA,   // NOTE: Linear, like metallic-roughness or occlusion.
+   GLTF_IMAGE_USAGE_COLOR,  // NOTE: sRGB, like base color or emissive.
+   GLTF_IMAGE_USAGE_NORMAL, // NOTE: Linear, only the X and Y channels matter.
+} gltf_image_usage;
+
+typedef struct {
+   gltf_image_format Format;
+   gltf_image_usage Usage;
+   int Width;  // NOTE: Of the finest level.
+   int Height;
+   int Mip_Count;
+
+   idx Offset; // NOTE: Into gltf_scene.Image_Data.
+   idx Size;   // NOTE: Of the whole mip chain.
+} gltf_image;
+
+static inline idx Get_GLTF_Image_Size(gltf_image_format Format, int Width, int Height)
+{
+   idx Blocks = (idx)((Width + 3) / 4) * ((Height + 3) / 4);
+
+   idx Result = 0;
+   switch(Format)
+   {
+      case GLTF_IMAGE_FORMAT_RGBA8: { Result = (idx)Width * Height * 4; } break;
+      case GLTF_IMAGE_FORMAT_BC1:   { Result = Blocks * 8; } break;
+      case GLTF_IMAGE_FORMAT_BC3:
+      case GLTF_IMAGE_FORMAT_BC5:
+      case GLTF_IMAGE_FORMAT_BC7:   { Result = Blocks * 16; } break;
+      default: break;
+   }
+
+   return(Result);
+}
+
+static inline int Get_GLTF_Mip_Count(int Width, int Height)
+{
+   int Result = 1;
+   while(Width > 1 || Height > 1)
+   {
+      Width = Maximum(Width / 2, 1);
+      Height = Maximum(Height / 2, 1);
+      Result++;
+   }
+
+   return(Result);
+}
+
+static inline idx Get_GLTF_Mip_Chain_Size(gltf_image_format Format, int Width, int Height, int Mip_Count)
+{
+   idx Result = 0;
+   for(int Level = 0; Level < Mip_Count; ++Level)
+   {
+      Result += Get_GLTF_Image_Size(Format, Width, Height);
+      Width = Maximum(Width / 2, 1);
+      Height = Maximum(Height / 2, 1);
+   }
+
+   return(Result);
+}
+
+#define GLTF_FILTER_NEAREST                9728
+#define GLTF_FILTER_LINEAR                 9729
+#define GLTF_FILTER_NEAREST_MIPMAP_NEAREST 9984
+#define GLTF_FILTER_LINEAR_MIPMAP_NEAREST  9985
+#define GLTF_FILTER_NEAREST_MIPMAP_LINEAR  9986
+#define GLTF_FILTER_LINEAR_MIPMAP_LINEAR   9987
+
+#define GLTF_WRAP_CLAMP_TO_EDGE   33071
+#define GLTF_WRAP_MIRRORED_REPEAT 33648
+#define GLTF_WRAP_REPEAT          10497
+
+typedef struct {
+   int Mag_Filter; // NOTE: 0 when the file leaves the filter up to us.
+   int Min_Filter;
+   int Wrap_S;
+   int Wrap_T;
+} gltf_sampler;
+
+typedef struct {
+   int Image;   // NOTE: -1 if the texture has no usable source.
+   int Sampler; // NOTE: -1 for repeat wrapping and linear filtering.
+} gltf_texture;
+
+// NOTE: Texture indices are -1 when the material doesn't have one. Every
+// texture is read with TEXCOORD_0, which is the only set the renderer binds.
+typedef struct {
+   float Base_Color_Factor[4];
+   int Base_Color_Texture;
+   int Metallic_Roughness_Texture;
+   int Normal_Texture;
+   int Occlusion_Texture;
+   int Emissive_Texture;
+} gltf_material;
+
 typedef struct {
    int Mesh_Count;
    gltf_mesh *Meshes;
 
+   int Primitive_Count;
+   gltf_primitive *Primitives;
+
+   gltf_nodes Nodes;
+
+   // NOTE: These are the scenes listed in the file. They aren't preserved by
+   // baking, since the draw list below is built from the default scene.
+   int Default_Scene;
+   int Scene_Count;
+   gltf_scene_roots *Scenes;
+
+   int Draw_Count;
+   gltf_draw *Draws;
+
+   // NOTE: Only baked scenes have meshlets.
+   int Meshlet_Count;
+   gltf_meshlet *Meshlets;
+   int Meshlet_Vertex_Count;
+   u32 *Meshlet_Vertices;
+   int Meshlet_Triangle_Count;
+   u8 *Meshlet_Triangles;
+
+   // NOTE: Only baked scenes have levels of detail.
+   int Lod_Count;
+   gltf_lod *Lods;
+
    int Accessor_Count;
    gltf_accessor *Accessors;
 
@@ -103,8 +387,21 @@ typedef struct {
    int Buffer_Count;
    gltf_buffer *Buffers;
 
-   idx Binary_Size;
-   u8 *Binary_Data;
+   int Material_Count;
+   gltf_material *Materials;
+   int Texture_Count;
+   gltf_texture *Textures;
+   int Sampler_Count;
+   gltf_sampler *Samplers;
+   int Image_Count;
+   gltf_image *Images;
+
+   idx Image_Data_Size;
+   u8 *Image_Data;
+
+   // NOTE: The .glb buffer (and, for baked scenes, every table) points straight
+   // into this mapping, so it stays mapped until Unload_Scene is called.
+   string File;
 } gltf_scene;
 
 static inline idx
@@ -138,72 +435,143 @@ Get_GLTF_Type_Size(gltf_accessor_type Type, gltf_component_type Component_Type)
    return(Result);
 }
 
-static inline VkFormat
-GLTF_To_Vulkan_Format(gltf_accessor_type Type, gltf_component_type Component_Type)
-{
-   VkFormat Result = VK_FORMAT_UNDEFINED;
+// NOTE: Baked scenes are written offline by code/bake.c, or by the loader as
+// cache entries, and loaded with Load_Baked_Scene. The layout is pointer-free:
+// every table is referenced by its byte offset from the start of the file, so
+// the loader only has to patch up the mesh table and describe the single
+// buffer. Vertex and index data for each buffer view starts on a
+// BAKED_SCENE_ALIGNMENT boundary, which satisfies the copy offset alignment of
+// any device we care about. Block compressed images follow the binary data,
+// each on the same alignment.
 
-   int Component_Count = GLTF_Accessor_Type_Infos[Type].Component_Count;
-   switch(Component_Type)
-   {
-      case GLTF_ACCESSOR_COMPONENT_S8:
-      case GLTF_ACCESSOR_COMPONENT_U8: {
-         switch(Component_Count)
-         {
-            case 1: { Result = VK_FORMAT_R8_UINT; } break;
-            case 2: { Result = VK_FORMAT_R8G8_UINT; } break;
-            case 3: { Result = VK_FORMAT_R8G8B8_UINT; } break;
-            case 4: { Result = VK_FORMAT_R8G8B8A8_UINT; } break;
-         } break;
-      } break;
+#define BAKED_SCENE_MAGIC_NUMBER 0x4E435342 // BSCN
+#define BAKED_SCENE_VERSION      10
+#define BAKED_SCENE_ALIGNMENT    256
 
-      case GLTF_ACCESSOR_COMPONENT_S16:
-      case GLTF_ACCESSOR_COMPONENT_U16: {
-         switch(Component_Count)
-         {
-            case 1: { Result = VK_FORMAT_R16_UINT; } break;
-            case 2: { Result = VK_FORMAT_R16G16_UINT; } break;
-            case 3: { Result = VK_FORMAT_R16G16B16_UINT; } break;
-            case 4: { Result = VK_FORMAT_R16G16B16A16_UINT; } break;
-         } break;
-      } break;
+typedef struct {
+   u32 Magic;
+   u32 Version;
+   u32 Alignment;
+   u32 Reserved;
+   u64 File_Size;
+   u64 Source_Stamp;       // NOTE: Get_GLTF_Source_Stamp of the source, or 0
+
+   u32 Mesh_Count;
+   u32 Mesh_Offset;        // NOTE: baked_mesh[Mesh_Count]
+
+   u32 Primitive_Count;
+   u32 Primitive_Offset;   // NOTE: gltf_primitive[Primitive_Count]
+
+   u32 Accessor_Count;
+   u32 Accessor_Offset;    // NOTE: gltf_accessor[Accessor_Count]
+
+   u32 Buffer_View_Count;
+   u32 Buffer_View_Offset; // NOTE: gltf_buffer_view[Buffer_View_Count]
+
+   u32 Node_Count;
+   u32 Node_Mesh_Offset;   // NOTE: int[Node_Count]
+   u32 Node_Parent_Offset; // NOTE: int[Node_Count]
+   u32 Node_Local_Offset;  // NOTE: matrix4[Node_Count]
+   u32 Node_World_Offset;  // NOTE: matrix4[Node_Count]
+
+   u32 Draw_Count;
+   u32 Draw_Offset;        // NOTE: gltf_draw[Draw_Count]
+
+   u32 Meshlet_Count;
+   u32 Meshlet_Offset;          // NOTE: gltf_meshlet[Meshlet_Count]
+   u32 Meshlet_Vertex_Count;
+   u32 Meshlet_Vertex_Offset;   // NOTE: u32[Meshlet_Vertex_Count]
+   u32 Meshlet_Triangle_Count;
+   u32 Meshlet_Triangle_Offset; // NOTE: u8[3*Meshlet_Triangle_Count]
+
+   u32 Lod_Count;
+   u32 Lod_Offset;              // NOTE: gltf_lod[Lod_Count]
+
+   u32 Material_Count;
+   u32 Material_Offset;         // NOTE: gltf_material[Material_Count]
+   u32 Texture_Count;
+   u32 Texture_Offset;          // NOTE: gltf_texture[Texture_Count]
+   u32 Sampler_Count;
+   u32 Sampler_Offset;          // NOTE: gltf_sampler[Sampler_Count]
+   u32 Image_Count;
+   u32 Image_Offset;            // NOTE: gltf_image[Image_Count]
+
+   u64 Binary_Offset;
+   u64 Binary_Size;
+
+   u64 Image_Data_Offset;
+   u64 Image_Data_Size;
+} baked_scene_header;
 
-      case GLTF_ACCESSOR_COMPONENT_U32: {
-         switch(Component_Count) {
-            case 1: { Result = VK_FORMAT_R32_UINT; } break;
-            case 2: { Result = VK_FORMAT_R32G32_UINT; } break;
-            case 3: { Result = VK_FORMAT_R32G32B32_UINT; } break;
-            case 4: { Result = VK_FORMAT_R32G32B32A32_UINT; } break;
-         } break;
-      } break;
+typedef struct {
+   u32 First_Primitive;
+   u32 Primitive_Count;
+} baked_mesh;
 
-      case GLTF_ACCESSOR_COMPONENT_F32: {
-         switch(Component_Count)
-         {
-            case 1: { Result = VK_FORMAT_R32_SFLOAT; } break;
-            case 2: { Result = VK_FORMAT_R32G32_SFLOAT; } break;
-            case 3: { Result = VK_FORMAT_R32G32B32_SFLOAT; } break;
-            case 4: { Result = VK_FORMAT_R32G32B32A32_SFLOAT; } break;
-         } break;
-      } break;
+// NOTE: The tables a baked scene is laid out from, apart from the meshes,
+// nodes, draws, materials, textures and samplers, which come straight from the
+// scene. Buffer view offsets are assigned during layout.
+typedef struct {
+   gltf_primitive *Primitives;
+   gltf_accessor *Accessors;
 
-      default: {
-         Invalid_Code_Path;
-      } break;
-   }
+   int Buffer_View_Count;
+   gltf_buffer_view *Buffer_Views;
 
-   return(Result);
-}
+   int Meshlet_Count;
+   gltf_meshlet *Meshlets;
+   int Meshlet_Vertex_Count;
+   u32 *Meshlet_Vertices;
+   int Meshlet_Triangle_Count;
+   u8 *Meshlet_Triangles;
+
+   int Lod_Count;
+   gltf_lod *Lods;
+
+   gltf_image *Images;
+   idx Image_Data_Size;
+   u8 *Image_Data;
+
+   u64 Source_Stamp;
+} baked_scene_tables;
+
+// NOTE: Scenes parsed from glTF are cached as baked scenes in this directory,
+// under the hash of their source file, so later loads of an unchanged file skip
+// parsing and decoding. Bump SCENE_CACHE_VERSION whenever Parse_GLTF's output
+// changes without the baked format itself changing.
+#define SCENE_CACHE_DIRECTORY "cache"
+#define SCENE_CACHE_VERSION   1
+
+// NOTE: Scenes can be loaded in parallel on the platform work queue with
+// Begin_GLTF_Loads. Each load gets an arena of its own from
+// Load_Sized_GLTF_Scene, and finished loads are published to a completion
+// queue that the thread that started them drains with
+// Next_Completed_GLTF_Load. Everything a load produced stays valid until
+// End_GLTF_Loads.
+
+// NOTE: Load arenas start at the file's size times the scale, within these
+// bounds, and double from there until the scene fits.
+#define GLTF_LOAD_ARENA_SCALE   8
+#define GLTF_LOAD_ARENA_MINIMUM Megabytes(4)
+#define GLTF_LOAD_ARENA_MAXIMUM Gigabytes((idx)2)
 
-static inline VkIndexType GLTF_To_Vulkan_Index(gltf_component_type Component_Type)
-{
-   VkIndexType Result;
-   switch(Component_Type)
-   {
-      case GLTF_ACCESSOR_COMPONENT_U8:  { Result = VK_INDEX_TYPE_UINT8_EXT; } break;
-      case GLTF_ACCESSOR_COMPONENT_U16: { Result = VK_INDEX_TYPE_UINT16;    } break;
-      case GLTF_ACCESSOR_COMPONENT_U32: { Result = VK_INDEX_TYPE_UINT32;    } break;
-      default:                          { Result = VK_INDEX_TYPE_UINT16;    } break;
-   }
-   return(Result);
-}
+typedef struct {
+   char *Path;
+   arena Arena;
+   gltf_scene *Scene;
+} gltf_load;
+
+typedef struct {
+   platform_work_queue *Queue;
+
+   int Load_Count;
+   gltf_load *Loads;
+
+   // NOTE: Workers claim loads through Next_Load and reserve completion slots
+   // through Completion_Write. A slot holds its load's index plus one once the
+   // load is finished, and zero until then.
+   u32 volatile Next_Load;
+   u32 volatile Completion_Write;
+   u32 volatile *Completions;
+   u32 Completion_Read;
+} gltf_loader;
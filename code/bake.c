@@ -0,0 +1,1537 @@
+/* (c) copyright 2025 Lawrence D. Kern /////////////////////////////////////// */
+
+// NOTE: This file is the entry point for the offline asset baker. It parses
+// glTF files with the same code the renderer uses, then writes them back out
+// in the baked scene format described in asset_parser.h so that the renderer
+// can load them without touching any JSON. It only relies on the C standard
+// library and the system's threads, so the same file builds on every
+// platform.
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <time.h>
+
+#if defined(_WIN32)
+#  include <windows.h>
+#else
+#  include <errno.h>
+#  include <pthread.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+#include "shared.h"
+#include "platform.h"
+#include "asset_parser.h"
+
+// NOTE: The benchmark mutes logging while it times the bake stages, so their
+// reports neither flood its output nor count towards their times.
+static bool Log_Muted;
+
+static LOG(Log)
+{
+   if(!Log_Muted)
+   {
+      va_list Arguments;
+
+      va_start(Arguments, Format);
+      vprintf(Format, Arguments);
+      va_end(Arguments);
+
+      fflush(stdout);
+   }
+}
+
+static READ_ENTIRE_FILE(Read_Entire_File)
+{
+   string Result = {0};
+
+   FILE *File = fopen(Path, "rb");
+   if(!File)
+   {
+      Log("Failed to open file %s.\n", Path);
+   }
+   else
+   {
+      fseek(File, 0, SEEK_END);
+      idx Length = ftell(File);
+      fseek(File, 0, SEEK_SET);
+
+      // NOTE: Add an extra byte to the allocation for a null terminator.
+      u8 *Data = malloc(Length + 1);
+      if(!Data)
+      {
+         Log("Failed to allocate file %s.\n", Path);
+      }
+      else if(fread(Data, 1, Length, File) != (size_t)Length)
+      {
+         Log("Failed to read entire file %s.\n", Path);
+         free(Data);
+      }
+      else
+      {
+         Data[Length] = 0;
+
+         Result.Data = Data;
+         Result.Length = Length;
+      }
+
+      fclose(File);
+   }
+
+   return(Result);
+}
+
+static FREE_ENTIRE_FILE(Free_Entire_File)
+{
+   free(Data);
+}
+
+// NOTE: The baker only touches each file once, so plain reads are good enough
+// to stand in for file mapping.
+static MAP_ENTIRE_FILE(Map_Entire_File)
+{
+   string Result = Read_Entire_File(Path);
+   return(Result);
+}
+
+static UNMAP_ENTIRE_FILE(Unmap_Entire_File)
+{
+   Free_Entire_File(Data, Length);
+}
+
+static WRITE_ENTIRE_FILE(Write_Entire_File)
+{
+   bool Result = false;
+
+   // NOTE: The baker writes each output once from the main thread, so a fixed
+   // temporary name is enough.
+   char Temporary_Path[512];
+   snprintf(Temporary_Path, sizeof(Temporary_Path), "%s.tmp", Path);
+
+   FILE *File = fopen(Temporary_Path, "wb");
+   if(!File)
+   {
+      Log("Failed to open %s for writing.\n", Temporary_Path);
+   }
+   else
+   {
+      bool Written = (fwrite(Data, 1, Length, File) == (size_t)Length);
+      Written = (fclose(File) == 0) && Written;
+
+#if defined(_WIN32)
+      bool Renamed = Written && MoveFileExA(Temporary_Path, Path, MOVEFILE_REPLACE_EXISTING);
+#else
+      bool Renamed = Written && (rename(Temporary_Path, Path) == 0);
+#endif
+      if(!Renamed)
+      {
+         Log("Failed to write %s.\n", Path);
+         remove(Temporary_Path);
+      }
+      Result = Renamed;
+   }
+
+   return(Result);
+}
+
+static MAKE_DIRECTORY(Make_Directory)
+{
+#if defined(_WIN32)
+   bool Result = (CreateDirectoryA(Path, 0) || GetLastError() == ERROR_ALREADY_EXISTS);
+#else
+   bool Result = (mkdir(Path, 0755) == 0 || errno == EEXIST);
+#endif
+   if(!Result)
+   {
+      Log("Failed to make directory %s.\n", Path);
+   }
+
+   return(Result);
+}
+
+static GET_FILE_STAMP(Get_File_Stamp)
+{
+   *Size = 0;
+   *Modified = 0;
+
+#if defined(_WIN32)
+   WIN32_FILE_ATTRIBUTE_DATA Data;
+   bool Result = GetFileAttributesExA(Path, GetFileExInfoStandard, &Data);
+   if(Result)
+   {
+      *Size = ((u64)Data.nFileSizeHigh << 32) | Data.nFileSizeLow;
+      *Modified = ((u64)Data.ftLastWriteTime.dwHighDateTime << 32) | Data.ftLastWriteTime.dwLowDateTime;
+   }
+#else
+   struct stat File_Information;
+   bool Result = (stat(Path, &File_Information) == 0);
+   if(Result)
+   {
+      *Size = (u64)File_Information.st_size;
+      *Modified = (u64)File_Information.st_mtim.tv_sec*1000000000 + (u64)File_Information.st_mtim.tv_nsec;
+   }
+#endif
+
+   return(Result);
+}
+
+// NOTE: Queued work runs when Complete_All_Work is called, on a pool of
+// threads started for the occasion and joined before it returns. The baker
+// only queues work in bursts (a band of block rows per entry when compressing
+// an image), so there's no point keeping the threads around in between.
+#define BAKE_WORK_QUEUE_ENTRY_COUNT 1024
+
+typedef struct {
+   work_queue_callback *Callback;
+   void *Data;
+} bake_work_entry;
+
+struct platform_work_queue {
+   int Thread_Count;
+   int Entry_Count;
+   u32 volatile Next_Entry;
+   bake_work_entry Entries[BAKE_WORK_QUEUE_ENTRY_COUNT];
+};
+
+typedef struct {
+   platform_work_queue *Queue;
+   int Thread_Index;
+} bake_work_thread;
+
+static void Do_Bake_Work(platform_work_queue *Queue, int Thread_Index)
+{
+   u32 Index;
+   while((Index = Atomic_Add_U32(&Queue->Next_Entry, 1)) < (u32)Queue->Entry_Count)
+   {
+      bake_work_entry *Entry = Queue->Entries + Index;
+      Entry->Callback(Queue, Thread_Index, Entry->Data);
+   }
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI Bake_Work_Thread(LPVOID Parameter)
+{
+   bake_work_thread *Thread = Parameter;
+   Do_Bake_Work(Thread->Queue, Thread->Thread_Index);
+   return(0);
+}
+
+static int Get_Processor_Count(void)
+{
+   SYSTEM_INFO Info;
+   GetSystemInfo(&Info);
+   return((int)Info.dwNumberOfProcessors);
+}
+#else
+static void *Bake_Work_Thread(void *Parameter)
+{
+   bake_work_thread *Thread = Parameter;
+   Do_Bake_Work(Thread->Queue, Thread->Thread_Index);
+   return(0);
+}
+
+static int Get_Processor_Count(void)
+{
+   return((int)sysconf(_SC_NPROCESSORS_ONLN));
+}
+#endif
+
+static GET_WORK_QUEUE_THREAD_COUNT(Get_Work_Queue_Thread_Count)
+{
+   return(Queue->Thread_Count);
+}
+
+static COMPLETE_ALL_WORK(Complete_All_Work)
+{
+   bake_work_thread Threads[MAX_WORK_QUEUE_THREAD_COUNT];
+#if defined(_WIN32)
+   HANDLE Handles[MAX_WORK_QUEUE_THREAD_COUNT];
+#else
+   pthread_t Handles[MAX_WORK_QUEUE_THREAD_COUNT];
+#endif
+
+   // NOTE: Threads that fail to start just leave their share to the others.
+   int Started_Count = 0;
+   for(int Thread_Index = 1; Thread_Index < Queue->Thread_Count && Thread_Index < Queue->Entry_Count; ++Thread_Index)
+   {
+      bake_work_thread *Thread = Threads + Started_Count;
+      Thread->Queue = Queue;
+      Thread->Thread_Index = Thread_Index;
+#if defined(_WIN32)
+      Handles[Started_Count] = CreateThread(0, 0, Bake_Work_Thread, Thread, 0, 0);
+      Started_Count += (Handles[Started_Count] != 0);
+#else
+      Started_Count += (pthread_create(Handles + Started_Count, 0, Bake_Work_Thread, Thread) == 0);
+#endif
+   }
+
+   Do_Bake_Work(Queue, 0);
+
+   for(int Thread_Index = 0; Thread_Index < Started_Count; ++Thread_Index)
+   {
+#if defined(_WIN32)
+      WaitForSingleObject(Handles[Thread_Index], INFINITE);
+      CloseHandle(Handles[Thread_Index]);
+#else
+      pthread_join(Handles[Thread_Index], 0);
+#endif
+   }
+
+   Queue->Entry_Count = 0;
+   Atomic_Store_U32(&Queue->Next_Entry, 0);
+}
+
+static ADD_WORK_QUEUE_ENTRY(Add_Work_Queue_Entry)
+{
+   if(Queue->Entry_Count == BAKE_WORK_QUEUE_ENTRY_COUNT)
+   {
+      Complete_All_Work(Queue);
+   }
+
+   bake_work_entry *Entry = Queue->Entries + Queue->Entry_Count++;
+   Entry->Callback = Callback;
+   Entry->Data = Data;
+}
+
+#include "basic_string.c"
+#include "basic_math.c"
+#include "image_decoder.c"
+#include "asset_parser.c"
+#include "mesh_optimizer.c"
+#include "mesh_simplifier.c"
+#include "texture_compressor.c"
+
+static bool Extract_Baked_Accessors(gltf_scene *Scene, gltf_accessor *Accessors, u8 **Data, arena *Scratch, char *Path)
+{
+   // NOTE: Copy each accessor's elements out of whatever (possibly interleaved
+   // or sparse) view they came from into a tightly packed array of their own,
+   // which the passes below can then rewrite in place. Positions quantized by
+   // the exporter are widened to floats, since every pass that reads
+   // positions expects them, and quantizing is redone at the end anyway.
+   bool *Is_Position = Allocate(Scratch, bool, Scene->Accessor_Count);
+   for(int Primitive_Index = 0; Primitive_Index < Scene->Primitive_Count; ++Primitive_Index)
+   {
+      int Position = Scene->Primitives[Primitive_Index].Position;
+      if(Position >= 0 && Position < Scene->Accessor_Count)
+      {
+         Is_Position[Position] = true;
+      }
+   }
+
+   bool Result = true;
+   for(int Accessor_Index = 0; Accessor_Index < Scene->Accessor_Count; ++Accessor_Index)
+   {
+      gltf_accessor Source = Scene->Accessors[Accessor_Index];
+      gltf_accessor *Accessor = Accessors + Accessor_Index;
+      *Accessor = Source;
+      Accessor->Buffer_View = Accessor_Index;
+      Accessor->Offset = 0;
+      Zero_Struct(&Accessor->Sparse);
+
+      if(Is_Position[Accessor_Index] && Source.Type == GLTF_ACCESSOR_TYPE_VEC3 && Source.Component_Type != GLTF_ACCESSOR_COMPONENT_F32)
+      {
+         Accessor->Component_Type = GLTF_ACCESSOR_COMPONENT_F32;
+         Accessor->Normalized = false;
+      }
+
+      int Component_Count = GLTF_Accessor_Type_Infos[Accessor->Type].Component_Count;
+      Data[Accessor_Index] = Allocate(Scratch, u8, Accessor->Count*Get_GLTF_Type_Size(Accessor->Type, Accessor->Component_Type));
+      if(!Read_GLTF_Accessor(Scene, &Source, Data[Accessor_Index], Accessor->Component_Type, Component_Count, *Scratch))
+      {
+         Log("Failed to bake %s: accessor %d reads outside of the binary chunk.\n", Path, Accessor_Index);
+         Result = false;
+         break;
+      }
+   }
+
+   return(Result);
+}
+
+static int *Count_Accessor_Uses(gltf_scene *Scene, arena *Scratch)
+{
+   // NOTE: Returns how many primitive attributes reference each accessor.
+   int *Result = Allocate(Scratch, int, Scene->Accessor_Count);
+   for(int Primitive_Index = 0; Primitive_Index < Scene->Primitive_Count; ++Primitive_Index)
+   {
+      gltf_primitive *Primitive = Scene->Primitives + Primitive_Index;
+      int References[] = {Primitive->Position, Primitive->Normal, Primitive->Texcoord_0, Primitive->Texcoord_1,
+                          Primitive->Color_0, Primitive->Color_1, Primitive->Indices};
+
+      for(int Reference = 0; Reference < Array_Count(References); ++Reference)
+      {
+         if(References[Reference] >= 0 && References[Reference] < Scene->Accessor_Count)
+         {
+            Result[References[Reference]]++;
+         }
+      }
+   }
+
+   return(Result);
+}
+
+static u32 *Read_Baked_Indices(u8 *Stored_Indices, idx Index_Size, idx Index_Count, idx Vertex_Count, arena *Arena)
+{
+   // NOTE: Returns a 32-bit copy of the indices, whatever their stored size, or
+   // null if any of them indexes past the vertices.
+   u32 *Result = Allocate(Arena, u32, Index_Count);
+
+   bool Valid = true;
+   for(idx Index = 0; Index < Index_Count; ++Index)
+   {
+      switch(Index_Size)
+      {
+         case 1: { Result[Index] = Stored_Indices[Index]; } break;
+         case 2: { Result[Index] = ((u16 *)Stored_Indices)[Index]; } break;
+         case 4: { Result[Index] = ((u32 *)Stored_Indices)[Index]; } break;
+      }
+      Valid = Valid && (Result[Index] < Vertex_Count);
+   }
+
+   return(Valid ? Result : 0);
+}
+
+static u32 Hash_Baked_Vertex(u8 **Streams, idx *Sizes, int Stream_Count, u32 Vertex)
+{
+   // NOTE: FNV-1a over the vertex's bytes in every stream.
+   u32 Result = 2166136261u;
+   for(int Stream = 0; Stream < Stream_Count; ++Stream)
+   {
+      u8 *Bytes = Streams[Stream] + Vertex*Sizes[Stream];
+      for(idx Byte = 0; Byte < Sizes[Stream]; ++Byte)
+      {
+         Result = (Result ^ Bytes[Byte]) * 16777619u;
+      }
+   }
+
+   return(Result);
+}
+
+static bool Baked_Vertices_Equal(u8 **Streams, idx *Sizes, int Stream_Count, u32 A, u32 B)
+{
+   bool Result = true;
+   for(int Stream = 0; Result && Stream < Stream_Count; ++Stream)
+   {
+      Result = (memcmp(Streams[Stream] + A*Sizes[Stream], Streams[Stream] + B*Sizes[Stream], Sizes[Stream]) == 0);
+   }
+
+   return(Result);
+}
+
+static void Weld_Baked_Primitives(gltf_scene *Scene, gltf_accessor *Accessors, u8 **Data, arena *Scratch, char *Path)
+{
+   // NOTE: Exporters often duplicate vertices, for example one per face corner,
+   // even when every attribute is identical. Vertices that are bit-identical
+   // across all of a primitive's attribute streams are merged and the indices
+   // rebuilt, which only works when none of the primitive's accessors are
+   // shared. Indices are then stored at the narrowest width the renderer can
+   // draw, which is 16 bits, since Parse_GLTF already widened any 8-bit ones.
+   int *Uses = Count_Accessor_Uses(Scene, Scratch);
+
+   idx Total_Saved = 0;
+   int Welded_Count = 0;
+
+   for(int Primitive_Index = 0; Primitive_Index < Scene->Primitive_Count; ++Primitive_Index)
+   {
+      gltf_primitive *Primitive = Scene->Primitives + Primitive_Index;
+      if(Primitive->Position < 0 || Primitive->Indices < 0 || Uses[Primitive->Indices] != 1 ||
+         Accessors[Primitive->Indices].Type != GLTF_ACCESSOR_TYPE_SCALAR)
+      {
+         continue;
+      }
+
+      int Attributes[] = {Primitive->Position, Primitive->Normal, Primitive->Texcoord_0, Primitive->Texcoord_1,
+                          Primitive->Color_0, Primitive->Color_1};
+
+      idx Vertex_Count = Accessors[Primitive->Position].Count;
+      u8 *Streams[Array_Count(Attributes)];
+      idx Sizes[Array_Count(Attributes)];
+      int Stream_Count = 0;
+
+      bool Weldable = true;
+      for(int Attribute = 0; Attribute < Array_Count(Attributes); ++Attribute)
+      {
+         int Accessor_Index = Attributes[Attribute];
+         if(Accessor_Index >= 0)
+         {
+            gltf_accessor *Accessor = Accessors + Accessor_Index;
+            Weldable = Weldable && (Uses[Accessor_Index] == 1 && Accessor->Count == Vertex_Count);
+
+            Streams[Stream_Count] = Data[Accessor_Index];
+            Sizes[Stream_Count] = Get_GLTF_Type_Size(Accessor->Type, Accessor->Component_Type);
+            Stream_Count++;
+         }
+      }
+      if(!Weldable || Vertex_Count == 0)
+      {
+         continue;
+      }
+
+      gltf_accessor *Index_Accessor = Accessors + Primitive->Indices;
+      idx Index_Count = Index_Accessor->Count;
+      idx Index_Size = Get_GLTF_Type_Size(GLTF_ACCESSOR_TYPE_SCALAR, Index_Accessor->Component_Type);
+      u8 *Stored_Indices = Data[Primitive->Indices];
+
+      // NOTE: Widened indices outlive the primitive's scratch, so they're
+      // allocated first.
+      u8 *Widened_Indices = (Index_Size < 4 && Vertex_Count > 65536) ? Allocate(Scratch, u8, sizeof(u32)*Index_Count) : 0;
+
+      arena Primitive_Scratch = *Scratch;
+      u32 *Indices = Read_Baked_Indices(Stored_Indices, Index_Size, Index_Count, Vertex_Count, &Primitive_Scratch);
+      if(!Indices)
+      {
+         Log("Skipped welding primitive %d in %s: it indexes past its vertices.\n", Primitive_Index, Path);
+         continue;
+      }
+
+      // NOTE: Open addressing keyed on the vertex hash. The table refers to
+      // vertices by their original index, and unique vertices keep their
+      // first-seen order.
+      idx Table_Size = 1;
+      while(Table_Size < 2*Vertex_Count)
+      {
+         Table_Size <<= 1;
+      }
+
+      u32 *Table = Allocate(&Primitive_Scratch, u32, Table_Size);
+      for(idx Slot = 0; Slot < Table_Size; ++Slot)
+      {
+         Table[Slot] = UINT32_MAX;
+      }
+
+      u32 *Remap = Allocate(&Primitive_Scratch, u32, Vertex_Count);
+      u32 *Unique_Vertices = Allocate(&Primitive_Scratch, u32, Vertex_Count);
+      u32 Unique_Count = 0;
+      for(u32 Vertex = 0; Vertex < Vertex_Count; ++Vertex)
+      {
+         idx Slot = Hash_Baked_Vertex(Streams, Sizes, Stream_Count, Vertex) & (Table_Size - 1);
+         while(Table[Slot] != UINT32_MAX && !Baked_Vertices_Equal(Streams, Sizes, Stream_Count, Table[Slot], Vertex))
+         {
+            Slot = (Slot + 1) & (Table_Size - 1);
+         }
+
+         if(Table[Slot] == UINT32_MAX)
+         {
+            Table[Slot] = Vertex;
+            Unique_Vertices[Unique_Count] = Vertex;
+            Remap[Vertex] = Unique_Count++;
+         }
+         else
+         {
+            Remap[Vertex] = Remap[Table[Slot]];
+         }
+      }
+
+      // NOTE: Indices are narrowed from 32 bits when the welded vertices fit,
+      // and only widened when 16 bits can't address them all.
+      idx New_Index_Size = (Unique_Count <= 65536) ? 2 : 4;
+      if(Unique_Count == Vertex_Count && New_Index_Size == Index_Size)
+      {
+         continue;
+      }
+
+      idx Vertex_Size = 0;
+      for(int Stream = 0; Stream < Stream_Count; ++Stream)
+      {
+         Vertex_Size += Sizes[Stream];
+      }
+
+      // NOTE: Each unique vertex moves down to its new index, which is never
+      // above its old one, so compacting in order never overwrites a vertex
+      // that has yet to move.
+      for(u32 Unique = 0; Unique < Unique_Count; ++Unique)
+      {
+         for(int Stream = 0; Stream < Stream_Count; ++Stream)
+         {
+            memmove(Streams[Stream] + Unique*Sizes[Stream], Streams[Stream] + Unique_Vertices[Unique]*Sizes[Stream], Sizes[Stream]);
+         }
+      }
+      for(int Attribute = 0; Attribute < Array_Count(Attributes); ++Attribute)
+      {
+         if(Attributes[Attribute] >= 0)
+         {
+            Accessors[Attributes[Attribute]].Count = Unique_Count;
+         }
+      }
+
+      u8 *New_Indices = (New_Index_Size <= Index_Size) ? Stored_Indices : Widened_Indices;
+      for(idx Index = 0; Index < Index_Count; ++Index)
+      {
+         u32 Value = Remap[Indices[Index]];
+         switch(New_Index_Size)
+         {
+            case 2: { ((u16 *)New_Indices)[Index] = (u16)Value; } break;
+            case 4: { ((u32 *)New_Indices)[Index] = Value; } break;
+         }
+      }
+      Data[Primitive->Indices] = New_Indices;
+      Index_Accessor->Component_Type = (New_Index_Size == 2) ? GLTF_ACCESSOR_COMPONENT_U16 : GLTF_ACCESSOR_COMPONENT_U32;
+
+      idx Size_Before = Vertex_Count*Vertex_Size + Index_Count*Index_Size;
+      idx Size_After = Unique_Count*Vertex_Size + Index_Count*New_Index_Size;
+      Log("Welded primitive %d in %s: %lld -> %u vertices, %d -> %d-bit indices, %lld bytes saved.\n",
+          Primitive_Index, Path, (long long)Vertex_Count, Unique_Count, (int)(8*Index_Size), (int)(8*New_Index_Size),
+          (long long)(Size_Before - Size_After));
+
+      Total_Saved += Size_Before - Size_After;
+      Welded_Count++;
+   }
+
+   Log("Welded %d of %d primitives in %s: %lld bytes saved.\n", Welded_Count, Scene->Primitive_Count, Path, (long long)Total_Saved);
+}
+
+static void Optimize_Baked_Primitives(gltf_scene *Scene, gltf_accessor *Accessors, u8 **Data, arena Scratch, char *Path)
+{
+   // NOTE: Reordering an accessor is only safe when no other primitive reads
+   // it. Triangles can be reordered whenever the index accessor is unshared,
+   // but vertices can only be renumbered when every attribute is unshared as
+   // well.
+   int *Uses = Count_Accessor_Uses(Scene, &Scratch);
+
+   vertex_cache_statistics Before = {0};
+   vertex_cache_statistics After = {0};
+   int Optimized_Count = 0;
+
+   for(int Primitive_Index = 0; Primitive_Index < Scene->Primitive_Count; ++Primitive_Index)
+   {
+      gltf_primitive *Primitive = Scene->Primitives + Primitive_Index;
+      if(Primitive->Mode != GLTF_PRIMITIVE_MODE_TRIANGLES ||
+         Primitive->Position < 0 || Primitive->Indices < 0 ||
+         Uses[Primitive->Indices] != 1)
+      {
+         continue;
+      }
+
+      gltf_accessor *Index_Accessor = Accessors + Primitive->Indices;
+      idx Index_Count = Index_Accessor->Count;
+      idx Index_Size = Get_GLTF_Type_Size(GLTF_ACCESSOR_TYPE_SCALAR, Index_Accessor->Component_Type);
+      idx Vertex_Count = Accessors[Primitive->Position].Count;
+      if(Index_Accessor->Type != GLTF_ACCESSOR_TYPE_SCALAR || (Index_Count % 3) != 0 || Vertex_Count == 0)
+      {
+         continue;
+      }
+
+      arena Primitive_Scratch = Scratch;
+      u8 *Stored_Indices = Data[Primitive->Indices];
+      u32 *Indices = Read_Baked_Indices(Stored_Indices, Index_Size, Index_Count, Vertex_Count, &Primitive_Scratch);
+      if(!Indices)
+      {
+         Log("Skipped optimizing primitive %d in %s: it indexes past its vertices.\n", Primitive_Index, Path);
+         continue;
+      }
+
+      vertex_cache_statistics Primitive_Before = Analyze_Vertex_Cache(Indices, Index_Count, Vertex_Count, Primitive_Scratch);
+
+      Optimize_Vertex_Cache(Indices, Index_Count, Vertex_Count, Primitive_Scratch);
+
+      gltf_accessor *Position_Accessor = Accessors + Primitive->Position;
+      if(Position_Accessor->Type == GLTF_ACCESSOR_TYPE_VEC3 &&
+         Position_Accessor->Component_Type == GLTF_ACCESSOR_COMPONENT_F32)
+      {
+         float *Positions = (float *)Data[Primitive->Position];
+         Optimize_Overdraw(Indices, Index_Count, Positions, 3, Vertex_Count, Primitive_Scratch);
+      }
+
+      int Attributes[] = {Primitive->Position, Primitive->Normal, Primitive->Texcoord_0, Primitive->Texcoord_1,
+                          Primitive->Color_0, Primitive->Color_1};
+
+      bool Remappable = true;
+      for(int Attribute = 0; Attribute < Array_Count(Attributes); ++Attribute)
+      {
+         int Accessor_Index = Attributes[Attribute];
+         if(Accessor_Index >= 0 && (Uses[Accessor_Index] != 1 || Accessors[Accessor_Index].Count != Vertex_Count))
+         {
+            Remappable = false;
+         }
+      }
+
+      if(Remappable)
+      {
+         u32 *Remap = Allocate(&Primitive_Scratch, u32, Vertex_Count);
+         Optimize_Vertex_Fetch_Remap(Remap, Indices, Index_Count, Vertex_Count);
+         Remap_Indices(Indices, Index_Count, Remap);
+
+         for(int Attribute = 0; Attribute < Array_Count(Attributes); ++Attribute)
+         {
+            int Accessor_Index = Attributes[Attribute];
+            if(Accessor_Index >= 0)
+            {
+               gltf_accessor *Accessor = Accessors + Accessor_Index;
+               idx Vertex_Size = Get_GLTF_Type_Size(Accessor->Type, Accessor->Component_Type);
+               Remap_Vertices(Data[Accessor_Index], Vertex_Size, Vertex_Count, Remap, Primitive_Scratch);
+            }
+         }
+      }
+
+      vertex_cache_statistics Primitive_After = Analyze_Vertex_Cache(Indices, Index_Count, Vertex_Count, Primitive_Scratch);
+
+      for(idx Index = 0; Index < Index_Count; ++Index)
+      {
+         switch(Index_Size)
+         {
+            case 1: { Stored_Indices[Index] = (u8)Indices[Index]; } break;
+            case 2: { ((u16 *)Stored_Indices)[Index] = (u16)Indices[Index]; } break;
+            case 4: { ((u32 *)Stored_Indices)[Index] = Indices[Index]; } break;
+         }
+      }
+
+      Before.Triangle_Count += Primitive_Before.Triangle_Count;
+      Before.Vertex_Count += Primitive_Before.Vertex_Count;
+      Before.Cache_Misses += Primitive_Before.Cache_Misses;
+
+      After.Triangle_Count += Primitive_After.Triangle_Count;
+      After.Vertex_Count += Primitive_After.Vertex_Count;
+      After.Cache_Misses += Primitive_After.Cache_Misses;
+
+      Optimized_Count++;
+   }
+
+   Log("Optimized %d of %d primitives in %s: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f.\n",
+       Optimized_Count, Scene->Primitive_Count, Path,
+       Get_ACMR(Before), Get_ACMR(After), Get_ATVR(Before), Get_ATVR(After));
+}
+
+typedef struct {
+   int Count;
+   gltf_meshlet *Meshlets;
+
+   int Vertex_Count;
+   u32 *Vertices;
+
+   int Triangle_Count;
+   u8 *Triangles;
+} baked_meshlets;
+
+static baked_meshlets Build_Baked_Meshlets(gltf_scene *Scene, gltf_primitive *Primitives, gltf_accessor *Accessors, u8 **Data, arena *Scratch, char *Path)
+{
+   // NOTE: Splits every triangle primitive with float positions into meshlets,
+   // following the triangle order left by Optimize_Baked_Primitives. Positions
+   // must not be quantized yet, since the bounds are computed from them.
+   baked_meshlets Result = {0};
+
+   idx Meshlet_Capacity = 0;
+   idx Index_Capacity = 0;
+   for(int Primitive_Index = 0; Primitive_Index < Scene->Primitive_Count; ++Primitive_Index)
+   {
+      gltf_primitive *Primitive = Primitives + Primitive_Index;
+      if(Primitive->Mode == GLTF_PRIMITIVE_MODE_TRIANGLES && Primitive->Position >= 0)
+      {
+         int Count_Accessor = (Primitive->Indices >= 0) ? Primitive->Indices : Primitive->Position;
+         idx Index_Count = Accessors[Count_Accessor].Count;
+         Meshlet_Capacity += Get_Meshlet_Bound(Index_Count);
+         Index_Capacity += Index_Count;
+      }
+   }
+
+   Result.Meshlets = Allocate(Scratch, gltf_meshlet, Meshlet_Capacity);
+   Result.Vertices = Allocate(Scratch, u32, Index_Capacity);
+   Result.Triangles = Allocate(Scratch, u8, Index_Capacity);
+
+   clock_t Start = clock();
+   idx Triangle_Total = 0;
+
+   for(int Primitive_Index = 0; Primitive_Index < Scene->Primitive_Count; ++Primitive_Index)
+   {
+      gltf_primitive *Primitive = Primitives + Primitive_Index;
+      Primitive->First_Meshlet = Result.Count;
+      Primitive->Meshlet_Count = 0;
+
+      if(Primitive->Mode != GLTF_PRIMITIVE_MODE_TRIANGLES || Primitive->Position < 0)
+      {
+         continue;
+      }
+
+      gltf_accessor *Position_Accessor = Accessors + Primitive->Position;
+      if(Position_Accessor->Type != GLTF_ACCESSOR_TYPE_VEC3 ||
+         Position_Accessor->Component_Type != GLTF_ACCESSOR_COMPONENT_F32)
+      {
+         continue;
+      }
+
+      // NOTE: Unindexed primitives are split as if their indices were 0, 1, 2...
+      arena Primitive_Scratch = *Scratch;
+      idx Vertex_Count = Position_Accessor->Count;
+      idx Index_Count = Vertex_Count;
+      u32 *Indices = 0;
+      if(Primitive->Indices >= 0)
+      {
+         gltf_accessor *Index_Accessor = Accessors + Primitive->Indices;
+         idx Index_Size = Get_GLTF_Type_Size(GLTF_ACCESSOR_TYPE_SCALAR, Index_Accessor->Component_Type);
+         Index_Count = Index_Accessor->Count;
+         Indices = Read_Baked_Indices(Data[Primitive->Indices], Index_Size, Index_Count, Vertex_Count, &Primitive_Scratch);
+      }
+      else
+      {
+         Indices = Allocate(&Primitive_Scratch, u32, Index_Count);
+         for(idx Index = 0; Index < Index_Count; ++Index)
+         {
+            Indices[Index] = (u32)Index;
+         }
+      }
+
+      if(!Indices)
+      {
+         Log("Skipped building meshlets for primitive %d in %s: it indexes past its vertices.\n", Primitive_Index, Path);
+         continue;
+      }
+
+      gltf_meshlet *Meshlets = Result.Meshlets + Result.Count;
+      idx Meshlet_Count = Build_Meshlets(Meshlets, Result.Vertices + Result.Vertex_Count, Result.Triangles + 3*Result.Triangle_Count,
+                                         Indices, Index_Count, Vertex_Count, Primitive_Scratch);
+
+      float *Positions = (float *)Data[Primitive->Position];
+      for(idx Meshlet_Index = 0; Meshlet_Index < Meshlet_Count; ++Meshlet_Index)
+      {
+         gltf_meshlet *Meshlet = Meshlets + Meshlet_Index;
+         Compute_Meshlet_Bounds(Meshlet, Result.Vertices + Result.Vertex_Count, Result.Triangles + 3*Result.Triangle_Count, Positions, 3);
+      }
+
+      // NOTE: Rebase the meshlets from the primitive's arrays onto the scene's.
+      int Vertex_Total = 0;
+      int Triangle_Count = 0;
+      for(idx Meshlet_Index = 0; Meshlet_Index < Meshlet_Count; ++Meshlet_Index)
+      {
+         gltf_meshlet *Meshlet = Meshlets + Meshlet_Index;
+         Vertex_Total += Meshlet->Vertex_Count;
+         Triangle_Count += Meshlet->Triangle_Count;
+         Meshlet->Vertex_Offset += Result.Vertex_Count;
+         Meshlet->Triangle_Offset += Result.Triangle_Count;
+      }
+
+      Primitive->Meshlet_Count = (int)Meshlet_Count;
+      Result.Count += (int)Meshlet_Count;
+      Result.Vertex_Count += Vertex_Total;
+      Result.Triangle_Count += Triangle_Count;
+      Triangle_Total += Index_Count / 3;
+   }
+
+   double Milliseconds = 1000.0 * (double)(clock() - Start) / CLOCKS_PER_SEC;
+   if(Result.Count)
+   {
+      Log("Built %d meshlets in %s: %.1f vertices and %.1f triangles each on average (%.1f%% full), %.1f ms per million triangles.\n",
+          Result.Count, Path,
+          (double)Result.Vertex_Count / Result.Count,
+          (double)Result.Triangle_Count / Result.Count,
+          100.0 * Result.Triangle_Count / ((double)Result.Count * MAX_MESHLET_TRIANGLE_COUNT),
+          Triangle_Total ? Milliseconds * 1000000.0 / Triangle_Total : 0.0);
+   }
+
+   return(Result);
+}
+
+typedef struct {
+   int Count;
+   gltf_lod *Lods;
+} baked_lods;
+
+static baked_lods Build_Baked_Lods(gltf_scene *Scene, gltf_primitive *Primitives, gltf_accessor *Accessors, u8 **Data,
+                                   int Lod_Count, float Lod_Ratio, arena *Scratch, char *Path)
+{
+   // NOTE: Simplifies every indexed triangle primitive with float positions
+   // and an index accessor of its own into a chain of up to Lod_Count levels,
+   // each aiming for Lod_Ratio of the previous level's triangles. Each level is
+   // simplified further from the one before it, so errors only grow along the
+   // chain. The chain ends early once a level can't get at least halfway to its
+   // target, or once it would need more than twice the full level's indices.
+   // Meshlets only cover the full level, and positions must not be quantized
+   // yet, since errors are measured on them.
+   baked_lods Result = {0};
+   Result.Lods = Allocate(Scratch, gltf_lod, Scene->Primitive_Count*Lod_Count);
+   int *Uses = Count_Accessor_Uses(Scene, Scratch);
+
+   idx Level_Triangles[MAX_LOD_COUNT] = {0};
+   float Level_Errors[MAX_LOD_COUNT] = {0};
+   int Chain_Count = 0;
+   clock_t Start = clock();
+
+   for(int Primitive_Index = 0; Primitive_Index < Scene->Primitive_Count; ++Primitive_Index)
+   {
+      gltf_primitive *Primitive = Primitives + Primitive_Index;
+      Primitive->First_Lod = Result.Count;
+      Primitive->Lod_Count = 0;
+
+      if(Lod_Count < 2 || Primitive->Mode != GLTF_PRIMITIVE_MODE_TRIANGLES ||
+         Primitive->Position < 0 || Primitive->Indices < 0 || Uses[Primitive->Indices] != 1)
+      {
+         continue;
+      }
+
+      gltf_accessor *Position_Accessor = Accessors + Primitive->Position;
+      gltf_accessor *Index_Accessor = Accessors + Primitive->Indices;
+      idx Vertex_Count = Position_Accessor->Count;
+      idx Index_Count = Index_Accessor->Count;
+      if(Position_Accessor->Type != GLTF_ACCESSOR_TYPE_VEC3 ||
+         Position_Accessor->Component_Type != GLTF_ACCESSOR_COMPONENT_F32 ||
+         Index_Accessor->Type != GLTF_ACCESSOR_TYPE_SCALAR ||
+         (Index_Count % 3) != 0 || Index_Count == 0 || Vertex_Count == 0)
+      {
+         continue;
+      }
+
+      // NOTE: The chain outlives the primitive's scratch, so it's allocated
+      // first. The full level keeps its indices as they are.
+      idx Index_Size = Get_GLTF_Type_Size(GLTF_ACCESSOR_TYPE_SCALAR, Index_Accessor->Component_Type);
+      idx Chain_Capacity = 2*Index_Count;
+      u8 *Chain = Allocate(Scratch, u8, Chain_Capacity*Index_Size);
+      Copy_Memory(Chain, Data[Primitive->Indices], Index_Count*Index_Size);
+
+      arena Primitive_Scratch = *Scratch;
+      u32 *Indices = Read_Baked_Indices(Data[Primitive->Indices], Index_Size, Index_Count, Vertex_Count, &Primitive_Scratch);
+      if(!Indices)
+      {
+         Log("Skipped building levels of detail for primitive %d in %s: it indexes past its vertices.\n", Primitive_Index, Path);
+         continue;
+      }
+
+      float *Positions = (float *)Data[Primitive->Position];
+      mesh_simplifier Simplifier = Begin_Mesh_Simplification(&Primitive_Scratch, Indices, Index_Count, Positions, 3, Vertex_Count);
+
+      gltf_lod *Lods = Result.Lods + Result.Count;
+      Lods[0].First_Index = 0;
+      Lods[0].Index_Count = (u32)Index_Count;
+      Lods[0].Error = 0;
+
+      int Level_Count = 1;
+      idx Chain_Index_Count = Index_Count;
+      while(Level_Count < Lod_Count)
+      {
+         idx Previous_Count = Lods[Level_Count - 1].Index_Count;
+         idx Target_Count = (idx)(Previous_Count * Lod_Ratio) / 3 * 3;
+         idx Count = Simplify_Mesh(&Simplifier, Target_Count, Primitive_Scratch);
+         if(Count == 0 || Count > Previous_Count - (Previous_Count - Target_Count) / 2 ||
+            Chain_Index_Count + Count > Chain_Capacity)
+         {
+            break;
+         }
+
+         // NOTE: Each level gets its own vertex cache order.
+         arena Level_Scratch = Primitive_Scratch;
+         u32 *Level = Allocate(&Level_Scratch, u32, Count);
+         Copy_Memory(Level, Simplifier.Indices, Count*sizeof(u32));
+         Optimize_Vertex_Cache(Level, Count, Vertex_Count, Level_Scratch);
+
+         u8 *Stored = Chain + Chain_Index_Count*Index_Size;
+         for(idx Index = 0; Index < Count; ++Index)
+         {
+            switch(Index_Size)
+            {
+               case 1: { Stored[Index] = (u8)Level[Index]; } break;
+               case 2: { ((u16 *)Stored)[Index] = (u16)Level[Index]; } break;
+               case 4: { ((u32 *)Stored)[Index] = Level[Index]; } break;
+            }
+         }
+
+         gltf_lod *Lod = Lods + Level_Count++;
+         Lod->First_Index = (u32)Chain_Index_Count;
+         Lod->Index_Count = (u32)Count;
+         Lod->Error = Square_Root(Simplifier.Error);
+         Chain_Index_Count += Count;
+      }
+
+      if(Level_Count < 2)
+      {
+         continue;
+      }
+
+      // NOTE: The bounding sphere is centered on the bounding box, like the
+      // meshlets' spheres.
+      vec3 Min = {Positions[0], Positions[1], Positions[2]};
+      vec3 Max = Min;
+      for(idx Vertex = 0; Vertex < Vertex_Count; ++Vertex)
+      {
+         float *P = Positions + 3*Vertex;
+         Min.X = Minimum(Min.X, P[0]); Max.X = Maximum(Max.X, P[0]);
+         Min.Y = Minimum(Min.Y, P[1]); Max.Y = Maximum(Max.Y, P[1]);
+         Min.Z = Minimum(Min.Z, P[2]); Max.Z = Maximum(Max.Z, P[2]);
+      }
+
+      vec3 Center = Mul_Vec3(Add_Vec3(Min, Max), 0.5f);
+      float Radius_Squared = 0;
+      for(idx Vertex = 0; Vertex < Vertex_Count; ++Vertex)
+      {
+         float *P = Positions + 3*Vertex;
+         vec3 Position = {P[0], P[1], P[2]};
+         Radius_Squared = Maximum(Radius_Squared, Length_Squared_Vec3(Sub_Vec3(Position, Center)));
+      }
+
+      Primitive->Center[0] = Center.X;
+      Primitive->Center[1] = Center.Y;
+      Primitive->Center[2] = Center.Z;
+      Primitive->Radius = Square_Root(Radius_Squared);
+
+      Primitive->Lod_Count = Level_Count;
+      Result.Count += Level_Count;
+      Index_Accessor->Count = (int)Chain_Index_Count;
+      Data[Primitive->Indices] = Chain;
+
+      // NOTE: Statistics count a primitive at its coarsest level for levels
+      // past the end of its chain.
+      for(int Level = 0; Level < Lod_Count; ++Level)
+      {
+         gltf_lod *Lod = Lods + Minimum(Level, Level_Count - 1);
+         Level_Triangles[Level] += Lod->Index_Count / 3;
+         Level_Errors[Level] = Maximum(Level_Errors[Level], Lod->Error);
+      }
+      Chain_Count++;
+   }
+
+   double Milliseconds = 1000.0 * (double)(clock() - Start) / CLOCKS_PER_SEC;
+   if(Chain_Count)
+   {
+      Log("Built levels of detail for %d of %d primitives in %s in %.1f ms.\n", Chain_Count, Scene->Primitive_Count, Path, Milliseconds);
+      for(int Level = 0; Level < Lod_Count; ++Level)
+      {
+         Log("  Level %d: %lld triangles (%.1f%% of full detail), error up to %g.\n", Level, (long long)Level_Triangles[Level],
+             100.0 * Level_Triangles[Level] / Level_Triangles[0], Level_Errors[Level]);
+      }
+   }
+
+   return(Result);
+}
+
+typedef enum {
+   BAKED_ROLE_NONE,
+   BAKED_ROLE_POSITION,
+   BAKED_ROLE_NORMAL,
+   BAKED_ROLE_COLOR,
+   BAKED_ROLE_TEXCOORD,
+   BAKED_ROLE_OTHER,
+} baked_accessor_role;
+
+static inline u16 Quantize_Unorm16(float Value)
+{
+   float Clamped = Minimum(Maximum(Value, 0.0f), 1.0f);
+   u16 Result = (u16)(Clamped*65535.0f + 0.5f);
+   return(Result);
+}
+
+static inline s16 Quantize_Snorm16(float Value)
+{
+   float Clamped = Minimum(Maximum(Value, -1.0f), 1.0f);
+   s16 Result = (s16)(Clamped*32767.0f + (Clamped >= 0.0f ? 0.5f : -0.5f));
+   return(Result);
+}
+
+static inline u8 Quantize_Unorm8(float Value)
+{
+   float Clamped = Minimum(Maximum(Value, 0.0f), 1.0f);
+   u8 Result = (u8)(Clamped*255.0f + 0.5f);
+   return(Result);
+}
+
+static void Quantize_Baked_Accessors(gltf_scene *Scene, gltf_accessor *Accessors, u8 **Data, float Position_Error, arena *Scratch, char *Path)
+{
+   // NOTE: Vertex attributes are stored in the compact formats allowed by
+   // KHR_mesh_quantization. Positions are normalized 16-bit values relative to
+   // their own accessor's bounding box, with one uniform scale so the decode
+   // can be folded into the model matrix. Accessors so large that the rounding
+   // error would exceed Position_Error keep their float positions. Normals are
+   // octahedral encoded into two 16-bit components, colors become 8-bit and
+   // texcoords in [0, 1] become 16-bit. An accessor read in more than one role
+   // is left alone.
+   baked_accessor_role *Roles = Allocate(Scratch, baked_accessor_role, Scene->Accessor_Count);
+   for(int Primitive_Index = 0; Primitive_Index < Scene->Primitive_Count; ++Primitive_Index)
+   {
+      gltf_primitive *Primitive = Scene->Primitives + Primitive_Index;
+      int References[] = {Primitive->Position, Primitive->Normal, Primitive->Color_0, Primitive->Color_1,
+                          Primitive->Texcoord_0, Primitive->Texcoord_1, Primitive->Indices};
+      baked_accessor_role Reference_Roles[] = {BAKED_ROLE_POSITION, BAKED_ROLE_NORMAL, BAKED_ROLE_COLOR, BAKED_ROLE_COLOR,
+                                               BAKED_ROLE_TEXCOORD, BAKED_ROLE_TEXCOORD, BAKED_ROLE_OTHER};
+
+      for(int Reference = 0; Reference < Array_Count(References); ++Reference)
+      {
+         int Accessor_Index = References[Reference];
+         if(Accessor_Index >= 0 && Accessor_Index < Scene->Accessor_Count)
+         {
+            baked_accessor_role Role = Roles[Accessor_Index];
+            Roles[Accessor_Index] = (Role == BAKED_ROLE_NONE || Role == Reference_Roles[Reference])
+               ? Reference_Roles[Reference]
+               : BAKED_ROLE_OTHER;
+         }
+      }
+   }
+
+   idx Size_Before = 0;
+   idx Size_After = 0;
+   int Float_Position_Count = 0;
+   for(int Accessor_Index = 0; Accessor_Index < Scene->Accessor_Count; ++Accessor_Index)
+   {
+      gltf_accessor *Accessor = Accessors + Accessor_Index;
+      baked_accessor_role Role = Roles[Accessor_Index];
+      if(Role == BAKED_ROLE_NONE || Role == BAKED_ROLE_OTHER)
+      {
+         continue;
+      }
+
+      idx Count = Accessor->Count;
+      Size_Before += Count * Get_GLTF_Type_Size(Accessor->Type, Accessor->Component_Type);
+
+      if(Accessor->Component_Type == GLTF_ACCESSOR_COMPONENT_F32 && Count > 0)
+      {
+         int Component_Count = GLTF_Accessor_Type_Infos[Accessor->Type].Component_Count;
+         float *Values = (float *)Data[Accessor_Index];
+
+         if(Role == BAKED_ROLE_POSITION && Accessor->Type == GLTF_ACCESSOR_TYPE_VEC3)
+         {
+            // NOTE: The fourth component only pads each position to 8 bytes,
+            // since three component 16-bit formats are rarely supported.
+            vec3 Min = {Values[0], Values[1], Values[2]};
+            vec3 Max = Min;
+            for(idx Index = 0; Index < Count; ++Index)
+            {
+               float *P = Values + 3*Index;
+               Min.X = Minimum(Min.X, P[0]); Max.X = Maximum(Max.X, P[0]);
+               Min.Y = Minimum(Min.Y, P[1]); Max.Y = Maximum(Max.Y, P[1]);
+               Min.Z = Minimum(Min.Z, P[2]); Max.Z = Maximum(Max.Z, P[2]);
+            }
+
+            float Extent = Maximum(Maximum(Max.X - Min.X, Max.Y - Min.Y), Max.Z - Min.Z);
+            float Scale = (Extent > 0.0f) ? Extent : 1.0f;
+
+            // NOTE: Rounding to the nearest step is off by at most half a step
+            // along each axis.
+            if(0.5f*Scale/65535.0f > Position_Error)
+            {
+               Float_Position_Count++;
+               Size_After += Count * Get_GLTF_Type_Size(Accessor->Type, Accessor->Component_Type);
+               continue;
+            }
+
+            u16 *Quantized = Allocate(Scratch, u16, 4*Count);
+            for(idx Index = 0; Index < Count; ++Index)
+            {
+               float *P = Values + 3*Index;
+               Quantized[4*Index + 0] = Quantize_Unorm16((P[0] - Min.X) / Scale);
+               Quantized[4*Index + 1] = Quantize_Unorm16((P[1] - Min.Y) / Scale);
+               Quantized[4*Index + 2] = Quantize_Unorm16((P[2] - Min.Z) / Scale);
+               Quantized[4*Index + 3] = 0;
+            }
+
+            Accessor->Type = GLTF_ACCESSOR_TYPE_VEC4;
+            Accessor->Component_Type = GLTF_ACCESSOR_COMPONENT_U16;
+            Accessor->Normalized = true;
+            Accessor->Decode_Offset[0] = Min.X;
+            Accessor->Decode_Offset[1] = Min.Y;
+            Accessor->Decode_Offset[2] = Min.Z;
+            Accessor->Decode_Scale = Scale;
+            Data[Accessor_Index] = (u8 *)Quantized;
+         }
+         else if(Role == BAKED_ROLE_NORMAL && Accessor->Type == GLTF_ACCESSOR_TYPE_VEC3)
+         {
+            s16 *Quantized = Allocate(Scratch, s16, 2*Count);
+            for(idx Index = 0; Index < Count; ++Index)
+            {
+               float *N = Values + 3*Index;
+               float Length = Absolute(N[0]) + Absolute(N[1]) + Absolute(N[2]);
+               float X = (Length > 0.0f) ? N[0] / Length : 0.0f;
+               float Y = (Length > 0.0f) ? N[1] / Length : 0.0f;
+               if(N[2] < 0.0f)
+               {
+                  float Folded_X = (1.0f - Absolute(Y)) * (X >= 0.0f ? 1.0f : -1.0f);
+                  float Folded_Y = (1.0f - Absolute(X)) * (Y >= 0.0f ? 1.0f : -1.0f);
+                  X = Folded_X;
+                  Y = Folded_Y;
+               }
+
+               Quantized[2*Index + 0] = Quantize_Snorm16(X);
+               Quantized[2*Index + 1] = Quantize_Snorm16(Y);
+            }
+
+            Accessor->Type = GLTF_ACCESSOR_TYPE_VEC2;
+            Accessor->Component_Type = GLTF_ACCESSOR_COMPONENT_S16;
+            Accessor->Normalized = true;
+            Data[Accessor_Index] = (u8 *)Quantized;
+         }
+         else if(Role == BAKED_ROLE_COLOR && (Accessor->Type == GLTF_ACCESSOR_TYPE_VEC3 || Accessor->Type == GLTF_ACCESSOR_TYPE_VEC4))
+         {
+            u8 *Quantized = Allocate(Scratch, u8, 4*Count);
+            for(idx Index = 0; Index < Count; ++Index)
+            {
+               float *C = Values + Component_Count*Index;
+               Quantized[4*Index + 0] = Quantize_Unorm8(C[0]);
+               Quantized[4*Index + 1] = Quantize_Unorm8(C[1]);
+               Quantized[4*Index + 2] = Quantize_Unorm8(C[2]);
+               Quantized[4*Index + 3] = (Component_Count == 4) ? Quantize_Unorm8(C[3]) : 255;
+            }
+
+            Accessor->Type = GLTF_ACCESSOR_TYPE_VEC4;
+            Accessor->Component_Type = GLTF_ACCESSOR_COMPONENT_U8;
+            Accessor->Normalized = true;
+            Data[Accessor_Index] = Quantized;
+         }
+         else if(Role == BAKED_ROLE_TEXCOORD && Accessor->Type == GLTF_ACCESSOR_TYPE_VEC2)
+         {
+            // NOTE: Wrapping texcoords outside of [0, 1] would need a decode
+            // transform of their own, so those stay as floats.
+            bool In_Range = true;
+            for(idx Index = 0; Index < 2*Count; ++Index)
+            {
+               In_Range = In_Range && (Values[Index] >= 0.0f && Values[Index] <= 1.0f);
+            }
+
+            if(In_Range)
+            {
+               u16 *Quantized = Allocate(Scratch, u16, 2*Count);
+               for(idx Index = 0; Index < 2*Count; ++Index)
+               {
+                  Quantized[Index] = Quantize_Unorm16(Values[Index]);
+               }
+
+               Accessor->Component_Type = GLTF_ACCESSOR_COMPONENT_U16;
+               Accessor->Normalized = true;
+               Data[Accessor_Index] = (u8 *)Quantized;
+            }
+         }
+      }
+
+      Size_After += Count * Get_GLTF_Type_Size(Accessor->Type, Accessor->Component_Type);
+   }
+
+   Log("Quantized vertex attributes in %s: %lld -> %lld bytes.\n", Path, (long long)Size_Before, (long long)Size_After);
+   if(Float_Position_Count)
+   {
+      Log("Kept %d position accessors in %s as floats, above the %g error threshold.\n", Float_Position_Count, Path, Position_Error);
+   }
+}
+
+static int Plan_Baked_Buffer_Views(gltf_scene *Scene, gltf_accessor *Accessors, gltf_buffer_view *Views, bool Interleave, arena Scratch)
+{
+   // NOTE: Assigns every accessor a buffer view, and returns the view count.
+   // When interleaving, the attributes the basic pipeline reads are packed
+   // into one strided view per primitive, so the renderer can fetch them
+   // through a single binding. Everything else gets a tightly packed view of
+   // its own. View offsets are filled in when the binary blob is laid out.
+   int Result = 0;
+   int *Uses = Count_Accessor_Uses(Scene, &Scratch);
+   for(int Accessor_Index = 0; Accessor_Index < Scene->Accessor_Count; ++Accessor_Index)
+   {
+      Accessors[Accessor_Index].Buffer_View = -1;
+   }
+
+   for(int Primitive_Index = 0; Interleave && Primitive_Index < Scene->Primitive_Count; ++Primitive_Index)
+   {
+      gltf_primitive *Primitive = Scene->Primitives + Primitive_Index;
+      int Attributes[] = {Primitive->Position, Primitive->Normal, Primitive->Color_0, Primitive->Texcoord_0};
+      if(Primitive->Position < 0 || Primitive->Position >= Scene->Accessor_Count)
+      {
+         continue;
+      }
+
+      // NOTE: Shared accessors can't be interleaved with more than one
+      // primitive, so they keep a view of their own.
+      int Vertex_Count = Accessors[Primitive->Position].Count;
+      bool Interleavable = true;
+      for(int Attribute = 0; Attribute < Array_Count(Attributes); ++Attribute)
+      {
+         int Accessor_Index = Attributes[Attribute];
+         if(Accessor_Index >= 0 && (Accessor_Index >= Scene->Accessor_Count ||
+                                    Uses[Accessor_Index] != 1 ||
+                                    Accessors[Accessor_Index].Count != Vertex_Count))
+         {
+            Interleavable = false;
+         }
+      }
+
+      if(Interleavable)
+      {
+         // NOTE: Elements are kept 4-byte aligned within the vertex, as glTF
+         // requires of strided views.
+         gltf_buffer_view *View = Views + Result;
+         for(int Attribute = 0; Attribute < Array_Count(Attributes); ++Attribute)
+         {
+            int Accessor_Index = Attributes[Attribute];
+            if(Accessor_Index >= 0)
+            {
+               gltf_accessor *Accessor = Accessors + Accessor_Index;
+               Accessor->Buffer_View = Result;
+               Accessor->Offset = View->Stride;
+               View->Stride += (int)Align_Offset(Get_GLTF_Type_Size(Accessor->Type, Accessor->Component_Type), 4);
+            }
+         }
+         View->Length = (idx)View->Stride * Vertex_Count;
+         Result++;
+      }
+   }
+
+   for(int Accessor_Index = 0; Accessor_Index < Scene->Accessor_Count; ++Accessor_Index)
+   {
+      gltf_accessor *Accessor = Accessors + Accessor_Index;
+      if(Accessor->Buffer_View < 0)
+      {
+         gltf_buffer_view *View = Views + Result;
+         View->Length = (idx)Accessor->Count * Get_GLTF_Type_Size(Accessor->Type, Accessor->Component_Type);
+
+         Accessor->Buffer_View = Result++;
+         Accessor->Offset = 0;
+      }
+   }
+
+   return(Result);
+}
+
+typedef struct {
+   gltf_image *Images;
+   idx Data_Size;
+   u8 *Data;
+} baked_images;
+
+static baked_images Compress_Baked_Images(gltf_scene *Scene, platform_work_queue *Queue, bool Fast, arena *Scratch, char *Path)
+{
+   // NOTE: Normal maps go to BC5, which keeps just their X and Y. Everything
+   // else goes to BC7, or with Fast to BC1 when it's opaque and BC3 when it
+   // isn't. Each image starts on the baked alignment within the image data.
+   baked_images Result = {0};
+   Result.Images = Allocate(Scratch, gltf_image, Scene->Image_Count);
+
+   for(int Image_Index = 0; Image_Index < Scene->Image_Count; ++Image_Index)
+   {
+      gltf_image *Source = Scene->Images + Image_Index;
+      gltf_image *Image = Result.Images + Image_Index;
+      *Image = *Source;
+      Image->Offset = 0;
+      Image->Size = 0;
+
+      if(Source->Format == GLTF_IMAGE_FORMAT_RGBA8)
+      {
+         u8 *Pixels = Scene->Image_Data + Source->Offset;
+         bool Opaque = true;
+         for(idx Texel = 0; Opaque && Texel < (idx)Source->Width*Source->Height; ++Texel)
+         {
+            Opaque = (Pixels[4*Texel + 3] == 255);
+         }
+
+         if(Source->Usage == GLTF_IMAGE_USAGE_NORMAL)
+         {
+            Image->Format = GLTF_IMAGE_FORMAT_BC5;
+         }
+         else if(Fast)
+         {
+            Image->Format = Opaque ? GLTF_IMAGE_FORMAT_BC1 : GLTF_IMAGE_FORMAT_BC3;
+         }
+         else
+         {
+            Image->Format = GLTF_IMAGE_FORMAT_BC7;
+         }
+
+         Result.Data_Size = Align_Offset(Result.Data_Size, BAKED_SCENE_ALIGNMENT);
+         Image->Offset = Result.Data_Size;
+         Image->Size = Get_GLTF_Mip_Chain_Size(Image->Format, Image->Width, Image->Height, Image->Mip_Count);
+         Result.Data_Size += Image->Size;
+      }
+   }
+
+   Result.Data = Allocate(Scratch, u8, Result.Data_Size);
+
+   char *Format_Names[] = {"none", "RGBA8", "BC1", "BC3", "BC5", "BC7"};
+   for(int Image_Index = 0; Image_Index < Scene->Image_Count; ++Image_Index)
+   {
+      gltf_image *Source = Scene->Images + Image_Index;
+      gltf_image *Image = Result.Images + Image_Index;
+      if(Image->Format != GLTF_IMAGE_FORMAT_NONE)
+      {
+         Compress_Image(Queue, Image->Format, Scene->Image_Data + Source->Offset, Image->Width, Image->Height,
+                        Image->Mip_Count, Result.Data + Image->Offset, *Scratch);
+
+         Log("Compressed image %d of %s (%dx%d, %d levels) to %s: %lld -> %lld bytes.\n", Image_Index, Path,
+             Image->Width, Image->Height, Image->Mip_Count, Format_Names[Image->Format], (long long)Source->Size, (long long)Image->Size);
+      }
+   }
+
+   return(Result);
+}
+
+// NOTE: glTF distances are in meters, so this is a tenth of a millimeter.
+#define DEFAULT_BAKED_POSITION_ERROR 0.0001f
+
+typedef struct {
+   bool Interleave;      // NOTE: Selects the single binding vertex layout.
+   int Lod_Count;        // NOTE: Levels per primitive, including the full one.
+   float Lod_Ratio;      // NOTE: Triangles in each level relative to the last.
+   bool Fast_Textures;   // NOTE: Selects BC1 and BC3 over BC7.
+   float Position_Error; // NOTE: Largest position quantization error.
+} bake_options;
+
+static bool Bake_Scene(gltf_scene *Scene, platform_work_queue *Queue, arena Scratch, char *Path, u64 Source_Stamp, bake_options Options)
+{
+   bool Result = false;
+
+   // NOTE: Every accessor gets a buffer view of its own, holding a tightly
+   // packed, aligned run of the binary blob. Its elements are extracted,
+   // welded, reordered, simplified and quantized before the file is laid out,
+   // since all but reordering change their size.
+   gltf_accessor *Baked_Accessors = Allocate(&Scratch, gltf_accessor, Scene->Accessor_Count);
+   u8 **Accessor_Data = Allocate(&Scratch, u8 *, Scene->Accessor_Count);
+   if(!Extract_Baked_Accessors(Scene, Baked_Accessors, Accessor_Data, &Scratch, Path))
+   {
+      return(Result);
+   }
+
+   Weld_Baked_Primitives(Scene, Baked_Accessors, Accessor_Data, &Scratch, Path);
+   Optimize_Baked_Primitives(Scene, Baked_Accessors, Accessor_Data, Scratch, Path);
+
+   gltf_primitive *Baked_Primitives = Allocate(&Scratch, gltf_primitive, Scene->Primitive_Count);
+   Copy_Memory(Baked_Primitives, Scene->Primitives, Scene->Primitive_Count*sizeof(gltf_primitive));
+   baked_meshlets Meshlets = Build_Baked_Meshlets(Scene, Baked_Primitives, Baked_Accessors, Accessor_Data, &Scratch, Path);
+   baked_lods Lods = Build_Baked_Lods(Scene, Baked_Primitives, Baked_Accessors, Accessor_Data, Options.Lod_Count, Options.Lod_Ratio, &Scratch, Path);
+   Quantize_Baked_Accessors(Scene, Baked_Accessors, Accessor_Data, Options.Position_Error, &Scratch, Path);
+   baked_images Images = Compress_Baked_Images(Scene, Queue, Options.Fast_Textures, &Scratch, Path);
+
+   gltf_buffer_view *Baked_Views = Allocate(&Scratch, gltf_buffer_view, Scene->Accessor_Count);
+   int Baked_View_Count = Plan_Baked_Buffer_Views(Scene, Baked_Accessors, Baked_Views, Options.Interleave, Scratch);
+
+   baked_scene_tables Tables = {0};
+   Tables.Primitives = Baked_Primitives;
+   Tables.Accessors = Baked_Accessors;
+   Tables.Buffer_View_Count = Baked_View_Count;
+   Tables.Buffer_Views = Baked_Views;
+   Tables.Meshlet_Count = Meshlets.Count;
+   Tables.Meshlets = Meshlets.Meshlets;
+   Tables.Meshlet_Vertex_Count = Meshlets.Vertex_Count;
+   Tables.Meshlet_Vertices = Meshlets.Vertices;
+   Tables.Meshlet_Triangle_Count = Meshlets.Triangle_Count;
+   Tables.Meshlet_Triangles = Meshlets.Triangles;
+   Tables.Lod_Count = Lods.Count;
+   Tables.Lods = Lods.Lods;
+   Tables.Images = Images.Images;
+   Tables.Image_Data_Size = Images.Data_Size;
+   Tables.Image_Data = Images.Data;
+   Tables.Source_Stamp = Source_Stamp;
+
+   arena Output = {0};
+   string File = Lay_Out_Baked_Scene(Scene, &Tables, &Output);
+   u8 *Binary = File.Data + ((baked_scene_header *)File.Data)->Binary_Offset;
+
+   for(int Accessor_Index = 0; Accessor_Index < Scene->Accessor_Count; ++Accessor_Index)
+   {
+      gltf_accessor *Accessor = Baked_Accessors + Accessor_Index;
+      gltf_buffer_view *View = Baked_Views + Accessor->Buffer_View;
+
+      idx Element_Size = Get_GLTF_Type_Size(Accessor->Type, Accessor->Component_Type);
+      u8 *From = Accessor_Data[Accessor_Index];
+      u8 *To = Binary + View->Offset + Accessor->Offset;
+      if(View->Stride)
+      {
+         for(int Element_Index = 0; Element_Index < Accessor->Count; ++Element_Index)
+         {
+            Copy_Memory(To + Element_Index*View->Stride, From + Element_Index*Element_Size, Element_Size);
+         }
+      }
+      else
+      {
+         Copy_Memory(To, From, Accessor->Count*Element_Size);
+      }
+   }
+
+   Result = Write_Entire_File(Path, File.Data, File.Length);
+   Free_Arena(&Output);
+
+   return(Result);
+}
+
+// NOTE: bench.c includes this file for its platform layer and bake stages, and
+// has an entry point of its own.
+#if !defined(BAKE_BENCHMARK)
+int main(int Argument_Count, char **Arguments)
+{
+   // NOTE: Arguments are pairs of input .glb and output .scene paths, after
+   // any options.
+   bake_options Options = {0};
+   Options.Lod_Count = 4;
+   Options.Lod_Ratio = 0.5f;
+   Options.Position_Error = DEFAULT_BAKED_POSITION_ERROR;
+
+   int Thread_Count = Clamp(Get_Processor_Count(), 1, MAX_WORK_QUEUE_THREAD_COUNT);
+
+   char *Program = Arguments[0];
+   bool Valid = true;
+   while(Valid && Argument_Count > 1 && Arguments[1][0] == '-')
+   {
+      if(C_Strings_Are_Equal(Arguments[1], "-interleave"))
+      {
+         Options.Interleave = true;
+         Arguments++;
+         Argument_Count--;
+      }
+      else if(C_Strings_Are_Equal(Arguments[1], "-fast-textures"))
+      {
+         Options.Fast_Textures = true;
+         Arguments++;
+         Argument_Count--;
+      }
+      else if(C_Strings_Are_Equal(Arguments[1], "-threads") && Argument_Count > 2)
+      {
+         Thread_Count = atoi(Arguments[2]);
+         Valid = (Thread_Count >= 1 && Thread_Count <= MAX_WORK_QUEUE_THREAD_COUNT);
+         Arguments += 2;
+         Argument_Count -= 2;
+      }
+      else if(C_Strings_Are_Equal(Arguments[1], "-lods") && Argument_Count > 2)
+      {
+         Options.Lod_Count = atoi(Arguments[2]);
+         Valid = (Options.Lod_Count >= 1 && Options.Lod_Count <= MAX_LOD_COUNT);
+         Arguments += 2;
+         Argument_Count -= 2;
+      }
+      else if(C_Strings_Are_Equal(Arguments[1], "-lod-ratio") && Argument_Count > 2)
+      {
+         Options.Lod_Ratio = (float)atof(Arguments[2]);
+         Valid = (Options.Lod_Ratio > 0.0f && Options.Lod_Ratio < 1.0f);
+         Arguments += 2;
+         Argument_Count -= 2;
+      }
+      else if(C_Strings_Are_Equal(Arguments[1], "-position-error") && Argument_Count > 2)
+      {
+         Options.Position_Error = (float)atof(Arguments[2]);
+         Valid = (Options.Position_Error > 0.0f);
+         Arguments += 2;
+         Argument_Count -= 2;
+      }
+      else
+      {
+         Valid = false;
+      }
+   }
+
+   if(!Valid || Argument_Count < 3 || (Argument_Count % 2) != 1)
+   {
+      Log("Usage: %s [-interleave] [-lods 1-%d] [-lod-ratio 0-1] [-position-error meters] [-fast-textures] [-threads 1-%d] "
+          "input.gl[b|tf] output.scene [input.gl[b|tf] output.scene ...]\n",
+          Program, MAX_LOD_COUNT, MAX_WORK_QUEUE_THREAD_COUNT);
+      return(1);
+   }
+
+   static platform_work_queue Queue;
+   Queue.Thread_Count = Thread_Count;
+
+   arena Permanent = {0};
+   arena Scratch = {0};
+   Make_Arena(&Permanent, Megabytes(256));
+   Make_Arena(&Scratch, Gigabytes(1));
+
+   int Failures = 0;
+   for(int Argument_Index = 1; Argument_Index + 1 < Argument_Count; Argument_Index += 2)
+   {
+      char *Source_Path = Arguments[Argument_Index];
+      char *Baked_Path = Arguments[Argument_Index + 1];
+
+      Reset_Arena(&Permanent);
+      Reset_Arena(&Scratch);
+
+      gltf_scene Scene = {0};
+      if(Parse_GLTF(&Scene, &Permanent, Scratch, Source_Path) &&
+         Bake_Scene(&Scene, &Queue, Scratch, Baked_Path, Get_GLTF_Source_Stamp(Source_Path, Scratch), Options))
+      {
+         Log("Baked %s to %s (%d meshes, %d nodes, %d draws, %d accessors).\n", Source_Path, Baked_Path,
+             Scene.Mesh_Count, Scene.Nodes.Count, Scene.Draw_Count, Scene.Accessor_Count);
+      }
+      else
+      {
+         Failures++;
+      }
+
+      Unload_Scene(&Scene);
+   }
+
+   return(Failures ? 1 : 0);
+}
+#endif
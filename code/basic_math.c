@@ -28,6 +28,28 @@ static inline float Square_Root(float Value)
    return(Result);
 }
 
+static inline float Power(float Base, float Exponent)
+{
+   float Result = powf(Base, Exponent);
+   return(Result);
+}
+
+static inline float Absolute(float Value)
+{
+   float Result = fabsf(Value);
+   return(Result);
+}
+
+static inline vec3 Add_Vec3(vec3 A, vec3 B)
+{
+   vec3 Result;
+   Result.X = A.X + B.X;
+   Result.Y = A.Y + B.Y;
+   Result.Z = A.Z + B.Z;
+
+   return(Result);
+}
+
 static inline vec3 Sub_Vec3(vec3 A, vec3 B)
 {
    vec3 Result;
@@ -181,6 +203,87 @@ static inline matrix4 Rotate_Z(float Turns)
    return(Result);
 }
 
+static inline matrix4 Multiply_Matrix4(matrix4 A, matrix4 B)
+{
+   // NOTE: Matrices are column-major, so this is the transform that applies B
+   // followed by A.
+   matrix4 Result;
+   for(int Column = 0; Column < 4; ++Column)
+   {
+      for(int Row = 0; Row < 4; ++Row)
+      {
+         float Sum = 0;
+         for(int Index = 0; Index < 4; ++Index)
+         {
+            Sum += A.Elements[Index*4 + Row] * B.Elements[Column*4 + Index];
+         }
+         Result.Elements[Column*4 + Row] = Sum;
+      }
+   }
+
+   return(Result);
+}
+
+static inline vec3 Transform_Point(matrix4 M, vec3 P)
+{
+   float *E = M.Elements;
+
+   vec3 Result;
+   Result.X = E[0]*P.X + E[4]*P.Y + E[8]*P.Z + E[12];
+   Result.Y = E[1]*P.X + E[5]*P.Y + E[9]*P.Z + E[13];
+   Result.Z = E[2]*P.X + E[6]*P.Y + E[10]*P.Z + E[14];
+
+   return(Result);
+}
+
+static inline matrix4 Normal_Matrix(matrix4 M)
+{
+   // NOTE: The inverse transpose of M's upper 3x3, which keeps normals
+   // perpendicular to surfaces under non-uniform scale. Its columns are the
+   // cross products of M's columns over the determinant. Everything outside the
+   // upper 3x3 is left as identity.
+   float *E = M.Elements;
+   vec3 C0 = {E[0], E[1], E[2]};
+   vec3 C1 = {E[4], E[5], E[6]};
+   vec3 C2 = {E[8], E[9], E[10]};
+
+   vec3 N0 = Cross_Vec3(C1, C2);
+   vec3 N1 = Cross_Vec3(C2, C0);
+   vec3 N2 = Cross_Vec3(C0, C1);
+
+   float Determinant = Dot_Vec3(C0, N0);
+   float Inverse = (Determinant != 0) ? 1.0f / Determinant : 1.0f;
+
+   matrix4 Result =
+   {{
+      N0.X*Inverse, N0.Y*Inverse, N0.Z*Inverse, 0,
+      N1.X*Inverse, N1.Y*Inverse, N1.Z*Inverse, 0,
+      N2.X*Inverse, N2.Y*Inverse, N2.Z*Inverse, 0,
+      0,            0,            0,            1,
+   }};
+
+   return(Result);
+}
+
+static inline matrix4 Translate_Rotate_Scale(vec3 T, vec4 Q, vec3 S)
+{
+   // NOTE: Equivalent to Translate * Rotate(Q) * Scale, with the rotation given
+   // as a unit quaternion.
+   float XX = Q.X*Q.X, YY = Q.Y*Q.Y, ZZ = Q.Z*Q.Z;
+   float XY = Q.X*Q.Y, XZ = Q.X*Q.Z, YZ = Q.Y*Q.Z;
+   float WX = Q.W*Q.X, WY = Q.W*Q.Y, WZ = Q.W*Q.Z;
+
+   matrix4 Result =
+   {{
+      S.X*(1 - 2*(YY + ZZ)), S.X*(2*(XY + WZ)),     S.X*(2*(XZ - WY)),     0,
+      S.Y*(2*(XY - WZ)),     S.Y*(1 - 2*(XX + ZZ)), S.Y*(2*(YZ + WX)),     0,
+      S.Z*(2*(XZ + WY)),     S.Z*(2*(YZ - WX)),     S.Z*(1 - 2*(XX + YY)), 0,
+      T.X,                   T.Y,                   T.Z,                   1,
+   }};
+
+   return(Result);
+}
+
 static inline matrix4 Look_At(vec3 Eye, vec3 Target)
 {
    // NOTE: We're assuming +z is always up in our definition of world space.
@@ -205,9 +308,13 @@ static inline matrix4 Look_At(vec3 Eye, vec3 Target)
    return(Result);
 }
 
+// NOTE: Shared with level of detail selection, which needs to know how many
+// pixels a world space distance covers.
+#define PERSPECTIVE_FOCAL_LENGTH 3.0f
+
 static inline matrix4 Perspective(float Width, float Height, float Near, float Far)
 {
-   float Focal_Length = 3.0f;
+   float Focal_Length = PERSPECTIVE_FOCAL_LENGTH;
 
    float A = Focal_Length / (Width / Height);
    float B = -Focal_Length;
@@ -11,6 +11,13 @@ typedef struct {
    float Z;
 } vec3;
 
+typedef struct {
+   float X;
+   float Y;
+   float Z;
+   float W;
+} vec4;
+
 typedef struct {
    float Elements[16];
 } matrix4;
@@ -104,3 +104,118 @@ static cut Cut(string String, u8 Separator)
 
    return(Result);
 }
+
+static char *Get_File_Name(char *Path)
+{
+   // NOTE: Returns the part of Path after its last separator, or all of it
+   // if there isn't one.
+   char *Result = Path;
+   for(char *At = Path; *At; ++At)
+   {
+      if(*At == '/' || *At == '\\')
+      {
+         Result = At + 1;
+      }
+   }
+
+   return(Result);
+}
+
+// NOTE: A 64-bit hash in the style of xxHash64, which reads 32 bytes per step
+// through four independent lanes and mixes them into one at the end. It's
+// meant for keying caches on file contents, so it's fast rather than secure.
+#define HASH_PRIME_1 0x9E3779B185EBCA87ull
+#define HASH_PRIME_2 0xC2B2AE3D27D4EB4Full
+#define HASH_PRIME_3 0x165667B19E3779F9ull
+#define HASH_PRIME_4 0x85EBCA77C2B2AE63ull
+#define HASH_PRIME_5 0x27D4EB2F165667C5ull
+
+static inline u64 Rotate_Left_64(u64 Value, int Shift)
+{
+   u64 Result = (Value << Shift) | (Value >> (64 - Shift));
+   return(Result);
+}
+
+static inline u64 Read_U64(u8 *From)
+{
+   u64 Result;
+   Copy_Memory(&Result, From, sizeof(Result));
+   return(Result);
+}
+
+static inline u64 Hash_Round(u64 Lane, u64 Input)
+{
+   Lane += Input * HASH_PRIME_2;
+   Lane = Rotate_Left_64(Lane, 31);
+   Lane *= HASH_PRIME_1;
+
+   return(Lane);
+}
+
+static inline u64 Hash_Merge_Round(u64 Hash, u64 Lane)
+{
+   Hash ^= Hash_Round(0, Lane);
+   Hash = Hash*HASH_PRIME_1 + HASH_PRIME_4;
+
+   return(Hash);
+}
+
+static u64 Hash_String(string String, u64 Seed)
+{
+   u8 *At = String.Data;
+   u8 *End = At + String.Length;
+
+   u64 Result;
+   if(String.Length >= 32)
+   {
+      u64 Lanes[4] = {Seed + HASH_PRIME_1 + HASH_PRIME_2, Seed + HASH_PRIME_2, Seed, Seed - HASH_PRIME_1};
+      for(; At + 32 <= End; At += 32)
+      {
+         Lanes[0] = Hash_Round(Lanes[0], Read_U64(At + 0));
+         Lanes[1] = Hash_Round(Lanes[1], Read_U64(At + 8));
+         Lanes[2] = Hash_Round(Lanes[2], Read_U64(At + 16));
+         Lanes[3] = Hash_Round(Lanes[3], Read_U64(At + 24));
+      }
+
+      Result = (Rotate_Left_64(Lanes[0], 1) + Rotate_Left_64(Lanes[1], 7) +
+                Rotate_Left_64(Lanes[2], 12) + Rotate_Left_64(Lanes[3], 18));
+      for(int Lane = 0; Lane < 4; ++Lane)
+      {
+         Result = Hash_Merge_Round(Result, Lanes[Lane]);
+      }
+   }
+   else
+   {
+      Result = Seed + HASH_PRIME_5;
+   }
+
+   Result += (u64)String.Length;
+
+   for(; At + 8 <= End; At += 8)
+   {
+      Result ^= Hash_Round(0, Read_U64(At));
+      Result = Rotate_Left_64(Result, 27)*HASH_PRIME_1 + HASH_PRIME_4;
+   }
+   if(At + 4 <= End)
+   {
+      u32 Word;
+      Copy_Memory(&Word, At, sizeof(Word));
+      Result ^= (u64)Word * HASH_PRIME_1;
+      Result = Rotate_Left_64(Result, 23)*HASH_PRIME_2 + HASH_PRIME_3;
+      At += 4;
+   }
+   for(; At < End; ++At)
+   {
+      Result ^= (u64)*At * HASH_PRIME_5;
+      Result = Rotate_Left_64(Result, 11)*HASH_PRIME_1;
+   }
+
+   // NOTE: Avalanche, so every input bit affects every output bit.
+   Result ^= Result >> 33;
+   Result *= HASH_PRIME_2;
+   Result ^= Result >> 29;
+   Result *= HASH_PRIME_3;
+   Result ^= Result >> 32;
+
+   return(Result);
+}
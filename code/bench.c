@@ -0,0 +1,874 @@
+/* (c) copyright 2025 Lawrence D. Kern /////////////////////////////////////// */
+
+// NOTE: This file is the entry point for the asset import benchmark. It writes
+// synthetic glTF files at whatever scale it's asked for, and times each stage
+// of importing glTF files, from parsing through baking to loading the baked
+// result. It builds on the baker's platform layer and bake stages, so the
+// numbers come from exactly the code "make bake" and the renderer run.
+
+#define BAKE_BENCHMARK 1
+#include "bake.c"
+
+static double Get_Bench_Seconds(void)
+{
+#if defined(_WIN32)
+   LARGE_INTEGER Frequency, Counter;
+   QueryPerformanceFrequency(&Frequency);
+   QueryPerformanceCounter(&Counter);
+
+   double Result = (double)Counter.QuadPart / (double)Frequency.QuadPart;
+#else
+   struct timespec Time;
+   clock_gettime(CLOCK_MONOTONIC, &Time);
+
+   double Result = (double)Time.tv_sec + (double)Time.tv_nsec / 1000000000.0;
+#endif
+   return(Result);
+}
+
+// NOTE: Synthetic scenes have a node per mesh, each mesh has the same number
+// of primitives, and each primitive is a gently curved grid of vertices with
+// positions, normals and texture coordinates. Interleaved and Sparse are the
+// fractions of primitives whose attributes share one strided buffer view, and
+// whose positions are partly replaced by a sparse block. Json_Padding is a
+// rough number of extra JSON bytes, spread over the nodes' extras as arrays
+// of numbers.
+typedef struct {
+   int Mesh_Count;
+   int Primitive_Count; // NOTE: Per mesh.
+   int Vertex_Count;    // NOTE: Per primitive, rounded up to a square grid.
+   idx Json_Padding;
+   float Interleaved;
+   float Sparse;
+} bench_scene_options;
+
+#define BENCH_VERTEX_STRIDE 32 // NOTE: Position, normal and texture coordinate.
+#define BENCH_SPARSE_SPACING 16
+
+typedef struct {
+   bool Interleaved;
+   bool Sparse;
+
+   int Side;
+   int Vertex_Count;
+   int Index_Count;
+   int Sparse_Count;
+   gltf_component_type Index_Type;
+
+   idx Vertex_Offset;
+   idx Index_Offset;
+   idx Sparse_Offset;
+
+   int First_View;
+   int First_Accessor;
+} bench_primitive;
+
+static void Append_Bench_Text(arena *Arena, char *Format, ...)
+{
+   char *At = (char *)Arena->Base + Arena->Used;
+   idx Available = Arena->Size - Arena->Used;
+
+   va_list Arguments;
+   va_start(Arguments, Format);
+   int Length = vsnprintf(At, Available, Format, Arguments);
+   va_end(Arguments);
+
+   Assert(Length >= 0 && Length < Available);
+   Arena->Used += Length;
+}
+
+static inline bool Has_Bench_Share(int Index, float Fraction)
+{
+   // NOTE: Spreads Fraction of the indices evenly rather than taking a run of
+   // them from the front.
+   bool Result = ((int)((Index + 1)*Fraction) > (int)(Index*Fraction));
+   return(Result);
+}
+
+static void Write_Bench_Primitive(u8 *Binary, bench_primitive *Primitive, int Primitive_Index)
+{
+   u8 *Vertices = Binary + Primitive->Vertex_Offset;
+   idx Vertex_Count = Primitive->Vertex_Count;
+
+   // NOTE: Separate attributes are packed one after the other, interleaved
+   // ones share a single strided run.
+   idx Stride[3] = {12, 12, 8};
+   u8 *Attributes[3] = {Vertices, Vertices + 12*Vertex_Count, Vertices + 24*Vertex_Count};
+   if(Primitive->Interleaved)
+   {
+      Stride[0] = Stride[1] = Stride[2] = BENCH_VERTEX_STRIDE;
+      Attributes[1] = Vertices + 12;
+      Attributes[2] = Vertices + 24;
+   }
+
+   int Side = Primitive->Side;
+   float Phase = 0.37f*Primitive_Index;
+   for(int Row = 0; Row < Side; ++Row)
+   {
+      for(int Column = 0; Column < Side; ++Column)
+      {
+         idx Vertex = Row*Side + Column;
+         float U = (float)Column / (float)(Side - 1);
+         float V = (float)Row / (float)(Side - 1);
+
+         float Position[3] = {U - 0.5f, 0.05f*sinf(6.2831853f*(U + Phase))*cosf(6.2831853f*V), V - 0.5f};
+         float Normal[3] = {0.0f, 1.0f, 0.0f};
+         float Texcoord[2] = {U, V};
+
+         Copy_Memory(Attributes[0] + Vertex*Stride[0], Position, sizeof(Position));
+         Copy_Memory(Attributes[1] + Vertex*Stride[1], Normal, sizeof(Normal));
+         Copy_Memory(Attributes[2] + Vertex*Stride[2], Texcoord, sizeof(Texcoord));
+      }
+   }
+
+   u8 *Indices = Binary + Primitive->Index_Offset;
+   int Index_Count = 0;
+   for(int Row = 0; Row + 1 < Side; ++Row)
+   {
+      for(int Column = 0; Column + 1 < Side; ++Column)
+      {
+         u32 Corner = Row*Side + Column;
+         u32 Quad[6] = {Corner, Corner + Side, Corner + 1, Corner + 1, Corner + Side, Corner + Side + 1};
+         for(int Quad_Index = 0; Quad_Index < 6; ++Quad_Index)
+         {
+            if(Primitive->Index_Type == GLTF_ACCESSOR_COMPONENT_U16)
+            {
+               ((u16 *)Indices)[Index_Count++] = (u16)Quad[Quad_Index];
+            }
+            else
+            {
+               ((u32 *)Indices)[Index_Count++] = Quad[Quad_Index];
+            }
+         }
+      }
+   }
+
+   // NOTE: Sparse positions raise every so many vertices.
+   if(Primitive->Sparse)
+   {
+      u32 *Sparse_Indices = (u32 *)(Binary + Primitive->Sparse_Offset);
+      float *Sparse_Values = (float *)(Sparse_Indices + Primitive->Sparse_Count);
+      for(int Sparse_Index = 0; Sparse_Index < Primitive->Sparse_Count; ++Sparse_Index)
+      {
+         u32 Vertex = Sparse_Index*BENCH_SPARSE_SPACING;
+         Sparse_Indices[Sparse_Index] = Vertex;
+
+         float *Position = (float *)(Attributes[0] + Vertex*Stride[0]);
+         Sparse_Values[3*Sparse_Index + 0] = Position[0];
+         Sparse_Values[3*Sparse_Index + 1] = Position[1] + 0.1f;
+         Sparse_Values[3*Sparse_Index + 2] = Position[2];
+      }
+   }
+}
+
+static bool Generate_Bench_Scene(char *Path, bench_scene_options Options, arena Scratch)
+{
+   // NOTE: Writes a .glb, or a .gltf with its binary in a .bin next to it,
+   // depending on Path's extension.
+   string Name = {(idx)strlen(Path), (u8 *)Path};
+   bool Separate = Has_Suffix(Name, S(".gltf"));
+
+   int Primitive_Count = Options.Mesh_Count*Options.Primitive_Count;
+   bench_primitive *Primitives = Allocate(&Scratch, bench_primitive, Primitive_Count);
+
+   // NOTE: Lay out the binary buffer and number the views and accessors.
+   idx Binary_Size = 0;
+   int View_Count = 0;
+   int Accessor_Count = 0;
+   for(int Primitive_Index = 0; Primitive_Index < Primitive_Count; ++Primitive_Index)
+   {
+      bench_primitive *Primitive = Primitives + Primitive_Index;
+      Primitive->Interleaved = Has_Bench_Share(Primitive_Index, Options.Interleaved);
+      Primitive->Sparse = Has_Bench_Share(Primitive_Index, Options.Sparse);
+
+      Primitive->Side = Maximum(2, (int)ceil(sqrt((double)Options.Vertex_Count)));
+      Primitive->Vertex_Count = Primitive->Side*Primitive->Side;
+      Primitive->Index_Count = 6*(Primitive->Side - 1)*(Primitive->Side - 1);
+      Primitive->Index_Type = (Primitive->Vertex_Count <= 0xFFFF) ? GLTF_ACCESSOR_COMPONENT_U16 : GLTF_ACCESSOR_COMPONENT_U32;
+      Primitive->Sparse_Count = Primitive->Sparse ? (Primitive->Vertex_Count + BENCH_SPARSE_SPACING - 1) / BENCH_SPARSE_SPACING : 0;
+
+      idx Index_Size = (Primitive->Index_Type == GLTF_ACCESSOR_COMPONENT_U16) ? 2 : 4;
+      Primitive->Vertex_Offset = Binary_Size;
+      Binary_Size += Primitive->Vertex_Count*BENCH_VERTEX_STRIDE;
+      Primitive->Index_Offset = Binary_Size;
+      Binary_Size += Align_Offset(Primitive->Index_Count*Index_Size, 4);
+      Primitive->Sparse_Offset = Binary_Size;
+      Binary_Size += Primitive->Sparse_Count*(4 + 12);
+
+      Primitive->First_View = View_Count;
+      View_Count += (Primitive->Interleaved ? 1 : 3) + 1 + (Primitive->Sparse ? 2 : 0);
+      Primitive->First_Accessor = Accessor_Count;
+      Accessor_Count += 4;
+   }
+
+   u8 *Binary = Allocate(&Scratch, u8, Binary_Size);
+   for(int Primitive_Index = 0; Primitive_Index < Primitive_Count; ++Primitive_Index)
+   {
+      Write_Bench_Primitive(Binary, Primitives + Primitive_Index, Primitive_Index);
+   }
+
+   char Binary_Path[512];
+   string Stem = Name;
+   Has_Suffix_Then_Remove(&Stem, S(".gltf"));
+   snprintf(Binary_Path, sizeof(Binary_Path), "%.*s.bin", (int)Stem.Length, (char *)Stem.Data);
+
+   // NOTE: Write the JSON, one top level array at a time.
+   arena Json = {0};
+   Json.Size = Megabytes(1) + (idx)Primitive_Count*2048 + Options.Json_Padding*2;
+   Json.Base = Allocate(&Scratch, u8, Json.Size);
+
+   Append_Bench_Text(&Json, "{\"asset\":{\"version\":\"2.0\",\"generator\":\"vulkan-renderer bench\"},\"scene\":0,");
+   if(Separate)
+   {
+      Append_Bench_Text(&Json, "\"buffers\":[{\"byteLength\":%lld,\"uri\":\"%s\"}],", (long long)Binary_Size, Get_File_Name(Binary_Path));
+   }
+   else
+   {
+      Append_Bench_Text(&Json, "\"buffers\":[{\"byteLength\":%lld}],", (long long)Binary_Size);
+   }
+
+   Append_Bench_Text(&Json, "\"bufferViews\":[");
+   for(int Primitive_Index = 0; Primitive_Index < Primitive_Count; ++Primitive_Index)
+   {
+      bench_primitive *Primitive = Primitives + Primitive_Index;
+      char *Separator = Primitive_Index ? "," : "";
+      idx Vertex_Count = Primitive->Vertex_Count;
+      idx Index_Size = (Primitive->Index_Type == GLTF_ACCESSOR_COMPONENT_U16) ? 2 : 4;
+      if(Primitive->Interleaved)
+      {
+         Append_Bench_Text(&Json, "%s{\"buffer\":0,\"byteOffset\":%lld,\"byteLength\":%lld,\"byteStride\":%d,\"target\":34962}",
+                           Separator, (long long)Primitive->Vertex_Offset, (long long)(Vertex_Count*BENCH_VERTEX_STRIDE), BENCH_VERTEX_STRIDE);
+      }
+      else
+      {
+         idx Sizes[3] = {12, 12, 8};
+         idx Offset = Primitive->Vertex_Offset;
+         for(int Attribute = 0; Attribute < 3; ++Attribute)
+         {
+            Append_Bench_Text(&Json, "%s{\"buffer\":0,\"byteOffset\":%lld,\"byteLength\":%lld,\"target\":34962}",
+                              Attribute ? "," : Separator, (long long)Offset, (long long)(Vertex_Count*Sizes[Attribute]));
+            Offset += Vertex_Count*Sizes[Attribute];
+         }
+      }
+      Append_Bench_Text(&Json, ",{\"buffer\":0,\"byteOffset\":%lld,\"byteLength\":%lld,\"target\":34963}",
+                        (long long)Primitive->Index_Offset, (long long)(Primitive->Index_Count*Index_Size));
+      if(Primitive->Sparse)
+      {
+         Append_Bench_Text(&Json, ",{\"buffer\":0,\"byteOffset\":%lld,\"byteLength\":%lld}",
+                           (long long)Primitive->Sparse_Offset, (long long)(Primitive->Sparse_Count*4));
+         Append_Bench_Text(&Json, ",{\"buffer\":0,\"byteOffset\":%lld,\"byteLength\":%lld}",
+                           (long long)(Primitive->Sparse_Offset + Primitive->Sparse_Count*4), (long long)(Primitive->Sparse_Count*12));
+      }
+   }
+
+   Append_Bench_Text(&Json, "],\"accessors\":[");
+   for(int Primitive_Index = 0; Primitive_Index < Primitive_Count; ++Primitive_Index)
+   {
+      bench_primitive *Primitive = Primitives + Primitive_Index;
+      int View = Primitive->First_View;
+      int Vertex_Views[3] = {View, View, View};
+      int Vertex_Offsets[3] = {0, 12, 24};
+      if(!Primitive->Interleaved)
+      {
+         Vertex_Views[1] = View + 1;
+         Vertex_Views[2] = View + 2;
+         Vertex_Offsets[1] = Vertex_Offsets[2] = 0;
+      }
+      int Index_View = Vertex_Views[2] + 1;
+
+      Append_Bench_Text(&Json, "%s{\"bufferView\":%d,\"byteOffset\":%d,\"componentType\":5126,\"count\":%d,\"type\":\"VEC3\","
+                        "\"min\":[-0.5,-0.05,-0.5],\"max\":[0.5,0.15,0.5]",
+                        Primitive_Index ? "," : "", Vertex_Views[0], Vertex_Offsets[0], Primitive->Vertex_Count);
+      if(Primitive->Sparse)
+      {
+         Append_Bench_Text(&Json, ",\"sparse\":{\"count\":%d,\"indices\":{\"bufferView\":%d,\"componentType\":5125},\"values\":{\"bufferView\":%d}}",
+                           Primitive->Sparse_Count, Index_View + 1, Index_View + 2);
+      }
+      Append_Bench_Text(&Json, "}");
+
+      Append_Bench_Text(&Json, ",{\"bufferView\":%d,\"byteOffset\":%d,\"componentType\":5126,\"count\":%d,\"type\":\"VEC3\"}",
+                        Vertex_Views[1], Vertex_Offsets[1], Primitive->Vertex_Count);
+      Append_Bench_Text(&Json, ",{\"bufferView\":%d,\"byteOffset\":%d,\"componentType\":5126,\"count\":%d,\"type\":\"VEC2\"}",
+                        Vertex_Views[2], Vertex_Offsets[2], Primitive->Vertex_Count);
+      Append_Bench_Text(&Json, ",{\"bufferView\":%d,\"componentType\":%d,\"count\":%d,\"type\":\"SCALAR\"}",
+                        Index_View, Primitive->Index_Type, Primitive->Index_Count);
+   }
+
+   Append_Bench_Text(&Json, "],\"meshes\":[");
+   for(int Mesh_Index = 0; Mesh_Index < Options.Mesh_Count; ++Mesh_Index)
+   {
+      Append_Bench_Text(&Json, "%s{\"name\":\"Mesh %d\",\"primitives\":[", Mesh_Index ? "," : "", Mesh_Index);
+      for(int Index = 0; Index < Options.Primitive_Count; ++Index)
+      {
+         int Accessor = Primitives[Mesh_Index*Options.Primitive_Count + Index].First_Accessor;
+         Append_Bench_Text(&Json, "%s{\"attributes\":{\"POSITION\":%d,\"NORMAL\":%d,\"TEXCOORD_0\":%d},\"indices\":%d,\"mode\":4}",
+                           Index ? "," : "", Accessor, Accessor + 1, Accessor + 2, Accessor + 3);
+      }
+      Append_Bench_Text(&Json, "]}");
+   }
+
+   int Grid = Maximum(1, (int)ceil(sqrt((double)Options.Mesh_Count)));
+   idx Padding_Count = Options.Json_Padding / Options.Mesh_Count / 6;
+   Append_Bench_Text(&Json, "],\"nodes\":[");
+   for(int Mesh_Index = 0; Mesh_Index < Options.Mesh_Count; ++Mesh_Index)
+   {
+      Append_Bench_Text(&Json, "%s{\"name\":\"Node %d\",\"mesh\":%d,\"translation\":[%d,0,%d]",
+                        Mesh_Index ? "," : "", Mesh_Index, Mesh_Index, Mesh_Index % Grid, Mesh_Index / Grid);
+      if(Padding_Count)
+      {
+         Append_Bench_Text(&Json, ",\"extras\":{\"padding\":[");
+         for(idx Padding_Index = 0; Padding_Index < Padding_Count; ++Padding_Index)
+         {
+            Append_Bench_Text(&Json, "0.125,");
+         }
+         Append_Bench_Text(&Json, "0]}");
+      }
+      Append_Bench_Text(&Json, "}");
+   }
+
+   Append_Bench_Text(&Json, "],\"scenes\":[{\"nodes\":[");
+   for(int Mesh_Index = 0; Mesh_Index < Options.Mesh_Count; ++Mesh_Index)
+   {
+      Append_Bench_Text(&Json, "%s%d", Mesh_Index ? "," : "", Mesh_Index);
+   }
+   Append_Bench_Text(&Json, "]}]}");
+
+   bool Result = false;
+   if(Separate)
+   {
+      Result = (Write_Entire_File(Binary_Path, Binary, Binary_Size) &&
+                Write_Entire_File(Path, Json.Base, Json.Used));
+   }
+   else
+   {
+      // NOTE: Both chunks are padded to four bytes, the JSON with spaces.
+      idx Json_Length = Align_Offset(Json.Used, 4);
+      idx Binary_Length = Align_Offset(Binary_Size, 4);
+      idx File_Length = sizeof(glb_header) + 2*sizeof(glb_chunk_header) + Json_Length + Binary_Length;
+
+      u8 *File = Allocate(&Scratch, u8, File_Length);
+      u8 *At = File;
+
+      glb_header Header = {GLB_MAGIC_NUMBER, 2, (u32)File_Length};
+      Copy_Memory(At, &Header, sizeof(Header));
+      At += sizeof(Header);
+
+      glb_chunk_header Json_Header = {(u32)Json_Length, GLB_CHUNK_TYPE_JSON};
+      Copy_Memory(At, &Json_Header, sizeof(Json_Header));
+      At += sizeof(Json_Header);
+      Copy_Memory(At, Json.Base, Json.Used);
+      memset(At + Json.Used, ' ', Json_Length - Json.Used);
+      At += Json_Length;
+
+      glb_chunk_header Binary_Header = {(u32)Binary_Length, GLB_CHUNK_TYPE_BINARY};
+      Copy_Memory(At, &Binary_Header, sizeof(Binary_Header));
+      At += sizeof(Binary_Header);
+      Copy_Memory(At, Binary, Binary_Size);
+
+      Result = Write_Entire_File(Path, File, File_Length);
+   }
+
+   if(Result)
+   {
+      Log("Generated %s (%d meshes, %d primitives of %d vertices, %lld bytes of JSON, %lld bytes of binary).\n",
+          Path, Options.Mesh_Count, Primitive_Count, Primitives[0].Vertex_Count, (long long)Json.Used, (long long)Binary_Size);
+   }
+
+   return(Result);
+}
+
+// NOTE: Every stage of an import, in the order they run. The geometry stages
+// all report throughput over the size of the scene's accessor data, so their
+// MB/s can be compared with each other.
+typedef enum {
+   BENCH_STAGE_READ,
+   BENCH_STAGE_TOKENIZE,
+   BENCH_STAGE_PARSE,
+   BENCH_STAGE_EXTRACT,
+   BENCH_STAGE_WELD,
+   BENCH_STAGE_OPTIMIZE,
+   BENCH_STAGE_MESHLETS,
+   BENCH_STAGE_LODS,
+   BENCH_STAGE_QUANTIZE,
+   BENCH_STAGE_IMAGES,
+   BENCH_STAGE_PLAN,
+   BENCH_STAGE_LAY_OUT,
+   BENCH_STAGE_WRITE,
+   BENCH_STAGE_LOAD_BAKED,
+
+   BENCH_STAGE_COUNT,
+} bench_stage;
+
+typedef struct {
+   char *Name;
+   char *Unit;
+} bench_stage_info;
+
+static bench_stage_info Bench_Stage_Infos[BENCH_STAGE_COUNT] =
+{
+   [BENCH_STAGE_READ]       = {"read",       "files"},
+   [BENCH_STAGE_TOKENIZE]   = {"tokenize",   "tokens"},
+   [BENCH_STAGE_PARSE]      = {"parse",      "accessors"},
+   [BENCH_STAGE_EXTRACT]    = {"extract",    "elements"},
+   [BENCH_STAGE_WELD]       = {"weld",       "vertices"},
+   [BENCH_STAGE_OPTIMIZE]   = {"optimize",   "triangles"},
+   [BENCH_STAGE_MESHLETS]   = {"meshlets",   "triangles"},
+   [BENCH_STAGE_LODS]       = {"lods",       "triangles"},
+   [BENCH_STAGE_QUANTIZE]   = {"quantize",   "vertices"},
+   [BENCH_STAGE_IMAGES]     = {"images",     "images"},
+   [BENCH_STAGE_PLAN]       = {"plan",       "accessors"},
+   [BENCH_STAGE_LAY_OUT]    = {"lay out",    "accessors"},
+   [BENCH_STAGE_WRITE]      = {"write",      "files"},
+   [BENCH_STAGE_LOAD_BAKED] = {"load baked", "draws"},
+};
+
+#define MAX_BENCH_ITERATION_COUNT 1024
+
+typedef struct {
+   double Seconds[BENCH_STAGE_COUNT][MAX_BENCH_ITERATION_COUNT];
+   idx Bytes[BENCH_STAGE_COUNT];
+   idx Items[BENCH_STAGE_COUNT];
+} bench_samples;
+
+static string Get_Bench_Json(string File)
+{
+   // NOTE: The JSON chunk of a .glb, or all of a .gltf.
+   string Result = File;
+
+   glb_header *Header = (glb_header *)File.Data;
+   if(File.Length >= (idx)(sizeof(glb_header) + sizeof(glb_chunk_header)) && Header->Magic == GLB_MAGIC_NUMBER)
+   {
+      glb_chunk_header *Json_Header = (glb_chunk_header *)(Header + 1);
+      Result.Data = (u8 *)(Json_Header + 1);
+      Result.Length = Minimum((idx)Json_Header->Chunk_Length, File.Length - (idx)(sizeof(glb_header) + sizeof(glb_chunk_header)));
+   }
+
+   return(Result);
+}
+
+static bool Run_Bench_Import(bench_samples *Samples, int Iteration, char *Path, char *Baked_Path,
+                             platform_work_queue *Queue, bake_options Options, arena *Permanent, arena Scratch)
+{
+   // NOTE: Mirrors Bake_Scene, with each stage timed on its own, then loads the
+   // baked file the way the renderer does.
+   double *Seconds = 0;
+   double Start = 0;
+#define Begin_Bench_Stage(Stage) (Seconds = &Samples->Seconds[(Stage)][Iteration], Start = Get_Bench_Seconds())
+#define End_Bench_Stage() (*Seconds = Get_Bench_Seconds() - Start)
+
+   Begin_Bench_Stage(BENCH_STAGE_READ);
+   string File = Map_Entire_File(Path);
+   End_Bench_Stage();
+   if(!File.Data)
+   {
+      return(false);
+   }
+
+   string Json = Get_Bench_Json(File);
+   arena Tape_Scratch = Scratch;
+   Begin_Bench_Stage(BENCH_STAGE_TOKENIZE);
+   json_tape Tape = Tokenize_Json(&Tape_Scratch, Json);
+   End_Bench_Stage();
+
+   Samples->Bytes[BENCH_STAGE_READ] = File.Length;
+   Samples->Items[BENCH_STAGE_READ] = 1;
+   Samples->Bytes[BENCH_STAGE_TOKENIZE] = Json.Length;
+   Samples->Items[BENCH_STAGE_TOKENIZE] = Tape.Count;
+   Unmap_Entire_File(File.Data, File.Length);
+
+   gltf_scene Scene = {0};
+   Begin_Bench_Stage(BENCH_STAGE_PARSE);
+   Parse_GLTF(&Scene, Permanent, Scratch, Path);
+   End_Bench_Stage();
+
+   idx Parsed_Bytes = Scene.File.Length;
+   for(int Buffer_Index = 0; Buffer_Index < Scene.Buffer_Count; ++Buffer_Index)
+   {
+      Parsed_Bytes += Scene.Buffers[Buffer_Index].File.Length;
+   }
+   Samples->Bytes[BENCH_STAGE_PARSE] = Parsed_Bytes;
+   Samples->Items[BENCH_STAGE_PARSE] = Scene.Accessor_Count;
+
+   idx Element_Count = 0;
+   idx Geometry_Bytes = 0;
+   for(int Accessor_Index = 0; Accessor_Index < Scene.Accessor_Count; ++Accessor_Index)
+   {
+      gltf_accessor *Accessor = Scene.Accessors + Accessor_Index;
+      Element_Count += Accessor->Count;
+      Geometry_Bytes += Accessor->Count*Get_GLTF_Type_Size(Accessor->Type, Accessor->Component_Type);
+   }
+
+   idx Vertex_Count = 0;
+   idx Triangle_Count = 0;
+   for(int Primitive_Index = 0; Primitive_Index < Scene.Primitive_Count; ++Primitive_Index)
+   {
+      gltf_primitive *Primitive = Scene.Primitives + Primitive_Index;
+      if(Primitive->Position >= 0)
+      {
+         Vertex_Count += Scene.Accessors[Primitive->Position].Count;
+      }
+      if(Primitive->Indices >= 0)
+      {
+         Triangle_Count += Scene.Accessors[Primitive->Indices].Count / 3;
+      }
+   }
+
+   gltf_accessor *Baked_Accessors = Allocate(&Scratch, gltf_accessor, Scene.Accessor_Count);
+   u8 **Accessor_Data = Allocate(&Scratch, u8 *, Scene.Accessor_Count);
+
+   Begin_Bench_Stage(BENCH_STAGE_EXTRACT);
+   bool Extracted = Extract_Baked_Accessors(&Scene, Baked_Accessors, Accessor_Data, &Scratch, Path);
+   End_Bench_Stage();
+   if(!Extracted)
+   {
+      Unload_Scene(&Scene);
+      return(false);
+   }
+
+   Begin_Bench_Stage(BENCH_STAGE_WELD);
+   Weld_Baked_Primitives(&Scene, Baked_Accessors, Accessor_Data, &Scratch, Path);
+   End_Bench_Stage();
+
+   Begin_Bench_Stage(BENCH_STAGE_OPTIMIZE);
+   Optimize_Baked_Primitives(&Scene, Baked_Accessors, Accessor_Data, Scratch, Path);
+   End_Bench_Stage();
+
+   gltf_primitive *Baked_Primitives = Allocate(&Scratch, gltf_primitive, Scene.Primitive_Count);
+   Copy_Memory(Baked_Primitives, Scene.Primitives, Scene.Primitive_Count*sizeof(gltf_primitive));
+
+   Begin_Bench_Stage(BENCH_STAGE_MESHLETS);
+   baked_meshlets Meshlets = Build_Baked_Meshlets(&Scene, Baked_Primitives, Baked_Accessors, Accessor_Data, &Scratch, Path);
+   End_Bench_Stage();
+
+   Begin_Bench_Stage(BENCH_STAGE_LODS);
+   baked_lods Lods = Build_Baked_Lods(&Scene, Baked_Primitives, Baked_Accessors, Accessor_Data, Options.Lod_Count, Options.Lod_Ratio, &Scratch, Path);
+   End_Bench_Stage();
+
+   Begin_Bench_Stage(BENCH_STAGE_QUANTIZE);
+   Quantize_Baked_Accessors(&Scene, Baked_Accessors, Accessor_Data, Options.Position_Error, &Scratch, Path);
+   End_Bench_Stage();
+
+   Begin_Bench_Stage(BENCH_STAGE_IMAGES);
+   baked_images Images = Compress_Baked_Images(&Scene, Queue, Options.Fast_Textures, &Scratch, Path);
+   End_Bench_Stage();
+
+   gltf_buffer_view *Baked_Views = Allocate(&Scratch, gltf_buffer_view, Scene.Accessor_Count);
+   Begin_Bench_Stage(BENCH_STAGE_PLAN);
+   int Baked_View_Count = Plan_Baked_Buffer_Views(&Scene, Baked_Accessors, Baked_Views, Options.Interleave, Scratch);
+   End_Bench_Stage();
+
+   baked_scene_tables Tables = {0};
+   Tables.Primitives = Baked_Primitives;
+   Tables.Accessors = Baked_Accessors;
+   Tables.Buffer_View_Count = Baked_View_Count;
+   Tables.Buffer_Views = Baked_Views;
+   Tables.Meshlet_Count = Meshlets.Count;
+   Tables.Meshlets = Meshlets.Meshlets;
+   Tables.Meshlet_Vertex_Count = Meshlets.Vertex_Count;
+   Tables.Meshlet_Vertices = Meshlets.Vertices;
+   Tables.Meshlet_Triangle_Count = Meshlets.Triangle_Count;
+   Tables.Meshlet_Triangles = Meshlets.Triangles;
+   Tables.Lod_Count = Lods.Count;
+   Tables.Lods = Lods.Lods;
+   Tables.Images = Images.Images;
+   Tables.Image_Data_Size = Images.Data_Size;
+   Tables.Image_Data = Images.Data;
+
+   arena Output = {0};
+   Begin_Bench_Stage(BENCH_STAGE_LAY_OUT);
+   string Baked = Lay_Out_Baked_Scene(&Scene, &Tables, &Output);
+   u8 *Binary = Baked.Data + ((baked_scene_header *)Baked.Data)->Binary_Offset;
+   for(int Accessor_Index = 0; Accessor_Index < Scene.Accessor_Count; ++Accessor_Index)
+   {
+      gltf_accessor *Accessor = Baked_Accessors + Accessor_Index;
+      gltf_buffer_view *View = Baked_Views + Accessor->Buffer_View;
+
+      idx Element_Size = Get_GLTF_Type_Size(Accessor->Type, Accessor->Component_Type);
+      u8 *From = Accessor_Data[Accessor_Index];
+      u8 *To = Binary + View->Offset + Accessor->Offset;
+      if(View->Stride)
+      {
+         for(int Element_Index = 0; Element_Index < Accessor->Count; ++Element_Index)
+         {
+            Copy_Memory(To + Element_Index*View->Stride, From + Element_Index*Element_Size, Element_Size);
+         }
+      }
+      else
+      {
+         Copy_Memory(To, From, Accessor->Count*Element_Size);
+      }
+   }
+   End_Bench_Stage();
+
+   Begin_Bench_Stage(BENCH_STAGE_WRITE);
+   bool Written = Write_Entire_File(Baked_Path, Baked.Data, Baked.Length);
+   End_Bench_Stage();
+
+   idx Baked_Length = Baked.Length;
+   Free_Arena(&Output);
+
+   Samples->Bytes[BENCH_STAGE_EXTRACT] = Geometry_Bytes;
+   Samples->Items[BENCH_STAGE_EXTRACT] = Element_Count;
+   Samples->Bytes[BENCH_STAGE_WELD] = Geometry_Bytes;
+   Samples->Items[BENCH_STAGE_WELD] = Vertex_Count;
+   Samples->Bytes[BENCH_STAGE_OPTIMIZE] = Geometry_Bytes;
+   Samples->Items[BENCH_STAGE_OPTIMIZE] = Triangle_Count;
+   Samples->Bytes[BENCH_STAGE_MESHLETS] = Geometry_Bytes;
+   Samples->Items[BENCH_STAGE_MESHLETS] = Triangle_Count;
+   Samples->Bytes[BENCH_STAGE_LODS] = Geometry_Bytes;
+   Samples->Items[BENCH_STAGE_LODS] = Triangle_Count;
+   Samples->Bytes[BENCH_STAGE_QUANTIZE] = Geometry_Bytes;
+   Samples->Items[BENCH_STAGE_QUANTIZE] = Vertex_Count;
+   Samples->Bytes[BENCH_STAGE_IMAGES] = Images.Data_Size;
+   Samples->Items[BENCH_STAGE_IMAGES] = Scene.Image_Count;
+   Samples->Items[BENCH_STAGE_PLAN] = Scene.Accessor_Count;
+   Samples->Bytes[BENCH_STAGE_LAY_OUT] = Baked_Length;
+   Samples->Items[BENCH_STAGE_LAY_OUT] = Scene.Accessor_Count;
+   Samples->Bytes[BENCH_STAGE_WRITE] = Baked_Length;
+   Samples->Items[BENCH_STAGE_WRITE] = 1;
+   Unload_Scene(&Scene);
+
+   if(!Written)
+   {
+      return(false);
+   }
+
+   gltf_scene Loaded = {0};
+   Begin_Bench_Stage(BENCH_STAGE_LOAD_BAKED);
+   bool Loaded_Baked = Load_Baked_Scene(&Loaded, Permanent, Baked_Path, 0);
+   End_Bench_Stage();
+
+   Samples->Bytes[BENCH_STAGE_LOAD_BAKED] = Baked_Length;
+   Samples->Items[BENCH_STAGE_LOAD_BAKED] = Loaded.Draw_Count;
+   Unload_Scene(&Loaded);
+
+#undef Begin_Bench_Stage
+#undef End_Bench_Stage
+
+   return(Loaded_Baked);
+}
+
+static int Compare_Bench_Seconds(const void *A, const void *B)
+{
+   double First = *(double *)A;
+   double Second = *(double *)B;
+
+   int Result = (First > Second) - (First < Second);
+   return(Result);
+}
+
+static double Get_Bench_Percentile(double *Sorted, int Count, int Percentile)
+{
+   // NOTE: Nearest rank, so every reported time is one that was measured.
+   int Rank = (Percentile*Count + 99) / 100;
+   double Result = Sorted[Clamp(Rank, 1, Count) - 1];
+   return(Result);
+}
+
+static void Report_Bench_Samples(bench_samples *Samples, int Iteration_Count, char *Path)
+{
+   // NOTE: Throughput is measured at the median.
+   Log("\n%s, %d iterations:\n", Path, Iteration_Count);
+   Log("%-10s %12s %-9s %9s %9s %9s %9s %10s %12s\n",
+       "stage", "items", "", "p50 ms", "p90 ms", "p99 ms", "max ms", "MB/s", "items/s");
+
+   double *Totals = calloc(Iteration_Count, sizeof(double));
+   for(int Stage = 0; Stage < BENCH_STAGE_COUNT; ++Stage)
+   {
+      double *Sorted = Samples->Seconds[Stage];
+      for(int Iteration = 0; Iteration < Iteration_Count; ++Iteration)
+      {
+         Totals[Iteration] += Sorted[Iteration];
+      }
+      qsort(Sorted, Iteration_Count, sizeof(double), Compare_Bench_Seconds);
+
+      double Median = Get_Bench_Percentile(Sorted, Iteration_Count, 50);
+      char Megabytes_Per_Second[32] = "-";
+      if(Samples->Bytes[Stage] && Median > 0)
+      {
+         snprintf(Megabytes_Per_Second, sizeof(Megabytes_Per_Second), "%.1f", Samples->Bytes[Stage] / Median / (1024.0*1024.0));
+      }
+
+      Log("%-10s %12lld %-9s %9.3f %9.3f %9.3f %9.3f %10s %12.0f\n",
+          Bench_Stage_Infos[Stage].Name, (long long)Samples->Items[Stage], Bench_Stage_Infos[Stage].Unit,
+          1000.0*Median,
+          1000.0*Get_Bench_Percentile(Sorted, Iteration_Count, 90),
+          1000.0*Get_Bench_Percentile(Sorted, Iteration_Count, 99),
+          1000.0*Sorted[Iteration_Count - 1],
+          Megabytes_Per_Second,
+          (Median > 0) ? Samples->Items[Stage] / Median : 0.0);
+   }
+
+   qsort(Totals, Iteration_Count, sizeof(double), Compare_Bench_Seconds);
+   double Median = Get_Bench_Percentile(Totals, Iteration_Count, 50);
+   Log("%-10s %12lld %-9s %9.3f %9.3f %9.3f %9.3f %10.1f %12s\n",
+       "total", (long long)Samples->Bytes[BENCH_STAGE_PARSE], "bytes",
+       1000.0*Median,
+       1000.0*Get_Bench_Percentile(Totals, Iteration_Count, 90),
+       1000.0*Get_Bench_Percentile(Totals, Iteration_Count, 99),
+       1000.0*Totals[Iteration_Count - 1],
+       (Median > 0) ? Samples->Bytes[BENCH_STAGE_PARSE] / Median / (1024.0*1024.0) : 0.0, "-");
+
+   free(Totals);
+}
+
+int main(int Argument_Count, char **Arguments)
+{
+   // NOTE: With -generate, writes one synthetic scene. Otherwise the arguments
+   // are glTF files to time the import of, after any options. Each file is
+   // imported once to warm up before the timed iterations, and is baked next
+   // to itself with a .scene extension appended.
+   char *Program = Arguments[0];
+   char *Generate_Path = 0;
+
+   bench_scene_options Scene_Options = {0};
+   Scene_Options.Mesh_Count = 16;
+   Scene_Options.Primitive_Count = 1;
+   Scene_Options.Vertex_Count = 4096;
+
+   bake_options Options = {0};
+   Options.Lod_Count = 4;
+   Options.Lod_Ratio = 0.5f;
+   Options.Position_Error = DEFAULT_BAKED_POSITION_ERROR;
+
+   int Iteration_Count = 16;
+   int Thread_Count = Clamp(Get_Processor_Count(), 1, MAX_WORK_QUEUE_THREAD_COUNT);
+
+   bool Valid = true;
+   while(Valid && Argument_Count > 2 && Arguments[1][0] == '-')
+   {
+      char *Option = Arguments[1];
+      char *Value = Arguments[2];
+      int Consumed = 2;
+
+      if(C_Strings_Are_Equal(Option, "-generate"))
+      {
+         Generate_Path = Value;
+      }
+      else if(C_Strings_Are_Equal(Option, "-meshes"))
+      {
+         Scene_Options.Mesh_Count = atoi(Value);
+         Valid = (Scene_Options.Mesh_Count >= 1);
+      }
+      else if(C_Strings_Are_Equal(Option, "-primitives"))
+      {
+         Scene_Options.Primitive_Count = atoi(Value);
+         Valid = (Scene_Options.Primitive_Count >= 1);
+      }
+      else if(C_Strings_Are_Equal(Option, "-vertices"))
+      {
+         Scene_Options.Vertex_Count = atoi(Value);
+         Valid = (Scene_Options.Vertex_Count >= 4 && Scene_Options.Vertex_Count <= 16*1024*1024);
+      }
+      else if(C_Strings_Are_Equal(Option, "-json-padding"))
+      {
+         Scene_Options.Json_Padding = atoll(Value);
+         Valid = (Scene_Options.Json_Padding >= 0);
+      }
+      else if(C_Strings_Are_Equal(Option, "-interleaved"))
+      {
+         Scene_Options.Interleaved = (float)atof(Value);
+         Valid = (Scene_Options.Interleaved >= 0.0f && Scene_Options.Interleaved <= 1.0f);
+      }
+      else if(C_Strings_Are_Equal(Option, "-sparse"))
+      {
+         Scene_Options.Sparse = (float)atof(Value);
+         Valid = (Scene_Options.Sparse >= 0.0f && Scene_Options.Sparse <= 1.0f);
+      }
+      else if(C_Strings_Are_Equal(Option, "-iterations"))
+      {
+         Iteration_Count = atoi(Value);
+         Valid = (Iteration_Count >= 1 && Iteration_Count <= MAX_BENCH_ITERATION_COUNT);
+      }
+      else if(C_Strings_Are_Equal(Option, "-threads"))
+      {
+         Thread_Count = atoi(Value);
+         Valid = (Thread_Count >= 1 && Thread_Count <= MAX_WORK_QUEUE_THREAD_COUNT);
+      }
+      else if(C_Strings_Are_Equal(Option, "-lods"))
+      {
+         Options.Lod_Count = atoi(Value);
+         Valid = (Options.Lod_Count >= 1 && Options.Lod_Count <= MAX_LOD_COUNT);
+      }
+      else if(C_Strings_Are_Equal(Option, "-interleave"))
+      {
+         Options.Interleave = true;
+         Consumed = 1;
+      }
+      else if(C_Strings_Are_Equal(Option, "-fast-textures"))
+      {
+         Options.Fast_Textures = true;
+         Consumed = 1;
+      }
+      else
+      {
+         Valid = false;
+      }
+
+      Arguments += Consumed;
+      Argument_Count -= Consumed;
+   }
+
+   if(!Valid || (!Generate_Path && Argument_Count < 2) || (Generate_Path && Argument_Count != 1))
+   {
+      Log("Usage: %s -generate output.gl[b|tf] [-meshes count] [-primitives count] [-vertices count] "
+          "[-json-padding bytes] [-interleaved 0-1] [-sparse 0-1]\n"
+          "       %s [-iterations 1-%d] [-interleave] [-lods 1-%d] [-fast-textures] [-threads 1-%d] "
+          "input.gl[b|tf] [input.gl[b|tf] ...]\n",
+          Program, Program, MAX_BENCH_ITERATION_COUNT, MAX_LOD_COUNT, MAX_WORK_QUEUE_THREAD_COUNT);
+      return(1);
+   }
+
+   arena Permanent = {0};
+   arena Scratch = {0};
+   Make_Arena(&Permanent, Megabytes(512));
+   Make_Arena(&Scratch, Gigabytes(1));
+
+   if(Generate_Path)
+   {
+      return(Generate_Bench_Scene(Generate_Path, Scene_Options, Scratch) ? 0 : 1);
+   }
+
+   static platform_work_queue Queue;
+   Queue.Thread_Count = Thread_Count;
+
+   bench_samples *Samples = malloc(sizeof(bench_samples));
+   Assert(Samples);
+
+   int Failures = 0;
+   for(int Argument_Index = 1; Argument_Index < Argument_Count; ++Argument_Index)
+   {
+      char *Path = Arguments[Argument_Index];
+      char Baked_Path[512];
+      snprintf(Baked_Path, sizeof(Baked_Path), "%s.scene", Path);
+
+      Zero_Struct(Samples);
+
+      bool Imported = true;
+      for(int Iteration = -1; Imported && Iteration < Iteration_Count; ++Iteration)
+      {
+         Reset_Arena(&Permanent);
+         Reset_Arena(&Scratch);
+
+         // NOTE: The warm up iteration's times are overwritten by the first
+         // timed one.
+         Log_Muted = true;
+         Imported = Run_Bench_Import(Samples, Maximum(Iteration, 0), Path, Baked_Path, &Queue, Options, &Permanent, Scratch);
+         Log_Muted = false;
+      }
+
+      if(Imported)
+      {
+         Report_Bench_Samples(Samples, Iteration_Count, Path);
+      }
+      else
+      {
+         Log("Failed to import %s.\n", Path);
+         Failures++;
+      }
+   }
+
+   free(Samples);
+
+   return(Failures ? 1 : 0);
+}
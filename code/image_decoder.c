@@ -0,0 +1,758 @@
+/* (c) copyright 2025 Lawrence D. Kern /////////////////////////////////////// */
+
+// NOTE: Decoders for the image formats glTF files embed. Images are always
+// decoded to 8-bit RGBA. Only PNG is supported so far: JPEG images are
+// reported as undecodable and left for the caller to skip. Decoded images get
+// their mip chains built here too, by Build_Image_Mips at the bottom.
+
+#define PNG_FAST_BITS 9
+
+typedef struct {
+   // NOTE: Codes of up to PNG_FAST_BITS bits are looked up directly by their
+   // next bits, stored as (Length << 9) | Symbol. Zero means the code is
+   // longer, and is found by comparing against Max_Code for each length.
+   u16 Fast[1 << PNG_FAST_BITS];
+   u16 First_Code[16];
+   u32 Max_Code[17];
+   u16 First_Symbol[16];
+   u8 Lengths[288];
+   u16 Symbols[288];
+} inflate_huffman;
+
+typedef struct {
+   u8 *At;
+   u8 *End;
+   u64 Bits;
+   int Bit_Count;
+   int Padding_Bits;
+
+   u8 *Output;
+   idx Output_Length;
+   idx Output_Size;
+} inflate_state;
+
+static inline int Reverse_Bits(int Value, int Bit_Count)
+{
+   int Result = 0;
+   for(int Bit = 0; Bit < Bit_Count; ++Bit)
+   {
+      Result = (Result << 1) | ((Value >> Bit) & 1);
+   }
+   return(Result);
+}
+
+static inline void Refill_Inflate_Bits(inflate_state *State)
+{
+   // NOTE: Reading past the end feeds in zeros, which is only an error if any
+   // of them actually get used.
+   while(State->Bit_Count <= 56)
+   {
+      u64 Byte = 0;
+      if(State->At < State->End)
+      {
+         Byte = *State->At++;
+      }
+      else
+      {
+         State->Padding_Bits += 8;
+      }
+      State->Bits |= Byte << State->Bit_Count;
+      State->Bit_Count += 8;
+   }
+}
+
+static inline bool Inflate_Overran(inflate_state *State)
+{
+   bool Result = (State->Bit_Count < State->Padding_Bits);
+   return(Result);
+}
+
+static inline u32 Get_Inflate_Bits(inflate_state *State, int Count)
+{
+   if(State->Bit_Count < Count)
+   {
+      Refill_Inflate_Bits(State);
+   }
+
+   u32 Result = (u32)(State->Bits & ((1ull << Count) - 1));
+   State->Bits >>= Count;
+   State->Bit_Count -= Count;
+
+   return(Result);
+}
+
+static bool Build_Inflate_Huffman(inflate_huffman *Huffman, u8 *Lengths, int Symbol_Count)
+{
+   Zero_Struct(Huffman);
+
+   int Counts[16] = {0};
+   for(int Symbol = 0; Symbol < Symbol_Count; ++Symbol)
+   {
+      Counts[Lengths[Symbol]]++;
+   }
+   Counts[0] = 0;
+
+   int Next_Code[16];
+   int Code = 0;
+   int Position = 0;
+   for(int Length = 1; Length < 16; ++Length)
+   {
+      Next_Code[Length] = Code;
+      Huffman->First_Code[Length] = (u16)Code;
+      Huffman->First_Symbol[Length] = (u16)Position;
+
+      Code += Counts[Length];
+      if(Counts[Length] && Code > (1 << Length))
+      {
+         return(false);
+      }
+      Huffman->Max_Code[Length] = (u32)Code << (16 - Length);
+
+      Code <<= 1;
+      Position += Counts[Length];
+   }
+   Huffman->Max_Code[16] = 0x10000;
+
+   for(int Symbol = 0; Symbol < Symbol_Count; ++Symbol)
+   {
+      int Length = Lengths[Symbol];
+      if(Length)
+      {
+         int Index = Huffman->First_Symbol[Length] + (Next_Code[Length] - Huffman->First_Code[Length]);
+         Huffman->Lengths[Index] = (u8)Length;
+         Huffman->Symbols[Index] = (u16)Symbol;
+
+         if(Length <= PNG_FAST_BITS)
+         {
+            u16 Entry = (u16)((Length << 9) | Symbol);
+            for(int Fill = Reverse_Bits(Next_Code[Length], Length); Fill < (1 << PNG_FAST_BITS); Fill += (1 << Length))
+            {
+               Huffman->Fast[Fill] = Entry;
+            }
+         }
+         Next_Code[Length]++;
+      }
+   }
+
+   return(true);
+}
+
+static int Decode_Inflate_Symbol(inflate_state *State, inflate_huffman *Huffman)
+{
+   if(State->Bit_Count < 16)
+   {
+      Refill_Inflate_Bits(State);
+   }
+
+   int Result = -1;
+   u16 Entry = Huffman->Fast[State->Bits & ((1 << PNG_FAST_BITS) - 1)];
+   if(Entry)
+   {
+      int Length = Entry >> 9;
+      State->Bits >>= Length;
+      State->Bit_Count -= Length;
+      Result = Entry & 511;
+   }
+   else
+   {
+      // NOTE: Codes are packed starting from their most significant bit, so
+      // compare them most significant bit first.
+      u32 Code = (u32)Reverse_Bits((int)(State->Bits & 0xFFFF), 16);
+      int Length = PNG_FAST_BITS + 1;
+      while(Length < 16 && Code >= Huffman->Max_Code[Length])
+      {
+         Length++;
+      }
+
+      if(Length < 16)
+      {
+         int Index = (int)(Code >> (16 - Length)) - Huffman->First_Code[Length] + Huffman->First_Symbol[Length];
+         if(Index < 288 && Huffman->Lengths[Index] == Length)
+         {
+            State->Bits >>= Length;
+            State->Bit_Count -= Length;
+            Result = Huffman->Symbols[Index];
+         }
+      }
+   }
+
+   return(Result);
+}
+
+static bool Inflate_Huffman_Block(inflate_state *State, inflate_huffman *Literals, inflate_huffman *Distances)
+{
+   static u16 Length_Bases[] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+   static u8 Length_Extra[] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+   static u16 Distance_Bases[] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+   static u8 Distance_Extra[] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+   while(true)
+   {
+      int Symbol = Decode_Inflate_Symbol(State, Literals);
+      if(Symbol < 0 || Inflate_Overran(State))
+      {
+         return(false);
+      }
+      else if(Symbol < 256)
+      {
+         if(State->Output_Length >= State->Output_Size)
+         {
+            return(false);
+         }
+         State->Output[State->Output_Length++] = (u8)Symbol;
+      }
+      else if(Symbol == 256)
+      {
+         return(true);
+      }
+      else
+      {
+         Symbol -= 257;
+         if(Symbol >= Array_Count(Length_Bases))
+         {
+            return(false);
+         }
+         idx Length = Length_Bases[Symbol] + Get_Inflate_Bits(State, Length_Extra[Symbol]);
+
+         int Distance_Symbol = Decode_Inflate_Symbol(State, Distances);
+         if(Distance_Symbol < 0 || Distance_Symbol >= Array_Count(Distance_Bases))
+         {
+            return(false);
+         }
+         idx Distance = Distance_Bases[Distance_Symbol] + Get_Inflate_Bits(State, Distance_Extra[Distance_Symbol]);
+
+         if(Distance > State->Output_Length || Length > State->Output_Size - State->Output_Length)
+         {
+            return(false);
+         }
+
+         // NOTE: Copies may overlap their own output, so go byte by byte.
+         u8 *To = State->Output + State->Output_Length;
+         u8 *From = To - Distance;
+         for(idx Index = 0; Index < Length; ++Index)
+         {
+            To[Index] = From[Index];
+         }
+         State->Output_Length += Length;
+      }
+   }
+}
+
+static bool Inflate_Zlib(u8 *Output, idx Output_Size, u8 *Data, idx Length)
+{
+   // NOTE: Decompresses a zlib stream into exactly Output_Size bytes. The
+   // checksum isn't verified.
+   if(Length < 2 || (Data[0] & 15) != 8 || ((Data[0] << 8) | Data[1]) % 31 || (Data[1] & 32))
+   {
+      return(false);
+   }
+
+   inflate_state State = {0};
+   State.At = Data + 2;
+   State.End = Data + Length;
+   State.Output = Output;
+   State.Output_Size = Output_Size;
+
+   inflate_huffman Literals;
+   inflate_huffman Distances;
+
+   bool Result = true;
+   bool Final = false;
+   while(Result && !Final)
+   {
+      Final = Get_Inflate_Bits(&State, 1);
+      int Type = Get_Inflate_Bits(&State, 2);
+      if(Type == 0)
+      {
+         Get_Inflate_Bits(&State, State.Bit_Count & 7);
+         u32 Stored_Length = Get_Inflate_Bits(&State, 16);
+         u32 Inverse_Length = Get_Inflate_Bits(&State, 16);
+         Result = ((Stored_Length ^ 0xFFFF) == Inverse_Length && Stored_Length <= State.Output_Size - State.Output_Length);
+         for(u32 Index = 0; Result && Index < Stored_Length; ++Index)
+         {
+            State.Output[State.Output_Length++] = (u8)Get_Inflate_Bits(&State, 8);
+         }
+      }
+      else if(Type == 1 || Type == 2)
+      {
+         u8 Lengths[288 + 32];
+         int Literal_Count = 288;
+         int Distance_Count = 32;
+
+         if(Type == 1)
+         {
+            for(int Symbol = 0; Symbol < 288; ++Symbol)
+            {
+               Lengths[Symbol] = (Symbol < 144) ? 8 : (Symbol < 256) ? 9 : (Symbol < 280) ? 7 : 8;
+            }
+            for(int Symbol = 0; Symbol < 32; ++Symbol)
+            {
+               Lengths[288 + Symbol] = 5;
+            }
+         }
+         else
+         {
+            static u8 Order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+            Literal_Count = Get_Inflate_Bits(&State, 5) + 257;
+            Distance_Count = Get_Inflate_Bits(&State, 5) + 1;
+            int Code_Length_Count = Get_Inflate_Bits(&State, 4) + 4;
+
+            u8 Code_Lengths[19] = {0};
+            for(int Index = 0; Index < Code_Length_Count; ++Index)
+            {
+               Code_Lengths[Order[Index]] = (u8)Get_Inflate_Bits(&State, 3);
+            }
+
+            inflate_huffman Code_Length_Huffman;
+            Result = Build_Inflate_Huffman(&Code_Length_Huffman, Code_Lengths, 19);
+
+            int Count = 0;
+            int Total = Literal_Count + Distance_Count;
+            while(Result && Count < Total)
+            {
+               int Symbol = Decode_Inflate_Symbol(&State, &Code_Length_Huffman);
+               int Repeat = 0;
+               u8 Value = 0;
+               if(Symbol < 0)
+               {
+                  Result = false;
+               }
+               else if(Symbol < 16)
+               {
+                  Lengths[Count++] = (u8)Symbol;
+               }
+               else if(Symbol == 16)
+               {
+                  Result = (Count > 0);
+                  Value = Result ? Lengths[Count - 1] : 0;
+                  Repeat = 3 + Get_Inflate_Bits(&State, 2);
+               }
+               else if(Symbol == 17)
+               {
+                  Repeat = 3 + Get_Inflate_Bits(&State, 3);
+               }
+               else
+               {
+                  Repeat = 11 + Get_Inflate_Bits(&State, 7);
+               }
+
+               Result = Result && (Count + Repeat <= Total);
+               while(Result && Repeat--)
+               {
+                  Lengths[Count++] = Value;
+               }
+            }
+
+            // NOTE: Distance lengths follow the literal lengths directly, so
+            // move them to where the fixed tables keep them.
+            if(Result)
+            {
+               for(int Index = Distance_Count - 1; Index >= 0; --Index)
+               {
+                  Lengths[288 + Index] = Lengths[Literal_Count + Index];
+               }
+               for(int Index = Literal_Count; Index < 288; ++Index)
+               {
+                  Lengths[Index] = 0;
+               }
+            }
+         }
+
+         Result = (Result &&
+                   Build_Inflate_Huffman(&Literals, Lengths, Literal_Count) &&
+                   Build_Inflate_Huffman(&Distances, Lengths + 288, Distance_Count) &&
+                   Inflate_Huffman_Block(&State, &Literals, &Distances));
+      }
+      else
+      {
+         Result = false;
+      }
+
+      Result = Result && !Inflate_Overran(&State);
+   }
+
+   Result = Result && (State.Output_Length == Output_Size);
+   return(Result);
+}
+
+static inline u32 Read_PNG_U32(u8 *At)
+{
+   u32 Result = ((u32)At[0] << 24) | ((u32)At[1] << 16) | ((u32)At[2] << 8) | (u32)At[3];
+   return(Result);
+}
+
+typedef struct {
+   int Width;
+   int Height;
+   int Bit_Depth;
+   int Color_Type;
+   bool Interlaced;
+} png_header;
+
+static bool Read_PNG_Header(string File, png_header *Header)
+{
+   static u8 Signature[8] = {0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A};
+
+   bool Result = (File.Length >= 33 && !memcmp(File.Data, Signature, 8) && !memcmp(File.Data + 12, "IHDR", 4));
+   if(Result)
+   {
+      u8 *IHDR = File.Data + 16;
+      Header->Width = (int)Read_PNG_U32(IHDR);
+      Header->Height = (int)Read_PNG_U32(IHDR + 4);
+      Header->Bit_Depth = IHDR[8];
+      Header->Color_Type = IHDR[9];
+      Header->Interlaced = (IHDR[12] != 0);
+
+      int Depth = Header->Bit_Depth;
+      switch(Header->Color_Type)
+      {
+         case 0:  { Result = (Depth == 1 || Depth == 2 || Depth == 4 || Depth == 8 || Depth == 16); } break;
+         case 3:  { Result = (Depth == 1 || Depth == 2 || Depth == 4 || Depth == 8); } break;
+         case 2:
+         case 4:
+         case 6:  { Result = (Depth == 8 || Depth == 16); } break;
+         default: { Result = false; } break;
+      }
+
+      // NOTE: Keep the decoded size comfortably inside of 32 bits.
+      Result = Result && (Header->Width > 0 && Header->Height > 0 && Header->Width <= 16384 && Header->Height <= 16384);
+   }
+
+   return(Result);
+}
+
+static bool Get_Image_Size(string File, int *Width, int *Height)
+{
+   png_header Header;
+   bool Result = Read_PNG_Header(File, &Header);
+   if(Result)
+   {
+      *Width = Header.Width;
+      *Height = Header.Height;
+   }
+   return(Result);
+}
+
+static inline u8 Paeth_Predictor(int A, int B, int C)
+{
+   int P = A + B - C;
+   int PA = abs(P - A);
+   int PB = abs(P - B);
+   int PC = abs(P - C);
+
+   int Result = (PA <= PB && PA <= PC) ? A : (PB <= PC) ? B : C;
+   return((u8)Result);
+}
+
+static bool Decode_PNG(string File, u8 *Pixels, arena Scratch)
+{
+   // NOTE: Pixels must have room for Width*Height RGBA texels. Returns false
+   // if the file is malformed or doesn't fit in Scratch.
+   png_header Header;
+   if(!Read_PNG_Header(File, &Header) || Header.Interlaced)
+   {
+      return(false);
+   }
+
+   int Channel_Counts[7] = {1, 0, 3, 1, 2, 0, 4};
+   int Channels = Channel_Counts[Header.Color_Type];
+   int Bits_Per_Pixel = Channels * Header.Bit_Depth;
+   idx Filter_Stride = Maximum(Bits_Per_Pixel / 8, 1);
+   idx Row_Size = ((idx)Header.Width*Bits_Per_Pixel + 7) / 8;
+
+   // NOTE: Gather the IDAT chunks into one zlib stream, and pick up the palette
+   // and transparency along the way.
+   u8 Palette[256][4];
+   for(int Index = 0; Index < 256; ++Index)
+   {
+      Palette[Index][0] = Palette[Index][1] = Palette[Index][2] = 0;
+      Palette[Index][3] = 255;
+   }
+   bool Has_Key = false;
+   u16 Key[3] = {0};
+
+   u8 *Compressed = Try_Allocate(&Scratch, u8, File.Length);
+   idx Compressed_Length = 0;
+   if(!Compressed)
+   {
+      return(false);
+   }
+
+   u8 *At = File.Data + 8;
+   u8 *End = File.Data + File.Length;
+   while(At + 12 <= End)
+   {
+      u32 Length = Read_PNG_U32(At);
+      u8 *Type = At + 4;
+      u8 *Data = At + 8;
+      if(Length > (u64)(End - Data - 4))
+      {
+         return(false);
+      }
+
+      if(!memcmp(Type, "IDAT", 4))
+      {
+         Copy_Memory(Compressed + Compressed_Length, Data, Length);
+         Compressed_Length += Length;
+      }
+      else if(!memcmp(Type, "PLTE", 4))
+      {
+         for(u32 Index = 0; Index < Length/3 && Index < 256; ++Index)
+         {
+            Palette[Index][0] = Data[3*Index + 0];
+            Palette[Index][1] = Data[3*Index + 1];
+            Palette[Index][2] = Data[3*Index + 2];
+         }
+      }
+      else if(!memcmp(Type, "tRNS", 4))
+      {
+         if(Header.Color_Type == 3)
+         {
+            for(u32 Index = 0; Index < Length && Index < 256; ++Index)
+            {
+               Palette[Index][3] = Data[Index];
+            }
+         }
+         else if(Length >= 2)
+         {
+            Has_Key = true;
+            for(u32 Index = 0; Index < 3 && 2*Index + 1 < Length; ++Index)
+            {
+               Key[Index] = (u16)((Data[2*Index] << 8) | Data[2*Index + 1]);
+            }
+         }
+      }
+      else if(!memcmp(Type, "IEND", 4))
+      {
+         break;
+      }
+
+      At = Data + Length + 4;
+   }
+
+   idx Filtered_Size = (Row_Size + 1) * Header.Height;
+   u8 *Filtered = Try_Allocate(&Scratch, u8, Filtered_Size);
+   if(!Filtered || !Inflate_Zlib(Filtered, Filtered_Size, Compressed, Compressed_Length))
+   {
+      return(false);
+   }
+
+   // NOTE: Undo the filters in place. Each row starts with its filter type,
+   // and is predicted from the unfiltered row above it.
+   u8 *Zero_Row = Try_Allocate(&Scratch, u8, Row_Size);
+   if(!Zero_Row)
+   {
+      return(false);
+   }
+   u8 *Previous = Zero_Row;
+   for(int Y = 0; Y < Header.Height; ++Y)
+   {
+      u8 *Row = Filtered + Y*(Row_Size + 1);
+      int Filter = Row[0];
+      u8 *Current = Row + 1;
+
+      for(idx X = 0; X < Row_Size; ++X)
+      {
+         int A = (X >= Filter_Stride) ? Current[X - Filter_Stride] : 0;
+         int B = Previous[X];
+         int C = (X >= Filter_Stride) ? Previous[X - Filter_Stride] : 0;
+         switch(Filter)
+         {
+            case 0: break;
+            case 1: { Current[X] += (u8)A; } break;
+            case 2: { Current[X] += (u8)B; } break;
+            case 3: { Current[X] += (u8)((A + B) / 2); } break;
+            case 4: { Current[X] += Paeth_Predictor(A, B, C); } break;
+            default: return(false);
+         }
+      }
+      Previous = Current;
+   }
+
+   // NOTE: Expand every pixel to RGBA8. 16-bit samples keep their high byte,
+   // and gray samples under 8 bits are scaled up to the full range.
+   int Depth = Header.Bit_Depth;
+   for(int Y = 0; Y < Header.Height; ++Y)
+   {
+      u8 *Row = Filtered + Y*(Row_Size + 1) + 1;
+      u8 *To = Pixels + (idx)Y*Header.Width*4;
+
+      for(int X = 0; X < Header.Width; ++X)
+      {
+         u16 Samples[4] = {0};
+         for(int Channel = 0; Channel < Channels; ++Channel)
+         {
+            if(Depth == 16)
+            {
+               u8 *Sample = Row + 2*(X*Channels + Channel);
+               Samples[Channel] = (u16)((Sample[0] << 8) | Sample[1]);
+            }
+            else if(Depth == 8)
+            {
+               Samples[Channel] = Row[X*Channels + Channel];
+            }
+            else
+            {
+               int Bit = X*Depth;
+               Samples[Channel] = (u16)((Row[Bit / 8] >> (8 - Depth - (Bit % 8))) & ((1 << Depth) - 1));
+            }
+         }
+
+         u8 *Texel = To + 4*X;
+         if(Header.Color_Type == 3)
+         {
+            Copy_Memory(Texel, Palette[Samples[0]], 4);
+         }
+         else
+         {
+            bool Keyed = (Has_Key &&
+                          Samples[0] == Key[0] &&
+                          (Channels < 3 || (Samples[1] == Key[1] && Samples[2] == Key[2])));
+
+            for(int Channel = 0; Channel < Channels; ++Channel)
+            {
+               u16 Sample = Samples[Channel];
+               Samples[Channel] = (Depth == 16) ? (Sample >> 8) : (Depth < 8) ? (Sample * 255 / ((1 << Depth) - 1)) : Sample;
+            }
+
+            bool Gray = (Channels <= 2);
+            Texel[0] = (u8)Samples[0];
+            Texel[1] = (u8)Samples[Gray ? 0 : 1];
+            Texel[2] = (u8)Samples[Gray ? 0 : 2];
+            Texel[3] = (Channels == 2 || Channels == 4) ? (u8)Samples[Channels - 1] : Keyed ? 0 : 255;
+         }
+      }
+   }
+
+   return(true);
+}
+
+// NOTE: Mip levels are built with a 2x2 box filter, each from the level before
+// it. Color images are averaged in linear light, since averaging their sRGB
+// values directly darkens every level. Odd sizes repeat their last row or
+// column. Each texel is one vector of four channels, so with SSE2 the filter
+// runs a whole texel per instruction.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define IMAGE_MIPS_SSE2 1
+#endif
+
+#define MIP_ENCODE_STEPS 4096
+
+typedef struct {
+   // NOTE: Decode maps each byte to its value per channel as a linear float
+   // from 0 to 1, and Encode maps linear values in MIP_ENCODE_STEPS steps back
+   // to bytes for the color channels.
+   float Decode[256][4];
+   u8 Encode[MIP_ENCODE_STEPS + 1];
+} mip_filter;
+
+static void Make_Mip_Filter(mip_filter *Filter, bool Srgb)
+{
+   for(int Value = 0; Value < 256; ++Value)
+   {
+      float Stored = Value / 255.0f;
+      float Linear = Stored;
+      if(Srgb)
+      {
+         Linear = (Stored <= 0.04045f) ? (Stored / 12.92f) : Power((Stored + 0.055f) / 1.055f, 2.4f);
+      }
+      Filter->Decode[Value][0] = Linear;
+      Filter->Decode[Value][1] = Linear;
+      Filter->Decode[Value][2] = Linear;
+      Filter->Decode[Value][3] = Stored;
+   }
+
+   for(int Step = 0; Step <= MIP_ENCODE_STEPS; ++Step)
+   {
+      float Linear = (float)Step / MIP_ENCODE_STEPS;
+      float Stored = Linear;
+      if(Srgb)
+      {
+         Stored = (Linear <= 0.0031308f) ? (Linear * 12.92f) : (1.055f*Power(Linear, 1.0f/2.4f) - 0.055f);
+      }
+      Filter->Encode[Step] = (u8)(Stored*255.0f + 0.5f);
+   }
+}
+
+static void Downsample_Image(mip_filter *Filter, u8 *Source, int Source_Width, int Source_Height, u8 *Destination, int Width, int Height)
+{
+   for(int Y = 0; Y < Height; ++Y)
+   {
+      u8 *Rows[2];
+      Rows[0] = Source + 4*(idx)Minimum(2*Y, Source_Height - 1)*Source_Width;
+      Rows[1] = Source + 4*(idx)Minimum(2*Y + 1, Source_Height - 1)*Source_Width;
+
+      for(int X = 0; X < Width; ++X)
+      {
+         int Columns[2] = {4*Minimum(2*X, Source_Width - 1), 4*Minimum(2*X + 1, Source_Width - 1)};
+         u8 *Texel = Destination + 4*((idx)Y*Width + X);
+
+#if IMAGE_MIPS_SSE2
+         __m128 Sum = _mm_setzero_ps();
+         for(int Tap = 0; Tap < 4; ++Tap)
+         {
+            u8 *Source_Texel = Rows[Tap >> 1] + Columns[Tap & 1];
+            Sum = _mm_add_ps(Sum, _mm_set_ps(Filter->Decode[Source_Texel[3]][3], Filter->Decode[Source_Texel[2]][2],
+                                             Filter->Decode[Source_Texel[1]][1], Filter->Decode[Source_Texel[0]][0]));
+         }
+
+         // NOTE: Color channels index the encode table, alpha is stored as is.
+         __m128 Scale = _mm_set_ps(255.0f, MIP_ENCODE_STEPS, MIP_ENCODE_STEPS, MIP_ENCODE_STEPS);
+         __m128i Steps = _mm_cvtps_epi32(_mm_mul_ps(_mm_mul_ps(Sum, _mm_set1_ps(0.25f)), Scale));
+
+         s32 Indices[4];
+         _mm_storeu_si128((__m128i *)Indices, Steps);
+         Texel[0] = Filter->Encode[Indices[0]];
+         Texel[1] = Filter->Encode[Indices[1]];
+         Texel[2] = Filter->Encode[Indices[2]];
+         Texel[3] = (u8)Indices[3];
+#else
+         float Sum[4] = {0};
+         for(int Tap = 0; Tap < 4; ++Tap)
+         {
+            u8 *Source_Texel = Rows[Tap >> 1] + Columns[Tap & 1];
+            for(int Channel = 0; Channel < 4; ++Channel)
+            {
+               Sum[Channel] += Filter->Decode[Source_Texel[Channel]][Channel];
+            }
+         }
+
+         // NOTE: Color channels index the encode table, alpha is stored as is.
+         for(int Channel = 0; Channel < 3; ++Channel)
+         {
+            Texel[Channel] = Filter->Encode[(int)(0.25f*Sum[Channel]*MIP_ENCODE_STEPS + 0.5f)];
+         }
+         Texel[3] = (u8)(0.25f*Sum[3]*255.0f + 0.5f);
+#endif
+      }
+   }
+}
+
+static bool Build_Image_Mips(u8 *Pixels, int Width, int Height, int Mip_Count, bool Srgb, arena Scratch)
+{
+   // NOTE: Pixels holds the whole chain of 8-bit RGBA levels, with the finest
+   // one already filled in. Returns false if the filter doesn't fit in Scratch.
+   mip_filter *Filter = Try_Allocate(&Scratch, mip_filter, 1);
+   if(!Filter)
+   {
+      return(false);
+   }
+   Make_Mip_Filter(Filter, Srgb);
+
+   for(int Level = 1; Level < Mip_Count; ++Level)
+   {
+      int Level_Width = Maximum(Width / 2, 1);
+      int Level_Height = Maximum(Height / 2, 1);
+      u8 *Level_Pixels = Pixels + 4*(idx)Width*Height;
+
+      Downsample_Image(Filter, Pixels, Width, Height, Level_Pixels, Level_Width, Level_Height);
+
+      Pixels = Level_Pixels;
+      Width = Level_Width;
+      Height = Level_Height;
+   }
+
+   return(true);
+}
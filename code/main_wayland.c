@@ -64,6 +64,8 @@ typedef struct {
    struct zxdg_decoration_manager_v1 *Decoration_Manager;
    struct zxdg_toplevel_decoration_v1 *Toplevel_Decoration;
 
+   platform_work_queue *Work_Queue;
+   platform_file_watcher *File_Watcher;
    vulkan_context VK;
 } wayland_context;
 
@@ -80,6 +82,18 @@ static GET_WINDOW_DIMENSIONS(Get_Window_Dimensions)
    *Height = Wayland->Window_Height;
 }
 
+static GET_WORK_QUEUE(Get_Work_Queue)
+{
+   wayland_context *Wayland = Platform_Context;
+   return(Wayland->Work_Queue);
+}
+
+static GET_FILE_WATCHER(Get_File_Watcher)
+{
+   wayland_context *Wayland = Platform_Context;
+   return(Wayland->File_Watcher);
+}
+
 static inline void Toggle_Wayland_Fullscreen(wayland_context *Wayland)
 {
    static bool Fullscreen;
@@ -537,6 +551,15 @@ static void Initialize_Wayland(wayland_context *Wayland, int Width, int Height)
 int main(void)
 {
    wayland_context Wayland = {0};
+
+   static platform_work_queue Work_Queue;
+   Initialize_Work_Queue(&Work_Queue);
+   Wayland.Work_Queue = &Work_Queue;
+
+   static platform_file_watcher File_Watcher;
+   Initialize_File_Watcher(&File_Watcher);
+   Wayland.File_Watcher = &File_Watcher;
+
    Initialize_Wayland(&Wayland, DEFAULT_RESOLUTION_WIDTH, DEFAULT_RESOLUTION_HEIGHT);
 
    if(Initialize_Vulkan(&Wayland.VK, &Wayland))
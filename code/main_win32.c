@@ -25,6 +25,8 @@ typedef struct {
    bool Running;
    bool Rendering_Paused;
 
+   platform_work_queue *Work_Queue;
+   platform_file_watcher *File_Watcher;
    vulkan_context VK;
 } win32_context;
 
@@ -32,7 +34,9 @@ typedef struct {
 
 static LOG(Log)
 {
-   static char Message[512];
+   // NOTE: Log is called from worker threads too, so the message buffer can't
+   // be shared.
+   char Message[512];
 
    va_list Arguments;
    va_start(Arguments, Format);
@@ -97,6 +101,395 @@ static FREE_ENTIRE_FILE(Free_Entire_File)
    }
 }
 
+static MAP_ENTIRE_FILE(Map_Entire_File)
+{
+   string Result = {0};
+
+   HANDLE File = CreateFileA(Path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, 0);
+   if(File == INVALID_HANDLE_VALUE)
+   {
+      Log("Failed to open file \"%s\".\n", Path);
+   }
+   else
+   {
+      LARGE_INTEGER Length;
+      if(!GetFileSizeEx(File, &Length) || Length.QuadPart == 0)
+      {
+         Log("Failed to determine size of file \"%s\".\n", Path);
+      }
+      else
+      {
+         HANDLE Mapping = CreateFileMappingA(File, 0, PAGE_READONLY, 0, 0, 0);
+         if(!Mapping)
+         {
+            Log("Failed to create mapping for file \"%s\".\n", Path);
+         }
+         else
+         {
+            Result.Data = MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0);
+            if(!Result.Data)
+            {
+               Log("Failed to map file \"%s\".\n", Path);
+            }
+            else
+            {
+               Result.Length = (idx)Length.QuadPart;
+            }
+
+            // NOTE: The view keeps the mapping alive after its handle is closed.
+            CloseHandle(Mapping);
+         }
+      }
+      CloseHandle(File);
+   }
+
+   return(Result);
+}
+
+static UNMAP_ENTIRE_FILE(Unmap_Entire_File)
+{
+   if(!UnmapViewOfFile(Data))
+   {
+      Log("Failed to unmap mapped file.\n");
+   }
+}
+
+static WRITE_ENTIRE_FILE(Write_Entire_File)
+{
+   bool Result = false;
+
+   // NOTE: The thread id keeps temporary names unique between threads writing
+   // the same path at once.
+   char Temporary_Path[512];
+   snprintf(Temporary_Path, sizeof(Temporary_Path), "%s.%lu.tmp", Path, GetCurrentThreadId());
+
+   HANDLE File = CreateFileA(Temporary_Path, GENERIC_WRITE, 0, 0, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, 0);
+   if(File == INVALID_HANDLE_VALUE)
+   {
+      Log("Failed to create file \"%s\".\n", Temporary_Path);
+   }
+   else
+   {
+      // NOTE: WriteFile is limited to 32-bit sizes, so larger files are written
+      // in pieces.
+      idx Written = 0;
+      while(Written < Length)
+      {
+         DWORD Single_Write;
+         DWORD Size = (DWORD)Minimum(Length - Written, Megabytes(512));
+         if(!WriteFile(File, Data + Written, Size, &Single_Write, 0) || !Single_Write)
+         {
+            break;
+         }
+         Written += Single_Write;
+      }
+      CloseHandle(File);
+
+      if(Written != Length)
+      {
+         Log("Failed to write file \"%s\".\n", Path);
+         DeleteFileA(Temporary_Path);
+      }
+      else if(!MoveFileExA(Temporary_Path, Path, MOVEFILE_REPLACE_EXISTING))
+      {
+         Log("Failed to rename \"%s\" to \"%s\".\n", Temporary_Path, Path);
+         DeleteFileA(Temporary_Path);
+      }
+      else
+      {
+         Result = true;
+      }
+   }
+
+   return(Result);
+}
+
+static MAKE_DIRECTORY(Make_Directory)
+{
+   bool Result = (CreateDirectoryA(Path, 0) || GetLastError() == ERROR_ALREADY_EXISTS);
+   if(!Result)
+   {
+      Log("Failed to make directory \"%s\".\n", Path);
+   }
+
+   return(Result);
+}
+
+static GET_FILE_STAMP(Get_File_Stamp)
+{
+   *Size = 0;
+   *Modified = 0;
+
+   WIN32_FILE_ATTRIBUTE_DATA Data;
+   bool Result = GetFileAttributesExA(Path, GetFileExInfoStandard, &Data);
+   if(Result)
+   {
+      *Size = ((u64)Data.nFileSizeHigh << 32) | Data.nFileSizeLow;
+      *Modified = ((u64)Data.ftLastWriteTime.dwHighDateTime << 32) | Data.ftLastWriteTime.dwLowDateTime;
+   }
+
+   return(Result);
+}
+
+static GET_SECONDS(Get_Seconds)
+{
+   LARGE_INTEGER Frequency, Counter;
+   QueryPerformanceFrequency(&Frequency);
+   QueryPerformanceCounter(&Counter);
+
+   double Result = (double)Counter.QuadPart / (double)Frequency.QuadPart;
+   return(Result);
+}
+
+#define WORK_QUEUE_ENTRY_COUNT 256
+
+typedef struct {
+   work_queue_callback *Callback;
+   void *Data;
+} platform_work_queue_entry;
+
+typedef struct {
+   platform_work_queue *Queue;
+   int Thread_Index;
+} platform_work_thread;
+
+struct platform_work_queue {
+   u32 volatile Completion_Goal;
+   u32 volatile Completion_Count;
+
+   u32 volatile Next_Entry_To_Write;
+   u32 volatile Next_Entry_To_Read;
+   HANDLE Semaphore;
+
+   platform_work_queue_entry Entries[WORK_QUEUE_ENTRY_COUNT];
+
+   int Thread_Count;
+   platform_work_thread Threads[MAX_WORK_QUEUE_THREAD_COUNT];
+};
+
+static bool Do_Next_Work_Queue_Entry(platform_work_queue *Queue, int Thread_Index)
+{
+   bool Should_Sleep = false;
+
+   u32 Original_Next_Entry_To_Read = Atomic_Load_U32(&Queue->Next_Entry_To_Read);
+   u32 New_Next_Entry_To_Read = (Original_Next_Entry_To_Read + 1) % WORK_QUEUE_ENTRY_COUNT;
+   if(Original_Next_Entry_To_Read != Atomic_Load_U32(&Queue->Next_Entry_To_Write))
+   {
+      u32 Index = Atomic_Compare_Exchange_U32(&Queue->Next_Entry_To_Read, Original_Next_Entry_To_Read, New_Next_Entry_To_Read);
+      if(Index == Original_Next_Entry_To_Read)
+      {
+         platform_work_queue_entry Entry = Queue->Entries[Index];
+         Entry.Callback(Queue, Thread_Index, Entry.Data);
+         Atomic_Add_U32(&Queue->Completion_Count, 1);
+      }
+   }
+   else
+   {
+      Should_Sleep = true;
+   }
+
+   return(Should_Sleep);
+}
+
+static DWORD WINAPI Win32_Work_Thread(LPVOID Parameter)
+{
+   platform_work_thread *Thread = Parameter;
+   platform_work_queue *Queue = Thread->Queue;
+
+   for(;;)
+   {
+      if(Do_Next_Work_Queue_Entry(Queue, Thread->Thread_Index))
+      {
+         WaitForSingleObjectEx(Queue->Semaphore, INFINITE, FALSE);
+      }
+   }
+
+   return(0);
+}
+
+static void Initialize_Work_Queue(platform_work_queue *Queue)
+{
+   // NOTE: One worker per remaining core, since the thread that fills the queue
+   // also pitches in whenever it waits on it. There is always at least one
+   // worker, since that thread may never wait at all.
+   SYSTEM_INFO System_Info;
+   GetSystemInfo(&System_Info);
+   Queue->Thread_Count = Minimum(Maximum((int)System_Info.dwNumberOfProcessors, 2), MAX_WORK_QUEUE_THREAD_COUNT);
+
+   Queue->Semaphore = CreateSemaphoreEx(0, 0, Queue->Thread_Count, 0, 0, SEMAPHORE_ALL_ACCESS);
+
+   for(int Thread_Index = 1; Thread_Index < Queue->Thread_Count; ++Thread_Index)
+   {
+      platform_work_thread *Thread = Queue->Threads + Thread_Index;
+      Thread->Queue = Queue;
+      Thread->Thread_Index = Thread_Index;
+
+      HANDLE Handle = CreateThread(0, 0, Win32_Work_Thread, Thread, 0, 0);
+      if(!Handle)
+      {
+         Log("Failed to create worker thread %d.\n", Thread_Index);
+         Queue->Thread_Count = Thread_Index;
+         break;
+      }
+      CloseHandle(Handle);
+   }
+}
+
+static GET_WORK_QUEUE_THREAD_COUNT(Get_Work_Queue_Thread_Count)
+{
+   return(Queue->Thread_Count);
+}
+
+static ADD_WORK_QUEUE_ENTRY(Add_Work_Queue_Entry)
+{
+   u32 Next_Entry_To_Write = Queue->Next_Entry_To_Write;
+   u32 New_Next_Entry_To_Write = (Next_Entry_To_Write + 1) % WORK_QUEUE_ENTRY_COUNT;
+   Assert(New_Next_Entry_To_Write != Atomic_Load_U32(&Queue->Next_Entry_To_Read));
+
+   platform_work_queue_entry *Entry = Queue->Entries + Next_Entry_To_Write;
+   Entry->Callback = Callback;
+   Entry->Data = Data;
+   Queue->Completion_Goal++;
+
+   // NOTE: The atomic store publishes the entry before any worker can see it.
+   Atomic_Store_U32(&Queue->Next_Entry_To_Write, New_Next_Entry_To_Write);
+   ReleaseSemaphore(Queue->Semaphore, 1, 0);
+}
+
+static COMPLETE_ALL_WORK(Complete_All_Work)
+{
+   while(Queue->Completion_Goal != Atomic_Load_U32(&Queue->Completion_Count))
+   {
+      Do_Next_Work_Queue_Entry(Queue, 0);
+   }
+
+   Queue->Completion_Goal = 0;
+   Atomic_Store_U32(&Queue->Completion_Count, 0);
+}
+
+// NOTE: File watching uses an overlapped ReadDirectoryChangesW per directory,
+// polled without waiting. Windows reports writes as they happen rather than
+// when the file is closed, so a file may be reported while it's still being
+// written, and again once it's done.
+#define MAX_WATCHED_DIRECTORY_COUNT 16
+
+typedef struct {
+   char *Path;
+   HANDLE Directory;
+   OVERLAPPED Overlapped;
+   DWORD Events[1024]; // NOTE: Aligned for FILE_NOTIFY_INFORMATION.
+
+   DWORD Event_Offset;
+   DWORD Event_Size;
+   bool Pending; // NOTE: A read has been issued and not yet completed.
+} win32_watched_directory;
+
+struct platform_file_watcher {
+   int Directory_Count;
+   win32_watched_directory Directories[MAX_WATCHED_DIRECTORY_COUNT];
+};
+
+static void Initialize_File_Watcher(platform_file_watcher *Watcher)
+{
+   ZeroMemory(Watcher, sizeof(*Watcher));
+}
+
+static bool Read_Win32_Directory_Changes(win32_watched_directory *Directory)
+{
+   DWORD Filter = FILE_NOTIFY_CHANGE_FILE_NAME|FILE_NOTIFY_CHANGE_LAST_WRITE;
+   bool Result = ReadDirectoryChangesW(Directory->Directory, Directory->Events, sizeof(Directory->Events),
+                                       FALSE, Filter, 0, &Directory->Overlapped, 0);
+   return(Result);
+}
+
+static WATCH_DIRECTORY(Watch_Directory)
+{
+   bool Result = false;
+   for(int Directory_Index = 0; Directory_Index < Watcher->Directory_Count; ++Directory_Index)
+   {
+      Result = Result || (strcmp(Watcher->Directories[Directory_Index].Path, Path) == 0);
+   }
+
+   if(!Result && Watcher->Directory_Count < MAX_WATCHED_DIRECTORY_COUNT)
+   {
+      win32_watched_directory *Directory = Watcher->Directories + Watcher->Directory_Count;
+      Directory->Path = Path;
+      Directory->Directory = CreateFileA(Path, FILE_LIST_DIRECTORY, FILE_SHARE_READ|FILE_SHARE_WRITE|FILE_SHARE_DELETE, 0,
+                                         OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS|FILE_FLAG_OVERLAPPED, 0);
+      Directory->Overlapped.hEvent = CreateEventA(0, TRUE, FALSE, 0);
+
+      if(Directory->Directory == INVALID_HANDLE_VALUE || !Read_Win32_Directory_Changes(Directory))
+      {
+         Log("Failed to watch \"%s\".\n", Path);
+         if(Directory->Directory != INVALID_HANDLE_VALUE)
+         {
+            CloseHandle(Directory->Directory);
+         }
+         CloseHandle(Directory->Overlapped.hEvent);
+         ZeroMemory(Directory, sizeof(*Directory));
+      }
+      else
+      {
+         Directory->Pending = true;
+         Watcher->Directory_Count++;
+         Result = true;
+      }
+   }
+
+   return(Result);
+}
+
+static NEXT_CHANGED_FILE(Next_Changed_File)
+{
+   bool Result = false;
+   for(int Directory_Index = 0; !Result && Directory_Index < Watcher->Directory_Count; ++Directory_Index)
+   {
+      win32_watched_directory *Directory = Watcher->Directories + Directory_Index;
+      while(!Result)
+      {
+         if(Directory->Event_Offset >= Directory->Event_Size)
+         {
+            // NOTE: Once a batch is used up, the next read is issued straight
+            // away so no changes are missed in between polls. A read that
+            // completes empty overflowed, and its changes are lost.
+            if(!Directory->Pending)
+            {
+               if(!Read_Win32_Directory_Changes(Directory))
+               {
+                  break;
+               }
+               Directory->Pending = true;
+            }
+
+            DWORD Read_Size;
+            if(!GetOverlappedResult(Directory->Directory, &Directory->Overlapped, &Read_Size, FALSE))
+            {
+               break; // NOTE: Still waiting on changes.
+            }
+            Directory->Pending = false;
+            Directory->Event_Offset = 0;
+            Directory->Event_Size = Read_Size;
+            continue;
+         }
+
+         FILE_NOTIFY_INFORMATION *Event = (FILE_NOTIFY_INFORMATION *)((u8 *)Directory->Events + Directory->Event_Offset);
+         Directory->Event_Offset = Event->NextEntryOffset ? Directory->Event_Offset + Event->NextEntryOffset : Directory->Event_Size;
+
+         if(Event->Action == FILE_ACTION_ADDED || Event->Action == FILE_ACTION_MODIFIED || Event->Action == FILE_ACTION_RENAMED_NEW_NAME)
+         {
+            char Name[MAX_PATH];
+            int Name_Length = WideCharToMultiByte(CP_UTF8, 0, Event->FileName, Event->FileNameLength / sizeof(WCHAR), Name, sizeof(Name) - 1, 0, 0);
+            Name[Name_Length] = 0;
+
+            int Length = snprintf(Path, Size, "%s/%s", Directory->Path, Name);
+            Result = (Name_Length > 0 && Length > 0 && Length < Size);
+         }
+      }
+   }
+
+   return(Result);
+}
+
 static void Get_Win32_Window_Dimensions(HWND Window, int *Width, int *Height)
 {
    RECT Client_Rect;
@@ -113,6 +506,18 @@ static GET_WINDOW_DIMENSIONS(Get_Window_Dimensions)
    Get_Win32_Window_Dimensions(Win32->Window, Width, Height);
 }
 
+static GET_WORK_QUEUE(Get_Work_Queue)
+{
+   win32_context *Win32 = Platform_Context;
+   return(Win32->Work_Queue);
+}
+
+static GET_FILE_WATCHER(Get_File_Watcher)
+{
+   win32_context *Win32 = Platform_Context;
+   return(Win32->File_Watcher);
+}
+
 static bool Is_Win32_Fullscreen(HWND Window)
 {
    DWORD Style = GetWindowLong(Window, GWL_STYLE);
@@ -315,6 +720,15 @@ static void Initialize_Win32(win32_context *Win32, int Show_Command)
 int WinMain(HINSTANCE Instance, HINSTANCE Previous_Instance, LPSTR Command_Line, int Show_Command)
 {
    win32_context Win32 = {0};
+
+   static platform_work_queue Work_Queue;
+   Initialize_Work_Queue(&Work_Queue);
+   Win32.Work_Queue = &Work_Queue;
+
+   static platform_file_watcher File_Watcher;
+   Initialize_File_Watcher(&File_Watcher);
+   Win32.File_Watcher = &File_Watcher;
+
    Initialize_Win32(&Win32, Show_Command);
 
    if(Initialize_Vulkan(&Win32.VK, &Win32))
@@ -23,6 +23,8 @@ typedef struct {
    u32 *Image_Pixels;
    XImage *Image;
 
+   platform_work_queue *Work_Queue;
+   platform_file_watcher *File_Watcher;
    vulkan_context VK;
    bool Running;
 } xlib_context;
@@ -43,6 +45,18 @@ static GET_WINDOW_DIMENSIONS(Get_Window_Dimensions)
    *Height = (int)Window_Attributes.height;
 }
 
+static GET_WORK_QUEUE(Get_Work_Queue)
+{
+   xlib_context *Xlib = Platform_Context;
+   return(Xlib->Work_Queue);
+}
+
+static GET_FILE_WATCHER(Get_File_Watcher)
+{
+   xlib_context *Xlib = Platform_Context;
+   return(Xlib->File_Watcher);
+}
+
 static void Toggle_Xlib_Fullscreen(xlib_context *Xlib)
 {
    Atom WM_State = XInternAtom(Xlib->Display, "_NET_WM_STATE", False);
@@ -234,6 +248,15 @@ static void Render_With_Xlib(xlib_context *Xlib)
 int main(void)
 {
    xlib_context Xlib = {0};
+
+   static platform_work_queue Work_Queue;
+   Initialize_Work_Queue(&Work_Queue);
+   Xlib.Work_Queue = &Work_Queue;
+
+   static platform_file_watcher File_Watcher;
+   Initialize_File_Watcher(&File_Watcher);
+   Xlib.File_Watcher = &File_Watcher;
+
    Initialize_Xlib(&Xlib, DEFAULT_RESOLUTION_WIDTH, DEFAULT_RESOLUTION_HEIGHT);
 
    if(Initialize_Vulkan(&Xlib.VK, &Xlib))
@@ -0,0 +1,624 @@
+/* (c) copyright 2025 Lawrence D. Kern /////////////////////////////////////// */
+
+// NOTE: Offline mesh optimizations used by the baker. Everything here works on
+// triangle lists with 32-bit indices and only ever reorders data, so an
+// optimized primitive still draws exactly the same triangles.
+//
+// Triangles are first reordered for the post-transform vertex cache using
+// Tipsify (Sander, Nehab and Barczak, "Fast Triangle Reordering for Vertex
+// Locality and Reduced Overdraw", 2007). The same paper's overdraw pass then
+// splits that order into clusters wherever it can without hurting the cache
+// much, and sorts the clusters so that those facing away from the mesh's center
+// are drawn first. Finally vertices are renumbered in the order the triangles
+// first reference them, so that vertex fetches walk memory front to back.
+//
+// Meshlets are built afterwards by scanning the final triangle order, which
+// already has good vertex locality, and starting a new meshlet whenever the
+// next triangle wouldn't fit. Each one then gets a bounding sphere and a
+// normal cone for culling.
+
+#define VERTEX_CACHE_SIZE 16
+#define OVERDRAW_CACHE_THRESHOLD 1.05f
+
+typedef struct {
+   idx Triangle_Count;
+   idx Vertex_Count;
+   idx Cache_Misses;
+} vertex_cache_statistics;
+
+typedef struct {
+   u32 *Offsets; // NOTE: Vertex_Count + 1 entries.
+   u32 *Triangles;
+} vertex_triangle_adjacency;
+
+typedef struct {
+   u32 Time;
+   u32 *Timestamps;
+} vertex_cache;
+
+static inline float Get_ACMR(vertex_cache_statistics Statistics)
+{
+   // NOTE: Average cache miss ratio: vertex shader invocations per triangle.
+   float Result = Statistics.Triangle_Count ? (float)Statistics.Cache_Misses / Statistics.Triangle_Count : 0;
+   return(Result);
+}
+
+static inline float Get_ATVR(vertex_cache_statistics Statistics)
+{
+   // NOTE: Average transformed vertex ratio: vertex shader invocations per
+   // vertex, where 1.0 is ideal.
+   float Result = Statistics.Vertex_Count ? (float)Statistics.Cache_Misses / Statistics.Vertex_Count : 0;
+   return(Result);
+}
+
+static void Reset_Vertex_Cache(vertex_cache *Cache)
+{
+   // NOTE: Advancing time past the cache size makes every stamp stale at once.
+   Cache->Time += VERTEX_CACHE_SIZE + 1;
+}
+
+static vertex_cache Make_Vertex_Cache(arena *Arena, idx Vertex_Count)
+{
+   vertex_cache Result = {0};
+   Result.Timestamps = Allocate(Arena, u32, Vertex_Count);
+   Reset_Vertex_Cache(&Result);
+
+   return(Result);
+}
+
+static bool Touch_Vertex_Cache(vertex_cache *Cache, u32 Vertex)
+{
+   // NOTE: Simulates a FIFO cache. Hits don't refresh a vertex's position, so a
+   // vertex is evicted VERTEX_CACHE_SIZE misses after it was loaded. Returns
+   // true on a miss.
+   bool Miss = (Cache->Time - Cache->Timestamps[Vertex] > VERTEX_CACHE_SIZE);
+   if(Miss)
+   {
+      Cache->Timestamps[Vertex] = Cache->Time++;
+   }
+
+   return(Miss);
+}
+
+static vertex_cache_statistics Analyze_Vertex_Cache(u32 *Indices, idx Index_Count, idx Vertex_Count, arena Scratch)
+{
+   vertex_cache_statistics Result = {0};
+   Result.Triangle_Count = Index_Count / 3;
+   Result.Vertex_Count = Vertex_Count;
+
+   vertex_cache Cache = Make_Vertex_Cache(&Scratch, Vertex_Count);
+   for(idx Index = 0; Index < Index_Count; ++Index)
+   {
+      Result.Cache_Misses += Touch_Vertex_Cache(&Cache, Indices[Index]);
+   }
+
+   return(Result);
+}
+
+static vertex_triangle_adjacency Build_Vertex_Triangle_Adjacency(arena *Arena, u32 *Indices, idx Index_Count, idx Vertex_Count)
+{
+   vertex_triangle_adjacency Result = {0};
+   Result.Offsets = Allocate(Arena, u32, Vertex_Count + 1);
+   Result.Triangles = Allocate(Arena, u32, Index_Count);
+
+   // NOTE: Count triangles per vertex, turn the counts into offsets, then fill
+   // each vertex's run. The offsets are left pointing one run ahead while
+   // filling, and shifted back afterwards.
+   for(idx Index = 0; Index < Index_Count; ++Index)
+   {
+      Result.Offsets[Indices[Index] + 1]++;
+   }
+   for(idx Vertex = 0; Vertex < Vertex_Count; ++Vertex)
+   {
+      Result.Offsets[Vertex + 1] += Result.Offsets[Vertex];
+   }
+   for(idx Index = 0; Index < Index_Count; ++Index)
+   {
+      Result.Triangles[Result.Offsets[Indices[Index]]++] = (u32)(Index / 3);
+   }
+   for(idx Vertex = Vertex_Count; Vertex > 0; --Vertex)
+   {
+      Result.Offsets[Vertex] = Result.Offsets[Vertex - 1];
+   }
+   Result.Offsets[0] = 0;
+
+   return(Result);
+}
+
+static void Optimize_Vertex_Cache(u32 *Indices, idx Index_Count, idx Vertex_Count, arena Scratch)
+{
+   // NOTE: Tipsify. Triangles are emitted by fanning around one vertex at a
+   // time, and the next fanning vertex is picked from the ones just emitted,
+   // preferring vertices that will still be in the cache once all of their
+   // remaining triangles are drawn. Reorders Indices in place.
+   idx Triangle_Count = Index_Count / 3;
+
+   vertex_triangle_adjacency Adjacency = Build_Vertex_Triangle_Adjacency(&Scratch, Indices, Index_Count, Vertex_Count);
+
+   u32 *Live_Triangles = Allocate(&Scratch, u32, Vertex_Count);
+   for(idx Vertex = 0; Vertex < Vertex_Count; ++Vertex)
+   {
+      Live_Triangles[Vertex] = Adjacency.Offsets[Vertex + 1] - Adjacency.Offsets[Vertex];
+   }
+
+   u32 *Cache_Times = Allocate(&Scratch, u32, Vertex_Count);
+   u32 *Dead_End_Stack = Allocate(&Scratch, u32, Index_Count);
+   u32 *Candidates = Allocate(&Scratch, u32, Index_Count);
+   u32 *Result = Allocate(&Scratch, u32, Index_Count);
+   bool *Emitted = Allocate(&Scratch, bool, Triangle_Count);
+
+   idx Dead_End_Count = 0;
+   idx Result_Count = 0;
+   idx Next_Vertex = 0;
+   u32 Time = VERTEX_CACHE_SIZE + 1;
+
+   s64 Fanning_Vertex = 0;
+   while(Fanning_Vertex >= 0)
+   {
+      idx Candidate_Count = 0;
+
+      u32 *Triangles = Adjacency.Triangles + Adjacency.Offsets[Fanning_Vertex];
+      u32 *Triangles_End = Adjacency.Triangles + Adjacency.Offsets[Fanning_Vertex + 1];
+      for(u32 *Triangle = Triangles; Triangle < Triangles_End; ++Triangle)
+      {
+         if(!Emitted[*Triangle])
+         {
+            for(int Corner = 0; Corner < 3; ++Corner)
+            {
+               u32 Vertex = Indices[*Triangle*3 + Corner];
+
+               Result[Result_Count++] = Vertex;
+               Dead_End_Stack[Dead_End_Count++] = Vertex;
+               Candidates[Candidate_Count++] = Vertex;
+               Live_Triangles[Vertex]--;
+
+               if(Time - Cache_Times[Vertex] > VERTEX_CACHE_SIZE)
+               {
+                  Cache_Times[Vertex] = Time++;
+               }
+            }
+            Emitted[*Triangle] = true;
+         }
+      }
+
+      // NOTE: Pick the candidate that has been in the cache the longest while
+      // still being expected to survive its remaining fan.
+      Fanning_Vertex = -1;
+      s64 Best_Priority = -1;
+      for(idx Candidate_Index = 0; Candidate_Index < Candidate_Count; ++Candidate_Index)
+      {
+         u32 Vertex = Candidates[Candidate_Index];
+         if(Live_Triangles[Vertex] > 0)
+         {
+            s64 Priority = 0;
+            s64 Age = Time - Cache_Times[Vertex];
+            if(Age + 2*(s64)Live_Triangles[Vertex] <= VERTEX_CACHE_SIZE)
+            {
+               Priority = Age;
+            }
+            if(Priority > Best_Priority)
+            {
+               Best_Priority = Priority;
+               Fanning_Vertex = Vertex;
+            }
+         }
+      }
+
+      // NOTE: At a dead end, back up to the most recently used vertex that
+      // still has triangles, and failing that take the next one in order.
+      while(Fanning_Vertex < 0 && Dead_End_Count > 0)
+      {
+         u32 Vertex = Dead_End_Stack[--Dead_End_Count];
+         if(Live_Triangles[Vertex] > 0)
+         {
+            Fanning_Vertex = Vertex;
+         }
+      }
+      while(Fanning_Vertex < 0 && Next_Vertex < Vertex_Count)
+      {
+         if(Live_Triangles[Next_Vertex] > 0)
+         {
+            Fanning_Vertex = Next_Vertex;
+         }
+         Next_Vertex++;
+      }
+   }
+
+   Assert(Result_Count == Triangle_Count*3);
+   Copy_Memory(Indices, Result, Result_Count*sizeof(*Result));
+}
+
+typedef struct {
+   float Sort_Key;
+   u32 Cluster;
+} overdraw_cluster_key;
+
+static int Compare_Overdraw_Cluster_Keys(const void *A, const void *B)
+{
+   // NOTE: Descending by key, then ascending by cluster to keep the sort stable.
+   const overdraw_cluster_key *Key_A = A;
+   const overdraw_cluster_key *Key_B = B;
+
+   int Result = (Key_A->Sort_Key < Key_B->Sort_Key) - (Key_A->Sort_Key > Key_B->Sort_Key);
+   if(Result == 0)
+   {
+      Result = (Key_A->Cluster > Key_B->Cluster) - (Key_A->Cluster < Key_B->Cluster);
+   }
+
+   return(Result);
+}
+
+static void Optimize_Overdraw(u32 *Indices, idx Index_Count, float *Positions, idx Position_Stride, idx Vertex_Count, arena Scratch)
+{
+   // NOTE: Expects Indices to already be in vertex cache order. Positions are
+   // read as three floats every Position_Stride floats.
+   idx Triangle_Count = Index_Count / 3;
+   if(Triangle_Count == 0)
+   {
+      return;
+   }
+
+   // NOTE: Hard boundaries are where the cache order started over anyway: the
+   // triangles for which every vertex missed.
+   u32 *Boundaries = Allocate(&Scratch, u32, Triangle_Count + 1);
+   u32 *Misses = Allocate(&Scratch, u32, Triangle_Count);
+   idx Boundary_Count = 0;
+
+   vertex_cache Cache = Make_Vertex_Cache(&Scratch, Vertex_Count);
+   for(idx Triangle = 0; Triangle < Triangle_Count; ++Triangle)
+   {
+      for(int Corner = 0; Corner < 3; ++Corner)
+      {
+         Misses[Triangle] += Touch_Vertex_Cache(&Cache, Indices[Triangle*3 + Corner]);
+      }
+      if(Triangle == 0 || Misses[Triangle] == 3)
+      {
+         Boundaries[Boundary_Count++] = (u32)Triangle;
+      }
+   }
+   Boundaries[Boundary_Count] = (u32)Triangle_Count;
+
+   // NOTE: Soft boundaries split each hard cluster further, wherever the cache
+   // miss ratio since the previous split, simulated with a cold cache, is
+   // within the threshold of the hard cluster's own ratio.
+   u32 *Clusters = Allocate(&Scratch, u32, Triangle_Count + 1);
+   idx Cluster_Count = 0;
+
+   for(idx Boundary = 0; Boundary < Boundary_Count; ++Boundary)
+   {
+      u32 Begin = Boundaries[Boundary];
+      u32 End = Boundaries[Boundary + 1];
+
+      u32 Cluster_Misses = 0;
+      for(u32 Triangle = Begin; Triangle < End; ++Triangle)
+      {
+         Cluster_Misses += Misses[Triangle];
+      }
+      float Threshold = OVERDRAW_CACHE_THRESHOLD * (float)Cluster_Misses / (End - Begin);
+
+      Clusters[Cluster_Count++] = Begin;
+      Reset_Vertex_Cache(&Cache);
+
+      u32 Running_Misses = 0;
+      u32 Running_Triangles = 0;
+      for(u32 Triangle = Begin; Triangle < End; ++Triangle)
+      {
+         for(int Corner = 0; Corner < 3; ++Corner)
+         {
+            Running_Misses += Touch_Vertex_Cache(&Cache, Indices[Triangle*3 + Corner]);
+         }
+         Running_Triangles++;
+
+         if(Triangle + 1 < End && (float)Running_Misses / Running_Triangles <= Threshold)
+         {
+            Clusters[Cluster_Count++] = Triangle + 1;
+            Reset_Vertex_Cache(&Cache);
+
+            Running_Misses = 0;
+            Running_Triangles = 0;
+         }
+      }
+   }
+   Clusters[Cluster_Count] = (u32)Triangle_Count;
+
+   // NOTE: Sort clusters by how far they face out from the mesh's center, so
+   // that likely occluders are drawn first.
+   vec3 *Cluster_Centers = Allocate(&Scratch, vec3, Cluster_Count);
+   vec3 *Cluster_Normals = Allocate(&Scratch, vec3, Cluster_Count);
+   vec3 Mesh_Center = {0};
+   float Mesh_Area = 0;
+
+   for(idx Cluster = 0; Cluster < Cluster_Count; ++Cluster)
+   {
+      vec3 Center = {0};
+      vec3 Normal = {0};
+      float Cluster_Area = 0;
+
+      for(u32 Triangle = Clusters[Cluster]; Triangle < Clusters[Cluster + 1]; ++Triangle)
+      {
+         float *P0 = Positions + Indices[Triangle*3 + 0]*Position_Stride;
+         float *P1 = Positions + Indices[Triangle*3 + 1]*Position_Stride;
+         float *P2 = Positions + Indices[Triangle*3 + 2]*Position_Stride;
+
+         vec3 A = {P0[0], P0[1], P0[2]};
+         vec3 B = {P1[0], P1[1], P1[2]};
+         vec3 C = {P2[0], P2[1], P2[2]};
+
+         vec3 Cross = Cross_Vec3(Sub_Vec3(B, A), Sub_Vec3(C, A));
+         float Area = Length_Vec3(Cross);
+
+         Center.X += (A.X + B.X + C.X) * (Area / 3.0f);
+         Center.Y += (A.Y + B.Y + C.Y) * (Area / 3.0f);
+         Center.Z += (A.Z + B.Z + C.Z) * (Area / 3.0f);
+
+         Normal.X += Cross.X;
+         Normal.Y += Cross.Y;
+         Normal.Z += Cross.Z;
+
+         Cluster_Area += Area;
+      }
+
+      Mesh_Center.X += Center.X;
+      Mesh_Center.Y += Center.Y;
+      Mesh_Center.Z += Center.Z;
+      Mesh_Area += Cluster_Area;
+
+      Cluster_Centers[Cluster] = (Cluster_Area > 0) ? Mul_Vec3(Center, 1.0f / Cluster_Area) : Center;
+      Cluster_Normals[Cluster] = Normalize_Vec3(Normal);
+   }
+
+   if(Mesh_Area > 0)
+   {
+      Mesh_Center = Mul_Vec3(Mesh_Center, 1.0f / Mesh_Area);
+   }
+
+   overdraw_cluster_key *Keys = Allocate(&Scratch, overdraw_cluster_key, Cluster_Count);
+   for(idx Cluster = 0; Cluster < Cluster_Count; ++Cluster)
+   {
+      Keys[Cluster].Sort_Key = Dot_Vec3(Sub_Vec3(Cluster_Centers[Cluster], Mesh_Center), Cluster_Normals[Cluster]);
+      Keys[Cluster].Cluster = (u32)Cluster;
+   }
+   qsort(Keys, Cluster_Count, sizeof(*Keys), Compare_Overdraw_Cluster_Keys);
+
+   u32 *Result = Allocate(&Scratch, u32, Index_Count);
+   idx Result_Count = 0;
+   for(idx Key = 0; Key < Cluster_Count; ++Key)
+   {
+      u32 Cluster = Keys[Key].Cluster;
+      idx Count = (Clusters[Cluster + 1] - Clusters[Cluster]) * 3;
+
+      Copy_Memory(Result + Result_Count, Indices + Clusters[Cluster]*3, Count*sizeof(*Result));
+      Result_Count += Count;
+   }
+
+   Copy_Memory(Indices, Result, Index_Count*sizeof(*Result));
+}
+
+static void Optimize_Vertex_Fetch_Remap(u32 *Remap, u32 *Indices, idx Index_Count, idx Vertex_Count)
+{
+   // NOTE: Numbers vertices in the order the index buffer first touches them.
+   // Vertices no triangle uses keep their relative order at the end. Remap maps
+   // old vertex indices to new ones.
+   for(idx Vertex = 0; Vertex < Vertex_Count; ++Vertex)
+   {
+      Remap[Vertex] = (u32)-1;
+   }
+
+   u32 Next = 0;
+   for(idx Index = 0; Index < Index_Count; ++Index)
+   {
+      if(Remap[Indices[Index]] == (u32)-1)
+      {
+         Remap[Indices[Index]] = Next++;
+      }
+   }
+   for(idx Vertex = 0; Vertex < Vertex_Count; ++Vertex)
+   {
+      if(Remap[Vertex] == (u32)-1)
+      {
+         Remap[Vertex] = Next++;
+      }
+   }
+}
+
+static void Remap_Indices(u32 *Indices, idx Index_Count, u32 *Remap)
+{
+   for(idx Index = 0; Index < Index_Count; ++Index)
+   {
+      Indices[Index] = Remap[Indices[Index]];
+   }
+}
+
+static void Remap_Vertices(u8 *Vertices, idx Vertex_Size, idx Vertex_Count, u32 *Remap, arena Scratch)
+{
+   u8 *Result = Allocate(&Scratch, u8, Vertex_Size*Vertex_Count);
+   for(idx Vertex = 0; Vertex < Vertex_Count; ++Vertex)
+   {
+      Copy_Memory(Result + Remap[Vertex]*Vertex_Size, Vertices + Vertex*Vertex_Size, Vertex_Size);
+   }
+
+   Copy_Memory(Vertices, Result, Vertex_Size*Vertex_Count);
+}
+
+static inline idx Get_Meshlet_Bound(idx Index_Count)
+{
+   // NOTE: A meshlet only closes early when its vertices run out, and every
+   // triangle adds at most 3 of them, so every meshlet but the last holds at
+   // least this many triangles.
+   idx Minimum_Triangle_Count = Minimum((MAX_MESHLET_VERTEX_COUNT - 2) / 3, MAX_MESHLET_TRIANGLE_COUNT);
+   idx Result = (Index_Count / 3) / Minimum_Triangle_Count + 1;
+   return(Result);
+}
+
+static idx Build_Meshlets(gltf_meshlet *Meshlets, u32 *Meshlet_Vertices, u8 *Meshlet_Triangles,
+                          u32 *Indices, idx Index_Count, idx Vertex_Count, arena Scratch)
+{
+   // NOTE: Offsets are relative to the arrays passed in. Meshlet_Vertices needs
+   // room for Index_Count entries and Meshlet_Triangles for Index_Count bytes
+   // in the worst case. Returns the meshlet count.
+   u32 *Stamps = Allocate(&Scratch, u32, Vertex_Count);
+   u8 *Local_Indices = Allocate(&Scratch, u8, Vertex_Count);
+
+   idx Result = 0;
+   gltf_meshlet *Meshlet = 0;
+   u32 Vertex_Offset = 0;
+   u32 Triangle_Offset = 0;
+
+   for(idx Index = 0; Index + 2 < Index_Count; Index += 3)
+   {
+      u32 *Triangle = Indices + Index;
+
+      // NOTE: Stamps hold the 1-based meshlet a vertex was last added to.
+      u32 Stamp = (u32)Result;
+      u32 New_Vertex_Count = 0;
+      for(int Corner = 0; Corner < 3; ++Corner)
+      {
+         bool Repeated = (Corner > 0 && Triangle[Corner] == Triangle[0]) || (Corner > 1 && Triangle[Corner] == Triangle[1]);
+         New_Vertex_Count += (Stamps[Triangle[Corner]] != Stamp && !Repeated);
+      }
+
+      if(!Meshlet ||
+         Meshlet->Vertex_Count + New_Vertex_Count > MAX_MESHLET_VERTEX_COUNT ||
+         Meshlet->Triangle_Count + 1 > MAX_MESHLET_TRIANGLE_COUNT)
+      {
+         if(Meshlet)
+         {
+            Vertex_Offset += Meshlet->Vertex_Count;
+            Triangle_Offset += Meshlet->Triangle_Count;
+         }
+
+         Meshlet = Meshlets + Result++;
+         Zero_Struct(Meshlet);
+         Meshlet->Vertex_Offset = Vertex_Offset;
+         Meshlet->Triangle_Offset = Triangle_Offset;
+         Stamp = (u32)Result;
+      }
+
+      u8 *Local_Triangle = Meshlet_Triangles + 3*(Meshlet->Triangle_Offset + Meshlet->Triangle_Count++);
+      for(int Corner = 0; Corner < 3; ++Corner)
+      {
+         u32 Vertex = Triangle[Corner];
+         if(Stamps[Vertex] != Stamp)
+         {
+            Stamps[Vertex] = Stamp;
+            Local_Indices[Vertex] = (u8)Meshlet->Vertex_Count;
+            Meshlet_Vertices[Meshlet->Vertex_Offset + Meshlet->Vertex_Count++] = Vertex;
+         }
+         Local_Triangle[Corner] = Local_Indices[Vertex];
+      }
+   }
+
+   return(Result);
+}
+
+static void Compute_Meshlet_Bounds(gltf_meshlet *Meshlet, u32 *Meshlet_Vertices, u8 *Meshlet_Triangles, float *Positions, idx Position_Stride)
+{
+   // NOTE: The sphere is centered on the meshlet's bounding box, which is
+   // looser than a minimal sphere but cheap and stable.
+   u32 *Vertices = Meshlet_Vertices + Meshlet->Vertex_Offset;
+   u8 *Triangles = Meshlet_Triangles + 3*Meshlet->Triangle_Offset;
+
+   vec3 Min = {0}, Max = {0};
+   for(u32 Vertex = 0; Vertex < Meshlet->Vertex_Count; ++Vertex)
+   {
+      float *P = Positions + Vertices[Vertex]*Position_Stride;
+      if(Vertex == 0)
+      {
+         Min = Max = (vec3){P[0], P[1], P[2]};
+      }
+      Min.X = Minimum(Min.X, P[0]); Max.X = Maximum(Max.X, P[0]);
+      Min.Y = Minimum(Min.Y, P[1]); Max.Y = Maximum(Max.Y, P[1]);
+      Min.Z = Minimum(Min.Z, P[2]); Max.Z = Maximum(Max.Z, P[2]);
+   }
+
+   vec3 Center = Mul_Vec3(Add_Vec3(Min, Max), 0.5f);
+   float Radius_Squared = 0.0f;
+   for(u32 Vertex = 0; Vertex < Meshlet->Vertex_Count; ++Vertex)
+   {
+      float *P = Positions + Vertices[Vertex]*Position_Stride;
+      Radius_Squared = Maximum(Radius_Squared, Length_Squared_Vec3(Sub_Vec3((vec3){P[0], P[1], P[2]}, Center)));
+   }
+
+   Meshlet->Center[0] = Center.X;
+   Meshlet->Center[1] = Center.Y;
+   Meshlet->Center[2] = Center.Z;
+   Meshlet->Radius = Square_Root(Radius_Squared);
+
+   // NOTE: The cone axis is the average of the triangle normals, and its
+   // spread is set by the normal that strays furthest from it. Degenerate
+   // triangles don't face any direction, so they're ignored.
+   vec3 Normals[MAX_MESHLET_TRIANGLE_COUNT];
+   vec3 Points[MAX_MESHLET_TRIANGLE_COUNT];
+   u32 Normal_Count = 0;
+
+   vec3 Axis = {0};
+   for(u32 Triangle = 0; Triangle < Meshlet->Triangle_Count; ++Triangle)
+   {
+      float *P0 = Positions + Vertices[Triangles[3*Triangle + 0]]*Position_Stride;
+      float *P1 = Positions + Vertices[Triangles[3*Triangle + 1]]*Position_Stride;
+      float *P2 = Positions + Vertices[Triangles[3*Triangle + 2]]*Position_Stride;
+
+      vec3 A = {P0[0], P0[1], P0[2]};
+      vec3 B = {P1[0], P1[1], P1[2]};
+      vec3 C = {P2[0], P2[1], P2[2]};
+
+      vec3 Normal = Cross_Vec3(Sub_Vec3(B, A), Sub_Vec3(C, A));
+      float Length = Length_Vec3(Normal);
+      if(Length > 0.0f)
+      {
+         Normals[Normal_Count] = Mul_Vec3(Normal, 1.0f / Length);
+         Points[Normal_Count] = A;
+         Axis = Add_Vec3(Axis, Normals[Normal_Count]);
+         Normal_Count++;
+      }
+   }
+
+   float Axis_Length = Length_Vec3(Axis);
+   float Min_Dot = 1.0f;
+   if(Normal_Count && Axis_Length > 0.0f)
+   {
+      Axis = Mul_Vec3(Axis, 1.0f / Axis_Length);
+      for(u32 Normal = 0; Normal < Normal_Count; ++Normal)
+      {
+         Min_Dot = Minimum(Min_Dot, Dot_Vec3(Axis, Normals[Normal]));
+      }
+   }
+   else
+   {
+      Min_Dot = -1.0f;
+   }
+
+   if(Min_Dot <= 0.1f)
+   {
+      // NOTE: The normals span (nearly) a hemisphere, so no single viewpoint
+      // sees every triangle's back.
+      Meshlet->Cone_Apex[0] = Center.X;
+      Meshlet->Cone_Apex[1] = Center.Y;
+      Meshlet->Cone_Apex[2] = Center.Z;
+      Meshlet->Cone_Axis[0] = 0.0f;
+      Meshlet->Cone_Axis[1] = 0.0f;
+      Meshlet->Cone_Axis[2] = 0.0f;
+      Meshlet->Cone_Cutoff = 1.0f;
+   }
+   else
+   {
+      // NOTE: Move the apex back along the axis until it lies behind every
+      // triangle's plane, so the test holds for cameras close to the meshlet.
+      float Max_T = 0.0f;
+      for(u32 Normal = 0; Normal < Normal_Count; ++Normal)
+      {
+         float Distance = Dot_Vec3(Sub_Vec3(Center, Points[Normal]), Normals[Normal]);
+         float Rate = Dot_Vec3(Axis, Normals[Normal]);
+         Max_T = Maximum(Max_T, Distance / Rate);
+      }
+
+      vec3 Apex = Sub_Vec3(Center, Mul_Vec3(Axis, Max_T));
+      Meshlet->Cone_Apex[0] = Apex.X;
+      Meshlet->Cone_Apex[1] = Apex.Y;
+      Meshlet->Cone_Apex[2] = Apex.Z;
+      Meshlet->Cone_Axis[0] = Axis.X;
+      Meshlet->Cone_Axis[1] = Axis.Y;
+      Meshlet->Cone_Axis[2] = Axis.Z;
+      Meshlet->Cone_Cutoff = Square_Root(1.0f - Min_Dot*Min_Dot);
+   }
+}
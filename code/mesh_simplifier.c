@@ -0,0 +1,672 @@
+/* (c) copyright 2025 Lawrence D. Kern /////////////////////////////////////// */
+
+// NOTE: Offline mesh simplification used by the baker to build LOD chains.
+// This is edge collapse driven by quadric error metrics (Garland and Heckbert,
+// "Surface Simplification Using Quadric Error Metrics", 1997). A vertex only
+// ever collapses onto one of its neighbors, so no vertices are created and
+// every level can index the primitive's original vertices.
+//
+// Vertices that share a position but differ in their other attributes are
+// called wedges, and they're treated as a single vertex when measuring error.
+// Each position is classified once up front: manifold positions can collapse
+// onto any neighbor, positions on an open border or an attribute seam can only
+// slide along it, and interior positions with a more complicated set of wedges
+// (as with flat shading) collapse wedge by wedge onto whichever wedge of the
+// target lies on the same side. Anything else stays put. Collapses are made
+// in passes, cheapest first, and every position a collapse touches is locked
+// for the rest of its pass so that the errors it was ranked by stay accurate.
+
+#define SIMPLIFIER_EDGE_WEIGHT 10.0f
+#define SIMPLIFIER_NO_VERTEX UINT32_MAX
+
+typedef enum {
+   SIMPLIFIER_VERTEX_MANIFOLD,
+   SIMPLIFIER_VERTEX_BORDER,
+   SIMPLIFIER_VERTEX_SEAM,
+   SIMPLIFIER_VERTEX_COMPLEX,
+   SIMPLIFIER_VERTEX_LOCKED,
+} simplifier_vertex_kind;
+
+typedef struct {
+   // NOTE: The weighted sum of squared distances to a set of planes, as the
+   // symmetric matrix A, vector B and constant C of p'Ap + 2B'p + C. Weight is
+   // kept so that errors can be averaged over the planes' total area.
+   float A00, A11, A22;
+   float A10, A20, A21;
+   float B0, B1, B2;
+   float C;
+   float Weight;
+} quadric;
+
+typedef struct {
+   u32 From;
+   u32 To;
+   float Error;
+} edge_collapse;
+
+typedef struct {
+   idx Vertex_Count;
+   float *Positions;
+   idx Position_Stride;
+
+   u32 *Position_Remap; // NOTE: First vertex with the same position.
+   u32 *Wedges;         // NOTE: Circular list of the vertices sharing a position.
+   u8 *Kinds;
+   u32 *Loops;          // NOTE: Target of a border or seam vertex's open edge.
+   u32 *Loopbacks;      // NOTE: Source of its open incoming edge.
+   quadric *Quadrics;   // NOTE: Indexed by position, so by Position_Remap.
+
+   idx Index_Count;
+   u32 *Indices;
+
+   float Error; // NOTE: Largest mean squared error of any collapse so far.
+} mesh_simplifier;
+
+static inline vec3 Get_Simplifier_Position(mesh_simplifier *Simplifier, u32 Vertex)
+{
+   float *P = Simplifier->Positions + Vertex*Simplifier->Position_Stride;
+   vec3 Result = {P[0], P[1], P[2]};
+   return(Result);
+}
+
+static inline bool Can_Collapse(simplifier_vertex_kind From, simplifier_vertex_kind To)
+{
+   // NOTE: Border and seam vertices also have to stay on their own loop, which
+   // is checked separately when picking edges.
+   bool Result = (From == SIMPLIFIER_VERTEX_MANIFOLD || From == SIMPLIFIER_VERTEX_COMPLEX ||
+                  (From == SIMPLIFIER_VERTEX_BORDER && To == SIMPLIFIER_VERTEX_BORDER) ||
+                  (From == SIMPLIFIER_VERTEX_SEAM && To == SIMPLIFIER_VERTEX_SEAM));
+   return(Result);
+}
+
+static void Add_Plane_Quadric(quadric *Quadric, vec3 Normal, float Distance, float Weight)
+{
+   // NOTE: The plane is Dot(Normal, p) + Distance = 0, with a unit normal.
+   Quadric->A00 += Weight * Normal.X * Normal.X;
+   Quadric->A11 += Weight * Normal.Y * Normal.Y;
+   Quadric->A22 += Weight * Normal.Z * Normal.Z;
+   Quadric->A10 += Weight * Normal.Y * Normal.X;
+   Quadric->A20 += Weight * Normal.Z * Normal.X;
+   Quadric->A21 += Weight * Normal.Z * Normal.Y;
+   Quadric->B0 += Weight * Distance * Normal.X;
+   Quadric->B1 += Weight * Distance * Normal.Y;
+   Quadric->B2 += Weight * Distance * Normal.Z;
+   Quadric->C += Weight * Distance * Distance;
+   Quadric->Weight += Weight;
+}
+
+static void Add_Quadric(quadric *Quadric, quadric *Other)
+{
+   Quadric->A00 += Other->A00;
+   Quadric->A11 += Other->A11;
+   Quadric->A22 += Other->A22;
+   Quadric->A10 += Other->A10;
+   Quadric->A20 += Other->A20;
+   Quadric->A21 += Other->A21;
+   Quadric->B0 += Other->B0;
+   Quadric->B1 += Other->B1;
+   Quadric->B2 += Other->B2;
+   Quadric->C += Other->C;
+   Quadric->Weight += Other->Weight;
+}
+
+static inline float Get_Quadric_Error(quadric *Q, vec3 P)
+{
+   // NOTE: The sum is never negative in exact arithmetic, but rounding can
+   // push a near zero error below it.
+   float RX = Q->A00*P.X + Q->A10*P.Y + Q->A20*P.Z;
+   float RY = Q->A10*P.X + Q->A11*P.Y + Q->A21*P.Z;
+   float RZ = Q->A20*P.X + Q->A21*P.Y + Q->A22*P.Z;
+
+   float Result = RX*P.X + RY*P.Y + RZ*P.Z + 2.0f*(Q->B0*P.X + Q->B1*P.Y + Q->B2*P.Z) + Q->C;
+   return(Absolute(Result));
+}
+
+static float Get_Collapse_Error(mesh_simplifier *Simplifier, u32 From, u32 To)
+{
+   // NOTE: The mean squared distance from the merged vertex's planes, were the
+   // collapse made.
+   quadric *From_Quadric = Simplifier->Quadrics + Simplifier->Position_Remap[From];
+   quadric *To_Quadric = Simplifier->Quadrics + Simplifier->Position_Remap[To];
+   vec3 P = Get_Simplifier_Position(Simplifier, To);
+
+   float Weight = From_Quadric->Weight + To_Quadric->Weight;
+   float Error = Get_Quadric_Error(From_Quadric, P) + Get_Quadric_Error(To_Quadric, P);
+
+   float Result = (Weight > 0.0f) ? Error / Weight : Error;
+   return(Result);
+}
+
+static bool Has_Directed_Edge(vertex_triangle_adjacency *Adjacency, u32 *Indices, u32 A, u32 B)
+{
+   bool Result = false;
+   for(u32 Entry = Adjacency->Offsets[A]; !Result && Entry < Adjacency->Offsets[A + 1]; ++Entry)
+   {
+      u32 *Triangle = Indices + 3*Adjacency->Triangles[Entry];
+      Result = ((Triangle[0] == A && Triangle[1] == B) ||
+                (Triangle[1] == A && Triangle[2] == B) ||
+                (Triangle[2] == A && Triangle[0] == B));
+   }
+
+   return(Result);
+}
+
+static idx Remove_Degenerate_Triangles(mesh_simplifier *Simplifier, u32 *Collapse_Remap)
+{
+   // NOTE: Applies the collapses, if any, then drops every triangle with two
+   // corners at the same position. Returns the new index count.
+   u32 *Indices = Simplifier->Indices;
+   u32 *Remap = Simplifier->Position_Remap;
+
+   idx Result = 0;
+   for(idx Index = 0; Index + 2 < Simplifier->Index_Count; Index += 3)
+   {
+      u32 A = Collapse_Remap ? Collapse_Remap[Indices[Index + 0]] : Indices[Index + 0];
+      u32 B = Collapse_Remap ? Collapse_Remap[Indices[Index + 1]] : Indices[Index + 1];
+      u32 C = Collapse_Remap ? Collapse_Remap[Indices[Index + 2]] : Indices[Index + 2];
+      if(Remap[A] != Remap[B] && Remap[B] != Remap[C] && Remap[C] != Remap[A])
+      {
+         Indices[Result++] = A;
+         Indices[Result++] = B;
+         Indices[Result++] = C;
+      }
+   }
+
+   return(Result);
+}
+
+static mesh_simplifier Begin_Mesh_Simplification(arena *Arena, u32 *Indices, idx Index_Count,
+                                                 float *Positions, idx Position_Stride, idx Vertex_Count)
+{
+   // NOTE: Position_Stride is in floats. The simplifier keeps its own copy of
+   // the indices, which each call to Simplify_Mesh reduces further. Temporary
+   // work uses the arena's space past the simplifier's own arrays.
+   mesh_simplifier Result = {0};
+   Result.Vertex_Count = Vertex_Count;
+   Result.Positions = Positions;
+   Result.Position_Stride = Position_Stride;
+
+   Result.Position_Remap = Allocate(Arena, u32, Vertex_Count);
+   Result.Wedges = Allocate(Arena, u32, Vertex_Count);
+   Result.Kinds = Allocate(Arena, u8, Vertex_Count);
+   Result.Loops = Allocate(Arena, u32, Vertex_Count);
+   Result.Loopbacks = Allocate(Arena, u32, Vertex_Count);
+   Result.Quadrics = Allocate(Arena, quadric, Vertex_Count);
+
+   Result.Index_Count = Index_Count;
+   Result.Indices = Allocate(Arena, u32, Index_Count);
+   Copy_Memory(Result.Indices, Indices, Index_Count*sizeof(u32));
+
+   arena Scratch = *Arena;
+
+   // NOTE: Find the wedges of each position with an open addressing table
+   // keyed on the position's bits.
+   idx Table_Size = 1;
+   while(Table_Size < 2*Vertex_Count)
+   {
+      Table_Size <<= 1;
+   }
+
+   u32 *Table = Allocate(&Scratch, u32, Table_Size);
+   for(idx Slot = 0; Slot < Table_Size; ++Slot)
+   {
+      Table[Slot] = SIMPLIFIER_NO_VERTEX;
+   }
+
+   for(u32 Vertex = 0; Vertex < Vertex_Count; ++Vertex)
+   {
+      u8 *Bytes = (u8 *)(Positions + Vertex*Position_Stride);
+      u32 Hash = 2166136261u;
+      for(idx Byte = 0; Byte < (idx)(3*sizeof(float)); ++Byte)
+      {
+         Hash = (Hash ^ Bytes[Byte]) * 16777619u;
+      }
+
+      idx Slot = Hash & (Table_Size - 1);
+      while(Table[Slot] != SIMPLIFIER_NO_VERTEX && memcmp(Positions + Table[Slot]*Position_Stride, Bytes, 3*sizeof(float)) != 0)
+      {
+         Slot = (Slot + 1) & (Table_Size - 1);
+      }
+
+      if(Table[Slot] == SIMPLIFIER_NO_VERTEX)
+      {
+         Table[Slot] = Vertex;
+         Result.Position_Remap[Vertex] = Vertex;
+         Result.Wedges[Vertex] = Vertex;
+      }
+      else
+      {
+         u32 First = Table[Slot];
+         Result.Position_Remap[Vertex] = First;
+         Result.Wedges[Vertex] = Result.Wedges[First];
+         Result.Wedges[First] = Vertex;
+      }
+   }
+
+   Result.Index_Count = Remove_Degenerate_Triangles(&Result, 0);
+   Indices = Result.Indices;
+   Index_Count = Result.Index_Count;
+
+   // NOTE: An edge is open when no triangle uses it in the other direction.
+   // Border edges are open, and so are seam edges, since the triangles on
+   // either side of a seam use different wedges. Each vertex remembers the
+   // one open edge in and out of it, or itself when it has more than one.
+   vertex_triangle_adjacency Adjacency = Build_Vertex_Triangle_Adjacency(&Scratch, Indices, Index_Count, Vertex_Count);
+   u32 *Open_In = Result.Loopbacks;
+   u32 *Open_Out = Result.Loops;
+   for(u32 Vertex = 0; Vertex < Vertex_Count; ++Vertex)
+   {
+      Open_In[Vertex] = SIMPLIFIER_NO_VERTEX;
+      Open_Out[Vertex] = SIMPLIFIER_NO_VERTEX;
+   }
+
+   for(idx Index = 0; Index < Index_Count; Index += 3)
+   {
+      u32 *Triangle = Indices + Index;
+      vec3 P0 = Get_Simplifier_Position(&Result, Triangle[0]);
+      vec3 P1 = Get_Simplifier_Position(&Result, Triangle[1]);
+      vec3 P2 = Get_Simplifier_Position(&Result, Triangle[2]);
+
+      // NOTE: Every triangle adds its plane to its corners, weighted by area.
+      vec3 Normal = Cross_Vec3(Sub_Vec3(P1, P0), Sub_Vec3(P2, P0));
+      float Double_Area = Length_Vec3(Normal);
+      if(Double_Area > 0.0f)
+      {
+         Normal = Mul_Vec3(Normal, 1.0f / Double_Area);
+         float Distance = -Dot_Vec3(Normal, P0);
+         for(int Corner = 0; Corner < 3; ++Corner)
+         {
+            Add_Plane_Quadric(Result.Quadrics + Result.Position_Remap[Triangle[Corner]], Normal, Distance, 0.5f*Double_Area);
+         }
+      }
+
+      for(int Corner = 0; Corner < 3; ++Corner)
+      {
+         u32 A = Triangle[Corner];
+         u32 B = Triangle[(Corner + 1) % 3];
+         u32 C = Triangle[(Corner + 2) % 3];
+         if(Has_Directed_Edge(&Adjacency, Indices, B, A))
+         {
+            continue;
+         }
+
+         Open_Out[A] = (Open_Out[A] == SIMPLIFIER_NO_VERTEX) ? B : A;
+         Open_In[B] = (Open_In[B] == SIMPLIFIER_NO_VERTEX) ? A : B;
+
+         // NOTE: Open edges also add a plane perpendicular to their triangle,
+         // so that moving a vertex off the border or seam costs error too.
+         vec3 PA = Get_Simplifier_Position(&Result, A);
+         vec3 Edge = Sub_Vec3(Get_Simplifier_Position(&Result, B), PA);
+         float Length = Length_Vec3(Edge);
+         if(Length > 0.0f)
+         {
+            Edge = Mul_Vec3(Edge, 1.0f / Length);
+            vec3 To_C = Sub_Vec3(Get_Simplifier_Position(&Result, C), PA);
+            vec3 Perpendicular = Normalize_Vec3(Sub_Vec3(To_C, Mul_Vec3(Edge, Dot_Vec3(To_C, Edge))));
+            float Distance = -Dot_Vec3(Perpendicular, PA);
+            float Weight = SIMPLIFIER_EDGE_WEIGHT * Length * Length;
+
+            Add_Plane_Quadric(Result.Quadrics + Result.Position_Remap[A], Perpendicular, Distance, Weight);
+            Add_Plane_Quadric(Result.Quadrics + Result.Position_Remap[B], Perpendicular, Distance, Weight);
+         }
+      }
+   }
+
+   // NOTE: Positions with any open edge between positions, rather than
+   // between vertices, lie on a border.
+   u32 *Position_Indices = Allocate(&Scratch, u32, Index_Count);
+   for(idx Index = 0; Index < Index_Count; ++Index)
+   {
+      Position_Indices[Index] = Result.Position_Remap[Indices[Index]];
+   }
+
+   vertex_triangle_adjacency Position_Adjacency = Build_Vertex_Triangle_Adjacency(&Scratch, Position_Indices, Index_Count, Vertex_Count);
+   u8 *Position_Open = Allocate(&Scratch, u8, Vertex_Count);
+   for(idx Index = 0; Index < Index_Count; Index += 3)
+   {
+      u32 *Triangle = Position_Indices + Index;
+      for(int Corner = 0; Corner < 3; ++Corner)
+      {
+         u32 A = Triangle[Corner];
+         u32 B = Triangle[(Corner + 1) % 3];
+         if(!Has_Directed_Edge(&Position_Adjacency, Position_Indices, B, A))
+         {
+            Position_Open[A] = 1;
+            Position_Open[B] = 1;
+         }
+      }
+   }
+
+   for(u32 Vertex = 0; Vertex < Vertex_Count; ++Vertex)
+   {
+      if(Result.Position_Remap[Vertex] != Vertex)
+      {
+         continue;
+      }
+
+      simplifier_vertex_kind Kind = SIMPLIFIER_VERTEX_LOCKED;
+      u32 Wedge = Result.Wedges[Vertex];
+      if(Wedge == Vertex)
+      {
+         // NOTE: A border vertex has exactly one open edge in and one out.
+         u32 In = Open_In[Vertex];
+         u32 Out = Open_Out[Vertex];
+         if(In == SIMPLIFIER_NO_VERTEX && Out == SIMPLIFIER_NO_VERTEX)
+         {
+            Kind = SIMPLIFIER_VERTEX_MANIFOLD;
+         }
+         else if(In != SIMPLIFIER_NO_VERTEX && Out != SIMPLIFIER_NO_VERTEX && In != Vertex && Out != Vertex)
+         {
+            Kind = SIMPLIFIER_VERTEX_BORDER;
+         }
+      }
+      else if(Result.Wedges[Wedge] == Vertex)
+      {
+         // NOTE: A seam vertex has two wedges, each with one open edge in and
+         // one out, and the two sides have to run between the same positions
+         // in opposite directions.
+         u32 In_V = Open_In[Vertex], Out_V = Open_Out[Vertex];
+         u32 In_W = Open_In[Wedge], Out_W = Open_Out[Wedge];
+         if(In_V != SIMPLIFIER_NO_VERTEX && In_V != Vertex && Out_V != SIMPLIFIER_NO_VERTEX && Out_V != Vertex &&
+            In_W != SIMPLIFIER_NO_VERTEX && In_W != Wedge && Out_W != SIMPLIFIER_NO_VERTEX && Out_W != Wedge &&
+            Result.Position_Remap[In_V] == Result.Position_Remap[Out_W] &&
+            Result.Position_Remap[Out_V] == Result.Position_Remap[In_W] &&
+            Result.Position_Remap[In_V] != Result.Position_Remap[Out_V])
+         {
+            Kind = SIMPLIFIER_VERTEX_SEAM;
+         }
+      }
+
+      if(Kind == SIMPLIFIER_VERTEX_LOCKED && Wedge != Vertex && !Position_Open[Vertex])
+      {
+         Kind = SIMPLIFIER_VERTEX_COMPLEX;
+      }
+
+      Result.Kinds[Vertex] = (u8)Kind;
+   }
+
+   for(u32 Vertex = 0; Vertex < Vertex_Count; ++Vertex)
+   {
+      Result.Kinds[Vertex] = Result.Kinds[Result.Position_Remap[Vertex]];
+   }
+
+   return(Result);
+}
+
+static void Sort_Edge_Collapses(edge_collapse *Collapses, idx Count, arena Scratch)
+{
+   // NOTE: Errors are never negative, so their bits sort the same way their
+   // values do. Two 16-bit radix passes sort by them while keeping collapses
+   // with equal errors in order, and leave the result back in Collapses.
+   edge_collapse *Sorted = Allocate(&Scratch, edge_collapse, Count);
+   u32 *Offsets = Allocate(&Scratch, u32, 65536);
+
+   edge_collapse *From = Collapses;
+   edge_collapse *To = Sorted;
+   for(int Shift = 0; Shift < 32; Shift += 16)
+   {
+      Zero_Memory(Offsets, 65536*sizeof(u32));
+      for(idx Index = 0; Index < Count; ++Index)
+      {
+         u32 Bits;
+         memcpy(&Bits, &From[Index].Error, sizeof(Bits));
+         Offsets[(Bits >> Shift) & 0xFFFF]++;
+      }
+
+      u32 Total = 0;
+      for(int Bucket = 0; Bucket < 65536; ++Bucket)
+      {
+         u32 Bucket_Count = Offsets[Bucket];
+         Offsets[Bucket] = Total;
+         Total += Bucket_Count;
+      }
+
+      for(idx Index = 0; Index < Count; ++Index)
+      {
+         u32 Bits;
+         memcpy(&Bits, &From[Index].Error, sizeof(Bits));
+         To[Offsets[(Bits >> Shift) & 0xFFFF]++] = From[Index];
+      }
+
+      edge_collapse *Swap = From;
+      From = To;
+      To = Swap;
+   }
+}
+
+static idx Pick_Edge_Collapses(mesh_simplifier *Simplifier, edge_collapse *Collapses)
+{
+   // NOTE: Lists each collapsible edge once, in whichever allowed direction
+   // costs less. Collapses needs room for Index_Count entries.
+   idx Result = 0;
+   u32 *Indices = Simplifier->Indices;
+   u32 *Remap = Simplifier->Position_Remap;
+
+   for(idx Index = 0; Index < Simplifier->Index_Count; Index += 3)
+   {
+      for(int Corner = 0; Corner < 3; ++Corner)
+      {
+         u32 V0 = Indices[Index + Corner];
+         u32 V1 = Indices[Index + (Corner + 1) % 3];
+         simplifier_vertex_kind K0 = Simplifier->Kinds[V0];
+         simplifier_vertex_kind K1 = Simplifier->Kinds[V1];
+
+         bool Forward = Can_Collapse(K0, K1);
+         bool Backward = Can_Collapse(K1, K0);
+         if(!Forward && !Backward)
+         {
+            continue;
+         }
+
+         // NOTE: Two border or seam vertices can be joined by an edge that
+         // cuts across the surface rather than running along their loop.
+         if(K0 == K1 && (K0 == SIMPLIFIER_VERTEX_BORDER || K0 == SIMPLIFIER_VERTEX_SEAM) && Simplifier->Loops[V0] != V1)
+         {
+            continue;
+         }
+
+         // NOTE: Border edges belong to one triangle, but every other edge is
+         // seen from both of its sides and only needs to be listed once.
+         bool Border_Edge = (K0 == SIMPLIFIER_VERTEX_BORDER && K1 == SIMPLIFIER_VERTEX_BORDER);
+         if(!Border_Edge && Remap[V0] > Remap[V1])
+         {
+            continue;
+         }
+
+         edge_collapse *Collapse = Collapses + Result++;
+         float Forward_Error = Forward ? Get_Collapse_Error(Simplifier, V0, V1) : 0;
+         float Backward_Error = Backward ? Get_Collapse_Error(Simplifier, V1, V0) : 0;
+         if(Forward && (!Backward || Forward_Error <= Backward_Error))
+         {
+            Collapse->From = V0;
+            Collapse->To = V1;
+            Collapse->Error = Forward_Error;
+         }
+         else
+         {
+            Collapse->From = V1;
+            Collapse->To = V0;
+            Collapse->Error = Backward_Error;
+         }
+      }
+   }
+
+   return(Result);
+}
+
+static bool Collapse_Flips_Triangles(mesh_simplifier *Simplifier, vertex_triangle_adjacency *Adjacency, u32 *Collapse_Remap, u32 From, u32 To)
+{
+   // NOTE: Checks every surviving triangle around From's position, including
+   // the effect of collapses already made this pass.
+   vec3 From_Position = Get_Simplifier_Position(Simplifier, From);
+   vec3 To_Position = Get_Simplifier_Position(Simplifier, To);
+   u32 To_Remap = Simplifier->Position_Remap[To];
+
+   u32 Wedge = From;
+   do
+   {
+      for(u32 Entry = Adjacency->Offsets[Wedge]; Entry < Adjacency->Offsets[Wedge + 1]; ++Entry)
+      {
+         u32 *Triangle = Simplifier->Indices + 3*Adjacency->Triangles[Entry];
+         int Corner = (Triangle[0] == Wedge) ? 0 : (Triangle[1] == Wedge) ? 1 : 2;
+         u32 A = Collapse_Remap[Triangle[(Corner + 1) % 3]];
+         u32 B = Collapse_Remap[Triangle[(Corner + 2) % 3]];
+         if(Simplifier->Position_Remap[A] == To_Remap || Simplifier->Position_Remap[B] == To_Remap)
+         {
+            continue;
+         }
+
+         // NOTE: Turning a triangle by more than about 75 degrees is rejected
+         // along with outright flips, since a few turns just short of 90
+         // degrees would add up to a flip.
+         vec3 PA = Get_Simplifier_Position(Simplifier, A);
+         vec3 Edge = Sub_Vec3(Get_Simplifier_Position(Simplifier, B), PA);
+         vec3 Before = Cross_Vec3(Edge, Sub_Vec3(From_Position, PA));
+         vec3 After = Cross_Vec3(Edge, Sub_Vec3(To_Position, PA));
+         if(Dot_Vec3(Before, After) <= 0.25f*Square_Root(Length_Squared_Vec3(Before)*Length_Squared_Vec3(After)))
+         {
+            return(true);
+         }
+      }
+
+      Wedge = Simplifier->Wedges[Wedge];
+   } while(Wedge != From);
+
+   return(false);
+}
+
+static void Remap_Edge_Loops(u32 *Loops, idx Vertex_Count, u32 *Collapse_Remap)
+{
+   for(u32 Vertex = 0; Vertex < Vertex_Count; ++Vertex)
+   {
+      u32 Loop = Loops[Vertex];
+      if(Loop != SIMPLIFIER_NO_VERTEX && Loop != Vertex)
+      {
+         // NOTE: When an edge collapses against the loop's direction, the
+         // vertex collapses onto itself and takes over the next edge instead.
+         u32 Target = Collapse_Remap[Loop];
+         Loops[Vertex] = (Target == Vertex) ? Loops[Loop] : Target;
+      }
+   }
+}
+
+static idx Simplify_Mesh(mesh_simplifier *Simplifier, idx Target_Index_Count, arena Scratch)
+{
+   // NOTE: Collapses edges until at most Target_Index_Count indices remain or
+   // nothing more can be collapsed, and returns the new index count. Error is
+   // updated to the largest collapse error so far.
+   idx Vertex_Count = Simplifier->Vertex_Count;
+   u32 *Remap = Simplifier->Position_Remap;
+
+   while(Simplifier->Index_Count > Target_Index_Count)
+   {
+      arena Pass_Scratch = Scratch;
+      vertex_triangle_adjacency Adjacency = Build_Vertex_Triangle_Adjacency(&Pass_Scratch, Simplifier->Indices, Simplifier->Index_Count, Vertex_Count);
+
+      edge_collapse *Collapses = Allocate(&Pass_Scratch, edge_collapse, Simplifier->Index_Count);
+      idx Collapse_Count = Pick_Edge_Collapses(Simplifier, Collapses);
+      if(Collapse_Count == 0)
+      {
+         break;
+      }
+      Sort_Edge_Collapses(Collapses, Collapse_Count, Pass_Scratch);
+
+      u32 *Collapse_Remap = Allocate(&Pass_Scratch, u32, Vertex_Count);
+      u8 *Locked = Allocate(&Pass_Scratch, u8, Vertex_Count);
+      for(u32 Vertex = 0; Vertex < Vertex_Count; ++Vertex)
+      {
+         Collapse_Remap[Vertex] = Vertex;
+      }
+
+      // NOTE: Most collapses remove two triangles, so about half the goal's
+      // worth of edges is collapsed per pass. The error limit stops a pass from
+      // reaching much further up the list than that, since edges locked this
+      // pass might turn out cheaper than those in the next. If every edge under
+      // the limit is blocked, the pass is retried without it.
+      idx Triangle_Goal = Maximum((Simplifier->Index_Count - Target_Index_Count) / 3, 1);
+      float Error_Limit = 1.5f * Collapses[Minimum(Triangle_Goal, Collapse_Count - 1)].Error;
+      idx Triangles_Removed = 0;
+
+      for(int Attempt = 0; Attempt < 2 && Triangles_Removed == 0; ++Attempt)
+      {
+         for(idx Collapse_Index = 0; Collapse_Index < Collapse_Count; ++Collapse_Index)
+         {
+            edge_collapse *Collapse = Collapses + Collapse_Index;
+            if(Triangles_Removed >= Triangle_Goal || Collapse->Error > Error_Limit)
+            {
+               break;
+            }
+
+            u32 From = Collapse->From;
+            u32 To = Collapse->To;
+            if(Locked[Remap[From]] || Locked[Remap[To]] ||
+               Collapse_Flips_Triangles(Simplifier, &Adjacency, Collapse_Remap, From, To))
+            {
+               continue;
+            }
+
+            simplifier_vertex_kind Kind = Simplifier->Kinds[From];
+            if(Kind == SIMPLIFIER_VERTEX_SEAM)
+            {
+               // NOTE: The wedge on the other side of the seam collapses onto
+               // the wedge of To on its side, which its own loop leads to.
+               // Collapsing a complex vertex at the end of a seam can leave the
+               // loop leading elsewhere, and then the seam has to stay put.
+               u32 Other_From = Simplifier->Wedges[From];
+               u32 Other_To = (Simplifier->Loops[From] == To) ? Simplifier->Loopbacks[Other_From] : Simplifier->Loops[Other_From];
+               if(Other_To == SIMPLIFIER_NO_VERTEX || Remap[Other_To] != Remap[To])
+               {
+                  continue;
+               }
+
+               Collapse_Remap[Other_From] = Other_To;
+            }
+            else if(Kind == SIMPLIFIER_VERTEX_COMPLEX)
+            {
+               // NOTE: Each wedge moves onto a wedge of To it shares a triangle
+               // with, so that it keeps the attributes of its own side where it
+               // can, and onto To itself otherwise.
+               u32 Wedge = From;
+               do
+               {
+                  Collapse_Remap[Wedge] = To;
+                  for(u32 Entry = Adjacency.Offsets[Wedge]; Entry < Adjacency.Offsets[Wedge + 1]; ++Entry)
+                  {
+                     u32 *Triangle = Simplifier->Indices + 3*Adjacency.Triangles[Entry];
+                     for(int Corner = 0; Corner < 3; ++Corner)
+                     {
+                        if(Remap[Triangle[Corner]] == Remap[To])
+                        {
+                           Collapse_Remap[Wedge] = Triangle[Corner];
+                        }
+                     }
+                  }
+
+                  Wedge = Simplifier->Wedges[Wedge];
+               } while(Wedge != From);
+            }
+            Collapse_Remap[From] = To;
+
+            Add_Quadric(Simplifier->Quadrics + Remap[To], Simplifier->Quadrics + Remap[From]);
+            Locked[Remap[From]] = 1;
+            Locked[Remap[To]] = 1;
+
+            Simplifier->Error = Maximum(Simplifier->Error, Collapse->Error);
+            Triangles_Removed += (Kind == SIMPLIFIER_VERTEX_BORDER) ? 1 : 2;
+         }
+
+         Error_Limit = Collapses[Collapse_Count - 1].Error;
+      }
+
+      if(Triangles_Removed == 0)
+      {
+         break;
+      }
+
+      Simplifier->Index_Count = Remove_Degenerate_Triangles(Simplifier, Collapse_Remap);
+      Remap_Edge_Loops(Simplifier->Loops, Vertex_Count, Collapse_Remap);
+      Remap_Edge_Loops(Simplifier->Loopbacks, Vertex_Count, Collapse_Remap);
+   }
+
+   return(Simplifier->Index_Count);
+}
@@ -11,5 +11,77 @@ static READ_ENTIRE_FILE(Read_Entire_File);
 #define FREE_ENTIRE_FILE(Name) void Name(u8 *Data, idx Length)
 static FREE_ENTIRE_FILE(Free_Entire_File);
 
+// NOTE: Mapped files are read-only views of the file itself rather than copies,
+// and are not null terminated.
+#define MAP_ENTIRE_FILE(Name) string Name(char *Path)
+static MAP_ENTIRE_FILE(Map_Entire_File);
+
+#define UNMAP_ENTIRE_FILE(Name) void Name(u8 *Data, idx Length)
+static UNMAP_ENTIRE_FILE(Unmap_Entire_File);
+
+// NOTE: Files are written to a temporary name next to Path and then renamed
+// over it, so nothing reading Path ever sees a partial file.
+#define WRITE_ENTIRE_FILE(Name) bool Name(char *Path, u8 *Data, idx Length)
+static WRITE_ENTIRE_FILE(Write_Entire_File);
+
+// NOTE: Succeeds if the directory already exists.
+#define MAKE_DIRECTORY(Name) bool Name(char *Path)
+static MAKE_DIRECTORY(Make_Directory);
+
+// NOTE: Reports the size and last modification time of the file at Path,
+// without opening it. Modified is in whatever units the platform keeps, so it
+// is only good for telling whether a file changed. Returns false (and leaves
+// both zeroed) if there is no such file.
+#define GET_FILE_STAMP(Name) bool Name(char *Path, u64 *Size, u64 *Modified)
+static GET_FILE_STAMP(Get_File_Stamp);
+
+// NOTE: Seconds on a monotonic clock, for timing things that span frames.
+#define GET_SECONDS(Name) double Name(void)
+static GET_SECONDS(Get_Seconds);
+
 #define GET_WINDOW_DIMENSIONS(Name) void Name(void *Platform_Context, int *Width, int *Height)
 static GET_WINDOW_DIMENSIONS(Get_Window_Dimensions);
+
+// NOTE: Work queues hand jobs to a pool of worker threads. Entries may only be
+// added from a single thread (the one driving the renderer), but may be run by
+// any worker. Callbacks receive the index of the thread running them, which is
+// always below MAX_WORK_QUEUE_THREAD_COUNT, so that per-thread state can be
+// indexed without locking. Index 0 is the thread that calls Complete_All_Work.
+#define MAX_WORK_QUEUE_THREAD_COUNT 64
+
+typedef struct platform_work_queue platform_work_queue;
+
+#define WORK_QUEUE_CALLBACK(Name) void Name(platform_work_queue *Queue, int Thread_Index, void *Data)
+typedef WORK_QUEUE_CALLBACK(work_queue_callback);
+
+#define GET_WORK_QUEUE(Name) platform_work_queue *Name(void *Platform_Context)
+static GET_WORK_QUEUE(Get_Work_Queue);
+
+#define GET_WORK_QUEUE_THREAD_COUNT(Name) int Name(platform_work_queue *Queue)
+static GET_WORK_QUEUE_THREAD_COUNT(Get_Work_Queue_Thread_Count);
+
+#define ADD_WORK_QUEUE_ENTRY(Name) void Name(platform_work_queue *Queue, work_queue_callback *Callback, void *Data)
+static ADD_WORK_QUEUE_ENTRY(Add_Work_Queue_Entry);
+
+#define COMPLETE_ALL_WORK(Name) void Name(platform_work_queue *Queue)
+static COMPLETE_ALL_WORK(Complete_All_Work);
+
+// NOTE: File watchers report files in watched directories that were written or
+// moved into place, for reloading assets while the renderer runs. Only whole
+// files are reported: a file being written shows up once it's closed. Changes
+// are polled, so a file changed several times between polls may be reported
+// more than once.
+typedef struct platform_file_watcher platform_file_watcher;
+
+#define GET_FILE_WATCHER(Name) platform_file_watcher *Name(void *Platform_Context)
+static GET_FILE_WATCHER(Get_File_Watcher);
+
+// NOTE: Watching a directory that's already watched does nothing.
+#define WATCH_DIRECTORY(Name) bool Name(platform_file_watcher *Watcher, char *Path)
+static WATCH_DIRECTORY(Watch_Directory);
+
+// NOTE: Writes the path of the next changed file, as the watched directory's
+// path followed by the file name, to Path. Returns false once there are no
+// more changes to report, and never waits for one.
+#define NEXT_CHANGED_FILE(Name) bool Name(platform_file_watcher *Watcher, char *Path, idx Size)
+static NEXT_CHANGED_FILE(Next_Changed_File);
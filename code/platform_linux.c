@@ -3,7 +3,11 @@
 // NOTE: This file contains platform-specific code for Linux, intended to be
 // shared by the different windowing system entry points (Wayland, Xlib).
 
+#include <errno.h>
 #include <fcntl.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sys/inotify.h>
 #include <sys/stat.h>
 #include <sys/mman.h>
 #include <unistd.h>
@@ -100,6 +104,364 @@ static FREE_ENTIRE_FILE(Free_Entire_File)
    }
 }
 
+static MAP_ENTIRE_FILE(Map_Entire_File)
+{
+   string Result = {0};
+
+   int File = open(Path, O_RDONLY);
+   if(File == -1)
+   {
+      Log("Failed to open file %s.\n", Path);
+   }
+   else
+   {
+      struct stat File_Information;
+      if(fstat(File, &File_Information) != 0 || File_Information.st_size == 0)
+      {
+         Log("Failed to determine size of file %s.\n", Path);
+      }
+      else
+      {
+         idx Length = File_Information.st_size;
+         u8 *Data = mmap(0, Length, PROT_READ, MAP_PRIVATE, File, 0);
+         if(Data == MAP_FAILED)
+         {
+            Log("Failed to map file %s.\n", Path);
+         }
+         else
+         {
+            // NOTE: Assets are consumed front to back almost immediately, so ask
+            // for aggressive read-ahead and start paging the file in now.
+            madvise(Data, Length, MADV_SEQUENTIAL);
+            madvise(Data, Length, MADV_WILLNEED);
+
+            Result.Data = Data;
+            Result.Length = Length;
+         }
+      }
+
+      // NOTE: The mapping remains valid after the descriptor is closed.
+      close(File);
+   }
+
+   return(Result);
+}
+
+static UNMAP_ENTIRE_FILE(Unmap_Entire_File)
+{
+   if(munmap(Data, Length) == -1)
+   {
+      Log("Failed to unmap mapped file.\n");
+   }
+}
+
+static WRITE_ENTIRE_FILE(Write_Entire_File)
+{
+   bool Result = false;
+
+   // NOTE: mkstemp picks a unique temporary name, so threads writing the same
+   // path at once can't trample each other's partial files.
+   char Temporary_Path[512];
+   int File = -1;
+   if(snprintf(Temporary_Path, sizeof(Temporary_Path), "%s.XXXXXX", Path) < (int)sizeof(Temporary_Path))
+   {
+      File = mkstemp(Temporary_Path);
+   }
+
+   if(File == -1)
+   {
+      Log("Failed to create a temporary file for %s.\n", Path);
+   }
+   else
+   {
+      // NOTE: mkstemp only lets the owner read the file.
+      fchmod(File, 0644);
+
+      idx Written = 0;
+      while(Written < Length)
+      {
+         idx Single_Write = write(File, Data+Written, Length-Written);
+         if(Single_Write <= 0)
+         {
+            break; // NOTE: Failed write, number of bytes written is checked below.
+         }
+         Written += Single_Write;
+      }
+      close(File);
+
+      if(Written != Length)
+      {
+         Log("Failed to write entire file %s, (%ld of %ld bytes written).\n", Path, Written, Length);
+         unlink(Temporary_Path);
+      }
+      else if(rename(Temporary_Path, Path) != 0)
+      {
+         Log("Failed to rename %s to %s.\n", Temporary_Path, Path);
+         unlink(Temporary_Path);
+      }
+      else
+      {
+         Result = true;
+      }
+   }
+
+   return(Result);
+}
+
+static MAKE_DIRECTORY(Make_Directory)
+{
+   bool Result = (mkdir(Path, 0755) == 0 || errno == EEXIST);
+   if(!Result)
+   {
+      Log("Failed to make directory %s.\n", Path);
+   }
+
+   return(Result);
+}
+
+static GET_FILE_STAMP(Get_File_Stamp)
+{
+   *Size = 0;
+   *Modified = 0;
+
+   struct stat File_Information;
+   bool Result = (stat(Path, &File_Information) == 0);
+   if(Result)
+   {
+      *Size = (u64)File_Information.st_size;
+      *Modified = (u64)File_Information.st_mtim.tv_sec*1000000000 + (u64)File_Information.st_mtim.tv_nsec;
+   }
+
+   return(Result);
+}
+
+static GET_SECONDS(Get_Seconds)
+{
+   struct timespec Time;
+   clock_gettime(CLOCK_MONOTONIC, &Time);
+
+   double Result = (double)Time.tv_sec + (double)Time.tv_nsec / 1000000000.0;
+   return(Result);
+}
+
+#define WORK_QUEUE_ENTRY_COUNT 256
+
+typedef struct {
+   work_queue_callback *Callback;
+   void *Data;
+} platform_work_queue_entry;
+
+typedef struct {
+   platform_work_queue *Queue;
+   int Thread_Index;
+} platform_work_thread;
+
+struct platform_work_queue {
+   u32 volatile Completion_Goal;
+   u32 volatile Completion_Count;
+
+   u32 volatile Next_Entry_To_Write;
+   u32 volatile Next_Entry_To_Read;
+   sem_t Semaphore;
+
+   platform_work_queue_entry Entries[WORK_QUEUE_ENTRY_COUNT];
+
+   int Thread_Count;
+   platform_work_thread Threads[MAX_WORK_QUEUE_THREAD_COUNT];
+};
+
+static bool Do_Next_Work_Queue_Entry(platform_work_queue *Queue, int Thread_Index)
+{
+   bool Should_Sleep = false;
+
+   u32 Original_Next_Entry_To_Read = Atomic_Load_U32(&Queue->Next_Entry_To_Read);
+   u32 New_Next_Entry_To_Read = (Original_Next_Entry_To_Read + 1) % WORK_QUEUE_ENTRY_COUNT;
+   if(Original_Next_Entry_To_Read != Atomic_Load_U32(&Queue->Next_Entry_To_Write))
+   {
+      u32 Index = Atomic_Compare_Exchange_U32(&Queue->Next_Entry_To_Read, Original_Next_Entry_To_Read, New_Next_Entry_To_Read);
+      if(Index == Original_Next_Entry_To_Read)
+      {
+         platform_work_queue_entry Entry = Queue->Entries[Index];
+         Entry.Callback(Queue, Thread_Index, Entry.Data);
+         Atomic_Add_U32(&Queue->Completion_Count, 1);
+      }
+   }
+   else
+   {
+      Should_Sleep = true;
+   }
+
+   return(Should_Sleep);
+}
+
+static void *Linux_Work_Thread(void *Parameter)
+{
+   platform_work_thread *Thread = Parameter;
+   platform_work_queue *Queue = Thread->Queue;
+
+   for(;;)
+   {
+      if(Do_Next_Work_Queue_Entry(Queue, Thread->Thread_Index))
+      {
+         sem_wait(&Queue->Semaphore);
+      }
+   }
+
+   return(0);
+}
+
+static void Initialize_Work_Queue(platform_work_queue *Queue)
+{
+   // NOTE: One worker per remaining core, since the thread that fills the queue
+   // also pitches in whenever it waits on it. There is always at least one
+   // worker, since that thread may never wait at all.
+   int Core_Count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+   Queue->Thread_Count = Minimum(Maximum(Core_Count, 2), MAX_WORK_QUEUE_THREAD_COUNT);
+
+   sem_init(&Queue->Semaphore, 0, 0);
+
+   for(int Thread_Index = 1; Thread_Index < Queue->Thread_Count; ++Thread_Index)
+   {
+      platform_work_thread *Thread = Queue->Threads + Thread_Index;
+      Thread->Queue = Queue;
+      Thread->Thread_Index = Thread_Index;
+
+      pthread_t Handle;
+      if(pthread_create(&Handle, 0, Linux_Work_Thread, Thread) != 0)
+      {
+         Log("Failed to create worker thread %d.\n", Thread_Index);
+         Queue->Thread_Count = Thread_Index;
+         break;
+      }
+      pthread_detach(Handle);
+   }
+}
+
+static GET_WORK_QUEUE_THREAD_COUNT(Get_Work_Queue_Thread_Count)
+{
+   return(Queue->Thread_Count);
+}
+
+static ADD_WORK_QUEUE_ENTRY(Add_Work_Queue_Entry)
+{
+   u32 Next_Entry_To_Write = Queue->Next_Entry_To_Write;
+   u32 New_Next_Entry_To_Write = (Next_Entry_To_Write + 1) % WORK_QUEUE_ENTRY_COUNT;
+   Assert(New_Next_Entry_To_Write != Atomic_Load_U32(&Queue->Next_Entry_To_Read));
+
+   platform_work_queue_entry *Entry = Queue->Entries + Next_Entry_To_Write;
+   Entry->Callback = Callback;
+   Entry->Data = Data;
+   Queue->Completion_Goal++;
+
+   // NOTE: The atomic store publishes the entry before any worker can see it.
+   Atomic_Store_U32(&Queue->Next_Entry_To_Write, New_Next_Entry_To_Write);
+   sem_post(&Queue->Semaphore);
+}
+
+static COMPLETE_ALL_WORK(Complete_All_Work)
+{
+   while(Queue->Completion_Goal != Atomic_Load_U32(&Queue->Completion_Count))
+   {
+      Do_Next_Work_Queue_Entry(Queue, 0);
+   }
+
+   Queue->Completion_Goal = 0;
+   Atomic_Store_U32(&Queue->Completion_Count, 0);
+}
+
+// NOTE: File watching is done with inotify. The descriptor is non-blocking,
+// so polling it with nothing to report returns straight away. Events are read
+// in batches and handed out one at a time.
+#define MAX_WATCHED_DIRECTORY_COUNT 16
+
+struct platform_file_watcher {
+   int Descriptor;
+
+   int Directory_Count;
+   int Watches[MAX_WATCHED_DIRECTORY_COUNT];
+   char *Directories[MAX_WATCHED_DIRECTORY_COUNT];
+
+   int Event_Offset;
+   int Event_Size;
+   u32 Events[1024]; // NOTE: Aligned for struct inotify_event.
+};
+
+static void Initialize_File_Watcher(platform_file_watcher *Watcher)
+{
+   Watcher->Descriptor = inotify_init1(IN_NONBLOCK|IN_CLOEXEC);
+   if(Watcher->Descriptor == -1)
+   {
+      Log("Failed to initialize inotify, so assets won't be reloaded.\n");
+   }
+}
+
+static WATCH_DIRECTORY(Watch_Directory)
+{
+   bool Result = false;
+   if(Watcher->Descriptor != -1)
+   {
+      // NOTE: Renaming over a file is how most tools (including our own
+      // Write_Entire_File) replace one, so moves are watched as well as writes.
+      int Watch = inotify_add_watch(Watcher->Descriptor, Path, IN_CLOSE_WRITE|IN_MOVED_TO);
+      if(Watch == -1)
+      {
+         Log("Failed to watch %s.\n", Path);
+      }
+      else
+      {
+         Result = true;
+
+         bool Watched = false;
+         for(int Directory_Index = 0; Directory_Index < Watcher->Directory_Count; ++Directory_Index)
+         {
+            Watched = Watched || (Watcher->Watches[Directory_Index] == Watch);
+         }
+
+         if(!Watched && Watcher->Directory_Count < MAX_WATCHED_DIRECTORY_COUNT)
+         {
+            Watcher->Watches[Watcher->Directory_Count] = Watch;
+            Watcher->Directories[Watcher->Directory_Count] = Path;
+            Watcher->Directory_Count++;
+         }
+      }
+   }
+
+   return(Result);
+}
+
+static NEXT_CHANGED_FILE(Next_Changed_File)
+{
+   bool Result = false;
+   while(!Result && Watcher->Descriptor != -1)
+   {
+      if(Watcher->Event_Offset >= Watcher->Event_Size)
+      {
+         ssize_t Read_Size = read(Watcher->Descriptor, Watcher->Events, sizeof(Watcher->Events));
+         if(Read_Size <= 0)
+         {
+            break; // NOTE: Nothing left to report, which read signals with EAGAIN.
+         }
+         Watcher->Event_Offset = 0;
+         Watcher->Event_Size = (int)Read_Size;
+      }
+
+      struct inotify_event *Event = (struct inotify_event *)((u8 *)Watcher->Events + Watcher->Event_Offset);
+      Watcher->Event_Offset += sizeof(*Event) + Event->len;
+
+      for(int Directory_Index = 0; Event->len && Directory_Index < Watcher->Directory_Count; ++Directory_Index)
+      {
+         if(Watcher->Watches[Directory_Index] == Event->wd)
+         {
+            int Length = snprintf(Path, Size, "%s/%s", Watcher->Directories[Directory_Index], Event->name);
+            Result = (Length > 0 && Length < Size);
+            break;
+         }
+      }
+   }
+
+   return(Result);
+}
+
 static inline float Compute_Seconds_Elapsed(struct timespec *Start, struct timespec *End)
 {
    float Seconds_Elapsed = 1.0f / 60.0f;
@@ -9,7 +9,13 @@ layout(location = 3) in vec3 Fragment_Position;
 
 layout(location = 0) out vec4 Output_Color;
 
-layout(binding = 1) uniform sampler2D Texture_Sampler;
+layout(set = 1, binding = 0) uniform sampler2D Base_Color_Texture;
+
+layout(set = 0, binding = 1) uniform draw_uniform_buffer_object {
+   mat4 Model;
+   mat3 Normal_Matrix;
+   vec4 Base_Color_Factor;
+} Draw;
 
 void main(void)
 {
@@ -24,7 +30,11 @@ void main(void)
    float Diffuse_Strength = max(dot(Normal, Light_Direction), 0.0);
    vec3 Diffuse = Diffuse_Strength * Light_Color;
 
-   vec3 RGB = (Ambient + Diffuse) * Fragment_Color;
+   // NOTE: COLOR_0 multiplies the base color. Primitives without one read
+   // white, see Create_Vulkan_Scene.
+   vec4 Base_Color = Draw.Base_Color_Factor * texture(Base_Color_Texture, Fragment_Texture_Coordinate);
+   Base_Color.rgb *= Fragment_Color;
+   vec3 RGB = (Ambient + Diffuse) * Base_Color.rgb;
 
    Output_Color = vec4(RGB, 1.0f);
 }
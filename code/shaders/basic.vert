@@ -12,18 +12,39 @@ layout(location = 1) out vec3 Fragment_Color;
 layout(location = 2) out vec2 Fragment_Texture_Coordinate;
 layout(location = 3) out vec3 Fragment_Position;
 
-layout(binding = 0) uniform uniform_buffer_object {
-   mat4 Model;
+layout(set = 0, binding = 0) uniform uniform_buffer_object {
    mat4 View;
    mat4 Projection;
-   vec3 Camera_Position;
 } UBO;
 
+layout(set = 0, binding = 1) uniform draw_uniform_buffer_object {
+   mat4 Model; // NOTE: Includes the decode of quantized positions.
+   mat3 Normal_Matrix;
+   vec4 Base_Color_Factor;
+} Draw;
+
+// NOTE: Set when the normals are octahedral encoded into two components.
+layout(constant_id = 0) const bool Octahedral_Normals = false;
+
+vec3 Decode_Octahedral(vec2 Encoded)
+{
+   vec3 Result = vec3(Encoded, 1.0f - abs(Encoded.x) - abs(Encoded.y));
+   float T = max(-Result.z, 0.0f);
+   Result.x += (Result.x >= 0.0f) ? -T : T;
+   Result.y += (Result.y >= 0.0f) ? -T : T;
+
+   return(normalize(Result));
+}
+
 void main(void)
 {
-   Fragment_Normal = Vertex_Normal;
-   Fragment_Color = vec3(0, 0, 1); // Vertex_Color;
+   vec4 Position = Draw.Model * vec4(Vertex_Position, 1.0f);
+
+   vec3 Normal = Octahedral_Normals ? Decode_Octahedral(Vertex_Normal.xy) : Vertex_Normal;
+
+   Fragment_Normal = normalize(Draw.Normal_Matrix * Normal);
+   Fragment_Color = Vertex_Color;
    Fragment_Texture_Coordinate = Vertex_Texture_Coordinate;
-   Fragment_Position = Vertex_Position;
-   gl_Position = UBO.Projection * UBO.View * UBO.Model * vec4(Vertex_Position, 1.0f);
+   Fragment_Position = Position.xyz;
+   gl_Position = UBO.Projection * UBO.View * Position;
 }
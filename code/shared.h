@@ -8,6 +8,7 @@
 #define Array_Count(Array) (idx)(sizeof(Array) / sizeof((Array)[0]))
 #define Minimum(A, B) ((A) < (B) ? (A) : (B))
 #define Maximum(A, B) ((A) > (B) ? (A) : (B))
+#define Clamp(Value, Low, High) Minimum(Maximum((Value), (Low)), (High))
 
 #if _MSC_VER
 #  define Assert(Cond) do { if(!(Cond)) { __debugbreak(); } } while(0)
@@ -17,6 +18,22 @@
 
 #define Invalid_Code_Path Assert(0)
 
+// NOTE: Atomics used to share work between threads. Each one is a full memory
+// barrier, and Atomic_Add_U32 and Atomic_Compare_Exchange_U32 both return the
+// value stored before the operation.
+#if _MSC_VER
+#  include <intrin.h>
+#  define Atomic_Add_U32(Pointer, Value) (u32)_InterlockedExchangeAdd((volatile long *)(Pointer), (long)(Value))
+#  define Atomic_Compare_Exchange_U32(Pointer, Expected, Desired) (u32)_InterlockedCompareExchange((volatile long *)(Pointer), (long)(Desired), (long)(Expected))
+#  define Atomic_Load_U32(Pointer) (u32)_InterlockedOr((volatile long *)(Pointer), 0)
+#  define Atomic_Store_U32(Pointer, Value) _InterlockedExchange((volatile long *)(Pointer), (long)(Value))
+#else
+#  define Atomic_Add_U32(Pointer, Value) __atomic_fetch_add((Pointer), (Value), __ATOMIC_SEQ_CST)
+#  define Atomic_Compare_Exchange_U32(Pointer, Expected, Desired) __sync_val_compare_and_swap((Pointer), (Expected), (Desired))
+#  define Atomic_Load_U32(Pointer) __atomic_load_n((Pointer), __ATOMIC_SEQ_CST)
+#  define Atomic_Store_U32(Pointer, Value) __atomic_store_n((Pointer), (Value), __ATOMIC_SEQ_CST)
+#endif
+
 #define Kilobytes(N) (1024 * (N))
 #define Megabytes(N) (1024 * Kilobytes(N))
 #define Gigabytes(N) (1024 * Megabytes(N))
@@ -44,7 +61,12 @@ typedef ptrdiff_t idx;
 
 static inline void Copy_Memory(void *Destination, void *Source, idx Size)
 {
-   memcpy(Destination, Source, Size);
+   // NOTE: Empty tables may have null pointers, which memcpy doesn't allow
+   // even when there's nothing to copy.
+   if(Size)
+   {
+      memcpy(Destination, Source, Size);
+   }
 }
 
 #define Zero_Struct(Struct) Zero_Memory((Struct), sizeof(*(Struct)))
@@ -53,10 +75,21 @@ static inline void Zero_Memory(void *Destination, idx Size)
    memset(Destination, 0, Size);
 }
 
+static inline u64 Align_Offset(u64 Offset, u64 Alignment)
+{
+   u64 Result = (Offset + Alignment - 1) & ~(Alignment - 1);
+   return(Result);
+}
+
 typedef struct {
    u8 *Base;
    idx Size;
    idx Used;
+
+   // NOTE: Set by Try_Allocate, when it isn't null, if the arena runs out of
+   // room. It's a pointer so that scratch arenas passed around by value still
+   // report back to whoever sized them.
+   bool *Exhausted;
 } arena;
 
 static inline void Make_Arena(arena *Arena, idx Size)
@@ -64,6 +97,7 @@ static inline void Make_Arena(arena *Arena, idx Size)
    Arena->Base = calloc(1, Size);
    Arena->Size = Size;
    Arena->Used = 0;
+   Arena->Exhausted = 0;
 
    Assert(Arena->Base);
 }
@@ -73,6 +107,12 @@ static inline void Reset_Arena(arena *Arena)
    Arena->Used = 0;
 }
 
+static inline void Free_Arena(arena *Arena)
+{
+   free(Arena->Base);
+   Zero_Struct(Arena);
+}
+
 static inline void Make_Arena_Once(arena *Arena, idx Size)
 {
    // NOTE: Assumes new arenas were previously zero-initialized.
@@ -97,3 +137,28 @@ static inline void *Allocate_Size(arena *Arena, idx Size)
 
    return memset(Result, 0, Size);
 }
+
+static inline bool Arena_Has_Room(arena *Arena, idx Size)
+{
+   bool Result = (Size >= 0 && Size <= Arena->Size - Arena->Used);
+   if(!Result && Arena->Exhausted)
+   {
+      *Arena->Exhausted = true;
+   }
+
+   return(Result);
+}
+
+// NOTE: For allocations sized by untrusted input, like the contents of a file
+// being loaded. Returns null instead of asserting when there's no room.
+#define Try_Allocate(Arena, type, Count) (type *)Try_Allocate_Size((Arena), (idx)sizeof(type)*(Count))
+static inline void *Try_Allocate_Size(arena *Arena, idx Size)
+{
+   void *Result = 0;
+   if(Arena_Has_Room(Arena, Size))
+   {
+      Result = Allocate_Size(Arena, Size);
+   }
+
+   return(Result);
+}
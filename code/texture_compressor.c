@@ -0,0 +1,620 @@
+/* (c) copyright 2025 Lawrence D. Kern /////////////////////////////////////// */
+
+// NOTE: Block compression for baked images. Every format here works on 4x4
+// texel blocks, and every encoder follows the same plan: fit a pair of
+// endpoints along the block's principal axis, pick the palette entry nearest
+// to each texel, then refit the endpoints to those picks by least squares and
+// keep whichever pass came out better. Picking indices dominates the cost, so
+// it runs on four texels at a time with SSE2 on any x64 target. Images are cut
+// into bands of block rows that compress in parallel on the work queue.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define BLOCK_COMPRESSOR_SSE2 1
+#endif
+
+typedef struct {
+   // NOTE: Texels in structure of arrays order, as floats from 0 to 255.
+   float Channels[4][16];
+} texel_block;
+
+static void Load_Texel_Block(texel_block *Block, u8 *Pixels, int Width, int Height, int Block_X, int Block_Y)
+{
+   // NOTE: Blocks hanging off the edge of the image repeat its last row and
+   // column, which the decoder never shows but keeps them from skewing the fit.
+   for(int Y = 0; Y < 4; ++Y)
+   {
+      int Source_Y = Minimum(4*Block_Y + Y, Height - 1);
+      for(int X = 0; X < 4; ++X)
+      {
+         int Source_X = Minimum(4*Block_X + X, Width - 1);
+         u8 *Texel = Pixels + 4*((idx)Source_Y*Width + Source_X);
+         for(int Channel = 0; Channel < 4; ++Channel)
+         {
+            Block->Channels[Channel][4*Y + X] = Texel[Channel];
+         }
+      }
+   }
+}
+
+static float Choose_Block_Indices(texel_block *Block, float (*Palette)[4], int Palette_Count, float *Weights, u8 *Indices)
+{
+   // NOTE: Sets each texel's index to its nearest palette entry, by squared
+   // distance scaled per channel by Weights, and returns the total distance.
+   float Result = 0.0f;
+
+#if BLOCK_COMPRESSOR_SSE2
+   for(int Group = 0; Group < 16; Group += 4)
+   {
+      __m128 Texels[4];
+      for(int Channel = 0; Channel < 4; ++Channel)
+      {
+         Texels[Channel] = _mm_loadu_ps(Block->Channels[Channel] + Group);
+      }
+
+      __m128 Best_Error = _mm_set1_ps(3.0e38f);
+      __m128 Best_Index = _mm_setzero_ps();
+      for(int Entry = 0; Entry < Palette_Count; ++Entry)
+      {
+         __m128 Error = _mm_setzero_ps();
+         for(int Channel = 0; Channel < 4; ++Channel)
+         {
+            __m128 Difference = _mm_sub_ps(Texels[Channel], _mm_set1_ps(Palette[Entry][Channel]));
+            Error = _mm_add_ps(Error, _mm_mul_ps(_mm_mul_ps(Difference, Difference), _mm_set1_ps(Weights[Channel])));
+         }
+
+         __m128 Better = _mm_cmplt_ps(Error, Best_Error);
+         Best_Error = _mm_min_ps(Error, Best_Error);
+         Best_Index = _mm_or_ps(_mm_and_ps(Better, _mm_set1_ps((float)Entry)), _mm_andnot_ps(Better, Best_Index));
+      }
+
+      float Errors[4];
+      int Picks[4];
+      _mm_storeu_ps(Errors, Best_Error);
+      _mm_storeu_si128((__m128i *)Picks, _mm_cvttps_epi32(Best_Index));
+      for(int Lane = 0; Lane < 4; ++Lane)
+      {
+         Indices[Group + Lane] = (u8)Picks[Lane];
+         Result += Errors[Lane];
+      }
+   }
+#else
+   for(int Texel = 0; Texel < 16; ++Texel)
+   {
+      float Best_Error = 3.0e38f;
+      for(int Entry = 0; Entry < Palette_Count; ++Entry)
+      {
+         float Error = 0.0f;
+         for(int Channel = 0; Channel < 4; ++Channel)
+         {
+            float Difference = Block->Channels[Channel][Texel] - Palette[Entry][Channel];
+            Error += Difference*Difference*Weights[Channel];
+         }
+
+         if(Error < Best_Error)
+         {
+            Best_Error = Error;
+            Indices[Texel] = (u8)Entry;
+         }
+      }
+      Result += Best_Error;
+   }
+#endif
+
+   return(Result);
+}
+
+static void Fit_Block_Endpoints(texel_block *Block, float *Weights, float *Low, float *High)
+{
+   // NOTE: The principal axis is found by power iteration on the covariance of
+   // the channels with nonzero weight, starting from the widest channel.
+   float Mean[4] = {0};
+   for(int Channel = 0; Channel < 4; ++Channel)
+   {
+      for(int Texel = 0; Texel < 16; ++Texel)
+      {
+         Mean[Channel] += Block->Channels[Channel][Texel];
+      }
+      Mean[Channel] /= 16.0f;
+   }
+
+   float Covariance[4][4] = {0};
+   for(int Row = 0; Row < 4; ++Row)
+   {
+      for(int Column = 0; Column < 4; ++Column)
+      {
+         if(Weights[Row] > 0.0f && Weights[Column] > 0.0f)
+         {
+            for(int Texel = 0; Texel < 16; ++Texel)
+            {
+               Covariance[Row][Column] += ((Block->Channels[Row][Texel] - Mean[Row]) *
+                                           (Block->Channels[Column][Texel] - Mean[Column]));
+            }
+         }
+      }
+   }
+
+   float Axis[4] = {0};
+   int Widest = 0;
+   for(int Channel = 1; Channel < 4; ++Channel)
+   {
+      if(Covariance[Channel][Channel] > Covariance[Widest][Widest])
+      {
+         Widest = Channel;
+      }
+   }
+   Axis[Widest] = 1.0f;
+
+   for(int Iteration = 0; Iteration < 8; ++Iteration)
+   {
+      float Next[4] = {0};
+      float Length = 0.0f;
+      for(int Row = 0; Row < 4; ++Row)
+      {
+         for(int Column = 0; Column < 4; ++Column)
+         {
+            Next[Row] += Covariance[Row][Column]*Axis[Column];
+         }
+         Length = Maximum(Length, fabsf(Next[Row]));
+      }
+
+      if(Length <= 0.0f)
+      {
+         break;
+      }
+      for(int Channel = 0; Channel < 4; ++Channel)
+      {
+         Axis[Channel] = Next[Channel] / Length;
+      }
+   }
+
+   float Lowest = 0.0f;
+   float Highest = 0.0f;
+   for(int Texel = 0; Texel < 16; ++Texel)
+   {
+      float Projection = 0.0f;
+      for(int Channel = 0; Channel < 4; ++Channel)
+      {
+         Projection += (Block->Channels[Channel][Texel] - Mean[Channel])*Axis[Channel];
+      }
+      Lowest = Minimum(Lowest, Projection);
+      Highest = Maximum(Highest, Projection);
+   }
+
+   float Axis_Length_Squared = 0.0f;
+   for(int Channel = 0; Channel < 4; ++Channel)
+   {
+      Axis_Length_Squared += Axis[Channel]*Axis[Channel];
+   }
+   if(Axis_Length_Squared > 0.0f)
+   {
+      Lowest /= Axis_Length_Squared;
+      Highest /= Axis_Length_Squared;
+   }
+
+   for(int Channel = 0; Channel < 4; ++Channel)
+   {
+      Low[Channel] = Clamp(Mean[Channel] + Lowest*Axis[Channel], 0.0f, 255.0f);
+      High[Channel] = Clamp(Mean[Channel] + Highest*Axis[Channel], 0.0f, 255.0f);
+   }
+}
+
+static bool Refit_Block_Endpoints(texel_block *Block, u8 *Indices, float *Fractions, float *Low, float *High)
+{
+   // NOTE: Solves for the endpoints that minimize the error of the chosen
+   // indices, where Fractions gives how far each index sits from Low to High.
+   // Returns false when every texel picked the same fraction.
+   float AA = 0.0f, AB = 0.0f, BB = 0.0f;
+   float AX[4] = {0}, BX[4] = {0};
+   for(int Texel = 0; Texel < 16; ++Texel)
+   {
+      float B = Fractions[Indices[Texel]];
+      float A = 1.0f - B;
+      AA += A*A;
+      AB += A*B;
+      BB += B*B;
+      for(int Channel = 0; Channel < 4; ++Channel)
+      {
+         AX[Channel] += A*Block->Channels[Channel][Texel];
+         BX[Channel] += B*Block->Channels[Channel][Texel];
+      }
+   }
+
+   float Determinant = AA*BB - AB*AB;
+   bool Result = (fabsf(Determinant) > 1e-6f);
+   if(Result)
+   {
+      for(int Channel = 0; Channel < 4; ++Channel)
+      {
+         Low[Channel] = Clamp((AX[Channel]*BB - BX[Channel]*AB) / Determinant, 0.0f, 255.0f);
+         High[Channel] = Clamp((BX[Channel]*AA - AX[Channel]*AB) / Determinant, 0.0f, 255.0f);
+      }
+   }
+
+   return(Result);
+}
+
+static inline void Write_Block_Bits(u8 *Block, int *Bit, u32 Value, int Count)
+{
+   for(int Index = 0; Index < Count; ++Index, ++*Bit)
+   {
+      Block[*Bit / 8] |= (u8)(((Value >> Index) & 1) << (*Bit % 8));
+   }
+}
+
+// NOTE: BC1 stores two RGB565 endpoints and a 2-bit index per texel. With the
+// first endpoint greater, the palette is both endpoints and two points a
+// third of the way between them.
+static u16 Quantize_BC1_Color(float *Color, float *Dequantized)
+{
+   int R = (int)(Color[0]*31.0f/255.0f + 0.5f);
+   int G = (int)(Color[1]*63.0f/255.0f + 0.5f);
+   int B = (int)(Color[2]*31.0f/255.0f + 0.5f);
+
+   Dequantized[0] = (float)((R << 3) | (R >> 2));
+   Dequantized[1] = (float)((G << 2) | (G >> 4));
+   Dequantized[2] = (float)((B << 3) | (B >> 2));
+   Dequantized[3] = 0.0f;
+
+   u16 Result = (u16)((R << 11) | (G << 5) | B);
+   return(Result);
+}
+
+static float Encode_BC1_Endpoints(texel_block *Block, float *Low, float *High, float *Weights, u8 *Out)
+{
+   float Palette[4][4];
+   u16 Color_0 = Quantize_BC1_Color(High, Palette[0]);
+   u16 Color_1 = Quantize_BC1_Color(Low, Palette[1]);
+   if(Color_0 < Color_1)
+   {
+      u16 Swap = Color_0; Color_0 = Color_1; Color_1 = Swap;
+      for(int Channel = 0; Channel < 4; ++Channel)
+      {
+         float Value = Palette[0][Channel]; Palette[0][Channel] = Palette[1][Channel]; Palette[1][Channel] = Value;
+      }
+   }
+
+   for(int Channel = 0; Channel < 4; ++Channel)
+   {
+      Palette[2][Channel] = (2.0f*Palette[0][Channel] + Palette[1][Channel]) / 3.0f;
+      Palette[3][Channel] = (Palette[0][Channel] + 2.0f*Palette[1][Channel]) / 3.0f;
+   }
+
+   // NOTE: Equal endpoints select the three color mode, where index 0 is still
+   // the endpoint itself.
+   u8 Indices[16] = {0};
+   float Result = Choose_Block_Indices(Block, Palette, (Color_0 == Color_1) ? 1 : 4, Weights, Indices);
+
+   u32 Packed = 0;
+   for(int Texel = 0; Texel < 16; ++Texel)
+   {
+      Packed |= (u32)Indices[Texel] << (2*Texel);
+   }
+
+   Out[0] = (u8)Color_0; Out[1] = (u8)(Color_0 >> 8);
+   Out[2] = (u8)Color_1; Out[3] = (u8)(Color_1 >> 8);
+   Out[4] = (u8)Packed; Out[5] = (u8)(Packed >> 8); Out[6] = (u8)(Packed >> 16); Out[7] = (u8)(Packed >> 24);
+
+   return(Result);
+}
+
+static void Encode_BC1_Block(texel_block *Block, u8 *Out)
+{
+   float Weights[4] = {1, 1, 1, 0};
+   float Fractions[4] = {0, 1, 1.0f/3.0f, 2.0f/3.0f};
+
+   float Low[4], High[4];
+   Fit_Block_Endpoints(Block, Weights, Low, High);
+   float Error = Encode_BC1_Endpoints(Block, Low, High, Weights, Out);
+
+   // NOTE: The refit reads the indices back out of the block, where index 0 is
+   // always the larger endpoint.
+   u32 Packed = Out[4] | (Out[5] << 8) | (Out[6] << 16) | ((u32)Out[7] << 24);
+   u8 Indices[16];
+   for(int Texel = 0; Texel < 16; ++Texel)
+   {
+      Indices[Texel] = (Packed >> (2*Texel)) & 3;
+   }
+
+   float Refit_Low[4], Refit_High[4];
+   if(Refit_Block_Endpoints(Block, Indices, Fractions, Refit_High, Refit_Low))
+   {
+      u8 Refit[8] = {0};
+      if(Encode_BC1_Endpoints(Block, Refit_Low, Refit_High, Weights, Refit) < Error)
+      {
+         Copy_Memory(Out, Refit, 8);
+      }
+   }
+}
+
+// NOTE: BC4 stores one channel as two 8-bit endpoints and a 3-bit index per
+// texel. With the first endpoint greater, the palette is both endpoints and
+// six points evenly between them. BC3 uses it for alpha and BC5 twice for X
+// and Y.
+static float Encode_BC4_Endpoints(texel_block *Block, int Channel, float Low, float High, u8 *Out)
+{
+   int Endpoint_0 = (int)(High + 0.5f);
+   int Endpoint_1 = (int)(Low + 0.5f);
+
+   float Weights[4] = {0};
+   Weights[Channel] = 1.0f;
+
+   float Palette[8][4] = {0};
+   Palette[0][Channel] = (float)Endpoint_0;
+   Palette[1][Channel] = (float)Endpoint_1;
+   for(int Step = 1; Step < 7; ++Step)
+   {
+      Palette[Step + 1][Channel] = (float)((7 - Step)*Endpoint_0 + Step*Endpoint_1) / 7.0f;
+   }
+
+   u8 Indices[16] = {0};
+   float Result = Choose_Block_Indices(Block, Palette, (Endpoint_0 > Endpoint_1) ? 8 : 1, Weights, Indices);
+
+   Zero_Memory(Out, 8);
+   Out[0] = (u8)Endpoint_0;
+   Out[1] = (u8)Endpoint_1;
+
+   int Bit = 16;
+   for(int Texel = 0; Texel < 16; ++Texel)
+   {
+      Write_Block_Bits(Out, &Bit, Indices[Texel], 3);
+   }
+
+   return(Result);
+}
+
+static void Encode_BC4_Block(texel_block *Block, int Channel, u8 *Out)
+{
+   float Low = 255.0f;
+   float High = 0.0f;
+   for(int Texel = 0; Texel < 16; ++Texel)
+   {
+      Low = Minimum(Low, Block->Channels[Channel][Texel]);
+      High = Maximum(High, Block->Channels[Channel][Texel]);
+   }
+   float Error = Encode_BC4_Endpoints(Block, Channel, Low, High, Out);
+
+   // NOTE: Refit in a copy of the block with only this channel set, since the
+   // solve works on every channel at once.
+   float Fractions[8] = {0, 1, 1.0f/7, 2.0f/7, 3.0f/7, 4.0f/7, 5.0f/7, 6.0f/7};
+   u64 Packed = 0;
+   for(int Byte = 7; Byte >= 2; --Byte)
+   {
+      Packed = (Packed << 8) | Out[Byte];
+   }
+
+   u8 Indices[16];
+   for(int Texel = 0; Texel < 16; ++Texel)
+   {
+      Indices[Texel] = (Packed >> (3*Texel)) & 7;
+   }
+
+   float Refit_Low[4], Refit_High[4];
+   if(Out[0] > Out[1] && Refit_Block_Endpoints(Block, Indices, Fractions, Refit_High, Refit_Low) &&
+      Refit_High[Channel] > Refit_Low[Channel])
+   {
+      u8 Refit[8];
+      if(Encode_BC4_Endpoints(Block, Channel, Refit_Low[Channel], Refit_High[Channel], Refit) < Error)
+      {
+         Copy_Memory(Out, Refit, 8);
+      }
+   }
+}
+
+// NOTE: BC7 has eight modes, of which only mode 6 is used: a single subset
+// with RGBA endpoints of 7 bits plus a shared low bit each, and a 4-bit index
+// per texel. It handles both opaque and alpha blocks and needs no partition
+// search, which keeps it fast at a quality well above BC1 and BC3.
+static float Quantize_BC7_Endpoint(float *Color, int *Quantized, int *Bit, float *Dequantized)
+{
+   float Best_Error = 3.0e38f;
+   for(int Low_Bit = 0; Low_Bit < 2; ++Low_Bit)
+   {
+      float Error = 0.0f;
+      int Values[4];
+      for(int Channel = 0; Channel < 4; ++Channel)
+      {
+         Values[Channel] = Clamp((int)((Color[Channel] - Low_Bit)/2.0f + 0.5f), 0, 127);
+         float Difference = (float)((Values[Channel] << 1) | Low_Bit) - Color[Channel];
+         Error += Difference*Difference;
+      }
+
+      if(Error < Best_Error)
+      {
+         Best_Error = Error;
+         *Bit = Low_Bit;
+         for(int Channel = 0; Channel < 4; ++Channel)
+         {
+            Quantized[Channel] = Values[Channel];
+            Dequantized[Channel] = (float)((Values[Channel] << 1) | Low_Bit);
+         }
+      }
+   }
+
+   return(Best_Error);
+}
+
+static float Encode_BC7_Endpoints(texel_block *Block, float *Low, float *High, u8 *Out)
+{
+   static int Interpolation_Weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+   float Weights[4] = {1, 1, 1, 1};
+
+   int Quantized[2][4];
+   int Low_Bits[2];
+   float Endpoints[2][4];
+   Quantize_BC7_Endpoint(Low, Quantized[0], Low_Bits + 0, Endpoints[0]);
+   Quantize_BC7_Endpoint(High, Quantized[1], Low_Bits + 1, Endpoints[1]);
+
+   float Palette[16][4];
+   for(int Entry = 0; Entry < 16; ++Entry)
+   {
+      int W = Interpolation_Weights[Entry];
+      for(int Channel = 0; Channel < 4; ++Channel)
+      {
+         Palette[Entry][Channel] = (float)(((64 - W)*(int)Endpoints[0][Channel] + W*(int)Endpoints[1][Channel] + 32) >> 6);
+      }
+   }
+
+   u8 Indices[16];
+   float Result = Choose_Block_Indices(Block, Palette, 16, Weights, Indices);
+
+   // NOTE: The first texel's index is stored without its high bit, so swap
+   // the endpoints if it needs one.
+   int First = 0;
+   if(Indices[0] >= 8)
+   {
+      First = 1;
+      for(int Texel = 0; Texel < 16; ++Texel)
+      {
+         Indices[Texel] = 15 - Indices[Texel];
+      }
+   }
+
+   Zero_Memory(Out, 16);
+   int Bit = 0;
+   Write_Block_Bits(Out, &Bit, 1 << 6, 7);
+   for(int Channel = 0; Channel < 4; ++Channel)
+   {
+      Write_Block_Bits(Out, &Bit, Quantized[First][Channel], 7);
+      Write_Block_Bits(Out, &Bit, Quantized[1 - First][Channel], 7);
+   }
+   Write_Block_Bits(Out, &Bit, Low_Bits[First], 1);
+   Write_Block_Bits(Out, &Bit, Low_Bits[1 - First], 1);
+
+   Write_Block_Bits(Out, &Bit, Indices[0], 3);
+   for(int Texel = 1; Texel < 16; ++Texel)
+   {
+      Write_Block_Bits(Out, &Bit, Indices[Texel], 4);
+   }
+   Assert(Bit == 128);
+
+   return(Result);
+}
+
+static void Encode_BC7_Block(texel_block *Block, u8 *Out)
+{
+   float Weights[4] = {1, 1, 1, 1};
+   float Fractions[16];
+   static int Interpolation_Weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+   for(int Entry = 0; Entry < 16; ++Entry)
+   {
+      Fractions[Entry] = Interpolation_Weights[Entry] / 64.0f;
+   }
+
+   float Low[4], High[4];
+   Fit_Block_Endpoints(Block, Weights, Low, High);
+   float Error = Encode_BC7_Endpoints(Block, Low, High, Out);
+
+   // NOTE: Recover the indices relative to Low and High from the block, which
+   // may have swapped them.
+   float Palette[16][4];
+   for(int Entry = 0; Entry < 16; ++Entry)
+   {
+      for(int Channel = 0; Channel < 4; ++Channel)
+      {
+         Palette[Entry][Channel] = Low[Channel] + Fractions[Entry]*(High[Channel] - Low[Channel]);
+      }
+   }
+   u8 Indices[16];
+   Choose_Block_Indices(Block, Palette, 16, Weights, Indices);
+
+   if(Refit_Block_Endpoints(Block, Indices, Fractions, Low, High))
+   {
+      u8 Refit[16];
+      if(Encode_BC7_Endpoints(Block, Low, High, Refit) < Error)
+      {
+         Copy_Memory(Out, Refit, 16);
+      }
+   }
+}
+
+typedef struct {
+   gltf_image_format Format;
+   u8 *Pixels;
+   int Width;
+   int Height;
+
+   u8 *Output;
+   int First_Block_Row;
+   int Block_Row_Count;
+} block_compression_job;
+
+static WORK_QUEUE_CALLBACK(Compress_Block_Rows)
+{
+   block_compression_job *Job = Data;
+
+   int Blocks_Wide = (Job->Width + 3) / 4;
+   idx Block_Size = (Job->Format == GLTF_IMAGE_FORMAT_BC1) ? 8 : 16;
+
+   for(int Block_Y = Job->First_Block_Row; Block_Y < Job->First_Block_Row + Job->Block_Row_Count; ++Block_Y)
+   {
+      for(int Block_X = 0; Block_X < Blocks_Wide; ++Block_X)
+      {
+         texel_block Block;
+         Load_Texel_Block(&Block, Job->Pixels, Job->Width, Job->Height, Block_X, Block_Y);
+
+         u8 *Out = Job->Output + ((idx)Block_Y*Blocks_Wide + Block_X)*Block_Size;
+         switch(Job->Format)
+         {
+            case GLTF_IMAGE_FORMAT_BC1: {
+               Encode_BC1_Block(&Block, Out);
+            } break;
+
+            case GLTF_IMAGE_FORMAT_BC3: {
+               Encode_BC4_Block(&Block, 3, Out);
+               Encode_BC1_Block(&Block, Out + 8);
+            } break;
+
+            case GLTF_IMAGE_FORMAT_BC5: {
+               Encode_BC4_Block(&Block, 0, Out);
+               Encode_BC4_Block(&Block, 1, Out + 8);
+            } break;
+
+            case GLTF_IMAGE_FORMAT_BC7: {
+               Encode_BC7_Block(&Block, Out);
+            } break;
+
+            default: {
+               Invalid_Code_Path;
+            } break;
+         }
+      }
+   }
+}
+
+static void Compress_Image(platform_work_queue *Queue, gltf_image_format Format, u8 *Pixels, int Width, int Height, int Mip_Count, u8 *Output, arena Scratch)
+{
+   // NOTE: Pixels holds a chain of 8-bit RGBA levels, and Output must hold
+   // Get_GLTF_Mip_Chain_Size bytes for the same chain in Format. Every level's
+   // bands are queued before any run. Bands are small enough to give each
+   // thread several, so that threads finishing early can pick up the slack.
+   for(int Level = 0; Level < Mip_Count; ++Level)
+   {
+      int Blocks_High = (Height + 3) / 4;
+      int Band_Count = Minimum(Blocks_High, 4*Get_Work_Queue_Thread_Count(Queue));
+      int Rows_Per_Band = (Blocks_High + Band_Count - 1) / Band_Count;
+
+      block_compression_job *Jobs = Allocate(&Scratch, block_compression_job, Band_Count);
+      for(int Band = 0; Band < Band_Count; ++Band)
+      {
+         block_compression_job *Job = Jobs + Band;
+         Job->Format = Format;
+         Job->Pixels = Pixels;
+         Job->Width = Width;
+         Job->Height = Height;
+         Job->Output = Output;
+         Job->First_Block_Row = Band*Rows_Per_Band;
+         Job->Block_Row_Count = Minimum(Rows_Per_Band, Blocks_High - Job->First_Block_Row);
+
+         if(Job->Block_Row_Count > 0)
+         {
+            Add_Work_Queue_Entry(Queue, Compress_Block_Rows, Job);
+         }
+      }
+
+      Pixels += Get_GLTF_Image_Size(GLTF_IMAGE_FORMAT_RGBA8, Width, Height);
+      Output += Get_GLTF_Image_Size(Format, Width, Height);
+      Width = Maximum(Width / 2, 1);
+      Height = Maximum(Height / 2, 1);
+   }
+   Complete_All_Work(Queue);
+}
@@ -2,6 +2,7 @@
 
 #include "basic_string.c"
 #include "basic_math.c"
+#include "image_decoder.c"
 #include "asset_parser.c"
 
 static bool Vulkan_Extensions_Supported(VkExtensionProperties *Extensions, u32 Extension_Count, const char **Requested_Names, u32 Requested_Count)
@@ -156,6 +157,14 @@ static bool Choose_Vulkan_Physical_Device(vulkan_physical_device *Physical_Devic
          {
             Physical_Device->Handle = Handle;
             Physical_Device->Properties = Properties;
+
+            // NOTE: Baked scenes store BCn compressed images. Without support
+            // for them, those images are replaced by white at upload.
+            Physical_Device->Enabled_Features.textureCompressionBC = Features.textureCompressionBC;
+            if(!Features.textureCompressionBC)
+            {
+               Log("   BC texture compression is unsupported, compressed images won't be sampled.\n");
+            }
          }
       }
    }
@@ -244,7 +253,7 @@ static bool Create_Vulkan_Device(vulkan_context *VK)
       // NOTE: This array length is just hard coded to the max number of
       // potential queue families we might use.
       u32 Queue_Info_Count = 0;
-      VkDeviceQueueCreateInfo Queue_Infos[3];
+      VkDeviceQueueCreateInfo Queue_Infos[4];
 
       float Queue_Priorities[] = {1.0f};
 
@@ -256,6 +265,11 @@ static bool Create_Vulkan_Device(vulkan_context *VK)
       bool Graphics_Queue_Family_Found = false;
       bool Present_Queue_Family_Found = false;
 
+      // NOTE: Uploads use a transfer-only family when there is one, since it
+      // usually maps to a DMA engine that copies alongside rendering. Its image
+      // copies have to allow any offset, because images are uploaded in bands.
+      bool Transfer_Queue_Family_Found = false;
+
       for(u32 Family_Index = 0; Family_Index < Queue_Family_Count; ++Family_Index)
       {
          VkQueueFamilyProperties Family = Queue_Families[Family_Index];
@@ -275,6 +289,16 @@ static bool Create_Vulkan_Device(vulkan_context *VK)
             VK->Graphics_Queue_Family_Index = Family_Index;
          }
 
+         VkQueueFlags Transfer_Only = Family.queueFlags & (VK_QUEUE_TRANSFER_BIT|VK_QUEUE_GRAPHICS_BIT|VK_QUEUE_COMPUTE_BIT);
+         VkExtent3D Granularity = Family.minImageTransferGranularity;
+         bool Any_Offset = (Granularity.width == 1 && Granularity.height == 1 && Granularity.depth == 1);
+         if(!Transfer_Queue_Family_Found && Transfer_Only == VK_QUEUE_TRANSFER_BIT && Any_Offset)
+         {
+            Use_This_Family = true;
+            Transfer_Queue_Family_Found = true;
+            VK->Transfer_Queue_Family_Index = Family_Index;
+         }
+
          VkBool32 Present_Support;
          vkGetPhysicalDeviceSurfaceSupportKHR(VK->Physical_Device.Handle, Family_Index, VK->Surface, &Present_Support);
          if(Present_Support)
@@ -324,6 +348,17 @@ static bool Create_Vulkan_Device(vulkan_context *VK)
       vkGetDeviceQueue(VK->Device, VK->Compute_Queue_Family_Index, 0, &VK->Compute_Queue);
       vkGetDeviceQueue(VK->Device, VK->Graphics_Queue_Family_Index, 0, &VK->Graphics_Queue);
       vkGetDeviceQueue(VK->Device, VK->Present_Queue_Family_Index, 0, &VK->Present_Queue);
+
+      if(Transfer_Queue_Family_Found)
+      {
+         vkGetDeviceQueue(VK->Device, VK->Transfer_Queue_Family_Index, 0, &VK->Transfer_Queue);
+         Log("Uploading on transfer queue family %u.\n", VK->Transfer_Queue_Family_Index);
+      }
+      else
+      {
+         VK->Transfer_Queue_Family_Index = VK->Graphics_Queue_Family_Index;
+         VK->Transfer_Queue = VK->Graphics_Queue;
+      }
    }
 
    return(Result);
@@ -344,7 +379,7 @@ static VkImageView Create_Vulkan_Image_View(vulkan_context *VK, VkImage Image, V
 
    View_Info.subresourceRange.aspectMask = Aspect;
    View_Info.subresourceRange.baseMipLevel = 0;
-   View_Info.subresourceRange.levelCount = 1;
+   View_Info.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
    View_Info.subresourceRange.baseArrayLayer = 0;
    View_Info.subresourceRange.layerCount = 1;
 
@@ -354,26 +389,39 @@ static VkImageView Create_Vulkan_Image_View(vulkan_context *VK, VkImage Image, V
    return(Image_View);
 }
 
-static u32 Get_Memory_Type(vulkan_context *VK, u32 Memory_Type_Bits, VkMemoryPropertyFlags Properties)
+static inline u32 Count_Set_Bits_32(u32 Value)
+{
+#if _MSC_VER
+   return(__popcnt(Value));
+#else
+   return((u32)__builtin_popcount(Value));
+#endif
+}
+
+static u32 Get_Memory_Type(vulkan_context *VK, u32 Memory_Type_Bits, vulkan_memory_policy Policy)
 {
    u32 Memory_Type_Index = 0;
    u32 Memory_Type_Found = false;
+   u32 Best_Cost = UINT32_MAX;
 
-   VkPhysicalDeviceMemoryProperties Memory_Properties;
-   vkGetPhysicalDeviceMemoryProperties(VK->Physical_Device.Handle, &Memory_Properties);
-
-   for(u32 Type_Index = 0; Type_Index < Memory_Properties.memoryTypeCount; ++Type_Index)
+   VkPhysicalDeviceMemoryProperties *Memory_Properties = &VK->Memory->Properties;
+   for(u32 Type_Index = 0; Type_Index < Memory_Properties->memoryTypeCount; ++Type_Index)
    {
-      VkMemoryType *Type = Memory_Properties.memoryTypes + Type_Index;
+      VkMemoryType *Type = Memory_Properties->memoryTypes + Type_Index;
 
       u32 Type_Supported = Memory_Type_Bits & (1 << Type_Index);
-      u32 Properties_Supported = (Type->propertyFlags & Properties) == Properties;
+      u32 Properties_Supported = (Type->propertyFlags & Policy.Required) == Policy.Required;
 
       if(Type_Supported && Properties_Supported)
       {
-         Memory_Type_Index = Type_Index;
-         Memory_Type_Found = true;
-         break;
+         u32 Cost = (Count_Set_Bits_32(Policy.Preferred & ~Type->propertyFlags) +
+                     Count_Set_Bits_32(Policy.Avoid & Type->propertyFlags));
+         if(Cost < Best_Cost)
+         {
+            Memory_Type_Index = Type_Index;
+            Memory_Type_Found = true;
+            Best_Cost = Cost;
+         }
       }
    }
    Assert(Memory_Type_Found);
@@ -381,152 +429,486 @@ static u32 Get_Memory_Type(vulkan_context *VK, u32 Memory_Type_Bits, VkMemoryPro
    return(Memory_Type_Index);
 }
 
-static vulkan_image Create_Vulkan_Image(
-   vulkan_context *VK,
-   u32 Width,
-   u32 Height,
-   VkSampleCountFlagBits Sample_Count,
-   VkImageUsageFlags Usage,
-   VkFormat Format,
-   VkImageTiling Tiling,
-   VkMemoryPropertyFlags Properties
-   )
+static inline u32 Find_Highest_Set_Bit_64(u64 Value)
 {
-   VkImageCreateInfo Image_Info = {0};
-   Image_Info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-   Image_Info.imageType = VK_IMAGE_TYPE_2D;
-   Image_Info.extent.width = Width;
-   Image_Info.extent.height = Height;
-   Image_Info.extent.depth = 1;
-   Image_Info.mipLevels = 1;
-   Image_Info.arrayLayers = 1;
-   Image_Info.format = Format;
-   Image_Info.tiling = Tiling;
-   Image_Info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-   Image_Info.usage = Usage;
-   Image_Info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-   Image_Info.samples = Sample_Count;
-   Image_Info.flags = 0;
+#if _MSC_VER
+   unsigned long Result;
+   _BitScanReverse64(&Result, Value);
+   return((u32)Result);
+#else
+   return((u32)(63 - __builtin_clzll(Value)));
+#endif
+}
 
-   vulkan_image Result = {0};
-   Result.Format = Format;
+static void Get_Vulkan_Memory_Size_Class(VkDeviceSize Size, u32 *First_Level, u32 *Second_Level)
+{
+   u32 First = Find_Highest_Set_Bit_64(Size);
+   u32 Second = (First >= VULKAN_MEMORY_SECOND_LEVEL_LOG2)
+      ? (u32)(Size >> (First - VULKAN_MEMORY_SECOND_LEVEL_LOG2))
+      : (u32)(Size << (VULKAN_MEMORY_SECOND_LEVEL_LOG2 - First));
+   Assert(First < VULKAN_MEMORY_FIRST_LEVEL_COUNT);
+
+   *First_Level = First;
+   *Second_Level = Second & (VULKAN_MEMORY_SECOND_LEVEL_COUNT - 1);
+}
 
-   VC(vkCreateImage(VK->Device, &Image_Info, 0, &Result.Image));
+static void Insert_Free_Vulkan_Memory_Region(vulkan_memory_pool *Pool, vulkan_memory_region *Region)
+{
+   u32 First, Second;
+   Get_Vulkan_Memory_Size_Class(Region->Size, &First, &Second);
+
+   vulkan_memory_region **Head = &Pool->Free_Regions[First][Second];
+   Region->Free = true;
+   Region->Previous_Free = 0;
+   Region->Next_Free = *Head;
+   if(*Head)
+   {
+      (*Head)->Previous_Free = Region;
+   }
+   *Head = Region;
 
-   VkMemoryRequirements Memory_Requirements;
-   vkGetImageMemoryRequirements(VK->Device, Result.Image, &Memory_Requirements);
+   Pool->First_Level_Bitmap |= (1ull << First);
+   Pool->Second_Level_Bitmaps[First] |= (1u << Second);
+}
 
-   VkMemoryAllocateInfo Allocate_Info = {0};
-   Allocate_Info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-   Allocate_Info.allocationSize = Memory_Requirements.size;
-   Allocate_Info.memoryTypeIndex = Get_Memory_Type(VK, Memory_Requirements.memoryTypeBits, Properties);
+static void Remove_Free_Vulkan_Memory_Region(vulkan_memory_pool *Pool, vulkan_memory_region *Region)
+{
+   u32 First, Second;
+   Get_Vulkan_Memory_Size_Class(Region->Size, &First, &Second);
+
+   if(Region->Previous_Free)
+   {
+      Region->Previous_Free->Next_Free = Region->Next_Free;
+   }
+   else
+   {
+      Pool->Free_Regions[First][Second] = Region->Next_Free;
+      if(!Region->Next_Free)
+      {
+         Pool->Second_Level_Bitmaps[First] &= ~(1u << Second);
+         if(!Pool->Second_Level_Bitmaps[First])
+         {
+            Pool->First_Level_Bitmap &= ~(1ull << First);
+         }
+      }
+   }
+   if(Region->Next_Free)
+   {
+      Region->Next_Free->Previous_Free = Region->Previous_Free;
+   }
+
+   Region->Free = false;
+   Region->Previous_Free = 0;
+   Region->Next_Free = 0;
+}
+
+static vulkan_memory_region *Find_Free_Vulkan_Memory_Region(vulkan_memory_pool *Pool, VkDeviceSize Size)
+{
+   // NOTE: The size is rounded up to the next size class first, so that any
+   // region in the class found is big enough without looking at its size.
+   u32 First = Find_Highest_Set_Bit_64(Size);
+   if(First >= VULKAN_MEMORY_SECOND_LEVEL_LOG2)
+   {
+      Size += (1ull << (First - VULKAN_MEMORY_SECOND_LEVEL_LOG2)) - 1;
+   }
+
+   u32 Second;
+   Get_Vulkan_Memory_Size_Class(Size, &First, &Second);
+
+   vulkan_memory_region *Result = 0;
+   u32 Second_Level_Bitmap = Pool->Second_Level_Bitmaps[First] & (~0u << Second);
+   if(!Second_Level_Bitmap)
+   {
+      u64 First_Level_Bitmap = (First + 1 < 64) ? Pool->First_Level_Bitmap & (~0ull << (First + 1)) : 0;
+      if(First_Level_Bitmap)
+      {
+         First = Count_Trailing_Zeros_64(First_Level_Bitmap);
+         Second_Level_Bitmap = Pool->Second_Level_Bitmaps[First];
+      }
+   }
+   if(Second_Level_Bitmap)
+   {
+      Second = Count_Trailing_Zeros_64(Second_Level_Bitmap);
+      Result = Pool->Free_Regions[First][Second];
+   }
 
-   VC(vkAllocateMemory(VK->Device, &Allocate_Info, 0, &Result.Device_Memory));
-   VC(vkBindImageMemory(VK->Device, Result.Image, Result.Device_Memory, 0));
+   return(Result);
+}
 
+static vulkan_memory_pool *Get_Vulkan_Memory_Pool(vulkan_memory_allocator *Allocator, u32 Type_Index, bool Optimal)
+{
+   vulkan_memory_pool *Result = &Allocator->Pools[Type_Index][Allocator->Separate_Optimal && Optimal];
    return(Result);
 }
 
-static VkCommandBuffer Begin_Onetime_Vulkan_Commands(vulkan_context *VK)
+static vulkan_memory_region *Get_Vulkan_Memory_Region(vulkan_memory_allocator *Allocator)
 {
-   VkCommandBufferAllocateInfo Allocate_Info = {0};
-   Allocate_Info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-   Allocate_Info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-   Allocate_Info.commandPool = VK->Command_Pool;
-   Allocate_Info.commandBufferCount = 1;
+   vulkan_memory_region *Result = Allocator->Unused_Regions;
+   if(!Result)
+   {
+      Log("Ran out of device memory regions, raise MAX_VULKAN_MEMORY_REGION_COUNT.\n");
+      Invalid_Code_Path;
+   }
+   Allocator->Unused_Regions = Result->Next_Free;
+   Zero_Struct(Result);
+
+   return(Result);
+}
 
-   VkCommandBuffer Command_Buffer;
-   VC(vkAllocateCommandBuffers(VK->Device, &Allocate_Info, &Command_Buffer));
+static void Release_Vulkan_Memory_Region(vulkan_memory_allocator *Allocator, vulkan_memory_region *Region)
+{
+   if(Region->Previous_In_Block)
+   {
+      Region->Previous_In_Block->Next_In_Block = Region->Next_In_Block;
+   }
+   if(Region->Next_In_Block)
+   {
+      Region->Next_In_Block->Previous_In_Block = Region->Previous_In_Block;
+   }
 
-   VkCommandBufferBeginInfo Begin_Info = {0};
-   Begin_Info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-   Begin_Info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+   Zero_Struct(Region);
+   Region->Next_Free = Allocator->Unused_Regions;
+   Allocator->Unused_Regions = Region;
+}
 
-   VC(vkBeginCommandBuffer(Command_Buffer, &Begin_Info));
+static void Split_Vulkan_Memory_Region(vulkan_memory_allocator *Allocator, vulkan_memory_pool *Pool, vulkan_memory_region *Region, VkDeviceSize Size)
+{
+   // NOTE: The part of Region past Size becomes a free region of its own, which
+   // follows Region in its block.
+   vulkan_memory_region *Rest = Get_Vulkan_Memory_Region(Allocator);
+   Rest->Offset = Region->Offset + Size;
+   Rest->Size = Region->Size - Size;
+   Rest->Block = Region->Block;
+   Rest->Previous_In_Block = Region;
+   Rest->Next_In_Block = Region->Next_In_Block;
+   if(Region->Next_In_Block)
+   {
+      Region->Next_In_Block->Previous_In_Block = Rest;
+   }
+   Region->Next_In_Block = Rest;
+   Region->Size = Size;
 
-   return(Command_Buffer);
+   Insert_Free_Vulkan_Memory_Region(Pool, Rest);
 }
 
-static void End_Onetime_Vulkan_Commands(vulkan_context *VK, VkCommandBuffer Command_Buffer)
+static vulkan_memory_region *Create_Vulkan_Memory_Block(vulkan_context *VK, u32 Type_Index, bool Optimal, VkDeviceSize Size)
 {
-   vkEndCommandBuffer(Command_Buffer);
+   // NOTE: Blocks are a fraction of their heap at most, so small heaps aren't
+   // used up by a single block. Anything bigger than half a block gets its own,
+   // sized to fit. Returns the block's one free region, already in its pool.
+   vulkan_memory_allocator *Allocator = VK->Memory;
+   VkMemoryType *Type = Allocator->Properties.memoryTypes + Type_Index;
+   VkDeviceSize Heap_Size = Allocator->Properties.memoryHeaps[Type->heapIndex].size;
+
+   VkDeviceSize Block_Size = Minimum((VkDeviceSize)VULKAN_MEMORY_BLOCK_SIZE, Heap_Size/8);
+   bool Dedicated = (Size > Block_Size/2);
+   if(Dedicated)
+   {
+      Block_Size = Size;
+   }
 
-   VkSubmitInfo Submit_Info = {0};
-   Submit_Info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-   Submit_Info.commandBufferCount = 1;
-   Submit_Info.pCommandBuffers = &Command_Buffer;
+   vulkan_memory_block *Block = 0;
+   for(int Block_Index = 0; Block_Index < MAX_VULKAN_MEMORY_BLOCK_COUNT; ++Block_Index)
+   {
+      if(!Allocator->Blocks[Block_Index].Memory)
+      {
+         Block = Allocator->Blocks + Block_Index;
+         break;
+      }
+   }
+   if(!Block)
+   {
+      Log("Ran out of device memory blocks, raise MAX_VULKAN_MEMORY_BLOCK_COUNT.\n");
+      Invalid_Code_Path;
+   }
+
+   VkMemoryAllocateInfo Allocate_Info = {0};
+   Allocate_Info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+   Allocate_Info.allocationSize = Block_Size;
+   Allocate_Info.memoryTypeIndex = Type_Index;
+   VC(vkAllocateMemory(VK->Device, &Allocate_Info, 0, &Block->Memory));
+
+   Block->Size = Block_Size;
+   Block->Used = 0;
+   Block->Allocation_Count = 0;
+   Block->Type_Index = Type_Index;
+   Block->Optimal = Optimal;
+   Block->Dedicated = Dedicated;
+   Block->Mapped = 0;
+   if(Type->propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+   {
+      VC(vkMapMemory(VK->Device, Block->Memory, 0, VK_WHOLE_SIZE, 0, (void **)&Block->Mapped));
+   }
 
-   vkQueueSubmit(VK->Graphics_Queue, 1, &Submit_Info, VK_NULL_HANDLE);
-   vkQueueWaitIdle(VK->Graphics_Queue);
+   vulkan_memory_region *Result = Get_Vulkan_Memory_Region(Allocator);
+   Result->Offset = 0;
+   Result->Size = Block_Size;
+   Result->Block = Block;
+   Insert_Free_Vulkan_Memory_Region(Get_Vulkan_Memory_Pool(Allocator, Type_Index, Optimal), Result);
 
-   vkFreeCommandBuffers(VK->Device, VK->Command_Pool, 1, &Command_Buffer);
+   return(Result);
 }
 
-static void Transition_Vulkan_Image_Layout(vulkan_context *VK, VkImage Image, VkFormat Format, VkImageLayout Old, VkImageLayout New)
+static void Initialize_Vulkan_Memory(vulkan_context *VK)
 {
-   VkCommandBuffer Command_Buffer = Begin_Onetime_Vulkan_Commands(VK);
+   vulkan_memory_allocator *Allocator = Allocate(&VK->Permanent, vulkan_memory_allocator, 1);
+   vkGetPhysicalDeviceMemoryProperties(VK->Physical_Device.Handle, &Allocator->Properties);
+   Allocator->Separate_Optimal = (VK->Physical_Device.Properties.limits.bufferImageGranularity > 1);
+
+   // NOTE: Direct uploads need a host visible type on a heap as big as the
+   // biggest device local one, so that placing every scene buffer there
+   // doesn't exhaust a small window of mappable device memory.
+   VkDeviceSize Device_Heap_Size = 0;
+   VkDeviceSize Direct_Heap_Size = 0;
+   VkMemoryPropertyFlags Direct_Flags = VULKAN_MEMORY_DIRECT.Required;
+   for(u32 Type_Index = 0; Type_Index < Allocator->Properties.memoryTypeCount; ++Type_Index)
    {
-      VkImageMemoryBarrier Barrier = {0};
-      Barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-      Barrier.oldLayout = Old;
-      Barrier.newLayout = New;
-      Barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-      Barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-      Barrier.image = Image;
-      if(New == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)
+      VkMemoryType *Type = Allocator->Properties.memoryTypes + Type_Index;
+      VkDeviceSize Heap_Size = Allocator->Properties.memoryHeaps[Type->heapIndex].size;
+      if(Type->propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
       {
-         Barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-         bool Has_Stencil = (Format == VK_FORMAT_D32_SFLOAT_S8_UINT || Format == VK_FORMAT_D24_UNORM_S8_UINT);
-         if(Has_Stencil)
-         {
-            Barrier.subresourceRange.aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
-         }
+         Device_Heap_Size = Maximum(Device_Heap_Size, Heap_Size);
       }
-      else
+      if((Type->propertyFlags & Direct_Flags) == Direct_Flags)
       {
-         Barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+         Direct_Heap_Size = Maximum(Direct_Heap_Size, Heap_Size);
       }
-      Barrier.subresourceRange.baseMipLevel = 0;
-      Barrier.subresourceRange.levelCount = 1;
-      Barrier.subresourceRange.baseArrayLayer = 0;
-      Barrier.subresourceRange.layerCount = 1;
+   }
+   Allocator->Direct_Uploads = (Direct_Heap_Size > 0 && Direct_Heap_Size >= Device_Heap_Size);
+   if(Allocator->Direct_Uploads)
+   {
+      Log("Device memory is host visible, so buffers are uploaded without staging.\n");
+   }
 
+   for(int Region_Index = MAX_VULKAN_MEMORY_REGION_COUNT - 1; Region_Index >= 0; --Region_Index)
+   {
+      vulkan_memory_region *Region = Allocator->Regions + Region_Index;
+      Region->Next_Free = Allocator->Unused_Regions;
+      Allocator->Unused_Regions = Region;
+   }
 
+   VK->Memory = Allocator;
+}
 
-      VkPipelineStageFlags Source_Stage, Destination_Stage;
-      if(Old == VK_IMAGE_LAYOUT_UNDEFINED && New == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
+static void Destroy_Vulkan_Memory(vulkan_context *VK)
+{
+   // NOTE: Frees every block, whether or not everything in it was freed.
+   vulkan_memory_allocator *Allocator = VK->Memory;
+   if(Allocator)
+   {
+      for(int Block_Index = 0; Block_Index < MAX_VULKAN_MEMORY_BLOCK_COUNT; ++Block_Index)
       {
-         Barrier.srcAccessMask = 0;
-         Barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-
-         Source_Stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-         Destination_Stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+         vulkan_memory_block *Block = Allocator->Blocks + Block_Index;
+         if(Block->Memory)
+         {
+            vkFreeMemory(VK->Device, Block->Memory, 0);
+         }
       }
-      else if(Old == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && New == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+      VK->Memory = 0;
+   }
+}
+
+static vulkan_allocation Allocate_Vulkan_Memory(vulkan_context *VK, VkMemoryRequirements Requirements, vulkan_memory_policy Policy, bool Optimal)
+{
+   vulkan_memory_allocator *Allocator = VK->Memory;
+   u32 Type_Index = Get_Memory_Type(VK, Requirements.memoryTypeBits, Policy);
+   vulkan_memory_pool *Pool = Get_Vulkan_Memory_Pool(Allocator, Type_Index, Optimal);
+
+   // NOTE: Asking for alignment - 1 more than needed means any region found
+   // fits once its start is aligned.
+   VkDeviceSize Alignment = Maximum(Requirements.alignment, 1);
+   vulkan_memory_region *Region = Find_Free_Vulkan_Memory_Region(Pool, Requirements.size + Alignment - 1);
+   if(!Region)
+   {
+      Region = Create_Vulkan_Memory_Block(VK, Type_Index, Optimal, Requirements.size);
+   }
+   Remove_Free_Vulkan_Memory_Region(Pool, Region);
+
+   // NOTE: Padding in front of the aligned start goes back to the free lists,
+   // as does whatever is left after the allocation if it's worth keeping.
+   VkDeviceSize Padding = Align_Offset(Region->Offset, Alignment) - Region->Offset;
+   if(Padding)
+   {
+      vulkan_memory_region *Front = Region;
+      Split_Vulkan_Memory_Region(Allocator, Pool, Front, Padding);
+      Region = Front->Next_In_Block;
+      Remove_Free_Vulkan_Memory_Region(Pool, Region);
+      Insert_Free_Vulkan_Memory_Region(Pool, Front);
+   }
+   if(Region->Size - Requirements.size >= VULKAN_MEMORY_MIN_REGION_SIZE)
+   {
+      Split_Vulkan_Memory_Region(Allocator, Pool, Region, Requirements.size);
+   }
+
+   vulkan_memory_block *Block = Region->Block;
+   Block->Used += Region->Size;
+   Block->Allocation_Count++;
+
+   vulkan_allocation Result = {0};
+   Result.Memory = Block->Memory;
+   Result.Offset = Region->Offset;
+   Result.Size = Region->Size;
+   Result.Mapped = Block->Mapped ? Block->Mapped + Region->Offset : 0;
+   Result.Region = Region;
+
+   return(Result);
+}
+
+static void Free_Vulkan_Memory(vulkan_context *VK, vulkan_allocation *Allocation)
+{
+   vulkan_memory_allocator *Allocator = VK->Memory;
+   vulkan_memory_region *Region = Allocation->Region;
+   if(Region)
+   {
+      vulkan_memory_block *Block = Region->Block;
+      vulkan_memory_pool *Pool = Get_Vulkan_Memory_Pool(Allocator, Block->Type_Index, Block->Optimal);
+
+      Block->Used -= Region->Size;
+      Block->Allocation_Count--;
+
+      // NOTE: Merge with free neighbors, so that free regions never touch.
+      vulkan_memory_region *Previous = Region->Previous_In_Block;
+      if(Previous && Previous->Free)
       {
-         Barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-         Barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+         Remove_Free_Vulkan_Memory_Region(Pool, Previous);
+         Previous->Size += Region->Size;
+         Release_Vulkan_Memory_Region(Allocator, Region);
+         Region = Previous;
+      }
 
-         Source_Stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-         Destination_Stage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+      vulkan_memory_region *Next = Region->Next_In_Block;
+      if(Next && Next->Free)
+      {
+         Remove_Free_Vulkan_Memory_Region(Pool, Next);
+         Region->Size += Next->Size;
+         Release_Vulkan_Memory_Region(Allocator, Next);
       }
-      else if(Old == VK_IMAGE_LAYOUT_UNDEFINED && New == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)
+
+      // NOTE: Empty blocks are given back to the driver, except for one
+      // regular block per pool, so that a pool emptied and refilled right
+      // away doesn't allocate a new block each time.
+      bool Release_Block = false;
+      if(Block->Allocation_Count == 0)
       {
-         Barrier.srcAccessMask = 0;
-         Barrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT|VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+         Release_Block = Block->Dedicated;
+         for(int Block_Index = 0; !Release_Block && Block_Index < MAX_VULKAN_MEMORY_BLOCK_COUNT; ++Block_Index)
+         {
+            vulkan_memory_block *Other = Allocator->Blocks + Block_Index;
+            Release_Block = (Other != Block && Other->Memory && !Other->Dedicated &&
+                             Get_Vulkan_Memory_Pool(Allocator, Other->Type_Index, Other->Optimal) == Pool);
+         }
+      }
 
-         Source_Stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-         Destination_Stage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+      if(Release_Block)
+      {
+         vkFreeMemory(VK->Device, Block->Memory, 0);
+         Release_Vulkan_Memory_Region(Allocator, Region);
+         Zero_Struct(Block);
       }
       else
       {
-         // NOTE: Unsupported transition.
-         Assert(0);
+         Insert_Free_Vulkan_Memory_Region(Pool, Region);
       }
+   }
 
-      vkCmdPipelineBarrier(Command_Buffer, Source_Stage, Destination_Stage, 0, 0, 0, 0, 0, 1, &Barrier);
+   Zero_Struct(Allocation);
+}
+
+static vulkan_memory_stats Get_Vulkan_Memory_Stats(vulkan_context *VK)
+{
+   vulkan_memory_stats Result = {0};
+
+   vulkan_memory_allocator *Allocator = VK->Memory;
+   for(int Block_Index = 0; Block_Index < MAX_VULKAN_MEMORY_BLOCK_COUNT; ++Block_Index)
+   {
+      vulkan_memory_block *Block = Allocator->Blocks + Block_Index;
+      if(Block->Memory)
+      {
+         Result.Block_Count++;
+         Result.Allocation_Count += Block->Allocation_Count;
+         Result.Block_Bytes += Block->Size;
+         Result.Used_Bytes += Block->Used;
+      }
    }
-   End_Onetime_Vulkan_Commands(VK, Command_Buffer);
+   Result.Free_Bytes = Result.Block_Bytes - Result.Used_Bytes;
+
+   // NOTE: Regions not in use by the allocator have no block.
+   VkDeviceSize Largest_Free_Regions[MAX_VULKAN_MEMORY_BLOCK_COUNT] = {0};
+   for(int Region_Index = 0; Region_Index < MAX_VULKAN_MEMORY_REGION_COUNT; ++Region_Index)
+   {
+      vulkan_memory_region *Region = Allocator->Regions + Region_Index;
+      if(Region->Block && Region->Free)
+      {
+         VkDeviceSize *Largest = Largest_Free_Regions + (Region->Block - Allocator->Blocks);
+         *Largest = Maximum(*Largest, Region->Size);
+         Result.Largest_Free_Region = Maximum(Result.Largest_Free_Region, Region->Size);
+      }
+   }
+
+   VkDeviceSize Unfragmented_Bytes = 0;
+   for(int Block_Index = 0; Block_Index < MAX_VULKAN_MEMORY_BLOCK_COUNT; ++Block_Index)
+   {
+      Unfragmented_Bytes += Largest_Free_Regions[Block_Index];
+   }
+
+   if(Result.Free_Bytes)
+   {
+      Result.Fragmentation = 1.0f - (float)Unfragmented_Bytes / (float)Result.Free_Bytes;
+   }
+
+   return(Result);
+}
+
+static void Log_Vulkan_Memory_Stats(vulkan_context *VK)
+{
+   vulkan_memory_stats Stats = Get_Vulkan_Memory_Stats(VK);
+   Log("Device memory: %d allocations in %d blocks, %.1f MB used, %.1f MB free, %.1f%% fragmented.\n",
+       Stats.Allocation_Count, Stats.Block_Count,
+       Stats.Used_Bytes / (1024.0*1024.0), Stats.Free_Bytes / (1024.0*1024.0),
+       100.0f*Stats.Fragmentation);
+}
+
+static vulkan_image Create_Vulkan_Image(
+   vulkan_context *VK,
+   u32 Width,
+   u32 Height,
+   u32 Mip_Count,
+   VkSampleCountFlagBits Sample_Count,
+   VkImageUsageFlags Usage,
+   VkFormat Format,
+   VkImageTiling Tiling,
+   vulkan_memory_policy Policy
+   )
+{
+   VkImageCreateInfo Image_Info = {0};
+   Image_Info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+   Image_Info.imageType = VK_IMAGE_TYPE_2D;
+   Image_Info.extent.width = Width;
+   Image_Info.extent.height = Height;
+   Image_Info.extent.depth = 1;
+   Image_Info.mipLevels = Mip_Count;
+   Image_Info.arrayLayers = 1;
+   Image_Info.format = Format;
+   Image_Info.tiling = Tiling;
+   Image_Info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+   Image_Info.usage = Usage;
+   Image_Info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+   Image_Info.samples = Sample_Count;
+   Image_Info.flags = 0;
+
+   vulkan_image Result = {0};
+   Result.Format = Format;
+   Result.Mip_Count = Mip_Count;
+
+   VC(vkCreateImage(VK->Device, &Image_Info, 0, &Result.Image));
+
+   VkMemoryRequirements Memory_Requirements;
+   vkGetImageMemoryRequirements(VK->Device, Result.Image, &Memory_Requirements);
+
+   Result.Allocation = Allocate_Vulkan_Memory(VK, Memory_Requirements, Policy, Tiling == VK_IMAGE_TILING_OPTIMAL);
+   VC(vkBindImageMemory(VK->Device, Result.Image, Result.Allocation.Memory, Result.Allocation.Offset));
+
+   return(Result);
 }
 
 static vulkan_image Create_Vulkan_Depth_Image(vulkan_context *VK, u32 Width, u32 Height)
@@ -536,7 +918,6 @@ static vulkan_image Create_Vulkan_Depth_Image(vulkan_context *VK, u32 Width, u32
 
    VkImageUsageFlags Usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
    VkImageTiling Tiling = VK_IMAGE_TILING_OPTIMAL;
-   VkMemoryPropertyFlags Memory_Properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
 
    VkFormatFeatureFlags Features = VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT;
 
@@ -551,10 +932,11 @@ static vulkan_image Create_Vulkan_Depth_Image(vulkan_context *VK, u32 Width, u32
       Assert((Properties.linearTilingFeatures & Features) == Features);
    }
 
-   vulkan_image Result = Create_Vulkan_Image(VK, Width, Height, VK->Multisample_Count, Usage, Format, Tiling, Memory_Properties);
+   vulkan_image Result = Create_Vulkan_Image(VK, Width, Height, 1, VK->Multisample_Count, Usage, Format, Tiling, VULKAN_MEMORY_DEVICE_LOCAL);
    Result.View = Create_Vulkan_Image_View(VK, Result.Image, Result.Format, VK_IMAGE_ASPECT_DEPTH_BIT);
 
-   Transition_Vulkan_Image_Layout(VK, Result.Image, Result.Format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+   // NOTE: The render pass moves it out of its undefined initial layout, and
+   // clears it, every frame.
 
    return(Result);
 }
@@ -564,7 +946,7 @@ static vulkan_image Create_Vulkan_Color_Image(vulkan_context *VK, u32 Width, u32
    VkFormat Format = VK->Swapchain.Image_Format;
 
    VkImageUsageFlags Usage = VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT|VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
-   vulkan_image Result = Create_Vulkan_Image(VK, Width, Height, VK->Multisample_Count, Usage, Format, VK_IMAGE_TILING_OPTIMAL, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+   vulkan_image Result = Create_Vulkan_Image(VK, Width, Height, 1, VK->Multisample_Count, Usage, Format, VK_IMAGE_TILING_OPTIMAL, VULKAN_MEMORY_TRANSIENT);
    Result.View = Create_Vulkan_Image_View(VK, Result.Image, Result.Format, VK_IMAGE_ASPECT_COLOR_BIT);
 
    return(Result);
@@ -574,7 +956,7 @@ static void Destroy_Vulkan_Image(vulkan_context *VK, vulkan_image *Image)
 {
    vkDestroyImageView(VK->Device, Image->View, 0);
    vkDestroyImage(VK->Device, Image->Image, 0);
-   vkFreeMemory(VK->Device, Image->Device_Memory, 0);
+   Free_Vulkan_Memory(VK, &Image->Allocation);
 
    Zero_Struct(Image);
 }
@@ -751,19 +1133,6 @@ static void Create_Vulkan_Swapchain_Framebuffers(vulkan_context *VK, vulkan_swap
    }
 }
 
-static void Copy_Vulkan_Buffer(vulkan_context *VK, VkBuffer Destination, VkBuffer Source, VkDeviceSize Size)
-{
-   VkCommandBuffer Command_Buffer = Begin_Onetime_Vulkan_Commands(VK);
-   {
-      VkBufferCopy Copy_Region = {0};
-      Copy_Region.srcOffset = 0;
-      Copy_Region.dstOffset = 0;
-      Copy_Region.size = Size;
-      vkCmdCopyBuffer(Command_Buffer, Source, Destination, 1, &Copy_Region);
-   }
-   End_Onetime_Vulkan_Commands(VK, Command_Buffer);
-}
-
 static void Recreate_Vulkan_Swapchain(vulkan_context *VK, vulkan_swapchain *Swapchain)
 {
    vkDeviceWaitIdle(VK->Device);
@@ -772,7 +1141,7 @@ static void Recreate_Vulkan_Swapchain(vulkan_context *VK, vulkan_swapchain *Swap
    Create_Vulkan_Swapchain_Framebuffers(VK, &VK->Swapchain, VK->Basic_Render_Pass);
 }
 
-static vulkan_buffer Create_Vulkan_Buffer(vulkan_context *VK, idx Size, VkBufferUsageFlags Usage, VkMemoryPropertyFlags Properties)
+static vulkan_buffer Create_Vulkan_Buffer(vulkan_context *VK, idx Size, VkBufferUsageFlags Usage, vulkan_memory_policy Policy)
 {
    vulkan_buffer Result = {0};
    Result.Size = Size;
@@ -788,189 +1157,1821 @@ static vulkan_buffer Create_Vulkan_Buffer(vulkan_context *VK, idx Size, VkBuffer
    VkMemoryRequirements Memory_Requirements;
    vkGetBufferMemoryRequirements(VK->Device, Result.Buffer, &Memory_Requirements);
 
-   VkMemoryAllocateInfo Allocate_Info = {0};
-   Allocate_Info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-   Allocate_Info.allocationSize = Memory_Requirements.size;
-   Allocate_Info.memoryTypeIndex = Get_Memory_Type(VK, Memory_Requirements.memoryTypeBits, Properties);
-
-   VC(vkAllocateMemory(VK->Device, &Allocate_Info, 0, &Result.Device_Memory));
-   VC(vkBindBufferMemory(VK->Device, Result.Buffer, Result.Device_Memory, 0));
+   Result.Allocation = Allocate_Vulkan_Memory(VK, Memory_Requirements, Policy, false);
+   Result.Mapped_Memory_Address = Result.Allocation.Mapped;
+   VC(vkBindBufferMemory(VK->Device, Result.Buffer, Result.Allocation.Memory, Result.Allocation.Offset));
 
    return(Result);
 }
 
-static vulkan_buffer Create_Vulkan_Vertex_Buffer(vulkan_context *VK, gltf_scene *Scene, int Accessor_Index)
+static void Destroy_Vulkan_Buffer(vulkan_context *VK, vulkan_buffer *Buffer)
 {
-   gltf_accessor Accessor = Scene->Accessors[Accessor_Index];
-   gltf_buffer_view Buffer_View = Scene->Buffer_Views[Accessor.Buffer_View];
-
-   u8 *Source_Memory = Scene->Binary_Data + Buffer_View.Offset + Accessor.Offset;
-   idx Size = Accessor.Count * Get_GLTF_Type_Size(Accessor.Type, Accessor.Component_Type);
-
-   VkBufferUsageFlags Staging_Usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-   VkMemoryPropertyFlags Staging_Properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT|VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-   vulkan_buffer Staging = Create_Vulkan_Buffer(VK, Size, Staging_Usage, Staging_Properties);
-
-   void *Device_Memory;
-   VC(vkMapMemory(VK->Device, Staging.Device_Memory, 0, Size, 0, &Device_Memory));
-   Copy_Memory(Device_Memory, Source_Memory, Size);
-   vkUnmapMemory(VK->Device, Staging.Device_Memory);
+   vkDestroyBuffer(VK->Device, Buffer->Buffer, 0);
+   Free_Vulkan_Memory(VK, &Buffer->Allocation);
 
-   VkBufferUsageFlags Usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT|VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
-   VkMemoryPropertyFlags Properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
-   vulkan_buffer Result = Create_Vulkan_Buffer(VK, Size, Usage, Properties);
+   Zero_Struct(Buffer);
+}
 
-   Copy_Vulkan_Buffer(VK, Result.Buffer, Staging.Buffer, Size);
+static void Create_Vulkan_Uniform_Arena(vulkan_context *VK, vulkan_uniform_arena *Arena, VkDeviceSize Size)
+{
+   VkBufferUsageFlags Usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+   Arena->Buffer = Create_Vulkan_Buffer(VK, Size, Usage, VULKAN_MEMORY_UPLOAD);
+   Arena->Alignment = Maximum(VK->Physical_Device.Properties.limits.minUniformBufferOffsetAlignment, 1);
+   Arena->Used = 0;
 
-   vkDestroyBuffer(VK->Device, Staging.Buffer, 0);
-   vkFreeMemory(VK->Device, Staging.Device_Memory, 0);
+   Assert(Arena->Buffer.Mapped_Memory_Address);
+}
 
-   return(Result);
+static void Destroy_Vulkan_Uniform_Arena(vulkan_context *VK, vulkan_uniform_arena *Arena)
+{
+   Destroy_Vulkan_Buffer(VK, &Arena->Buffer);
+   Zero_Struct(Arena);
 }
 
-static inline idx Get_Vulkan_Index_Size(VkIndexType Index_Type)
+static inline void Reset_Vulkan_Uniform_Arena(vulkan_uniform_arena *Arena)
 {
-   idx Result = 0;
-   switch(Index_Type)
-   {
-      case VK_INDEX_TYPE_UINT8_EXT: { Result = 1; } break;
-      case VK_INDEX_TYPE_UINT16:    { Result = 2; } break;
-      case VK_INDEX_TYPE_UINT32:    { Result = 3; } break;
-      default: {} break;
-   }
-   return(Result);
-};
+   Arena->Used = 0;
+}
 
-static vulkan_buffer Create_Vulkan_Index_Buffer(vulkan_context *VK, gltf_scene *Scene, int Accessor_Index)
+static u32 Push_Vulkan_Uniform(vulkan_uniform_arena *Arena, void *Data, idx Size)
 {
-   gltf_accessor Accessor = Scene->Accessors[Accessor_Index];
-   gltf_buffer_view Buffer_View = Scene->Buffer_Views[Accessor.Buffer_View];
+   // NOTE: Returns the dynamic offset to bind the slice with.
+   VkDeviceSize Offset = Align_Offset(Arena->Used, Arena->Alignment);
+   Assert(Offset + Size <= (VkDeviceSize)Arena->Buffer.Size);
 
-   u8 *Source_Memory = Scene->Binary_Data + Buffer_View.Offset + Accessor.Offset;
-   idx Size = Accessor.Count * Get_GLTF_Type_Size(Accessor.Type, Accessor.Component_Type);
+   Copy_Memory((u8 *)Arena->Buffer.Mapped_Memory_Address + Offset, Data, Size);
+   Arena->Used = Offset + Size;
 
-   VkBufferUsageFlags Staging_Buffer_Usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-   VkMemoryPropertyFlags Staging_Buffer_Properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT|VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-   vulkan_buffer Staging = Create_Vulkan_Buffer(VK, Size, Staging_Buffer_Usage, Staging_Buffer_Properties);
+   return((u32)Offset);
+}
 
-   void *Mapped_Memory_Address;
-   VC(vkMapMemory(VK->Device, Staging.Device_Memory, 0, Size, 0, &Mapped_Memory_Address));
-   Copy_Memory(Mapped_Memory_Address, Source_Memory, Size);
-   vkUnmapMemory(VK->Device, Staging.Device_Memory);
+static inline VkFormat
+GLTF_To_Vulkan_Format(gltf_accessor_type Type, gltf_component_type Component_Type, bool Normalized)
+{
+   // NOTE: Vertex attributes are always read as floats by the shaders, so 8 and
+   // 16-bit integers map to normalized formats, or to scaled formats when they
+   // aren't normalized (as KHR_mesh_quantization allows for positions).
+   VkFormat Result = VK_FORMAT_UNDEFINED;
+
+   int Component_Count = GLTF_Accessor_Type_Infos[Type].Component_Count;
+   switch(Component_Type)
+   {
+      case GLTF_ACCESSOR_COMPONENT_S8: {
+         switch(Component_Count)
+         {
+            case 1: { Result = Normalized ? VK_FORMAT_R8_SNORM       : VK_FORMAT_R8_SSCALED;       } break;
+            case 2: { Result = Normalized ? VK_FORMAT_R8G8_SNORM     : VK_FORMAT_R8G8_SSCALED;     } break;
+            case 3: { Result = Normalized ? VK_FORMAT_R8G8B8_SNORM   : VK_FORMAT_R8G8B8_SSCALED;   } break;
+            case 4: { Result = Normalized ? VK_FORMAT_R8G8B8A8_SNORM : VK_FORMAT_R8G8B8A8_SSCALED; } break;
+         } break;
+      } break;
+
+      case GLTF_ACCESSOR_COMPONENT_U8: {
+         switch(Component_Count)
+         {
+            case 1: { Result = Normalized ? VK_FORMAT_R8_UNORM       : VK_FORMAT_R8_USCALED;       } break;
+            case 2: { Result = Normalized ? VK_FORMAT_R8G8_UNORM     : VK_FORMAT_R8G8_USCALED;     } break;
+            case 3: { Result = Normalized ? VK_FORMAT_R8G8B8_UNORM   : VK_FORMAT_R8G8B8_USCALED;   } break;
+            case 4: { Result = Normalized ? VK_FORMAT_R8G8B8A8_UNORM : VK_FORMAT_R8G8B8A8_USCALED; } break;
+         } break;
+      } break;
+
+      case GLTF_ACCESSOR_COMPONENT_S16: {
+         switch(Component_Count)
+         {
+            case 1: { Result = Normalized ? VK_FORMAT_R16_SNORM          : VK_FORMAT_R16_SSCALED;          } break;
+            case 2: { Result = Normalized ? VK_FORMAT_R16G16_SNORM       : VK_FORMAT_R16G16_SSCALED;       } break;
+            case 3: { Result = Normalized ? VK_FORMAT_R16G16B16_SNORM    : VK_FORMAT_R16G16B16_SSCALED;    } break;
+            case 4: { Result = Normalized ? VK_FORMAT_R16G16B16A16_SNORM : VK_FORMAT_R16G16B16A16_SSCALED; } break;
+         } break;
+      } break;
+
+      case GLTF_ACCESSOR_COMPONENT_U16: {
+         switch(Component_Count)
+         {
+            case 1: { Result = Normalized ? VK_FORMAT_R16_UNORM          : VK_FORMAT_R16_USCALED;          } break;
+            case 2: { Result = Normalized ? VK_FORMAT_R16G16_UNORM       : VK_FORMAT_R16G16_USCALED;       } break;
+            case 3: { Result = Normalized ? VK_FORMAT_R16G16B16_UNORM    : VK_FORMAT_R16G16B16_USCALED;    } break;
+            case 4: { Result = Normalized ? VK_FORMAT_R16G16B16A16_UNORM : VK_FORMAT_R16G16B16A16_USCALED; } break;
+         } break;
+      } break;
+
+      case GLTF_ACCESSOR_COMPONENT_U32: {
+         switch(Component_Count) {
+            case 1: { Result = VK_FORMAT_R32_UINT; } break;
+            case 2: { Result = VK_FORMAT_R32G32_UINT; } break;
+            case 3: { Result = VK_FORMAT_R32G32B32_UINT; } break;
+            case 4: { Result = VK_FORMAT_R32G32B32A32_UINT; } break;
+         } break;
+      } break;
+
+      case GLTF_ACCESSOR_COMPONENT_F32: {
+         switch(Component_Count)
+         {
+            case 1: { Result = VK_FORMAT_R32_SFLOAT; } break;
+            case 2: { Result = VK_FORMAT_R32G32_SFLOAT; } break;
+            case 3: { Result = VK_FORMAT_R32G32B32_SFLOAT; } break;
+            case 4: { Result = VK_FORMAT_R32G32B32A32_SFLOAT; } break;
+         } break;
+      } break;
+
+      default: {
+         Invalid_Code_Path;
+      } break;
+   }
+
+   return(Result);
+}
+
+static inline VkIndexType GLTF_To_Vulkan_Index(gltf_component_type Component_Type)
+{
+   VkIndexType Result;
+   switch(Component_Type)
+   {
+      case GLTF_ACCESSOR_COMPONENT_U16: { Result = VK_INDEX_TYPE_UINT16;    } break;
+      case GLTF_ACCESSOR_COMPONENT_U32: { Result = VK_INDEX_TYPE_UINT32;    } break;
+      default:                          { Result = VK_INDEX_TYPE_UINT16;    } break;
+   }
+   return(Result);
+}
+
+static vulkan_memory_policy Get_Vulkan_Buffer_Upload_Policy(vulkan_context *VK)
+{
+   // NOTE: Device local buffers the CPU fills once. They're written in place
+   // when possible, and get their contents through staging otherwise.
+   vulkan_memory_policy Result = VK->Memory->Direct_Uploads ? VULKAN_MEMORY_DIRECT : VULKAN_MEMORY_DEVICE_LOCAL;
+   return(Result);
+}
+
+static void Create_Vulkan_Staging_Ring(vulkan_context *VK, vulkan_staging_ring *Ring)
+{
+   Assert((VULKAN_STAGING_RING_SIZE & (VULKAN_STAGING_RING_SIZE - 1)) == 0);
+
+   VkBufferUsageFlags Usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+   Ring->Buffer = Create_Vulkan_Buffer(VK, VULKAN_STAGING_RING_SIZE, Usage, VULKAN_MEMORY_STAGING);
+   Ring->Hand_Off = (VK->Transfer_Queue_Family_Index != VK->Graphics_Queue_Family_Index);
+
+   VkCommandBuffer Command_Buffers[VULKAN_STAGING_SUBMISSION_COUNT];
+   VkCommandBufferAllocateInfo Allocate_Info = {0};
+   Allocate_Info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+   Allocate_Info.commandPool = VK->Transfer_Command_Pool;
+   Allocate_Info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+   Allocate_Info.commandBufferCount = VULKAN_STAGING_SUBMISSION_COUNT;
+   VC(vkAllocateCommandBuffers(VK->Device, &Allocate_Info, Command_Buffers));
+
+   VkCommandBuffer Acquire_Command_Buffers[VULKAN_STAGING_SUBMISSION_COUNT];
+   Allocate_Info.commandPool = VK->Command_Pool;
+   VC(vkAllocateCommandBuffers(VK->Device, &Allocate_Info, Acquire_Command_Buffers));
+
+   for(int Submission_Index = 0; Submission_Index < VULKAN_STAGING_SUBMISSION_COUNT; ++Submission_Index)
+   {
+      vulkan_staging_submission *Submission = Ring->Submissions + Submission_Index;
+      Submission->Command_Buffer = Command_Buffers[Submission_Index];
+      Submission->Acquire_Command_Buffer = Acquire_Command_Buffers[Submission_Index];
+
+      VkFenceCreateInfo Fence_Info = {0};
+      Fence_Info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+      VC(vkCreateFence(VK->Device, &Fence_Info, 0, &Submission->Fence));
+      VC(vkCreateFence(VK->Device, &Fence_Info, 0, &Submission->Acquire_Fence));
+
+      VkSemaphoreCreateInfo Semaphore_Info = {0};
+      Semaphore_Info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+      VC(vkCreateSemaphore(VK->Device, &Semaphore_Info, 0, &Submission->Semaphore));
+   }
+
+   Ring->Head = 0;
+   Ring->Tail = 0;
+   Ring->Open = false;
+   Ring->First_Pending = 0;
+   Ring->Pending_Count = 0;
+}
+
+static void Destroy_Vulkan_Staging_Ring(vulkan_context *VK, vulkan_staging_ring *Ring)
+{
+   for(int Submission_Index = 0; Submission_Index < VULKAN_STAGING_SUBMISSION_COUNT; ++Submission_Index)
+   {
+      vulkan_staging_submission *Submission = Ring->Submissions + Submission_Index;
+      vkDestroyFence(VK->Device, Submission->Fence, 0);
+      vkDestroyFence(VK->Device, Submission->Acquire_Fence, 0);
+      vkDestroySemaphore(VK->Device, Submission->Semaphore, 0);
+      vkFreeCommandBuffers(VK->Device, VK->Transfer_Command_Pool, 1, &Submission->Command_Buffer);
+      vkFreeCommandBuffers(VK->Device, VK->Command_Pool, 1, &Submission->Acquire_Command_Buffer);
+   }
+
+   Destroy_Vulkan_Buffer(VK, &Ring->Buffer);
+}
+
+static void Retire_Vulkan_Staging_Submissions(vulkan_context *VK, bool Wait_For_Oldest)
+{
+   // NOTE: Submissions on one queue are retired in the order they were made,
+   // so the ring's tail only moves forward. Whatever a retired submission
+   // released is acquired by the graphics queue right away.
+   vulkan_staging_ring *Ring = &VK->Staging;
+   while(Ring->Pending_Count > 0)
+   {
+      vulkan_staging_submission *Oldest = Ring->Submissions + Ring->First_Pending;
+      if(Wait_For_Oldest)
+      {
+         VC(vkWaitForFences(VK->Device, 1, &Oldest->Fence, VK_TRUE, UINT64_MAX));
+         Wait_For_Oldest = false;
+      }
+      else if(vkGetFenceStatus(VK->Device, Oldest->Fence) != VK_SUCCESS)
+      {
+         break;
+      }
+
+      if(Oldest->Acquiring)
+      {
+         VC(vkEndCommandBuffer(Oldest->Acquire_Command_Buffer));
+
+         VkPipelineStageFlags Wait_Stage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+         VkSubmitInfo Submit_Info = {0};
+         Submit_Info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+         Submit_Info.waitSemaphoreCount = 1;
+         Submit_Info.pWaitSemaphores = &Oldest->Semaphore;
+         Submit_Info.pWaitDstStageMask = &Wait_Stage;
+         Submit_Info.commandBufferCount = 1;
+         Submit_Info.pCommandBuffers = &Oldest->Acquire_Command_Buffer;
+         VC(vkQueueSubmit(VK->Graphics_Queue, 1, &Submit_Info, Oldest->Acquire_Fence));
+
+         Oldest->Acquiring = false;
+         Oldest->Acquire_Pending = true;
+      }
+
+      Ring->Tail = Oldest->Ring_End;
+      Ring->First_Pending = (Ring->First_Pending + 1) % VULKAN_STAGING_SUBMISSION_COUNT;
+      Ring->Pending_Count--;
+      Ring->Retired_Count++;
+   }
+}
+
+static void Submit_Vulkan_Staging(vulkan_context *VK)
+{
+   vulkan_staging_ring *Ring = &VK->Staging;
+   if(Ring->Open)
+   {
+      int Index = (Ring->First_Pending + Ring->Pending_Count) % VULKAN_STAGING_SUBMISSION_COUNT;
+      vulkan_staging_submission *Submission = Ring->Submissions + Index;
+      VC(vkEndCommandBuffer(Submission->Command_Buffer));
+
+      VkSubmitInfo Submit_Info = {0};
+      Submit_Info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+      Submit_Info.commandBufferCount = 1;
+      Submit_Info.pCommandBuffers = &Submission->Command_Buffer;
+      if(Submission->Acquiring)
+      {
+         Submit_Info.signalSemaphoreCount = 1;
+         Submit_Info.pSignalSemaphores = &Submission->Semaphore;
+      }
+      VC(vkQueueSubmit(VK->Transfer_Queue, 1, &Submit_Info, Submission->Fence));
+
+      Submission->Ring_End = Ring->Head;
+      Ring->Pending_Count++;
+      Ring->Submitted_Count++;
+      Ring->Open = false;
+   }
+}
+
+static u8 *Reserve_Vulkan_Staging(vulkan_context *VK, idx Size, VkDeviceSize *Offset)
+{
+   // NOTE: Reservations never wrap around the end of the buffer. When one
+   // doesn't fit before the end it starts over at the beginning, and what was
+   // skipped is freed along with everything else staged before it. Space
+   // reserved here belongs to the next submission to be made.
+   vulkan_staging_ring *Ring = &VK->Staging;
+   Assert(Size <= VULKAN_STAGING_RING_SIZE);
+
+   while(1)
+   {
+      if(Ring->Tail == Ring->Head && Ring->Pending_Count == 0 && !Ring->Open)
+      {
+         // NOTE: Nothing is in flight, so start from the beginning.
+         Ring->Head = Ring->Tail = Align_Offset(Ring->Head, VULKAN_STAGING_RING_SIZE);
+      }
+
+      u64 Start = Align_Offset(Ring->Head, VULKAN_STAGING_ALIGNMENT);
+      if((Start % VULKAN_STAGING_RING_SIZE) + Size > VULKAN_STAGING_RING_SIZE)
+      {
+         Start = Align_Offset(Start, VULKAN_STAGING_RING_SIZE);
+      }
+
+      if(Start + Size - Ring->Tail <= VULKAN_STAGING_RING_SIZE)
+      {
+         Ring->Head = Start + Size;
+         Ring->Staged_Bytes += Size;
+         *Offset = Start % VULKAN_STAGING_RING_SIZE;
+         break;
+      }
+
+      // NOTE: Out of space, so wait for the oldest submission. If the open one
+      // is all that's left, it has to be submitted first.
+      if(Ring->Pending_Count == 0)
+      {
+         Submit_Vulkan_Staging(VK);
+      }
+      Assert(Ring->Pending_Count > 0);
+      Retire_Vulkan_Staging_Submissions(VK, true);
+   }
+
+   u8 *Result = (u8 *)Ring->Buffer.Mapped_Memory_Address + *Offset;
+   return(Result);
+}
+
+static VkCommandBuffer Get_Vulkan_Staging_Commands(vulkan_context *VK)
+{
+   // NOTE: Returns the open submission's command buffer, beginning a new
+   // submission when none is open.
+   vulkan_staging_ring *Ring = &VK->Staging;
+   if(!Ring->Open)
+   {
+      if(Ring->Pending_Count == VULKAN_STAGING_SUBMISSION_COUNT)
+      {
+         Retire_Vulkan_Staging_Submissions(VK, true);
+      }
+
+      int Index = (Ring->First_Pending + Ring->Pending_Count) % VULKAN_STAGING_SUBMISSION_COUNT;
+      vulkan_staging_submission *Submission = Ring->Submissions + Index;
+      VC(vkResetFences(VK->Device, 1, &Submission->Fence));
+      VC(vkResetCommandBuffer(Submission->Command_Buffer, 0));
+
+      if(Submission->Acquire_Pending)
+      {
+         VC(vkWaitForFences(VK->Device, 1, &Submission->Acquire_Fence, VK_TRUE, UINT64_MAX));
+         VC(vkResetFences(VK->Device, 1, &Submission->Acquire_Fence));
+         Submission->Acquire_Pending = false;
+      }
+
+      VkCommandBufferBeginInfo Begin_Info = {0};
+      Begin_Info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+      Begin_Info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+      VC(vkBeginCommandBuffer(Submission->Command_Buffer, &Begin_Info));
+
+      Ring->Open = true;
+      Ring->Open_Head = Ring->Head;
+   }
+
+   VkCommandBuffer Result = Ring->Submissions[(Ring->First_Pending + Ring->Pending_Count) % VULKAN_STAGING_SUBMISSION_COUNT].Command_Buffer;
+   return(Result);
+}
+
+static VkCommandBuffer Get_Vulkan_Acquire_Commands(vulkan_context *VK)
+{
+   // NOTE: Returns the acquire commands of the open submission, which must be
+   // the one releasing what they acquire.
+   vulkan_staging_ring *Ring = &VK->Staging;
+   Assert(Ring->Open && Ring->Hand_Off);
+
+   vulkan_staging_submission *Submission = Ring->Submissions + (Ring->First_Pending + Ring->Pending_Count) % VULKAN_STAGING_SUBMISSION_COUNT;
+   if(!Submission->Acquiring)
+   {
+      VC(vkResetCommandBuffer(Submission->Acquire_Command_Buffer, 0));
+
+      VkCommandBufferBeginInfo Begin_Info = {0};
+      Begin_Info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+      Begin_Info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+      VC(vkBeginCommandBuffer(Submission->Acquire_Command_Buffer, &Begin_Info));
+
+      Submission->Acquiring = true;
+   }
+
+   return(Submission->Acquire_Command_Buffer);
+}
+
+static void End_Vulkan_Staging_Piece(vulkan_context *VK)
+{
+   // NOTE: Submitting once a quarter of the ring is staged lets the copies
+   // start while the CPU fills the rest.
+   vulkan_staging_ring *Ring = &VK->Staging;
+   if(Ring->Head - Ring->Open_Head >= VULKAN_STAGING_PIECE_SIZE)
+   {
+      Submit_Vulkan_Staging(VK);
+   }
+}
+
+static void Stream_To_Vulkan_Buffer(vulkan_context *VK, VkBuffer Destination, VkDeviceSize Destination_Offset, u8 *Source, idx Size)
+{
+   vulkan_staging_ring *Ring = &VK->Staging;
+
+   idx Offset = 0;
+   while(Offset < Size)
+   {
+      idx Piece_Size = Minimum(Size - Offset, VULKAN_STAGING_PIECE_SIZE);
+
+      VkDeviceSize Staging_Offset;
+      u8 *Staging = Reserve_Vulkan_Staging(VK, Piece_Size, &Staging_Offset);
+      Copy_Memory(Staging, Source + Offset, Piece_Size);
+
+      VkCommandBuffer Command_Buffer = Get_Vulkan_Staging_Commands(VK);
+      {
+         VkBufferCopy Region = {0};
+         Region.srcOffset = Staging_Offset;
+         Region.dstOffset = Destination_Offset + Offset;
+         Region.size = Piece_Size;
+         vkCmdCopyBuffer(Command_Buffer, Ring->Buffer.Buffer, Destination, 1, &Region);
+      }
+      End_Vulkan_Staging_Piece(VK);
+
+      Offset += Piece_Size;
+   }
+}
+
+static void Hand_Off_Vulkan_Buffer(vulkan_context *VK, VkBuffer Buffer)
+{
+   // NOTE: Called once everything has been streamed into a buffer. Without a
+   // transfer queue of its own, the batch's barrier covers it instead.
+   if(VK->Staging.Hand_Off)
+   {
+      VkBufferMemoryBarrier Barrier = {0};
+      Barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+      Barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+      Barrier.dstAccessMask = 0;
+      Barrier.srcQueueFamilyIndex = VK->Transfer_Queue_Family_Index;
+      Barrier.dstQueueFamilyIndex = VK->Graphics_Queue_Family_Index;
+      Barrier.buffer = Buffer;
+      Barrier.offset = 0;
+      Barrier.size = VK_WHOLE_SIZE;
+
+      VkCommandBuffer Release = Get_Vulkan_Staging_Commands(VK);
+      vkCmdPipelineBarrier(Release, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, 0, 1, &Barrier, 0, 0);
+
+      Barrier.srcAccessMask = 0;
+      Barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT|VK_ACCESS_INDEX_READ_BIT;
+
+      VkCommandBuffer Acquire = Get_Vulkan_Acquire_Commands(VK);
+      vkCmdPipelineBarrier(Acquire, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0, 0, 0, 1, &Barrier, 0, 0);
+   }
+}
+
+static void Record_Vulkan_Upload_Barrier(vulkan_context *VK, VkCommandBuffer Command_Buffer, vulkan_image *Image, bool Before_Copy)
+{
+   VkImageMemoryBarrier Barrier = {0};
+   Barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+   Barrier.oldLayout = Before_Copy ? VK_IMAGE_LAYOUT_UNDEFINED : VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+   Barrier.newLayout = Before_Copy ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+   Barrier.srcAccessMask = Before_Copy ? 0 : VK_ACCESS_TRANSFER_WRITE_BIT;
+   Barrier.dstAccessMask = Before_Copy ? VK_ACCESS_TRANSFER_WRITE_BIT : VK_ACCESS_SHADER_READ_BIT;
+   Barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+   Barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+   Barrier.image = Image->Image;
+   Barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+   Barrier.subresourceRange.levelCount = Image->Mip_Count;
+   Barrier.subresourceRange.layerCount = 1;
+
+   VkPipelineStageFlags Source_Stage = Before_Copy ? VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT : VK_PIPELINE_STAGE_TRANSFER_BIT;
+   VkPipelineStageFlags Destination_Stage = Before_Copy ? VK_PIPELINE_STAGE_TRANSFER_BIT : VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+
+   if(!Before_Copy && VK->Staging.Hand_Off)
+   {
+      // NOTE: The transfer queue can't name the fragment shader stage, so the
+      // layout change becomes a release there and an acquire on graphics.
+      Barrier.dstAccessMask = 0;
+      Barrier.srcQueueFamilyIndex = VK->Transfer_Queue_Family_Index;
+      Barrier.dstQueueFamilyIndex = VK->Graphics_Queue_Family_Index;
+      vkCmdPipelineBarrier(Command_Buffer, Source_Stage, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, 0, 0, 0, 1, &Barrier);
+
+      Barrier.srcAccessMask = 0;
+      Barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+      VkCommandBuffer Acquire = Get_Vulkan_Acquire_Commands(VK);
+      vkCmdPipelineBarrier(Acquire, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, Destination_Stage, 0, 0, 0, 0, 0, 1, &Barrier);
+   }
+   else
+   {
+      vkCmdPipelineBarrier(Command_Buffer, Source_Stage, Destination_Stage, 0, 0, 0, 0, 0, 1, &Barrier);
+   }
+}
+
+static void Get_Vulkan_Format_Block(VkFormat Format, u32 *Block_Width, u32 *Block_Height, idx *Block_Size)
+{
+   // NOTE: Uncompressed formats are treated as 1x1 blocks of one texel, and BC
+   // formats as 4x4 blocks of 8 or 16 bytes.
+   *Block_Width = 1;
+   *Block_Height = 1;
+   *Block_Size = 0;
+
+   switch(Format)
+   {
+      case VK_FORMAT_R8_UNORM:       { *Block_Size = 1; } break;
+      case VK_FORMAT_R8G8B8A8_UNORM:
+      case VK_FORMAT_R8G8B8A8_SRGB:  { *Block_Size = 4; } break;
+
+      case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+      case VK_FORMAT_BC1_RGB_SRGB_BLOCK: { *Block_Size = 8; } break;
+
+      case VK_FORMAT_BC3_UNORM_BLOCK:
+      case VK_FORMAT_BC3_SRGB_BLOCK:
+      case VK_FORMAT_BC5_UNORM_BLOCK:
+      case VK_FORMAT_BC7_UNORM_BLOCK:
+      case VK_FORMAT_BC7_SRGB_BLOCK: { *Block_Size = 16; } break;
+
+      // TODO: Add more formats as needed.
+      default: { Invalid_Code_Path; } break;
+   }
+
+   if(Format >= VK_FORMAT_BC1_RGB_UNORM_BLOCK && Format <= VK_FORMAT_BC7_SRGB_BLOCK)
+   {
+      *Block_Width = 4;
+      *Block_Height = 4;
+   }
+}
+
+static idx Get_Vulkan_Image_Size(VkFormat Format, u32 Width, u32 Height)
+{
+   u32 Block_Width, Block_Height;
+   idx Block_Size;
+   Get_Vulkan_Format_Block(Format, &Block_Width, &Block_Height, &Block_Size);
+
+   idx Result = (idx)((Width + Block_Width - 1) / Block_Width) * ((Height + Block_Height - 1) / Block_Height) * Block_Size;
+   return(Result);
+}
+
+static void Stream_To_Vulkan_Image(vulkan_context *VK, vulkan_image *Image, u32 Width, u32 Height, u8 *Source)
+{
+   // NOTE: Source holds every mip level, finest first. Each level is copied in
+   // bands of whole block rows, as many as fit in a piece. The transitions of
+   // all levels ride along with the first and last bands, and queue submission
+   // order covers the copies in between.
+   vulkan_staging_ring *Ring = &VK->Staging;
+
+   u32 Block_Width, Block_Height;
+   idx Block_Size;
+   Get_Vulkan_Format_Block(Image->Format, &Block_Width, &Block_Height, &Block_Size);
+
+   for(u32 Level = 0; Level < Image->Mip_Count; ++Level)
+   {
+      u32 Row_Count = (Height + Block_Height - 1) / Block_Height;
+      idx Row_Size = ((Width + Block_Width - 1) / Block_Width) * Block_Size;
+      u32 Rows_Per_Piece = (u32)(VULKAN_STAGING_PIECE_SIZE / Row_Size);
+      Assert(Rows_Per_Piece > 0);
+
+      u32 Row = 0;
+      do
+      {
+         u32 Band_Rows = Minimum(Row_Count - Row, Rows_Per_Piece);
+
+         VkDeviceSize Staging_Offset;
+         u8 *Staging = Reserve_Vulkan_Staging(VK, Band_Rows*Row_Size, &Staging_Offset);
+         Copy_Memory(Staging, Source + Row*Row_Size, Band_Rows*Row_Size);
+
+         VkCommandBuffer Command_Buffer = Get_Vulkan_Staging_Commands(VK);
+         if(Level == 0 && Row == 0)
+         {
+            Record_Vulkan_Upload_Barrier(VK, Command_Buffer, Image, true);
+         }
+         {
+            VkBufferImageCopy Region = {0};
+            Region.bufferOffset = Staging_Offset;
+            Region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            Region.imageSubresource.mipLevel = Level;
+            Region.imageSubresource.layerCount = 1;
+            Region.imageOffset.y = (s32)(Row * Block_Height);
+            Region.imageExtent.width = Width;
+            Region.imageExtent.height = Minimum(Band_Rows * Block_Height, Height - Row*Block_Height);
+            Region.imageExtent.depth = 1;
+            vkCmdCopyBufferToImage(Command_Buffer, Ring->Buffer.Buffer, Image->Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &Region);
+         }
+         Row += Band_Rows;
+         if(Level == Image->Mip_Count - 1 && Row == Row_Count)
+         {
+            Record_Vulkan_Upload_Barrier(VK, Command_Buffer, Image, false);
+         }
+
+         End_Vulkan_Staging_Piece(VK);
+      } while(Row < Row_Count);
+
+      Source += Row_Count*Row_Size;
+      Width = Maximum(Width / 2, 1);
+      Height = Maximum(Height / 2, 1);
+   }
+}
+
+static vulkan_upload_batch Begin_Vulkan_Upload_Batch(vulkan_context *VK)
+{
+   vulkan_upload_batch Result = {0};
+   Result.Start_Seconds = Get_Seconds();
+   Result.Start_Bytes = VK->Staging.Staged_Bytes;
+
+   return(Result);
+}
+
+static void End_Vulkan_Upload_Batch(vulkan_context *VK, vulkan_upload_batch *Batch)
+{
+   // NOTE: Image copies are followed by their own layout transitions, so only
+   // buffer copies need this barrier. Batches that staged nothing were written
+   // in place, and submitting anything afterwards makes host writes visible.
+   // Buffers handed off to the graphics queue were already released instead.
+   vulkan_staging_ring *Ring = &VK->Staging;
+   Batch->Bytes = Ring->Staged_Bytes - Batch->Start_Bytes;
+   if(Batch->Bytes && !Ring->Hand_Off)
+   {
+      VkCommandBuffer Command_Buffer = Get_Vulkan_Staging_Commands(VK);
+
+      VkMemoryBarrier Barrier = {0};
+      Barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+      Barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+      Barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT|VK_ACCESS_INDEX_READ_BIT|VK_ACCESS_UNIFORM_READ_BIT|VK_ACCESS_SHADER_READ_BIT;
+
+      VkPipelineStageFlags Source_Stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+      VkPipelineStageFlags Destination_Stage = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT|VK_PIPELINE_STAGE_VERTEX_SHADER_BIT|VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+      vkCmdPipelineBarrier(Command_Buffer, Source_Stage, Destination_Stage, 0, 1, &Barrier, 0, 0, 0, 0);
+   }
+   Submit_Vulkan_Staging(VK);
+
+   Batch->Submission = Ring->Submitted_Count;
+}
+
+static void Complete_Vulkan_Upload_Batch(vulkan_upload_batch *Batch)
+{
+   Batch->Complete = true;
+   if(Batch->Bytes)
+   {
+      double Seconds = Get_Seconds() - Batch->Start_Seconds;
+      double Megabytes = Batch->Bytes / (1024.0*1024.0);
+      Log("Uploaded %.1f MB in %.1f ms (%.1f MB/s).\n", Megabytes, 1000.0*Seconds, Megabytes / Maximum(Seconds, 1e-6));
+   }
+}
+
+static bool Poll_Vulkan_Upload_Batch(vulkan_context *VK, vulkan_upload_batch *Batch)
+{
+   if(!Batch->Complete)
+   {
+      Retire_Vulkan_Staging_Submissions(VK, false);
+      if(VK->Staging.Retired_Count >= Batch->Submission)
+      {
+         Complete_Vulkan_Upload_Batch(Batch);
+      }
+   }
+
+   return(Batch->Complete);
+}
+
+static void Wait_For_Vulkan_Upload_Batch(vulkan_context *VK, vulkan_upload_batch *Batch)
+{
+   if(!Batch->Complete)
+   {
+      while(VK->Staging.Retired_Count < Batch->Submission)
+      {
+         Retire_Vulkan_Staging_Submissions(VK, true);
+      }
+      Complete_Vulkan_Upload_Batch(Batch);
+   }
+}
+
+static vulkan_buffer Create_Vulkan_Device_Local_Buffer(vulkan_context *VK, void *Source_Memory, idx Size, VkBufferUsageFlags Usage)
+{
+   vulkan_memory_policy Policy = Get_Vulkan_Buffer_Upload_Policy(VK);
+   vulkan_buffer Result = Create_Vulkan_Buffer(VK, Size, Usage|VK_BUFFER_USAGE_TRANSFER_DST_BIT, Policy);
+
+   if(Result.Mapped_Memory_Address)
+   {
+      Copy_Memory(Result.Mapped_Memory_Address, Source_Memory, Size);
+   }
+   else
+   {
+      Stream_To_Vulkan_Buffer(VK, Result.Buffer, 0, Source_Memory, Size);
+      Hand_Off_Vulkan_Buffer(VK, Result.Buffer);
+   }
+
+   return(Result);
+}
+
+static inline idx Get_Vulkan_Index_Size(VkIndexType Index_Type)
+{
+   idx Result = 0;
+   switch(Index_Type)
+   {
+      case VK_INDEX_TYPE_UINT16:    { Result = 2; } break;
+      case VK_INDEX_TYPE_UINT32:    { Result = 4; } break;
+      default: {} break;
+   }
+   return(Result);
+};
+
+static bool Is_SPIRV(string Code)
+{
+   u32 Magic = 0;
+   if(Code.Length >= 20)
+   {
+      Copy_Memory(&Magic, Code.Data, sizeof(Magic));
+   }
+
+   bool Result = (Magic == 0x07230203 && (Code.Length % 4) == 0);
+   return(Result);
+}
+
+static bool Create_Basic_Vulkan_Shaders(vulkan_context *VK, vulkan_pipeline *Result)
+{
+   // NOTE: Creates nothing and returns false unless both files hold SPIR-V,
+   // which also turns away files caught halfway through being rewritten.
+   string Vertex_Shader_Code = Read_Entire_File("basic.vert.spv");
+   string Fragment_Shader_Code = Read_Entire_File("basic.frag.spv");
+
+   bool Valid = Is_SPIRV(Vertex_Shader_Code) && Is_SPIRV(Fragment_Shader_Code);
+   if(Valid)
+   {
+      VkShaderModuleCreateInfo Vertex_Shader_Info = {0};
+      Vertex_Shader_Info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+      Vertex_Shader_Info.codeSize = Vertex_Shader_Code.Length;
+      Vertex_Shader_Info.pCode = (u32 *)Vertex_Shader_Code.Data;
+
+      VkShaderModuleCreateInfo Fragment_Shader_Info = {0};
+      Fragment_Shader_Info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+      Fragment_Shader_Info.codeSize = Fragment_Shader_Code.Length;
+      Fragment_Shader_Info.pCode = (u32 *)Fragment_Shader_Code.Data;
+
+      VkShaderModule Vertex_Shader, Fragment_Shader;
+      Valid = (vkCreateShaderModule(VK->Device, &Vertex_Shader_Info, 0, &Vertex_Shader) == VK_SUCCESS);
+      if(Valid)
+      {
+         Valid = (vkCreateShaderModule(VK->Device, &Fragment_Shader_Info, 0, &Fragment_Shader) == VK_SUCCESS);
+         if(Valid)
+         {
+            Result->Vertex_Shader = Vertex_Shader;
+            Result->Fragment_Shader = Fragment_Shader;
+         }
+         else
+         {
+            vkDestroyShaderModule(VK->Device, Vertex_Shader, 0);
+         }
+      }
+   }
+
+   if(Vertex_Shader_Code.Data) Free_Entire_File(Vertex_Shader_Code.Data, Vertex_Shader_Code.Length);
+   if(Fragment_Shader_Code.Data) Free_Entire_File(Fragment_Shader_Code.Data, Fragment_Shader_Code.Length);
+
+   return(Valid);
+}
+
+static bool Create_Basic_Vulkan_Graphics_Pipeline(vulkan_context *VK, VkRenderPass Render_Pass, basic_vertex_layout *Layout,
+                                                  vulkan_pipeline *Base, vulkan_pipeline *Result)
+{
+   // NOTE: Variants for other vertex layouts pass the first pipeline as their
+   // base, and share its shader modules and pipeline layout. Returns false,
+   // leaving Result alone and creating nothing, if the shaders can't be loaded
+   // or the pipeline can't be created.
+   vulkan_pipeline Pipeline = {0};
+   if(Base)
+   {
+      Pipeline.Layout = Base->Layout;
+      Pipeline.Vertex_Shader = Base->Vertex_Shader;
+      Pipeline.Fragment_Shader = Base->Fragment_Shader;
+   }
+   else if(!Create_Basic_Vulkan_Shaders(VK, &Pipeline))
+   {
+      Log("Failed to load the basic shaders.\n");
+      return(false);
+   }
+
+   // NOTE: The vertex shader's normal decode is selected with a
+   // specialization constant, so it costs nothing when unused.
+   VkBool32 Octahedral_Normals = Layout->Octahedral_Normals;
+   VkSpecializationMapEntry Specialization_Entry = {0, 0, sizeof(VkBool32)};
+
+   VkSpecializationInfo Specialization_Info = {0};
+   Specialization_Info.mapEntryCount = 1;
+   Specialization_Info.pMapEntries = &Specialization_Entry;
+   Specialization_Info.dataSize = sizeof(Octahedral_Normals);
+   Specialization_Info.pData = &Octahedral_Normals;
+
+   VkPipelineShaderStageCreateInfo Shader_Stage_Infos[] =
+   {
+      {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, 0, 0, VK_SHADER_STAGE_VERTEX_BIT, Pipeline.Vertex_Shader, "main", &Specialization_Info},
+      {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, 0, 0, VK_SHADER_STAGE_FRAGMENT_BIT, Pipeline.Fragment_Shader, "main"},
+   };
+
+   // NOTE: Configure pipeline inputs. Each attribute has its own binding, with
+   // the locations declared in basic.vert, unless it's interleaved into the
+   // position's binding.
+   u32 Binding_Count = 0;
+   VkVertexInputBindingDescription Vertex_Binding_Descriptions[BASIC_VERTEX_ATTRIBUTE_COUNT] = {0};
+   VkVertexInputAttributeDescription Vertex_Attribute_Descriptions[BASIC_VERTEX_ATTRIBUTE_COUNT] = {0};
+   for(u32 Attribute = 0; Attribute < BASIC_VERTEX_ATTRIBUTE_COUNT; ++Attribute)
+   {
+      bool Interleaved = (Layout->Interleaved_Mask & (1 << Attribute));
+      u32 Binding = Interleaved ? BASIC_VERTEX_POSITION : Attribute;
+      if(Binding == Attribute)
+      {
+         VkVertexInputBindingDescription *Binding_Description = Vertex_Binding_Descriptions + Binding_Count++;
+         Binding_Description->binding = Attribute;
+         Binding_Description->stride = Layout->Strides[Attribute];
+         Binding_Description->inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+      }
+
+      Vertex_Attribute_Descriptions[Attribute].binding = Binding;
+      Vertex_Attribute_Descriptions[Attribute].location = Attribute;
+      Vertex_Attribute_Descriptions[Attribute].format = Layout->Formats[Attribute];
+      Vertex_Attribute_Descriptions[Attribute].offset = Interleaved ? Layout->Offsets[Attribute] : 0;
+   }
+
+   VkPipelineVertexInputStateCreateInfo Vertex_Input_Info = {0};
+   Vertex_Input_Info.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+   Vertex_Input_Info.vertexBindingDescriptionCount = Binding_Count;
+   Vertex_Input_Info.pVertexBindingDescriptions = Vertex_Binding_Descriptions;
+   Vertex_Input_Info.vertexAttributeDescriptionCount = Array_Count(Vertex_Attribute_Descriptions);
+   Vertex_Input_Info.pVertexAttributeDescriptions = Vertex_Attribute_Descriptions;
+
+   VkPipelineInputAssemblyStateCreateInfo Input_Assembly_Info = {0};
+   Input_Assembly_Info.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+   Input_Assembly_Info.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+   Input_Assembly_Info.primitiveRestartEnable = VK_FALSE;
+
+   VkDynamicState Dynamic_States[] =
+   {
+      VK_DYNAMIC_STATE_VIEWPORT,
+      VK_DYNAMIC_STATE_SCISSOR,
+   };
+   VkPipelineDynamicStateCreateInfo Dynamic_Info = {0};
+   Dynamic_Info.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+   Dynamic_Info.dynamicStateCount = Array_Count(Dynamic_States);
+   Dynamic_Info.pDynamicStates = Dynamic_States;
+
+   VkPipelineViewportStateCreateInfo Viewport_Info = {0};
+   Viewport_Info.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+   Viewport_Info.viewportCount = 1;
+   Viewport_Info.scissorCount = 1;
+
+   // NOTE: Configure rasterizer.
+   VkPipelineRasterizationStateCreateInfo Rasterizer_Info = {0};
+   Rasterizer_Info.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+   Rasterizer_Info.depthClampEnable = VK_FALSE;
+   Rasterizer_Info.polygonMode = VK_POLYGON_MODE_FILL;
+   Rasterizer_Info.lineWidth = 1.0f;
+   Rasterizer_Info.cullMode = VK_CULL_MODE_BACK_BIT;
+   Rasterizer_Info.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+   Rasterizer_Info.depthBiasEnable = VK_FALSE;
+   Rasterizer_Info.depthBiasConstantFactor = 0.0f;
+   Rasterizer_Info.depthBiasClamp = 0.0f;
+   Rasterizer_Info.depthBiasSlopeFactor = 0.0f;
+
+   // NOTE: Configure multisampling.
+   VkPipelineMultisampleStateCreateInfo Multisample_Info = {0};
+   Multisample_Info.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+   Multisample_Info.sampleShadingEnable = VK_FALSE;
+   Multisample_Info.rasterizationSamples = VK->Multisample_Count;
+   Multisample_Info.minSampleShading = 1.0f;
+   Multisample_Info.pSampleMask = 0;
+   Multisample_Info.alphaToCoverageEnable = VK_FALSE;
+   Multisample_Info.alphaToOneEnable = VK_FALSE;
+
+   // NOTE: Configure color blending.
+   VkPipelineColorBlendAttachmentState Blend_Attachment = {0};
+   Blend_Attachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT|VK_COLOR_COMPONENT_G_BIT|VK_COLOR_COMPONENT_B_BIT|VK_COLOR_COMPONENT_A_BIT;
+   Blend_Attachment.blendEnable = VK_FALSE;
+   Blend_Attachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+   Blend_Attachment.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
+   Blend_Attachment.colorBlendOp = VK_BLEND_OP_ADD;
+   Blend_Attachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+   Blend_Attachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+   Blend_Attachment.alphaBlendOp = VK_BLEND_OP_ADD;
+
+   VkPipelineColorBlendStateCreateInfo Blend_Info = {0};
+   Blend_Info.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+   Blend_Info.logicOpEnable = VK_FALSE;
+   Blend_Info.logicOp = VK_LOGIC_OP_COPY;
+   Blend_Info.attachmentCount = 1;
+   Blend_Info.pAttachments = &Blend_Attachment;
+   Blend_Info.blendConstants[0] = 0.0f;
+   Blend_Info.blendConstants[1] = 0.0f;
+   Blend_Info.blendConstants[2] = 0.0f;
+   Blend_Info.blendConstants[3] = 0.0f;
+
+   VkPipelineDepthStencilStateCreateInfo Depth_Info = {0};
+   Depth_Info.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+   Depth_Info.depthTestEnable = VK_TRUE;
+   Depth_Info.depthWriteEnable = VK_TRUE;
+   Depth_Info.depthCompareOp = VK_COMPARE_OP_LESS;
+   Depth_Info.depthBoundsTestEnable = VK_FALSE;
+   Depth_Info.minDepthBounds = 0.0f;
+   Depth_Info.maxDepthBounds = 1.0f;
+   Depth_Info.stencilTestEnable = VK_FALSE;
+   // Depth_Info.front = {0};
+   // Depth_Info.back = {0};
+
+   // NOTE: Create pipeline layout.
+   if(!Base)
+   {
+      VkDescriptorSetLayout Set_Layouts[] = {VK->Descriptor_Set_Layout, VK->Material_Set_Layout};
+
+      VkPipelineLayoutCreateInfo Layout_Info = {0};
+      Layout_Info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+      Layout_Info.setLayoutCount = Array_Count(Set_Layouts);
+      Layout_Info.pSetLayouts = Set_Layouts;
+
+      VC(vkCreatePipelineLayout(VK->Device, &Layout_Info, 0, &Pipeline.Layout));
+   }
+
+   VkGraphicsPipelineCreateInfo Pipeline_Info = {0};
+   Pipeline_Info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+   Pipeline_Info.stageCount = 2;
+   Pipeline_Info.pStages = Shader_Stage_Infos;
+   Pipeline_Info.pVertexInputState = &Vertex_Input_Info;
+   Pipeline_Info.pInputAssemblyState = &Input_Assembly_Info;
+   Pipeline_Info.pViewportState = &Viewport_Info;
+   Pipeline_Info.pRasterizationState = &Rasterizer_Info;
+   Pipeline_Info.pMultisampleState = &Multisample_Info;
+   Pipeline_Info.pDepthStencilState = &Depth_Info;
+   Pipeline_Info.pColorBlendState = &Blend_Info;
+   Pipeline_Info.pDynamicState = &Dynamic_Info;
+   Pipeline_Info.layout = Pipeline.Layout;
+   Pipeline_Info.renderPass = Render_Pass;
+   Pipeline_Info.subpass = 0;
+   Pipeline_Info.basePipelineHandle = VK_NULL_HANDLE;
+   Pipeline_Info.basePipelineIndex = -1;
+
+   VkResult Created = vkCreateGraphicsPipelines(VK->Device, VK_NULL_HANDLE, 1, &Pipeline_Info, 0, &Pipeline.Pipeline);
+   if(Created == VK_SUCCESS)
+   {
+      *Result = Pipeline;
+   }
+   else
+   {
+      Log("Failed to create a basic pipeline: %s\n", string_VkResult(Created));
+      if(!Base)
+      {
+         vkDestroyPipelineLayout(VK->Device, Pipeline.Layout, 0);
+         vkDestroyShaderModule(VK->Device, Pipeline.Vertex_Shader, 0);
+         vkDestroyShaderModule(VK->Device, Pipeline.Fragment_Shader, 0);
+      }
+   }
+
+   return(Created == VK_SUCCESS);
+}
+
+static basic_vertex_layout Get_Basic_Vertex_Layout(gltf_scene *Scene, gltf_primitive *Primitive)
+{
+   // NOTE: Attributes the primitive doesn't have fall back to these formats,
+   // which match the inputs declared in basic.vert, read at a stride of zero
+   // so every vertex gets the same default value. Attributes it does have are
+   // read at their buffer view's stride, so interleaved and padded views work.
+   basic_vertex_layout Result =
+   {
+      {VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32_SFLOAT},
+      {0, 0, 0, 0},
+   };
+
+   int Accessors[BASIC_VERTEX_ATTRIBUTE_COUNT] = {Primitive->Position, Primitive->Normal, Primitive->Color_0, Primitive->Texcoord_0};
+   for(int Attribute = 0; Attribute < BASIC_VERTEX_ATTRIBUTE_COUNT; ++Attribute)
+   {
+      if(Accessors[Attribute] >= 0)
+      {
+         gltf_accessor Accessor = Scene->Accessors[Accessors[Attribute]];
+         gltf_buffer_view View = Scene->Buffer_Views[Accessor.Buffer_View];
+
+         idx Element_Size = Get_GLTF_Type_Size(Accessor.Type, Accessor.Component_Type);
+         Result.Formats[Attribute] = GLTF_To_Vulkan_Format(Accessor.Type, Accessor.Component_Type, Accessor.Normalized);
+         Result.Strides[Attribute] = (u32)(View.Stride ? View.Stride : Element_Size);
+      }
+   }
+
+   // NOTE: Attributes that all live in the position's buffer view, within its
+   // stride, can share a single binding.
+   if(Primitive->Position >= 0)
+   {
+      gltf_accessor Position = Scene->Accessors[Primitive->Position];
+      gltf_buffer_view View = Scene->Buffer_Views[Position.Buffer_View];
+
+      u32 Mask = 0;
+      for(int Attribute = 0; View.Stride && Attribute < BASIC_VERTEX_ATTRIBUTE_COUNT; ++Attribute)
+      {
+         if(Accessors[Attribute] >= 0)
+         {
+            gltf_accessor Accessor = Scene->Accessors[Accessors[Attribute]];
+            idx Element_Size = Get_GLTF_Type_Size(Accessor.Type, Accessor.Component_Type);
+            if(Accessor.Buffer_View == Position.Buffer_View && Accessor.Offset + Element_Size <= View.Stride)
+            {
+               Mask |= (1 << Attribute);
+            }
+         }
+      }
+
+      // NOTE: Only worth it when more than the position shares the binding.
+      if(Mask & ~(1 << BASIC_VERTEX_POSITION))
+      {
+         Result.Interleaved_Mask = Mask;
+         for(int Attribute = 0; Attribute < BASIC_VERTEX_ATTRIBUTE_COUNT; ++Attribute)
+         {
+            if(Mask & (1 << Attribute))
+            {
+               Result.Offsets[Attribute] = Scene->Accessors[Accessors[Attribute]].Offset;
+            }
+         }
+      }
+   }
+
+   // NOTE: glTF normals are always three components, so two-component normals
+   // can only be the octahedral encoding written by the baker.
+   if(Primitive->Normal >= 0)
+   {
+      Result.Octahedral_Normals = (Scene->Accessors[Primitive->Normal].Type == GLTF_ACCESSOR_TYPE_VEC2);
+   }
+
+   return(Result);
+}
+
+static bool Basic_Vertex_Layout_Matches(basic_vertex_layout *Pipeline, basic_vertex_layout *Draw, gltf_primitive *Primitive)
+{
+   // NOTE: Missing attributes have to match exactly too, since their default
+   // value is only meaningful in the fallback format, see Create_Vulkan_Scene.
+   bool Result = true;
+   for(int Attribute = 0; Attribute < BASIC_VERTEX_ATTRIBUTE_COUNT; ++Attribute)
+   {
+      if(Pipeline->Formats[Attribute] != Draw->Formats[Attribute] ||
+         Pipeline->Strides[Attribute] != Draw->Strides[Attribute])
+      {
+         Result = false;
+      }
+   }
+
+   if(Primitive->Normal >= 0 && Pipeline->Octahedral_Normals != Draw->Octahedral_Normals)
+   {
+      Result = false;
+   }
+
+   if(Pipeline->Interleaved_Mask != Draw->Interleaved_Mask)
+   {
+      Result = false;
+   }
+   for(int Attribute = 0; Attribute < BASIC_VERTEX_ATTRIBUTE_COUNT; ++Attribute)
+   {
+      if((Draw->Interleaved_Mask & (1 << Attribute)) && Pipeline->Offsets[Attribute] != Draw->Offsets[Attribute])
+      {
+         Result = false;
+      }
+   }
+
+   return(Result);
+}
+
+static int Get_Basic_Pipeline(vulkan_context *VK, basic_vertex_layout *Layout, gltf_primitive *Primitive)
+{
+   // NOTE: Returns the index of a basic pipeline variant that can draw the
+   // primitive, compiling a new one if none can. Returns -1 if the layout
+   // can't be drawn at all.
+   int Result = -1;
+   for(int Pipeline_Index = 0; Pipeline_Index < VK->Basic_Pipeline_Count; ++Pipeline_Index)
+   {
+      if(Basic_Vertex_Layout_Matches(VK->Basic_Vertex_Layouts + Pipeline_Index, Layout, Primitive))
+      {
+         Result = Pipeline_Index;
+         break;
+      }
+   }
+
+   if(Result < 0 && VK->Basic_Pipeline_Count < MAX_BASIC_PIPELINE_COUNT)
+   {
+      bool Supported = true;
+      for(int Attribute = 0; Attribute < BASIC_VERTEX_ATTRIBUTE_COUNT; ++Attribute)
+      {
+         VkFormatProperties Properties;
+         vkGetPhysicalDeviceFormatProperties(VK->Physical_Device.Handle, Layout->Formats[Attribute], &Properties);
+         if(!(Properties.bufferFeatures & VK_FORMAT_FEATURE_VERTEX_BUFFER_BIT) ||
+            Layout->Strides[Attribute] > VK->Physical_Device.Properties.limits.maxVertexInputBindingStride)
+         {
+            Log("The basic pipeline can't read vertex format %s.\n", string_VkFormat(Layout->Formats[Attribute]));
+            Supported = false;
+         }
+      }
+
+      int Index = VK->Basic_Pipeline_Count;
+      if(Supported && Create_Basic_Vulkan_Graphics_Pipeline(VK, VK->Basic_Render_Pass, Layout, VK->Basic_Graphics_Pipelines, VK->Basic_Graphics_Pipelines + Index))
+      {
+         Result = VK->Basic_Pipeline_Count++;
+         VK->Basic_Vertex_Layouts[Result] = *Layout;
+      }
+   }
+
+   return(Result);
+}
+
+static VkSamplerAddressMode GLTF_To_Vulkan_Wrap(int Wrap)
+{
+   VkSamplerAddressMode Result = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+   if(Wrap == GLTF_WRAP_CLAMP_TO_EDGE)   Result = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+   if(Wrap == GLTF_WRAP_MIRRORED_REPEAT) Result = VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT;
+
+   return(Result);
+}
+
+static VkSampler Create_Vulkan_Texture_Sampler(vulkan_context *VK, gltf_sampler *Source)
+{
+   // NOTE: Filters the file leaves unspecified, or doesn't have a sampler for
+   // at all, default to linear with repeating coordinates.
+   int Mag = Source->Mag_Filter;
+   int Min = Source->Min_Filter;
+   bool Nearest_Mip = (Min == GLTF_FILTER_NEAREST_MIPMAP_NEAREST || Min == GLTF_FILTER_LINEAR_MIPMAP_NEAREST);
+   bool Nearest_Min = (Min == GLTF_FILTER_NEAREST || Min == GLTF_FILTER_NEAREST_MIPMAP_NEAREST || Min == GLTF_FILTER_NEAREST_MIPMAP_LINEAR);
 
-   VkBufferUsageFlags Usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT|VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
-   VkMemoryPropertyFlags Properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
-   vulkan_buffer Result = Create_Vulkan_Buffer(VK, Size, Usage, Properties);
-   Result.Index_Type = GLTF_To_Vulkan_Index(Accessor.Component_Type);
+   VkSamplerCreateInfo Sampler_Info = {0};
+   Sampler_Info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+   Sampler_Info.magFilter = (Mag == GLTF_FILTER_NEAREST) ? VK_FILTER_NEAREST : VK_FILTER_LINEAR;
+   Sampler_Info.minFilter = Nearest_Min ? VK_FILTER_NEAREST : VK_FILTER_LINEAR;
+   Sampler_Info.addressModeU = GLTF_To_Vulkan_Wrap(Source->Wrap_S);
+   Sampler_Info.addressModeV = GLTF_To_Vulkan_Wrap(Source->Wrap_T);
+   Sampler_Info.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+   Sampler_Info.anisotropyEnable = VK->Physical_Device.Enabled_Features.samplerAnisotropy;
+   Sampler_Info.maxAnisotropy = (VK->Physical_Device.Enabled_Features.samplerAnisotropy) ? VK->Physical_Device.Properties.limits.maxSamplerAnisotropy : 1.0f;
+   Sampler_Info.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+   Sampler_Info.unnormalizedCoordinates = VK_FALSE;
+   Sampler_Info.compareEnable = VK_FALSE;
+   Sampler_Info.compareOp = VK_COMPARE_OP_ALWAYS;
+   Sampler_Info.mipmapMode = Nearest_Mip ? VK_SAMPLER_MIPMAP_MODE_NEAREST : VK_SAMPLER_MIPMAP_MODE_LINEAR;
+   Sampler_Info.mipLodBias = 0.0f;
+   Sampler_Info.minLod = 0.0f;
+   Sampler_Info.maxLod = VK_LOD_CLAMP_NONE;
+
+   // NOTE: Samplers are shared by images with different mip counts, so the
+   // LOD range is left to clamp to each image's own levels. Min filters without
+   // a mipmap mode only read the top level, which Vulkan expresses as a max LOD
+   // of 0.25 with nearest mipmapping.
+   bool Mipmapped = (Min != GLTF_FILTER_NEAREST && Min != GLTF_FILTER_LINEAR);
+   if(!Mipmapped)
+   {
+      Sampler_Info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+      Sampler_Info.maxLod = 0.25f;
+   }
+
+   VkSampler Result;
+   VC(vkCreateSampler(VK->Device, &Sampler_Info, 0, &Result));
+
+   return(Result);
+}
 
-   Copy_Vulkan_Buffer(VK, Result.Buffer, Staging.Buffer, Size);
+static VkFormat GLTF_To_Vulkan_Image_Format(vulkan_context *VK, gltf_image *Image)
+{
+   // NOTE: Color images are sampled as sRGB, everything else as linear. BC
+   // formats are only usable when the device supports them.
+   bool Color = (Image->Usage == GLTF_IMAGE_USAGE_COLOR);
+   bool Compressed = (Image->Format != GLTF_IMAGE_FORMAT_NONE && Image->Format != GLTF_IMAGE_FORMAT_RGBA8);
 
-   vkDestroyBuffer(VK->Device, Staging.Buffer, 0);
-   vkFreeMemory(VK->Device, Staging.Device_Memory, 0);
+   VkFormat Result = VK_FORMAT_UNDEFINED;
+   if(!Compressed || VK->Physical_Device.Enabled_Features.textureCompressionBC)
+   {
+      switch(Image->Format)
+      {
+         case GLTF_IMAGE_FORMAT_RGBA8: { Result = Color ? VK_FORMAT_R8G8B8A8_SRGB       : VK_FORMAT_R8G8B8A8_UNORM;       } break;
+         case GLTF_IMAGE_FORMAT_BC1:   { Result = Color ? VK_FORMAT_BC1_RGB_SRGB_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK; } break;
+         case GLTF_IMAGE_FORMAT_BC3:   { Result = Color ? VK_FORMAT_BC3_SRGB_BLOCK     : VK_FORMAT_BC3_UNORM_BLOCK;     } break;
+         case GLTF_IMAGE_FORMAT_BC5:   { Result = VK_FORMAT_BC5_UNORM_BLOCK; } break;
+         case GLTF_IMAGE_FORMAT_BC7:   { Result = Color ? VK_FORMAT_BC7_SRGB_BLOCK     : VK_FORMAT_BC7_UNORM_BLOCK;     } break;
+         default: break;
+      }
+   }
 
    return(Result);
 }
 
-static void Copy_Vulkan_Buffer_To_Image(vulkan_context *VK, VkBuffer Buffer, VkImage Image, u32 Width, u32 Height)
+static void Create_Vulkan_Scene_Materials(vulkan_context *VK, vulkan_scene *Result, gltf_scene *Scene, arena *Arena)
+{
+   // NOTE: Stream each image the device can sample into its own image, then
+   // point a descriptor set per material at its base color texture. The set
+   // after the last material is for primitives without one.
+   Result->Image_Count = Scene->Image_Count;
+   Result->Images = Allocate(Arena, vulkan_image, Maximum(Scene->Image_Count, 1));
+
+   int Unsupported_Count = 0;
+   for(int Image_Index = 0; Image_Index < Scene->Image_Count; ++Image_Index)
+   {
+      gltf_image *Source = Scene->Images + Image_Index;
+      VkFormat Format = GLTF_To_Vulkan_Image_Format(VK, Source);
+      if(Format == VK_FORMAT_UNDEFINED)
+      {
+         Unsupported_Count += (Source->Format != GLTF_IMAGE_FORMAT_NONE);
+         continue;
+      }
+
+      VkImageUsageFlags Usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT|VK_IMAGE_USAGE_SAMPLED_BIT;
+      vulkan_image *Image = Result->Images + Image_Index;
+      *Image = Create_Vulkan_Image(VK, Source->Width, Source->Height, Source->Mip_Count, VK_SAMPLE_COUNT_1_BIT, Usage, Format, VK_IMAGE_TILING_OPTIMAL, VULKAN_MEMORY_DEVICE_LOCAL);
+      Image->View = Create_Vulkan_Image_View(VK, Image->Image, Format, VK_IMAGE_ASPECT_COLOR_BIT);
+
+      Stream_To_Vulkan_Image(VK, Image, Source->Width, Source->Height, Scene->Image_Data + Source->Offset);
+   }
+
+   if(Unsupported_Count)
+   {
+      Log("Replaced %d of %d images that the device can't sample with white.\n", Unsupported_Count, Scene->Image_Count);
+   }
+
+   Result->Sampler_Count = Scene->Sampler_Count;
+   Result->Samplers = Allocate(Arena, VkSampler, Maximum(Scene->Sampler_Count, 1));
+   for(int Sampler_Index = 0; Sampler_Index < Scene->Sampler_Count; ++Sampler_Index)
+   {
+      Result->Samplers[Sampler_Index] = Create_Vulkan_Texture_Sampler(VK, Scene->Samplers + Sampler_Index);
+   }
+
+   u32 Set_Count = Scene->Material_Count + 1;
+
+   VkDescriptorPoolSize Pool_Size = {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, Set_Count};
+   VkDescriptorPoolCreateInfo Pool_Info = {0};
+   Pool_Info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+   Pool_Info.poolSizeCount = 1;
+   Pool_Info.pPoolSizes = &Pool_Size;
+   Pool_Info.maxSets = Set_Count;
+   VC(vkCreateDescriptorPool(VK->Device, &Pool_Info, 0, &Result->Descriptor_Pool));
+
+   VkDescriptorSetLayout *Set_Layouts = Allocate(&VK->Scratch, VkDescriptorSetLayout, Set_Count);
+   for(u32 Set_Index = 0; Set_Index < Set_Count; ++Set_Index)
+   {
+      Set_Layouts[Set_Index] = VK->Material_Set_Layout;
+   }
+
+   VkDescriptorSetAllocateInfo Set_Info = {0};
+   Set_Info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+   Set_Info.descriptorPool = Result->Descriptor_Pool;
+   Set_Info.descriptorSetCount = Set_Count;
+   Set_Info.pSetLayouts = Set_Layouts;
+
+   Result->Material_Sets = Allocate(Arena, VkDescriptorSet, Set_Count);
+   VC(vkAllocateDescriptorSets(VK->Device, &Set_Info, Result->Material_Sets));
+
+   VkDescriptorImageInfo *Image_Infos = Allocate(&VK->Scratch, VkDescriptorImageInfo, Set_Count);
+   VkWriteDescriptorSet *Writes = Allocate(&VK->Scratch, VkWriteDescriptorSet, Set_Count);
+   for(u32 Set_Index = 0; Set_Index < Set_Count; ++Set_Index)
+   {
+      VkDescriptorImageInfo *Image_Info = Image_Infos + Set_Index;
+      Image_Info->imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+      Image_Info->imageView = VK->White_Texture.View;
+      Image_Info->sampler = VK->Texture_Sampler;
+
+      int Texture_Index = (Set_Index < (u32)Scene->Material_Count) ? Scene->Materials[Set_Index].Base_Color_Texture : -1;
+      if(Texture_Index >= 0)
+      {
+         gltf_texture *Texture = Scene->Textures + Texture_Index;
+         if(Texture->Image >= 0 && Result->Images[Texture->Image].Image)
+         {
+            Image_Info->imageView = Result->Images[Texture->Image].View;
+         }
+         if(Texture->Sampler >= 0)
+         {
+            Image_Info->sampler = Result->Samplers[Texture->Sampler];
+         }
+      }
+
+      VkWriteDescriptorSet *Write = Writes + Set_Index;
+      Write->sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+      Write->dstSet = Result->Material_Sets[Set_Index];
+      Write->dstBinding = 0;
+      Write->descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+      Write->descriptorCount = 1;
+      Write->pImageInfo = Image_Info;
+   }
+   vkUpdateDescriptorSets(VK->Device, Set_Count, Writes, 0, 0);
+}
+
+static void Create_Vulkan_Scene(vulkan_context *VK, vulkan_scene *Result, gltf_scene *Scene, arena *Arena)
 {
-   VkCommandBuffer Command_Buffer = Begin_Onetime_Vulkan_Commands(VK);
+   // NOTE: Stream the scene's buffers into one device buffer, then turn the
+   // scene's draw list into the bind offsets each draw needs. Scenes arrive
+   // after the pipeline exists, so draws whose layout differs from the
+   // pipeline's are skipped for now. The scene's tables are allocated from
+   // Arena. All of its uploads go in one batch, which is polled each frame
+   // rather than waited on here.
+   Result->Source = Scene;
+   Result->Upload = Begin_Vulkan_Upload_Batch(VK);
+   Result->Draws = Allocate(Arena, vulkan_draw, Scene->Draw_Count);
+   Result->Draw_Count = 0;
+
+   idx Total_Size = 0;
+   idx *Buffer_Offsets = Allocate(&VK->Scratch, idx, Maximum(Scene->Buffer_Count, 1));
+   for(int Buffer_Index = 0; Buffer_Index < Scene->Buffer_Count; ++Buffer_Index)
+   {
+      Buffer_Offsets[Buffer_Index] = Total_Size;
+      Total_Size = Align_Offset(Total_Size + Scene->Buffers[Buffer_Index].Length, 16);
+   }
+
+   if(Total_Size > 0)
+   {
+      VkBufferUsageFlags Usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT|VK_BUFFER_USAGE_INDEX_BUFFER_BIT|VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+      Result->Buffer = Create_Vulkan_Buffer(VK, Total_Size, Usage, Get_Vulkan_Buffer_Upload_Policy(VK));
+
+      // NOTE: Buffers in host visible device memory are written in place.
+      u8 *Mapped = Result->Buffer.Mapped_Memory_Address;
+      for(int Buffer_Index = 0; Buffer_Index < Scene->Buffer_Count; ++Buffer_Index)
+      {
+         gltf_buffer *Buffer = Scene->Buffers + Buffer_Index;
+         if(Mapped)
+         {
+            Copy_Memory(Mapped + Buffer_Offsets[Buffer_Index], Buffer->Data, Buffer->Length);
+         }
+         else
+         {
+            Stream_To_Vulkan_Buffer(VK, Result->Buffer.Buffer, Buffer_Offsets[Buffer_Index], Buffer->Data, Buffer->Length);
+         }
+      }
+      if(!Mapped)
+      {
+         Hand_Off_Vulkan_Buffer(VK, Result->Buffer.Buffer);
+      }
+   }
+
+   Create_Vulkan_Scene_Materials(VK, Result, Scene, Arena);
+
+   int Skipped_Count = 0;
+
+   for(int Draw_Index = 0; Draw_Index < Scene->Draw_Count; ++Draw_Index)
    {
-      VkBufferImageCopy Region = {0};
-      Region.bufferOffset = 0;
-      Region.bufferRowLength = 0;
-      Region.bufferImageHeight = 0;
+      gltf_draw *Source = Scene->Draws + Draw_Index;
+      gltf_primitive *Primitive = Scene->Primitives + Source->Primitive;
+      int Accessors[BASIC_VERTEX_ATTRIBUTE_COUNT] = {Primitive->Position, Primitive->Normal, Primitive->Color_0, Primitive->Texcoord_0};
+
+      bool Drawable = (Result->Buffer.Buffer &&
+                       Primitive->Mode == GLTF_PRIMITIVE_MODE_TRIANGLES &&
+                       Primitive->Position >= 0);
+
+      gltf_accessor Index_Accessor = {0};
+      if(Drawable && Primitive->Indices >= 0)
+      {
+         // NOTE: Parse_GLTF widens 8-bit indices, so anything else here came
+         // from a malformed file.
+         Index_Accessor = Scene->Accessors[Primitive->Indices];
+         Drawable = (Index_Accessor.Component_Type == GLTF_ACCESSOR_COMPONENT_U16 ||
+                     Index_Accessor.Component_Type == GLTF_ACCESSOR_COMPONENT_U32);
+      }
+
+      int Pipeline = -1;
+      if(Drawable)
+      {
+         basic_vertex_layout Layout = Get_Basic_Vertex_Layout(Scene, Primitive);
+         Pipeline = Get_Basic_Pipeline(VK, &Layout, Primitive);
+         Drawable = (Pipeline >= 0);
+      }
+
+      if(!Drawable)
+      {
+         Skipped_Count++;
+         continue;
+      }
+
+      vulkan_draw *Draw = Result->Draws + Result->Draw_Count++;
+      Draw->Node = Source->Node;
+      Draw->Pipeline = Pipeline;
+
+      // NOTE: Primitives without a material use the glTF default, which is
+      // plain white.
+      int Material = (Primitive->Material >= 0) ? Primitive->Material : Scene->Material_Count;
+      Draw->Material_Set = Result->Material_Sets[Material];
+      Draw->Base_Color_Factor = (vec4){1, 1, 1, 1};
+      if(Primitive->Material >= 0)
+      {
+         float *Factor = Scene->Materials[Material].Base_Color_Factor;
+         Draw->Base_Color_Factor = (vec4){Factor[0], Factor[1], Factor[2], Factor[3]};
+      }
+
+      basic_vertex_layout *Pipeline_Layout = VK->Basic_Vertex_Layouts + Pipeline;
+      for(int Attribute = 0; Attribute < BASIC_VERTEX_ATTRIBUTE_COUNT; ++Attribute)
+      {
+         if(Accessors[Attribute] >= 0)
+         {
+            gltf_accessor Accessor = Scene->Accessors[Accessors[Attribute]];
+            gltf_buffer_view View = Scene->Buffer_Views[Accessor.Buffer_View];
+
+            // NOTE: Interleaved attributes are offset by the pipeline instead,
+            // and only the position's binding is actually read.
+            bool Interleaved = (Pipeline_Layout->Interleaved_Mask & (1 << Attribute));
+            Draw->Vertex_Buffers[Attribute] = Result->Buffer.Buffer;
+            Draw->Vertex_Offsets[Attribute] = Buffer_Offsets[View.Buffer] + View.Offset + (Interleaved ? 0 : Accessor.Offset);
+         }
+         else
+         {
+            Draw->Vertex_Offsets[Attribute] = Attribute * sizeof(vec4);
+         }
+      }
+
+      // NOTE: Quantized positions are decoded by folding their offset and
+      // scale into the model matrix.
+      gltf_accessor Position_Accessor = Scene->Accessors[Primitive->Position];
+      float *Offset = Position_Accessor.Decode_Offset;
+      float S = Position_Accessor.Decode_Scale;
+      Draw->Position_Decode = Multiply_Matrix4(Translate(Offset[0], Offset[1], Offset[2]), Scale(S, S, S));
+
+      if(Primitive->Indices >= 0)
+      {
+         gltf_buffer_view View = Scene->Buffer_Views[Index_Accessor.Buffer_View];
 
-      Region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-      Region.imageSubresource.mipLevel = 0;
-      Region.imageSubresource.baseArrayLayer = 0;
-      Region.imageSubresource.layerCount = 1;
+         Draw->Indexed = true;
+         Draw->Index_Type = GLTF_To_Vulkan_Index(Index_Accessor.Component_Type);
+         Draw->Index_Offset = Buffer_Offsets[View.Buffer] + View.Offset + Index_Accessor.Offset;
+         Draw->Count = Index_Accessor.Count;
 
-      Region.imageOffset.x = 0;
-      Region.imageOffset.y = 0;
-      Region.imageOffset.z = 0;
+         // NOTE: The index accessor of a baked primitive spans its whole LOD
+         // chain, so only the first range is full detail.
+         if(Primitive->Lod_Count > 0)
+         {
+            Draw->Lod_Count = Primitive->Lod_Count;
+            Draw->Lods = Scene->Lods + Primitive->First_Lod;
+            Draw->Count = Draw->Lods[0].Index_Count;
+            Draw->Center = (vec3){Primitive->Center[0], Primitive->Center[1], Primitive->Center[2]};
+            Draw->Radius = Primitive->Radius;
+         }
+      }
+      else
+      {
+         Draw->Count = Position_Accessor.Count;
+      }
+   }
+
+   if(Skipped_Count)
+   {
+      Log("Skipped %d of %d draws that the basic pipeline can't render.\n", Skipped_Count, Scene->Draw_Count);
+   }
 
-      Region.imageExtent.width = Width;
-      Region.imageExtent.height = Height;
-      Region.imageExtent.depth = 1;
+   // NOTE: Point every missing attribute at its glTF default value, one vec4
+   // per attribute read at a stride of zero. Vertex colors multiply the base
+   // color, so a missing COLOR_0 has to read as white.
+   vec4 Defaults[BASIC_VERTEX_ATTRIBUTE_COUNT] = {0};
+   Defaults[BASIC_VERTEX_COLOR] = (vec4){1, 1, 1, 1};
+   Result->Default_Vertex_Buffer = Create_Vulkan_Device_Local_Buffer(VK, Defaults, sizeof(Defaults), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+   End_Vulkan_Upload_Batch(VK, &Result->Upload);
 
-      vkCmdCopyBufferToImage(Command_Buffer, Buffer, Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &Region);
+   for(int Draw_Index = 0; Draw_Index < Result->Draw_Count; ++Draw_Index)
+   {
+      vulkan_draw *Draw = Result->Draws + Draw_Index;
+      for(int Attribute = 0; Attribute < BASIC_VERTEX_ATTRIBUTE_COUNT; ++Attribute)
+      {
+         if(!Draw->Vertex_Buffers[Attribute])
+         {
+            Draw->Vertex_Buffers[Attribute] = Result->Default_Vertex_Buffer.Buffer;
+         }
+      }
    }
-   End_Onetime_Vulkan_Commands(VK, Command_Buffer);
 }
 
-static idx Get_Vulkan_Format_Size(VkFormat Format)
+static idx Get_Vulkan_Scene_Table_Size(gltf_scene *Scene)
 {
+   // NOTE: What Create_Vulkan_Scene allocates from its arena.
    idx Result = 0;
+   Result += sizeof(vulkan_draw)*Scene->Draw_Count;
+   Result += sizeof(vulkan_image)*Maximum(Scene->Image_Count, 1);
+   Result += sizeof(VkSampler)*Maximum(Scene->Sampler_Count, 1);
+   Result += sizeof(VkDescriptorSet)*(Scene->Material_Count + 1);
+
+   return(Result);
+}
+
+static void Destroy_Vulkan_Scene(vulkan_context *VK, vulkan_scene *Scene)
+{
+   vkDestroyDescriptorPool(VK->Device, Scene->Descriptor_Pool, 0);
+   for(int Sampler_Index = 0; Sampler_Index < Scene->Sampler_Count; ++Sampler_Index)
+   {
+      vkDestroySampler(VK->Device, Scene->Samplers[Sampler_Index], 0);
+   }
+   for(int Image_Index = 0; Image_Index < Scene->Image_Count; ++Image_Index)
+   {
+      if(Scene->Images[Image_Index].Image)
+      {
+         Destroy_Vulkan_Image(VK, Scene->Images + Image_Index);
+      }
+   }
+
+   Destroy_Vulkan_Buffer(VK, &Scene->Default_Vertex_Buffer);
+   Destroy_Vulkan_Buffer(VK, &Scene->Buffer);
+
+   Unload_Scene(Scene->Source);
+   Free_Arena(&Scene->Arena);
+   Free_Arena(&Scene->Tables);
+}
+
+static void Upload_Completed_Vulkan_Scenes(vulkan_context *VK)
+{
+   // NOTE: Pick up whatever the loader finished since the last call. This runs
+   // once per frame and never waits on loads still in progress.
+   gltf_load *Load;
+   while((Load = Next_Completed_GLTF_Load(&VK->Loader)))
+   {
+      // NOTE: The scene takes over the arena its source was loaded into, so
+      // that it's freed along with the scene once a reload replaces it.
+      vulkan_scene *Scene = VK->Scenes + VK->Scene_Count++;
+      Scene->Path = Load->Path;
+      Scene->Arena = Load->Arena;
+      Make_Arena(&Scene->Tables, Get_Vulkan_Scene_Table_Size(Load->Scene));
+      Create_Vulkan_Scene(VK, Scene, Load->Scene, &Scene->Tables);
+      Zero_Struct(&Load->Arena);
+      Load->Scene = 0;
+      Reset_Arena(&VK->Scratch);
+
+      Log("Loaded %s (%d draws).\n", Load->Path, Scene->Draw_Count);
+      Log_Vulkan_Memory_Stats(VK);
+   }
+
+   // NOTE: Draws are ordered after their scene's uploads on the queue, so this
+   // only reports when uploads finish.
+   for(int Scene_Index = 0; Scene_Index < VK->Scene_Count; ++Scene_Index)
+   {
+      Poll_Vulkan_Upload_Batch(VK, &VK->Scenes[Scene_Index].Upload);
+   }
+}
+
+static void Destroy_Retired_Vulkan_Resources(vulkan_context *VK, bool All)
+{
+   // NOTE: Called once the current frame's fence has been waited on. That
+   // fence belongs to the frame submitted MAX_FRAMES_IN_FLIGHT frames ago, and
+   // every frame before it has been waited on already, so anything retired no
+   // later than the frame after it is no longer in use. All is for when the
+   // device is idle.
+   int Kept_Count = 0;
+   for(int Retired_Index = 0; Retired_Index < VK->Retired_Count; ++Retired_Index)
+   {
+      vulkan_retired_resource *Resource = VK->Retired + Retired_Index;
+      if(All || Resource->Frame + MAX_FRAMES_IN_FLIGHT <= VK->Frame_Count + 1)
+      {
+         switch(Resource->Type)
+         {
+            case VULKAN_RETIRED_SCENE:         { Destroy_Vulkan_Scene(VK, &Resource->Scene); } break;
+            case VULKAN_RETIRED_PIPELINE:      { vkDestroyPipeline(VK->Device, Resource->Pipeline, 0); } break;
+            case VULKAN_RETIRED_SHADER_MODULE: { vkDestroyShaderModule(VK->Device, Resource->Shader_Module, 0); } break;
+         }
+      }
+      else
+      {
+         VK->Retired[Kept_Count++] = *Resource;
+      }
+   }
+   VK->Retired_Count = Kept_Count;
+}
+
+static void Retire_Vulkan_Resource(vulkan_context *VK, vulkan_retired_resource Resource)
+{
+   // NOTE: Running out of room only happens when reloading over and over
+   // faster than frames finish, so just wait for everything to finish then.
+   if(VK->Retired_Count == MAX_RETIRED_VULKAN_RESOURCE_COUNT)
+   {
+      vkDeviceWaitIdle(VK->Device);
+      Destroy_Retired_Vulkan_Resources(VK, true);
+   }
+
+   Resource.Frame = VK->Frame_Count;
+   VK->Retired[VK->Retired_Count++] = Resource;
+}
+
+static void Reload_Basic_Vulkan_Pipelines(vulkan_context *VK)
+{
+   // NOTE: Every variant is rebuilt with the new shaders, keeping the pipeline
+   // layout, since the descriptor set layouts haven't changed. The old
+   // pipelines are only retired once every new one has been created, so
+   // shaders that fail to load or link leave the old ones in use.
+   vulkan_pipeline Base = {0};
+   Base.Layout = VK->Basic_Graphics_Pipelines[0].Layout;
+
+   vulkan_pipeline Pipelines[MAX_BASIC_PIPELINE_COUNT] = {0};
+   int Created_Count = 0;
+   if(Create_Basic_Vulkan_Shaders(VK, &Base))
+   {
+      while(Created_Count < VK->Basic_Pipeline_Count &&
+            Create_Basic_Vulkan_Graphics_Pipeline(VK, VK->Basic_Render_Pass, VK->Basic_Vertex_Layouts + Created_Count, &Base, Pipelines + Created_Count))
+      {
+         Created_Count++;
+      }
+   }
+
+   if(Created_Count < VK->Basic_Pipeline_Count)
+   {
+      for(int Pipeline_Index = 0; Pipeline_Index < Created_Count; ++Pipeline_Index)
+      {
+         vkDestroyPipeline(VK->Device, Pipelines[Pipeline_Index].Pipeline, 0);
+      }
+      vkDestroyShaderModule(VK->Device, Base.Vertex_Shader, 0);
+      vkDestroyShaderModule(VK->Device, Base.Fragment_Shader, 0);
+
+      Log("Failed to reload the basic shaders, keeping the previous ones.\n");
+   }
+   else
+   {
+      vulkan_retired_resource Retired = {VULKAN_RETIRED_SHADER_MODULE};
+      Retired.Shader_Module = VK->Basic_Graphics_Pipelines[0].Vertex_Shader;
+      Retire_Vulkan_Resource(VK, Retired);
+      Retired.Shader_Module = VK->Basic_Graphics_Pipelines[0].Fragment_Shader;
+      Retire_Vulkan_Resource(VK, Retired);
+
+      for(int Pipeline_Index = 0; Pipeline_Index < VK->Basic_Pipeline_Count; ++Pipeline_Index)
+      {
+         vulkan_retired_resource Retired_Pipeline = {VULKAN_RETIRED_PIPELINE};
+         Retired_Pipeline.Pipeline = VK->Basic_Graphics_Pipelines[Pipeline_Index].Pipeline;
+         Retire_Vulkan_Resource(VK, Retired_Pipeline);
+
+         VK->Basic_Graphics_Pipelines[Pipeline_Index] = Pipelines[Pipeline_Index];
+      }
+
+      Log("Reloaded the basic shaders (%d pipelines).\n", VK->Basic_Pipeline_Count);
+   }
+}
+
+static WORK_QUEUE_CALLBACK(Do_Vulkan_Scene_Reload_Work)
+{
+   vulkan_scene_reload *Reload = Data;
+   Reload->Load.Scene = Load_Sized_GLTF_Scene(&Reload->Load.Arena, Reload->Load.Path);
+   Atomic_Store_U32(&Reload->Loaded, 1);
+}
+
+static void Begin_Vulkan_Scene_Reload(vulkan_context *VK, int Scene_Index)
+{
+   vulkan_scene_reload *Reload = VK->Reloads + Scene_Index;
+   if(Reload->Stage == VULKAN_RELOAD_IDLE)
+   {
+      Zero_Struct(Reload);
+      Reload->Stage = VULKAN_RELOAD_LOADING;
+      Reload->Load.Path = VK->Scenes[Scene_Index].Path;
+      Add_Work_Queue_Entry(VK->Loader.Queue, Do_Vulkan_Scene_Reload_Work, Reload);
+   }
+   else
+   {
+      Reload->Changed_Again = true;
+   }
+}
+
+static void Update_Vulkan_Scene_Reload(vulkan_context *VK, int Scene_Index)
+{
+   // NOTE: The new version only replaces the old one if it has something to
+   // draw, so a source that was caught halfway through being written just
+   // keeps the old version until the next change. Swapping in a scene that
+   // isn't uploaded yet would make it blink out for a few frames.
+   vulkan_scene *Scene = VK->Scenes + Scene_Index;
+   vulkan_scene_reload *Reload = VK->Reloads + Scene_Index;
+
+   if(Reload->Stage == VULKAN_RELOAD_LOADING && Atomic_Load_U32(&Reload->Loaded))
+   {
+      gltf_scene *Source = Reload->Load.Scene;
+      if(!Source->Draw_Count)
+      {
+         Log("Failed to reload %s, keeping the previous version.\n", Scene->Path);
+         Unload_Scene(Source);
+         Free_Arena(&Reload->Load.Arena);
+         Reload->Stage = VULKAN_RELOAD_IDLE;
+      }
+      else
+      {
+         vulkan_scene *Reloaded = &Reload->Scene;
+         Reloaded->Path = Scene->Path;
+         Reloaded->Arena = Reload->Load.Arena;
+         Make_Arena(&Reloaded->Tables, Get_Vulkan_Scene_Table_Size(Source));
+         Create_Vulkan_Scene(VK, Reloaded, Source, &Reloaded->Tables);
+         Reload->Stage = VULKAN_RELOAD_UPLOADING;
+      }
+   }
+
+   if(Reload->Stage == VULKAN_RELOAD_UPLOADING && Poll_Vulkan_Upload_Batch(VK, &Reload->Scene.Upload))
+   {
+      vulkan_retired_resource Retired = {VULKAN_RETIRED_SCENE};
+      Retired.Scene = *Scene;
+      Retire_Vulkan_Resource(VK, Retired);
+
+      *Scene = Reload->Scene;
+      Reload->Stage = VULKAN_RELOAD_IDLE;
+      Log("Reloaded %s (%d draws).\n", Scene->Path, Scene->Draw_Count);
+      Log_Vulkan_Memory_Stats(VK);
+   }
+
+   if(Reload->Stage == VULKAN_RELOAD_IDLE && Reload->Changed_Again)
+   {
+      Begin_Vulkan_Scene_Reload(VK, Scene_Index);
+   }
+}
+
+static void Cancel_Vulkan_Scene_Reloads(vulkan_context *VK)
+{
+   // NOTE: Waits for loads still on the work queue, then releases whatever
+   // reloads had produced so far. The device has to be idle.
+   if(VK->Loader.Queue)
+   {
+      Complete_All_Work(VK->Loader.Queue);
+   }
+
+   for(int Scene_Index = 0; Scene_Index < VK->Scene_Count; ++Scene_Index)
+   {
+      vulkan_scene_reload *Reload = VK->Reloads + Scene_Index;
+      if(Reload->Stage == VULKAN_RELOAD_LOADING)
+      {
+         Unload_Scene(Reload->Load.Scene);
+         Free_Arena(&Reload->Load.Arena);
+      }
+      else if(Reload->Stage == VULKAN_RELOAD_UPLOADING)
+      {
+         Destroy_Vulkan_Scene(VK, &Reload->Scene);
+      }
+      Reload->Stage = VULKAN_RELOAD_IDLE;
+   }
+}
+
+static void Reload_Changed_Vulkan_Assets(vulkan_context *VK)
+{
+   // NOTE: A scene is reloaded when its source or its baked version changes,
+   // and every pipeline when either basic shader does. Changes are collected
+   // before anything is reloaded, since saving a file can report it more than
+   // once.
+   bool Reload_Shaders = false;
+   bool *Reload_Scenes = Allocate(&VK->Scratch, bool, Maximum(VK->Scene_Count, 1));
+
+   char Path[256];
+   platform_file_watcher *Watcher = Get_File_Watcher(VK->Platform_Context);
+   while(Next_Changed_File(Watcher, Path, sizeof(Path)))
+   {
+      char *Name = Get_File_Name(Path);
+      if(C_Strings_Are_Equal(Name, "basic.vert.spv") || C_Strings_Are_Equal(Name, "basic.frag.spv"))
+      {
+         Reload_Shaders = true;
+      }
+
+      for(int Scene_Index = 0; Scene_Index < VK->Scene_Count; ++Scene_Index)
+      {
+         char *Scene_Path = VK->Scenes[Scene_Index].Path;
+         char Baked_Path[256];
+         if(C_Strings_Are_Equal(Name, Get_File_Name(Scene_Path)) ||
+            (Get_Baked_Scene_Path(Baked_Path, sizeof(Baked_Path), Scene_Path) && C_Strings_Are_Equal(Name, Baked_Path)))
+         {
+            Reload_Scenes[Scene_Index] = true;
+         }
+      }
+   }
 
-   switch(Format)
+   if(Reload_Shaders)
    {
-      case VK_FORMAT_R8_UNORM:      { Result = 1; } break;
-      case VK_FORMAT_R8G8B8A8_SRGB: { Result = 4; } break;
-
-      // TODO: Add more formats as needed.
-      default: { Invalid_Code_Path; } break;
+      Reload_Basic_Vulkan_Pipelines(VK);
    }
 
-   return(Result);
+   for(int Scene_Index = 0; Scene_Index < VK->Scene_Count; ++Scene_Index)
+   {
+      if(Reload_Scenes[Scene_Index])
+      {
+         Begin_Vulkan_Scene_Reload(VK, Scene_Index);
+      }
+      Update_Vulkan_Scene_Reload(VK, Scene_Index);
+   }
 }
 
 static vulkan_image Create_Vulkan_Texture_Image(vulkan_context *VK, void *Memory, int Width, int Height, VkFormat Format)
 {
-   idx Size = Width * Height * Get_Vulkan_Format_Size(Format);
-
-   VkBufferUsageFlags Staging_Usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-   VkMemoryPropertyFlags Staging_Properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT|VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-   vulkan_buffer Staging = Create_Vulkan_Buffer(VK, Size, Staging_Usage, Staging_Properties);
-
-   void *Mapped_Memory_Address;
-   VC(vkMapMemory(VK->Device, Staging.Device_Memory, 0, Size, 0, &Mapped_Memory_Address));
-   Copy_Memory(Mapped_Memory_Address, Memory, Size);
-
-   VkImageUsageFlags Image_Usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT|VK_IMAGE_USAGE_SAMPLED_BIT;
-   VkMemoryPropertyFlags Image_Properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+   VkImageUsageFlags Image_Usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT|VK_IMAGE_USAGE_SAMPLED_BIT;
    VkImageTiling Image_Tiling = VK_IMAGE_TILING_OPTIMAL;
-   vulkan_image Result = Create_Vulkan_Image(VK, Width, Height, VK_SAMPLE_COUNT_1_BIT, Image_Usage, Format, Image_Tiling, Image_Properties);
+   vulkan_image Result = Create_Vulkan_Image(VK, Width, Height, 1, VK_SAMPLE_COUNT_1_BIT, Image_Usage, Format, Image_Tiling, VULKAN_MEMORY_DEVICE_LOCAL);
    Result.View = Create_Vulkan_Image_View(VK, Result.Image, Format, VK_IMAGE_ASPECT_COLOR_BIT);
 
-   Transition_Vulkan_Image_Layout(VK, Result.Image, Result.Format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-   Copy_Vulkan_Buffer_To_Image(VK, Staging.Buffer, Result.Image, Width, Height);
-   Transition_Vulkan_Image_Layout(VK, Result.Image, Format, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-
-   vkDestroyBuffer(VK->Device, Staging.Buffer, 0);
-   vkFreeMemory(VK->Device, Staging.Device_Memory, 0);
+   Stream_To_Vulkan_Image(VK, &Result, Width, Height, Memory);
 
    return(Result);
 }
 
-static void Create_Vulkan_Texture_Sampler(vulkan_context *VK, VkSampler *Sampler)
+static void Write_Basic_Vulkan_Descriptor_Set(vulkan_context *VK, vulkan_frame *Frame)
 {
-   VkSamplerCreateInfo Sampler_Info = {0};
-   Sampler_Info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-   Sampler_Info.magFilter = VK_FILTER_LINEAR;
-   Sampler_Info.minFilter = VK_FILTER_LINEAR;
-   Sampler_Info.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-   Sampler_Info.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-   Sampler_Info.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-   Sampler_Info.anisotropyEnable = VK->Physical_Device.Enabled_Features.samplerAnisotropy;
-   Sampler_Info.maxAnisotropy = (VK->Physical_Device.Enabled_Features.samplerAnisotropy) ? VK->Physical_Device.Properties.limits.maxSamplerAnisotropy : 1.0f;
-   Sampler_Info.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
-   Sampler_Info.unnormalizedCoordinates = VK_FALSE;
-   Sampler_Info.compareEnable = VK_FALSE;
-   Sampler_Info.compareOp = VK_COMPARE_OP_ALWAYS;
-   Sampler_Info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
-   Sampler_Info.mipLodBias = 0.0f;
-   Sampler_Info.minLod = 0.0f;
-   Sampler_Info.maxLod = 0.0f;
+   // NOTE: Both bindings point at the start of the frame's uniform arena, and
+   // each bind offsets them to its slices.
+   VkDescriptorBufferInfo Uniform_Infos[2] = {0};
+   Uniform_Infos[0].buffer = Frame->Uniforms.Buffer.Buffer;
+   Uniform_Infos[0].offset = 0;
+   Uniform_Infos[0].range = sizeof(basic_uniform);
+   Uniform_Infos[1].buffer = Frame->Uniforms.Buffer.Buffer;
+   Uniform_Infos[1].offset = 0;
+   Uniform_Infos[1].range = sizeof(basic_draw_uniform);
+
+   VkWriteDescriptorSet Descriptor_Writes[2] = {0};
+   for(u32 Binding = 0; Binding < Array_Count(Descriptor_Writes); ++Binding)
+   {
+      Descriptor_Writes[Binding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+      Descriptor_Writes[Binding].dstSet = Frame->Descriptor_Set;
+      Descriptor_Writes[Binding].dstBinding = Binding;
+      Descriptor_Writes[Binding].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+      Descriptor_Writes[Binding].descriptorCount = 1;
+      Descriptor_Writes[Binding].pBufferInfo = Uniform_Infos + Binding;
+   }
+
+   vkUpdateDescriptorSets(VK->Device, Array_Count(Descriptor_Writes), Descriptor_Writes, 0, 0);
+}
+
+static void Reserve_Basic_Vulkan_Uniforms(vulkan_context *VK, vulkan_frame *Frame)
+{
+   // NOTE: Makes room for the frame's slice and one per draw. Only called once
+   // the frame's fence has signaled, so its buffer and descriptor set are no
+   // longer in use and can be replaced. Arenas at least double when they grow,
+   // so loading scenes one after another doesn't replace them every time.
+   vulkan_uniform_arena *Arena = &Frame->Uniforms;
+
+   idx Draw_Count = 0;
+   for(int Scene_Index = 0; Scene_Index < VK->Scene_Count; ++Scene_Index)
+   {
+      Draw_Count += VK->Scenes[Scene_Index].Draw_Count;
+   }
+
+   VkDeviceSize Size = Align_Offset(sizeof(basic_uniform), Arena->Alignment) +
+      Draw_Count*Align_Offset(sizeof(basic_draw_uniform), Arena->Alignment);
+   if(Size > (VkDeviceSize)Arena->Buffer.Size)
+   {
+      Size = Maximum(Size, 2*(VkDeviceSize)Arena->Buffer.Size);
+
+      Destroy_Vulkan_Uniform_Arena(VK, Arena);
+      Create_Vulkan_Uniform_Arena(VK, Arena, Size);
+      Write_Basic_Vulkan_Descriptor_Set(VK, Frame);
 
-   VC(vkCreateSampler(VK->Device, &Sampler_Info, 0, Sampler));
+      Log("Grew the frame uniform arena to %.1f KB for %lld draws.\n", Size / 1024.0, (long long)Draw_Count);
+   }
 }
 
 static void Create_Basic_Vulkan_Descriptor_Set(vulkan_context *VK)
 {
+   // NOTE: Set 0 holds the frame's uniforms and the draw's, and is bound per
+   // draw with a dynamic offset into the frame's uniform arena for each. Set 1
+   // holds a material's base color texture and is bound when the material
+   // changes, allocated from each scene's own pool.
    VkDescriptorSetLayoutBinding Descriptor_Layout_Bindings[] =
    {
-      {0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_ALL},
-      {1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT},
+      {0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_ALL},
+      {1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_VERTEX_BIT|VK_SHADER_STAGE_FRAGMENT_BIT},
    };
    VkDescriptorSetLayoutCreateInfo Descriptor_Layout_Info = {0};
    Descriptor_Layout_Info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
@@ -978,10 +2979,16 @@ static void Create_Basic_Vulkan_Descriptor_Set(vulkan_context *VK)
    Descriptor_Layout_Info.pBindings = Descriptor_Layout_Bindings;
    VC(vkCreateDescriptorSetLayout(VK->Device, &Descriptor_Layout_Info, 0, &VK->Descriptor_Set_Layout));
 
+   VkDescriptorSetLayoutBinding Material_Layout_Binding = {0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT};
+   VkDescriptorSetLayoutCreateInfo Material_Layout_Info = {0};
+   Material_Layout_Info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+   Material_Layout_Info.bindingCount = 1;
+   Material_Layout_Info.pBindings = &Material_Layout_Binding;
+   VC(vkCreateDescriptorSetLayout(VK->Device, &Material_Layout_Info, 0, &VK->Material_Set_Layout));
+
    VkDescriptorPoolSize Descriptor_Pool_Sizes[] =
    {
-      {Descriptor_Layout_Bindings[0].descriptorType, MAX_FRAMES_IN_FLIGHT},
-      {Descriptor_Layout_Bindings[1].descriptorType, MAX_FRAMES_IN_FLIGHT},
+      {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, Array_Count(Descriptor_Layout_Bindings)*MAX_FRAMES_IN_FLIGHT},
    };
    VkDescriptorPoolCreateInfo Descriptor_Pool_Info = {0};
    Descriptor_Pool_Info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
@@ -1011,36 +3018,7 @@ static void Create_Basic_Vulkan_Descriptor_Set(vulkan_context *VK)
    // NOTE: Create descriptor sets.
    for(int Frame_Index = 0; Frame_Index < MAX_FRAMES_IN_FLIGHT; ++Frame_Index)
    {
-      vulkan_frame *Frame = VK->Frames + Frame_Index;
-
-      VkDescriptorBufferInfo Uniform_Info = {0};
-      Uniform_Info.buffer = Frame->Uniform.Buffer;
-      Uniform_Info.offset = 0;
-      Uniform_Info.range = sizeof(basic_uniform);
-
-      VkDescriptorImageInfo Image_Info = {0};
-      Image_Info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-      Image_Info.imageView = VK->Debug_Texture.View;
-      Image_Info.sampler = VK->Texture_Sampler;
-
-      VkWriteDescriptorSet Descriptor_Writes[2] = {0};
-      Descriptor_Writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-      Descriptor_Writes[0].dstSet = Frame->Descriptor_Set;
-      Descriptor_Writes[0].dstBinding = 0;
-      Descriptor_Writes[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-      Descriptor_Writes[0].descriptorCount = 1;
-      Descriptor_Writes[0].pBufferInfo = &Uniform_Info;
-      Descriptor_Writes[0].pImageInfo = 0;
-
-      Descriptor_Writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-      Descriptor_Writes[1].dstSet = Frame->Descriptor_Set;
-      Descriptor_Writes[1].dstBinding = 1;
-      Descriptor_Writes[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-      Descriptor_Writes[1].descriptorCount = 1;
-      Descriptor_Writes[1].pBufferInfo = 0;
-      Descriptor_Writes[1].pImageInfo = &Image_Info;
-
-      vkUpdateDescriptorSets(VK->Device, Array_Count(Descriptor_Writes), Descriptor_Writes, 0, 0);
+      Write_Basic_Vulkan_Descriptor_Set(VK, VK->Frames + Frame_Index);
    }
 }
 
@@ -1121,195 +3099,6 @@ static VkRenderPass Create_Basic_Vulkan_Render_Passes(vulkan_context *VK)
    return(Result);
 }
 
-static vulkan_pipeline Create_Basic_Vulkan_Graphics_Pipeline(vulkan_context *VK, VkRenderPass Render_Pass)
-{
-   vulkan_pipeline Result = {0};
-
-   // NOTE: Initialize shaders.
-   string Vertex_Shader_Code = Read_Entire_File("basic.vert.spv");
-   string Fragment_Shader_Code = Read_Entire_File("basic.frag.spv");
-
-   VkShaderModuleCreateInfo Vertex_Shader_Info = {0};
-   Vertex_Shader_Info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-   Vertex_Shader_Info.codeSize = Vertex_Shader_Code.Length;
-   Vertex_Shader_Info.pCode = (u32 *)Vertex_Shader_Code.Data;
-
-   VkShaderModuleCreateInfo Fragment_Shader_Info = {0};
-   Fragment_Shader_Info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-   Fragment_Shader_Info.codeSize = Fragment_Shader_Code.Length;
-   Fragment_Shader_Info.pCode = (u32 *)Fragment_Shader_Code.Data;
-
-   VC(vkCreateShaderModule(VK->Device, &Vertex_Shader_Info, 0, &Result.Vertex_Shader));
-   VC(vkCreateShaderModule(VK->Device, &Fragment_Shader_Info, 0, &Result.Fragment_Shader));
-
-   VkPipelineShaderStageCreateInfo Shader_Stage_Infos[] =
-   {
-      {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, 0, 0, VK_SHADER_STAGE_VERTEX_BIT, Result.Vertex_Shader, "main"},
-      {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, 0, 0, VK_SHADER_STAGE_FRAGMENT_BIT, Result.Fragment_Shader, "main"},
-   };
-
-   // NOTE: Configure pipeline inputs.
-   gltf_primitive Debug_Primitive = VK->Debug_Scene.Meshes[0].Primitives[0];
-   gltf_accessor Position_Accessor = VK->Debug_Scene.Accessors[Debug_Primitive.Position];
-   gltf_accessor Normal_Accessor   = VK->Debug_Scene.Accessors[Debug_Primitive.Normal];
-   gltf_accessor Color_Accessor    = VK->Debug_Scene.Accessors[Debug_Primitive.Color_0];
-   gltf_accessor Texcoord_Accessor = VK->Debug_Scene.Accessors[Debug_Primitive.Texcoord_0];
-
-   VkVertexInputBindingDescription Vertex_Binding_Descriptions[4] = {0};
-   Vertex_Binding_Descriptions[0].binding = 0;
-   Vertex_Binding_Descriptions[0].stride = Get_GLTF_Type_Size(Position_Accessor.Type, Position_Accessor.Component_Type);
-   Vertex_Binding_Descriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-   Vertex_Binding_Descriptions[1].binding = 1;
-   Vertex_Binding_Descriptions[1].stride = Get_GLTF_Type_Size(Normal_Accessor.Type, Normal_Accessor.Component_Type);
-   Vertex_Binding_Descriptions[1].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-   Vertex_Binding_Descriptions[2].binding = 2;
-   Vertex_Binding_Descriptions[2].stride = Get_GLTF_Type_Size(Color_Accessor.Type, Color_Accessor.Component_Type);
-   Vertex_Binding_Descriptions[2].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-   Vertex_Binding_Descriptions[3].binding = 3;
-   Vertex_Binding_Descriptions[3].stride = Get_GLTF_Type_Size(Texcoord_Accessor.Type, Texcoord_Accessor.Component_Type);
-   Vertex_Binding_Descriptions[3].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-   VkVertexInputAttributeDescription Vertex_Attribute_Descriptions[4] = {0};
-   Vertex_Attribute_Descriptions[0].binding = 0;
-   Vertex_Attribute_Descriptions[0].location = 0;
-   Vertex_Attribute_Descriptions[0].format = GLTF_To_Vulkan_Format(Position_Accessor.Type, Position_Accessor.Component_Type);
-   Vertex_Attribute_Descriptions[0].offset = 0;
-
-   Vertex_Attribute_Descriptions[1].binding = 1;
-   Vertex_Attribute_Descriptions[1].location = 1;
-   Vertex_Attribute_Descriptions[1].format = GLTF_To_Vulkan_Format(Normal_Accessor.Type, Normal_Accessor.Component_Type);
-   Vertex_Attribute_Descriptions[1].offset = 0;
-
-   Vertex_Attribute_Descriptions[2].binding = 2;
-   Vertex_Attribute_Descriptions[2].location = 2;
-   Vertex_Attribute_Descriptions[2].format = GLTF_To_Vulkan_Format(Color_Accessor.Type, Color_Accessor.Component_Type);
-   Vertex_Attribute_Descriptions[2].offset = 0;
-
-   Vertex_Attribute_Descriptions[3].binding = 3;
-   Vertex_Attribute_Descriptions[3].location = 3;
-   Vertex_Attribute_Descriptions[3].format = GLTF_To_Vulkan_Format(Texcoord_Accessor.Type, Texcoord_Accessor.Component_Type);
-   Vertex_Attribute_Descriptions[3].offset = 0;
-
-   VkPipelineVertexInputStateCreateInfo Vertex_Input_Info = {0};
-   Vertex_Input_Info.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-   Vertex_Input_Info.vertexBindingDescriptionCount = Array_Count(Vertex_Binding_Descriptions);
-   Vertex_Input_Info.pVertexBindingDescriptions = Vertex_Binding_Descriptions;
-   Vertex_Input_Info.vertexAttributeDescriptionCount = Array_Count(Vertex_Attribute_Descriptions);
-   Vertex_Input_Info.pVertexAttributeDescriptions = Vertex_Attribute_Descriptions;
-
-   VkPipelineInputAssemblyStateCreateInfo Input_Assembly_Info = {0};
-   Input_Assembly_Info.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-   Input_Assembly_Info.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-   Input_Assembly_Info.primitiveRestartEnable = VK_FALSE;
-
-   VkDynamicState Dynamic_States[] =
-   {
-      VK_DYNAMIC_STATE_VIEWPORT,
-      VK_DYNAMIC_STATE_SCISSOR,
-   };
-   VkPipelineDynamicStateCreateInfo Dynamic_Info = {0};
-   Dynamic_Info.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-   Dynamic_Info.dynamicStateCount = Array_Count(Dynamic_States);
-   Dynamic_Info.pDynamicStates = Dynamic_States;
-
-   VkPipelineViewportStateCreateInfo Viewport_Info = {0};
-   Viewport_Info.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-   Viewport_Info.viewportCount = 1;
-   Viewport_Info.scissorCount = 1;
-
-   // NOTE: Configure rasterizer.
-   VkPipelineRasterizationStateCreateInfo Rasterizer_Info = {0};
-   Rasterizer_Info.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-   Rasterizer_Info.depthClampEnable = VK_FALSE;
-   Rasterizer_Info.polygonMode = VK_POLYGON_MODE_FILL;
-   Rasterizer_Info.lineWidth = 1.0f;
-   Rasterizer_Info.cullMode = VK_CULL_MODE_BACK_BIT;
-   Rasterizer_Info.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
-   Rasterizer_Info.depthBiasEnable = VK_FALSE;
-   Rasterizer_Info.depthBiasConstantFactor = 0.0f;
-   Rasterizer_Info.depthBiasClamp = 0.0f;
-   Rasterizer_Info.depthBiasSlopeFactor = 0.0f;
-
-   // NOTE: Configure multisampling.
-   VkPipelineMultisampleStateCreateInfo Multisample_Info = {0};
-   Multisample_Info.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-   Multisample_Info.sampleShadingEnable = VK_FALSE;
-   Multisample_Info.rasterizationSamples = VK->Multisample_Count;
-   Multisample_Info.minSampleShading = 1.0f;
-   Multisample_Info.pSampleMask = 0;
-   Multisample_Info.alphaToCoverageEnable = VK_FALSE;
-   Multisample_Info.alphaToOneEnable = VK_FALSE;
-
-   // NOTE: Configure color blending.
-   VkPipelineColorBlendAttachmentState Blend_Attachment = {0};
-   Blend_Attachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT|VK_COLOR_COMPONENT_G_BIT|VK_COLOR_COMPONENT_B_BIT|VK_COLOR_COMPONENT_A_BIT;
-   Blend_Attachment.blendEnable = VK_FALSE;
-   Blend_Attachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
-   Blend_Attachment.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
-   Blend_Attachment.colorBlendOp = VK_BLEND_OP_ADD;
-   Blend_Attachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-   Blend_Attachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-   Blend_Attachment.alphaBlendOp = VK_BLEND_OP_ADD;
-
-   VkPipelineColorBlendStateCreateInfo Blend_Info = {0};
-   Blend_Info.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-   Blend_Info.logicOpEnable = VK_FALSE;
-   Blend_Info.logicOp = VK_LOGIC_OP_COPY;
-   Blend_Info.attachmentCount = 1;
-   Blend_Info.pAttachments = &Blend_Attachment;
-   Blend_Info.blendConstants[0] = 0.0f;
-   Blend_Info.blendConstants[1] = 0.0f;
-   Blend_Info.blendConstants[2] = 0.0f;
-   Blend_Info.blendConstants[3] = 0.0f;
-
-   VkPipelineDepthStencilStateCreateInfo Depth_Info = {0};
-   Depth_Info.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-   Depth_Info.depthTestEnable = VK_TRUE;
-   Depth_Info.depthWriteEnable = VK_TRUE;
-   Depth_Info.depthCompareOp = VK_COMPARE_OP_LESS;
-   Depth_Info.depthBoundsTestEnable = VK_FALSE;
-   Depth_Info.minDepthBounds = 0.0f;
-   Depth_Info.maxDepthBounds = 1.0f;
-   Depth_Info.stencilTestEnable = VK_FALSE;
-   // Depth_Info.front = {0};
-   // Depth_Info.back = {0};
-
-   // NOTE: Create pipeline layout.
-   VkPipelineLayoutCreateInfo Layout_Info = {0};
-   Layout_Info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-   Layout_Info.setLayoutCount = 1;
-   Layout_Info.pSetLayouts = &VK->Descriptor_Set_Layout;
-   Layout_Info.pushConstantRangeCount = 0;
-   Layout_Info.pPushConstantRanges = 0;
-
-   VC(vkCreatePipelineLayout(VK->Device, &Layout_Info, 0, &Result.Layout));
-
-   VkGraphicsPipelineCreateInfo Pipeline_Info = {0};
-   Pipeline_Info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-   Pipeline_Info.stageCount = 2;
-   Pipeline_Info.pStages = Shader_Stage_Infos;
-   Pipeline_Info.pVertexInputState = &Vertex_Input_Info;
-   Pipeline_Info.pInputAssemblyState = &Input_Assembly_Info;
-   Pipeline_Info.pViewportState = &Viewport_Info;
-   Pipeline_Info.pRasterizationState = &Rasterizer_Info;
-   Pipeline_Info.pMultisampleState = &Multisample_Info;
-   Pipeline_Info.pDepthStencilState = &Depth_Info;
-   Pipeline_Info.pColorBlendState = &Blend_Info;
-   Pipeline_Info.pDynamicState = &Dynamic_Info;
-   Pipeline_Info.layout = Result.Layout;
-   Pipeline_Info.renderPass = Render_Pass;
-   Pipeline_Info.subpass = 0;
-   Pipeline_Info.basePipelineHandle = VK_NULL_HANDLE;
-   Pipeline_Info.basePipelineIndex = -1;
-
-   VC(vkCreateGraphicsPipelines(VK->Device, VK_NULL_HANDLE, 1, &Pipeline_Info, 0, &Result.Pipeline));
-
-   return(Result);
-}
-
 static INITIALIZE_VULKAN(Initialize_Vulkan)
 {
    bool Initialized = false;
@@ -1324,8 +3113,27 @@ static INITIALIZE_VULKAN(Initialize_Vulkan)
    Make_Arena_Once(&VK->Permanent, Megabytes(256));
    Make_Arena_Once(&VK->Scratch, Megabytes(256));
 
-   // NOTE: Load assets that are needed at start up.
-   Parse_GLB(&VK->Debug_Scene, &VK->Permanent, VK->Scratch, "../data/icosphere.glb");
+   // NOTE: Start loading the assets needed at start up on the worker threads.
+   // They parse while the rest of Vulkan is initialized, and are uploaded by
+   // Render_With_Vulkan as each one finishes. Baked versions of each scene are
+   // preferred when "make bake" has produced them.
+   static char *Startup_Scene_Paths[] =
+   {
+      "../data/icosphere.glb",
+   };
+   int Path_Count = Array_Count(Startup_Scene_Paths);
+
+   platform_work_queue *Queue = Get_Work_Queue(Platform_Context);
+   Begin_GLTF_Loads(&VK->Loader, Queue, &VK->Permanent, Startup_Scene_Paths, Path_Count);
+   VK->Scenes = Allocate(&VK->Permanent, vulkan_scene, Path_Count);
+   VK->Reloads = Allocate(&VK->Permanent, vulkan_scene_reload, Path_Count);
+
+   // NOTE: Shaders and baked scenes live in the working directory, and scene
+   // sources in the data directory. Render_With_Vulkan reloads whichever of
+   // them change.
+   platform_file_watcher *Watcher = Get_File_Watcher(Platform_Context);
+   Watch_Directory(Watcher, ".");
+   Watch_Directory(Watcher, "../data");
 
    if(Create_Vulkan_Instance(&VK->Instance, VK->Scratch))
    {
@@ -1336,6 +3144,8 @@ static INITIALIZE_VULKAN(Initialize_Vulkan)
          VK->Surface = Create_Vulkan_Surface(VK->Instance, Platform_Context);
          if(Create_Vulkan_Device(VK))
          {
+            Initialize_Vulkan_Memory(VK);
+
             // NOTE: Create command buffers.
             VkCommandPoolCreateInfo Pool_Info = {0};
             Pool_Info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
@@ -1343,6 +3153,9 @@ static INITIALIZE_VULKAN(Initialize_Vulkan)
             Pool_Info.queueFamilyIndex = VK->Graphics_Queue_Family_Index;
             VC(vkCreateCommandPool(VK->Device, &Pool_Info, 0, &VK->Command_Pool));
 
+            Pool_Info.queueFamilyIndex = VK->Transfer_Queue_Family_Index;
+            VC(vkCreateCommandPool(VK->Device, &Pool_Info, 0, &VK->Transfer_Command_Pool));
+
             VkCommandBufferAllocateInfo Allocate_Info = {0};
             Allocate_Info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
             Allocate_Info.commandPool = VK->Command_Pool;
@@ -1361,30 +3174,28 @@ static INITIALIZE_VULKAN(Initialize_Vulkan)
             Create_Vulkan_Swapchain(VK, &VK->Swapchain);
 
             // NOTE: Create buffers.
-            gltf_primitive Debug_Primitive = VK->Debug_Scene.Meshes[0].Primitives[0];
-            VK->Vertex_Positions = Create_Vulkan_Vertex_Buffer(VK, &VK->Debug_Scene, Debug_Primitive.Position);
-            VK->Vertex_Normals   = Create_Vulkan_Vertex_Buffer(VK, &VK->Debug_Scene, Debug_Primitive.Normal);
-            VK->Vertex_Colors    = Create_Vulkan_Vertex_Buffer(VK, &VK->Debug_Scene, Debug_Primitive.Color_0);
-            VK->Vertex_Texcoords = Create_Vulkan_Vertex_Buffer(VK, &VK->Debug_Scene, Debug_Primitive.Texcoord_0);
-
-            VK->Vertex_Indices = Create_Vulkan_Index_Buffer(VK, &VK->Debug_Scene, Debug_Primitive.Indices);
             for(int Frame_Index = 0; Frame_Index < MAX_FRAMES_IN_FLIGHT; ++Frame_Index)
             {
-               idx Size = sizeof(basic_uniform);
-               VkBufferUsageFlags Usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-               VkMemoryPropertyFlags Properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT|VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-
-               vulkan_frame *Frame = VK->Frames + Frame_Index;
-               Frame->Uniform = Create_Vulkan_Buffer(VK, Size, Usage, Properties);
-               VC(vkMapMemory(VK->Device, Frame->Uniform.Device_Memory, 0, Size, 0, &Frame->Uniform.Mapped_Memory_Address));
+               Create_Vulkan_Uniform_Arena(VK, &VK->Frames[Frame_Index].Uniforms, VULKAN_FRAME_UNIFORM_SIZE);
             }
 
-            // NOTE: Create images.
+            // NOTE: Create the staging ring every upload goes through.
+            Create_Vulkan_Staging_Ring(VK, &VK->Staging);
+
+            // NOTE: Create images, uploaded together in one batch.
+            vulkan_upload_batch Batch = Begin_Vulkan_Upload_Batch(VK);
             VK->Debug_Texture = Create_Vulkan_Texture_Image(VK, Debug_Texture_Memory, Debug_Texture_Width, Debug_Texture_Height, VK_FORMAT_R8G8B8A8_SRGB);
             VK->Debug_Text = Create_Vulkan_Texture_Image(VK, Debug_Glyph_Memory_48, Debug_Glyph_Width, Debug_Glyph_Height, VK_FORMAT_R8_UNORM);
 
+            // NOTE: Create the white texture that stands in for missing ones.
+            u32 White = 0xFFFFFFFF;
+            VK->White_Texture = Create_Vulkan_Texture_Image(VK, &White, 1, 1, VK_FORMAT_R8G8B8A8_UNORM);
+            End_Vulkan_Upload_Batch(VK, &Batch);
+            Wait_For_Vulkan_Upload_Batch(VK, &Batch);
+
             // NOTE: Create samplers.
-            Create_Vulkan_Texture_Sampler(VK, &VK->Texture_Sampler);
+            gltf_sampler Default_Sampler = {0};
+            VK->Texture_Sampler = Create_Vulkan_Texture_Sampler(VK, &Default_Sampler);
 
             // NOTE: Create descriptor sets.
             Create_Basic_Vulkan_Descriptor_Set(VK);
@@ -1392,8 +3203,15 @@ static INITIALIZE_VULKAN(Initialize_Vulkan)
             // NOTE: Initialize render passes.
             VK->Basic_Render_Pass = Create_Basic_Vulkan_Render_Passes(VK);
 
-            // NOTE: Initialize pipelines.
-            VK->Basic_Graphics_Pipeline = Create_Basic_Vulkan_Graphics_Pipeline(VK, VK->Basic_Render_Pass);
+            // NOTE: Initialize pipelines. The first variant reads the full
+            // precision formats declared in basic.vert. Others are created as
+            // scenes need them.
+            gltf_primitive Empty = {-1, -1, -1, -1, -1, -1, -1, GLTF_PRIMITIVE_MODE_TRIANGLES};
+            basic_vertex_layout Default_Layout = Get_Basic_Vertex_Layout(0, &Empty);
+
+            VK->Basic_Pipeline_Count = 1;
+            VK->Basic_Vertex_Layouts[0] = Default_Layout;
+            bool Pipeline_Created = Create_Basic_Vulkan_Graphics_Pipeline(VK, VK->Basic_Render_Pass, &Default_Layout, 0, VK->Basic_Graphics_Pipelines);
 
             // NOTE: Create the swapchain's framebuffers independently of the
             // swapchain so a render pass is available.
@@ -1412,9 +3230,20 @@ static INITIALIZE_VULKAN(Initialize_Vulkan)
                Fence_Info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
                Fence_Info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
                VC(vkCreateFence(VK->Device, &Fence_Info, 0, &Frame->In_Flight_Fence));
+
+               if(VK->Physical_Device.Properties.limits.timestampComputeAndGraphics)
+               {
+                  VkQueryPoolCreateInfo Query_Pool_Info = {0};
+                  Query_Pool_Info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+                  Query_Pool_Info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+                  Query_Pool_Info.queryCount = 2;
+                  VC(vkCreateQueryPool(VK->Device, &Query_Pool_Info, 0, &Frame->Timestamp_Pool));
+               }
             }
 
-            Initialized = true;
+            // NOTE: Without its shaders the renderer has nothing to draw
+            // with, so a missing or broken .spv fails initialization.
+            Initialized = Pipeline_Created;
          }
       }
    }
@@ -1431,10 +3260,87 @@ static INITIALIZE_VULKAN(Initialize_Vulkan)
 }
 
 
+static int Select_Vulkan_Draw_Lod(vulkan_draw *Draw, matrix4 World, vec3 Eye, float Pixels_Per_Unit, float Near)
+{
+   // NOTE: Simplification errors are in model space, so they're scaled by the
+   // largest axis scale of the node. The projected error of each level is
+   // estimated at the closest point of the bounding sphere to the eye.
+   float *E = World.Elements;
+   float World_Scale = Square_Root(Maximum(Maximum(Square(E[0]) + Square(E[1]) + Square(E[2]),
+                                                    Square(E[4]) + Square(E[5]) + Square(E[6])),
+                                           Square(E[8]) + Square(E[9]) + Square(E[10])));
+
+   vec3 Center = Transform_Point(World, Draw->Center);
+   float Distance = Length_Vec3(Sub_Vec3(Center, Eye)) - Draw->Radius*World_Scale;
+   Distance = Maximum(Distance, Near);
+
+   int Result = 0;
+   for(int Lod_Index = Draw->Lod_Count - 1; Lod_Index > 0; --Lod_Index)
+   {
+      float Pixels = Draw->Lods[Lod_Index].Error * World_Scale * Pixels_Per_Unit / Distance;
+      if(Pixels <= LOD_PIXEL_ERROR)
+      {
+         Result = Lod_Index;
+         break;
+      }
+   }
+
+   return(Result);
+}
+
+static void Accumulate_Vulkan_GPU_Timing(vulkan_context *VK, vulkan_frame *Frame)
+{
+   // NOTE: The frame's fence has signaled, so its timestamps are available.
+   u64 Timestamps[2] = {0};
+   VkResult Query_Result = vkGetQueryPoolResults(VK->Device, Frame->Timestamp_Pool, 0, 2, sizeof(Timestamps), Timestamps,
+                                                 sizeof(Timestamps[0]), VK_QUERY_RESULT_64_BIT);
+   if(Query_Result == VK_SUCCESS)
+   {
+      vulkan_gpu_timing *Timing = &VK->GPU_Timing;
+      double Period = VK->Physical_Device.Properties.limits.timestampPeriod;
+      Timing->Milliseconds += (double)(Timestamps[1] - Timestamps[0]) * Period / 1000000.0;
+      Timing->Frame_Count++;
+
+      if(Timing->Frame_Count == GPU_TIMING_FRAME_COUNT)
+      {
+         int Draw_Count = 0;
+         for(int Scene_Index = 0; Scene_Index < VK->Scene_Count; ++Scene_Index)
+         {
+            Draw_Count += VK->Scenes[Scene_Index].Draw_Count;
+         }
+
+         int Interleaved_Count = 0;
+         for(int Pipeline_Index = 0; Pipeline_Index < VK->Basic_Pipeline_Count; ++Pipeline_Index)
+         {
+            Interleaved_Count += (VK->Basic_Vertex_Layouts[Pipeline_Index].Interleaved_Mask != 0);
+         }
+
+         Log("GPU render pass: %.3f ms average over %d frames (%d draws, %d of %d pipelines interleaved, %.1f%% of full detail triangles).\n",
+             Timing->Milliseconds / Timing->Frame_Count, Timing->Frame_Count,
+             Draw_Count, Interleaved_Count, VK->Basic_Pipeline_Count,
+             Timing->Detail_Triangles ? 100.0 * Timing->Drawn_Triangles / Timing->Detail_Triangles : 100.0);
+
+         Zero_Struct(Timing);
+      }
+   }
+}
+
 static RENDER_WITH_VULKAN(Render_With_Vulkan)
 {
+   Upload_Completed_Vulkan_Scenes(VK);
+   Reload_Changed_Vulkan_Assets(VK);
+
    vulkan_frame *Frame = VK->Frames + VK->Frame_Index;
    vkWaitForFences(VK->Device, 1, &Frame->In_Flight_Fence, VK_TRUE, UINT64_MAX);
+   Destroy_Retired_Vulkan_Resources(VK, false);
+   Reset_Vulkan_Uniform_Arena(&Frame->Uniforms);
+   Reserve_Basic_Vulkan_Uniforms(VK, Frame);
+
+   if(Frame->Timestamps_Written)
+   {
+      Accumulate_Vulkan_GPU_Timing(VK, Frame);
+      Frame->Timestamps_Written = false;
+   }
 
    u32 Image_Index;
    VkResult Image_Acquisition_Result = vkAcquireNextImageKHR(VK->Device, VK->Swapchain.Handle, UINT64_MAX, Frame->Image_Available_Semaphore, VK_NULL_HANDLE, &Image_Index);
@@ -1457,6 +3363,29 @@ static RENDER_WITH_VULKAN(Render_With_Vulkan)
       VkCommandBuffer Command_Buffer = Frame->Command_Buffer;
       vkResetCommandBuffer(Command_Buffer, 0);
 
+      // NOTE: Update uniforms. The eye is needed while recording, to pick
+      // each draw's level of detail.
+      static float Delta;
+      float S = Sine(Delta);
+      float C = Cosine(Delta);
+
+      vec3 Eye = {5.0f*S, 5.0f*C, 5.0f + 2.5f*S};
+      vec3 Target = {0, 0, 0};
+      float Near = 0.1f;
+
+      basic_uniform UBO = {0};
+      UBO.View = Look_At(Eye, Target);
+      UBO.Projection = Perspective(VK->Swapchain.Extent.width, VK->Swapchain.Extent.height, Near, 100.0f);
+
+      u32 Frame_Uniform_Offset = Push_Vulkan_Uniform(&Frame->Uniforms, &UBO, sizeof(UBO));
+
+      Delta += 0.025f * Frame_Seconds_Elapsed;
+      if(Delta >= 1.0f) Delta -= 1.0f;
+
+      // NOTE: A unit length at unit distance covers half the focal length
+      // times the viewport height in pixels.
+      float Pixels_Per_Unit = 0.5f * PERSPECTIVE_FOCAL_LENGTH * (float)VK->Swapchain.Extent.height;
+
       // NOTE: Record render commands.
       VkCommandBufferBeginInfo Buffer_Begin_Info = {0};
       Buffer_Begin_Info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -1472,7 +3401,7 @@ static RENDER_WITH_VULKAN(Render_With_Vulkan)
       Clear_Values[0].color = Clear_Color;
       Clear_Values[1].depthStencil = Clear_Stencil;
 
-      vulkan_pipeline *Basic = &VK->Basic_Graphics_Pipeline;
+      vulkan_pipeline *Basic = VK->Basic_Graphics_Pipelines;
 
       VkRenderPassBeginInfo Pass_Begin_Info = {0};
       Pass_Begin_Info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -1482,22 +3411,18 @@ static RENDER_WITH_VULKAN(Render_With_Vulkan)
       Pass_Begin_Info.clearValueCount = Array_Count(Clear_Values);
       Pass_Begin_Info.pClearValues = Clear_Values;
 
+      if(Frame->Timestamp_Pool)
+      {
+         vkCmdResetQueryPool(Command_Buffer, Frame->Timestamp_Pool, 0, 2);
+         vkCmdWriteTimestamp(Command_Buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, Frame->Timestamp_Pool, 0);
+      }
+
       vkCmdBeginRenderPass(Command_Buffer, &Pass_Begin_Info, VK_SUBPASS_CONTENTS_INLINE);
       {
+         int Bound_Pipeline = 0;
+         VkDescriptorSet Bound_Material_Set = VK_NULL_HANDLE;
          vkCmdBindPipeline(Command_Buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, Basic->Pipeline);
 
-         VkBuffer Vertex_Buffers[] =
-         {
-            VK->Vertex_Positions.Buffer,
-            VK->Vertex_Normals.Buffer,
-            VK->Vertex_Colors.Buffer,
-            VK->Vertex_Texcoords.Buffer
-         };
-         VkDeviceSize Vertex_Buffer_Offsets[Array_Count(Vertex_Buffers)] = {0};
-
-         vkCmdBindVertexBuffers(Command_Buffer, 0, Array_Count(Vertex_Buffers), Vertex_Buffers, Vertex_Buffer_Offsets);
-         vkCmdBindIndexBuffer(Command_Buffer, VK->Vertex_Indices.Buffer, 0, VK->Vertex_Indices.Index_Type);
-
          VkViewport Viewport = {0};
          Viewport.x = 0.0f;
          Viewport.y = 0.0f;
@@ -1511,31 +3436,92 @@ static RENDER_WITH_VULKAN(Render_With_Vulkan)
          Scissor.extent = VK->Swapchain.Extent;
          vkCmdSetScissor(Command_Buffer, 0, 1, &Scissor);
 
-         vkCmdBindDescriptorSets(Command_Buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, Basic->Layout, 0, 1, &Frame->Descriptor_Set, 0, 0);
+         for(int Scene_Index = 0; Scene_Index < VK->Scene_Count; ++Scene_Index)
+         {
+            vulkan_scene *Scene = VK->Scenes + Scene_Index;
+            gltf_nodes *Nodes = &Scene->Source->Nodes;
+
+            // NOTE: Scenes are drawn once their upload has been acquired by
+            // the graphics queue.
+            if(!Scene->Upload.Complete)
+            {
+               continue;
+            }
 
-         idx Index_Count = VK->Vertex_Indices.Size / Get_Vulkan_Index_Size(VK->Vertex_Indices.Index_Type);
-         vkCmdDrawIndexed(Command_Buffer, Index_Count, 1, 0, 0, 0);
+            for(int Draw_Index = 0; Draw_Index < Scene->Draw_Count; ++Draw_Index)
+            {
+               vulkan_draw *Draw = Scene->Draws + Draw_Index;
+
+               if(Draw->Pipeline != Bound_Pipeline)
+               {
+                  // NOTE: Variants share a pipeline layout, so the descriptor
+                  // sets stay bound across the switch.
+                  Bound_Pipeline = Draw->Pipeline;
+                  vkCmdBindPipeline(Command_Buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, VK->Basic_Graphics_Pipelines[Bound_Pipeline].Pipeline);
+               }
+
+               if(Draw->Material_Set != Bound_Material_Set)
+               {
+                  Bound_Material_Set = Draw->Material_Set;
+                  vkCmdBindDescriptorSets(Command_Buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, Basic->Layout, 1, 1, &Bound_Material_Set, 0, 0);
+               }
+
+               matrix4 World = (Draw->Node >= 0) ? Nodes->World[Draw->Node] : Identity();
+
+               // NOTE: The decode is a uniform scale and offset, so normals
+               // only need the node's own transform.
+               matrix4 Normal = Normal_Matrix(World);
+
+               basic_draw_uniform Draw_Uniform;
+               Draw_Uniform.Model = Multiply_Matrix4(World, Draw->Position_Decode);
+               for(int Column = 0; Column < 3; ++Column)
+               {
+                  float *From = Normal.Elements + 4*Column;
+                  Draw_Uniform.Normal_Matrix[Column] = (vec4){From[0], From[1], From[2], 0};
+               }
+               Draw_Uniform.Base_Color_Factor = Draw->Base_Color_Factor;
+
+               // NOTE: Rebinding set 0 with the same layout leaves the
+               // material set bound.
+               u32 Uniform_Offsets[2];
+               Uniform_Offsets[0] = Frame_Uniform_Offset;
+               Uniform_Offsets[1] = Push_Vulkan_Uniform(&Frame->Uniforms, &Draw_Uniform, sizeof(Draw_Uniform));
+               vkCmdBindDescriptorSets(Command_Buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, Basic->Layout, 0, 1, &Frame->Descriptor_Set, Array_Count(Uniform_Offsets), Uniform_Offsets);
+
+               vkCmdBindVertexBuffers(Command_Buffer, 0, BASIC_VERTEX_ATTRIBUTE_COUNT, Draw->Vertex_Buffers, Draw->Vertex_Offsets);
+               if(Draw->Indexed)
+               {
+                  u32 First_Index = 0;
+                  u32 Index_Count = Draw->Count;
+                  if(Draw->Lod_Count > 1)
+                  {
+                     gltf_lod *Lod = Draw->Lods + Select_Vulkan_Draw_Lod(Draw, World, Eye, Pixels_Per_Unit, Near);
+                     First_Index = Lod->First_Index;
+                     Index_Count = Lod->Index_Count;
+                  }
+                  VK->GPU_Timing.Drawn_Triangles += Index_Count / 3;
+
+                  vkCmdBindIndexBuffer(Command_Buffer, Scene->Buffer.Buffer, Draw->Index_Offset, Draw->Index_Type);
+                  vkCmdDrawIndexed(Command_Buffer, Index_Count, 1, First_Index, 0, 0);
+               }
+               else
+               {
+                  VK->GPU_Timing.Drawn_Triangles += Draw->Count / 3;
+                  vkCmdDraw(Command_Buffer, Draw->Count, 1, 0, 0);
+               }
+               VK->GPU_Timing.Detail_Triangles += Draw->Count / 3;
+            }
+         }
       }
       vkCmdEndRenderPass(Command_Buffer);
-      VC(vkEndCommandBuffer(Command_Buffer));
-
-      // NOTE: Update uniforms.
-      static float Delta;
-      float S = Sine(Delta);
-      float C = Cosine(Delta);
-
-      vec3 Eye = {5.0f*S, 5.0f*C, 5.0f + 2.5f*S};
-      vec3 Target = {0, 0, 0};
-
-      basic_uniform UBO = {0};
-      UBO.Model = Identity(); // Rotate_Y(C);
-      UBO.View = Look_At(Eye, Target);
-      UBO.Projection = Perspective(VK->Swapchain.Extent.width, VK->Swapchain.Extent.height, 0.1f, 100.0f);
 
-      Copy_Memory(Frame->Uniform.Mapped_Memory_Address, &UBO, sizeof(UBO));
+      if(Frame->Timestamp_Pool)
+      {
+         vkCmdWriteTimestamp(Command_Buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, Frame->Timestamp_Pool, 1);
+         Frame->Timestamps_Written = true;
+      }
 
-      Delta += 0.025f * Frame_Seconds_Elapsed;
-      if(Delta >= 1.0f) Delta -= 1.0f;
+      VC(vkEndCommandBuffer(Command_Buffer));
 
       // NOTE: Submit command buffer.
       VkSubmitInfo Submit_Info = {0};
@@ -1579,6 +3565,7 @@ static RENDER_WITH_VULKAN(Render_With_Vulkan)
          VC(Present_Result);
       }
 
+      VK->Frame_Count++;
       VK->Frame_Index++;
       VK->Frame_Index %= MAX_FRAMES_IN_FLIGHT;
       Reset_Arena(&VK->Scratch);
@@ -1590,43 +3577,47 @@ static DESTROY_VULKAN(Destroy_Vulkan)
    if(VK->Device)
    {
       vkDeviceWaitIdle(VK->Device);
+      Destroy_Retired_Vulkan_Resources(VK, true);
+      Cancel_Vulkan_Scene_Reloads(VK);
+
       for(int Frame_Index = 0; Frame_Index < MAX_FRAMES_IN_FLIGHT; ++Frame_Index)
       {
          vulkan_frame *Frame = VK->Frames + Frame_Index;
          vkDestroySemaphore(VK->Device, Frame->Image_Available_Semaphore, 0);
          vkDestroyFence(VK->Device, Frame->In_Flight_Fence, 0);
+         vkDestroyQueryPool(VK->Device, Frame->Timestamp_Pool, 0);
 
-         vkDestroyBuffer(VK->Device, Frame->Uniform.Buffer, 0);
-         vkFreeMemory(VK->Device, Frame->Uniform.Device_Memory, 0);
+         Destroy_Vulkan_Uniform_Arena(VK, &Frame->Uniforms);
       }
 
       Destroy_Vulkan_Swapchain(VK, &VK->Swapchain);
+      Destroy_Vulkan_Staging_Ring(VK, &VK->Staging);
       vkDestroyCommandPool(VK->Device, VK->Command_Pool, 0);
+      vkDestroyCommandPool(VK->Device, VK->Transfer_Command_Pool, 0);
 
       vkDestroySampler(VK->Device, VK->Texture_Sampler, 0);
+      Destroy_Vulkan_Image(VK, &VK->White_Texture);
       Destroy_Vulkan_Image(VK, &VK->Debug_Texture);
       Destroy_Vulkan_Image(VK, &VK->Debug_Text);
 
-      vkDestroyBuffer(VK->Device, VK->Vertex_Indices.Buffer, 0);
-      vkDestroyBuffer(VK->Device, VK->Vertex_Texcoords.Buffer, 0);
-      vkDestroyBuffer(VK->Device, VK->Vertex_Colors.Buffer, 0);
-      vkDestroyBuffer(VK->Device, VK->Vertex_Normals.Buffer, 0);
-      vkDestroyBuffer(VK->Device, VK->Vertex_Positions.Buffer, 0);
-
-      vkFreeMemory(VK->Device, VK->Vertex_Indices.Device_Memory, 0);
-      vkFreeMemory(VK->Device, VK->Vertex_Texcoords.Device_Memory, 0);
-      vkFreeMemory(VK->Device, VK->Vertex_Colors.Device_Memory, 0);
-      vkFreeMemory(VK->Device, VK->Vertex_Normals.Device_Memory, 0);
-      vkFreeMemory(VK->Device, VK->Vertex_Positions.Device_Memory, 0);
+      for(int Scene_Index = 0; Scene_Index < VK->Scene_Count; ++Scene_Index)
+      {
+         Destroy_Vulkan_Scene(VK, VK->Scenes + Scene_Index);
+      }
 
-      vkDestroyPipeline(VK->Device, VK->Basic_Graphics_Pipeline.Pipeline, 0);
-      vkDestroyPipelineLayout(VK->Device, VK->Basic_Graphics_Pipeline.Layout, 0);
+      for(int Pipeline_Index = 0; Pipeline_Index < VK->Basic_Pipeline_Count; ++Pipeline_Index)
+      {
+         vkDestroyPipeline(VK->Device, VK->Basic_Graphics_Pipelines[Pipeline_Index].Pipeline, 0);
+      }
+      vkDestroyPipelineLayout(VK->Device, VK->Basic_Graphics_Pipelines[0].Layout, 0);
       vkDestroyDescriptorPool(VK->Device, VK->Descriptor_Pool, 0);
       vkDestroyDescriptorSetLayout(VK->Device, VK->Descriptor_Set_Layout, 0);
+      vkDestroyDescriptorSetLayout(VK->Device, VK->Material_Set_Layout, 0);
       vkDestroyRenderPass(VK->Device, VK->Basic_Render_Pass, 0);
-      vkDestroyShaderModule(VK->Device, VK->Basic_Graphics_Pipeline.Fragment_Shader, 0);
-      vkDestroyShaderModule(VK->Device, VK->Basic_Graphics_Pipeline.Vertex_Shader, 0);
+      vkDestroyShaderModule(VK->Device, VK->Basic_Graphics_Pipelines[0].Fragment_Shader, 0);
+      vkDestroyShaderModule(VK->Device, VK->Basic_Graphics_Pipelines[0].Vertex_Shader, 0);
 
+      Destroy_Vulkan_Memory(VK);
       vkDestroyDevice(VK->Device, 0);
    }
 
@@ -1639,6 +3630,8 @@ static DESTROY_VULKAN(Destroy_Vulkan)
       vkDestroyInstance(VK->Instance, 0);
    }
 
+   End_GLTF_Loads(&VK->Loader);
+
    // NOTE: Allow the arenas to persist when clearing out the current state. If
    // we wanted to parameterize the arena sizes in Initialize_Vulkan, we would
    // instead destroy them here.
@@ -17,28 +17,378 @@
 #  error Support for this platform has not been implemented yet.
 #endif
 
+// NOTE: These match the std140 uniform blocks in basic.vert and basic.frag
+// byte for byte, so any change here has to be made there too.
 typedef struct {
-   matrix4 Model;
-   matrix4 View;
-   matrix4 Projection;
+   matrix4 View;       // NOTE: Offset 0.
+   matrix4 Projection; // NOTE: Offset 64, for 128 bytes in all.
 } basic_uniform;
 
+// NOTE: Each draw gets a slice of the frame's uniform arena, next to the one
+// holding basic_uniform, and both stages see the whole block. The normal matrix
+// is a mat3 in the shaders, whose std140 columns are padded out to vec4s.
+typedef struct {
+   matrix4 Model;            // NOTE: Offset 0. Includes the decode of quantized positions.
+   vec4 Normal_Matrix[3];    // NOTE: Offset 64. From the node's world transform alone.
+   vec4 Base_Color_Factor;   // NOTE: Offset 112, for 128 bytes in all.
+} basic_draw_uniform;
+
+// NOTE: Device memory is allocated in large blocks per memory type, and buffers
+// and images are placed in them by a two level segregated fit allocator. Free
+// regions are kept in lists by size class: the first level is the size's
+// power of two and the second splits that range linearly, with a bitmap over
+// each level so finding a fitting region never walks a list. Neighboring free
+// regions are merged as soon as they're freed.
+//
+// When the device's bufferImageGranularity is more than one byte, linear
+// resources (buffers) and optimal images get separate blocks, so they can
+// never share a granularity page and no padding between them is needed.
+// Resources bigger than half a block get a block of their own.
+#define VULKAN_MEMORY_BLOCK_SIZE Megabytes(64)
+#define VULKAN_MEMORY_MIN_REGION_SIZE 256
+#define MAX_VULKAN_MEMORY_BLOCK_COUNT 256
+#define MAX_VULKAN_MEMORY_REGION_COUNT 65536
+
+#define VULKAN_MEMORY_FIRST_LEVEL_COUNT 40
+#define VULKAN_MEMORY_SECOND_LEVEL_LOG2 4
+#define VULKAN_MEMORY_SECOND_LEVEL_COUNT (1 << VULKAN_MEMORY_SECOND_LEVEL_LOG2)
+
+typedef struct vulkan_memory_block vulkan_memory_block;
+typedef struct vulkan_memory_region vulkan_memory_region;
+
+struct vulkan_memory_region {
+   VkDeviceSize Offset;
+   VkDeviceSize Size;
+   bool Free;
+
+   vulkan_memory_block *Block;
+   vulkan_memory_region *Previous_In_Block; // NOTE: Neighbors by address.
+   vulkan_memory_region *Next_In_Block;
+   vulkan_memory_region *Previous_Free;     // NOTE: Neighbors in a free list.
+   vulkan_memory_region *Next_Free;
+};
+
+struct vulkan_memory_block {
+   VkDeviceMemory Memory; // NOTE: Unused blocks have none.
+   VkDeviceSize Size;
+   VkDeviceSize Used;
+   int Allocation_Count;
+
+   u32 Type_Index;
+   bool Optimal;
+   bool Dedicated;
+   u8 *Mapped; // NOTE: Host visible blocks stay mapped for their lifetime.
+};
+
+typedef struct {
+   u64 First_Level_Bitmap;
+   u32 Second_Level_Bitmaps[VULKAN_MEMORY_FIRST_LEVEL_COUNT];
+   vulkan_memory_region *Free_Regions[VULKAN_MEMORY_FIRST_LEVEL_COUNT][VULKAN_MEMORY_SECOND_LEVEL_COUNT];
+} vulkan_memory_pool;
+
+// NOTE: Memory types are picked by policy. A type must have every required
+// property, and among those the one missing the fewest preferred properties
+// and having the fewest avoided ones wins, with ties going to the earlier type
+// since drivers list their fastest types first.
+typedef struct {
+   VkMemoryPropertyFlags Required;
+   VkMemoryPropertyFlags Preferred;
+   VkMemoryPropertyFlags Avoid;
+} vulkan_memory_policy;
+
+// NOTE: Device local memory avoids host visible types, which are left for
+// resources the CPU writes. Uploads stay in host memory the device reads over
+// the bus, unless host visible device memory is available. Direct uploads
+// write straight into device memory and need no staging copy, and are only
+// used when that memory is as big as the device's own (unified memory, or a
+// discrete GPU with its whole heap mapped).
+#define VULKAN_MEMORY_DEVICE_LOCAL (vulkan_memory_policy){VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT}
+#define VULKAN_MEMORY_TRANSIENT    (vulkan_memory_policy){VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT}
+#define VULKAN_MEMORY_STAGING      (vulkan_memory_policy){VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT|VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 0, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT|VK_MEMORY_PROPERTY_HOST_CACHED_BIT}
+#define VULKAN_MEMORY_UPLOAD       (vulkan_memory_policy){VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT|VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_MEMORY_PROPERTY_HOST_CACHED_BIT}
+#define VULKAN_MEMORY_DIRECT       (vulkan_memory_policy){VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT|VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT|VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 0, VK_MEMORY_PROPERTY_HOST_CACHED_BIT}
+
+typedef struct {
+   VkPhysicalDeviceMemoryProperties Properties; // NOTE: Queried once, at startup.
+   bool Separate_Optimal; // NOTE: Set when bufferImageGranularity is over one.
+   bool Direct_Uploads;   // NOTE: Set when buffers can be written in place.
+
+   vulkan_memory_pool Pools[VK_MAX_MEMORY_TYPES][2]; // NOTE: Indexed by type, then optimal.
+   vulkan_memory_block Blocks[MAX_VULKAN_MEMORY_BLOCK_COUNT];
+
+   vulkan_memory_region *Unused_Regions; // NOTE: Linked through Next_Free.
+   vulkan_memory_region Regions[MAX_VULKAN_MEMORY_REGION_COUNT];
+} vulkan_memory_allocator;
+
+typedef struct {
+   VkDeviceMemory Memory;
+   VkDeviceSize Offset;
+   VkDeviceSize Size;
+   void *Mapped; // NOTE: Only set for host visible memory.
+
+   vulkan_memory_region *Region;
+} vulkan_allocation;
+
+// NOTE: Fragmentation is the share of free bytes outside of the largest free
+// region of their block, so zero means each block's free space is in one
+// piece.
+typedef struct {
+   int Block_Count;
+   int Allocation_Count;
+   VkDeviceSize Block_Bytes;
+   VkDeviceSize Used_Bytes;
+   VkDeviceSize Free_Bytes;
+   VkDeviceSize Largest_Free_Region;
+   float Fragmentation;
+} vulkan_memory_stats;
+
 typedef struct {
    VkBuffer Buffer;
-   VkDeviceMemory Device_Memory;
+   vulkan_allocation Allocation;
    void *Mapped_Memory_Address;
 
    idx Size;
    VkIndexType Index_Type;
 } vulkan_buffer;
 
+// NOTE: The basic pipeline reads each attribute from its own binding, in this
+// order. Primitives missing an attribute read its default from a scene-wide
+// buffer: white for colors and zeros for everything else.
+typedef enum {
+   BASIC_VERTEX_POSITION,
+   BASIC_VERTEX_NORMAL,
+   BASIC_VERTEX_COLOR,
+   BASIC_VERTEX_TEXCOORD,
+
+   BASIC_VERTEX_ATTRIBUTE_COUNT,
+} basic_vertex_attribute;
+
+// NOTE: When a primitive's attributes are interleaved in one buffer view,
+// they're all read through the position binding at their own offsets instead,
+// so each vertex costs a single fetch stream. Interleaved_Mask has a bit set
+// for each attribute read that way.
+typedef struct {
+   VkFormat Formats[BASIC_VERTEX_ATTRIBUTE_COUNT];
+   u32 Strides[BASIC_VERTEX_ATTRIBUTE_COUNT];
+   u32 Offsets[BASIC_VERTEX_ATTRIBUTE_COUNT];
+   u32 Interleaved_Mask;
+   bool Octahedral_Normals; // NOTE: Selects the shader's normal decode.
+} basic_vertex_layout;
+
+// NOTE: Each distinct vertex layout gets its own variant of the basic
+// pipeline. Variants share the shaders and pipeline layout of the first one.
+#define MAX_BASIC_PIPELINE_COUNT 16
+
+typedef struct {
+   VkBuffer Vertex_Buffers[BASIC_VERTEX_ATTRIBUTE_COUNT];
+   VkDeviceSize Vertex_Offsets[BASIC_VERTEX_ATTRIBUTE_COUNT];
+
+   VkDeviceSize Index_Offset;
+   VkIndexType Index_Type;
+   bool Indexed;
+
+   u32 Count; // NOTE: Index count when indexed, vertex count otherwise.
+   int Node;  // NOTE: Node providing the model matrix, or -1 for identity.
+   int Pipeline;
+
+   VkDescriptorSet Material_Set; // NOTE: Binds the base color texture.
+   vec4 Base_Color_Factor;
+
+   matrix4 Position_Decode; // NOTE: Maps quantized positions to model space.
+
+   // NOTE: Baked levels of detail are index ranges into the draw's indices,
+   // finest first. Each frame the coarsest one whose error projects to under
+   // a pixel is drawn, with the distance measured to the bounding sphere.
+   int Lod_Count;
+   gltf_lod *Lods;
+   vec3 Center;
+   float Radius;
+} vulkan_draw;
+
+// NOTE: The largest screen space error, in pixels, that a coarser level of
+// detail may introduce.
+#define LOD_PIXEL_ERROR 1.0f
+
 typedef struct {
    VkImage Image;
-   VkDeviceMemory Device_Memory;
+   vulkan_allocation Allocation;
    VkImageView View;
    VkFormat Format;
+   u32 Mip_Count;
 } vulkan_image;
 
+// NOTE: Everything uploaded through staging passes through one persistently
+// mapped ring buffer, so no upload allocates memory of its own. Each piece of
+// an upload is copied into the ring and its copy recorded into the open
+// submission, which is submitted once it holds a quarter of the ring. Each
+// submission's fence frees the part of the ring it used, so the CPU fills one
+// part of the ring while earlier ones are still being copied. Uploads larger
+// than a quarter of the ring are split into pieces that size or smaller.
+//
+// Build with -DVULKAN_STAGING_RING_SIZE=<bytes> to change the budget. It must
+// be a power of two.
+#if !defined(VULKAN_STAGING_RING_SIZE)
+#  define VULKAN_STAGING_RING_SIZE Megabytes(32)
+#endif
+#define VULKAN_STAGING_PIECE_SIZE (VULKAN_STAGING_RING_SIZE / 4)
+#define VULKAN_STAGING_ALIGNMENT 16
+#define VULKAN_STAGING_SUBMISSION_COUNT 8
+
+// NOTE: With a transfer queue of its own, uploaded resources change queue
+// family ownership. The submission that finishes a resource's upload releases
+// it and signals its semaphore, and the matching acquire is recorded into the
+// submission's acquire commands, which are submitted to the graphics queue,
+// waiting on that semaphore, once the submission is retired. By then the
+// semaphore has signaled, so the hand-off never stalls a frame.
+typedef struct {
+   VkCommandBuffer Command_Buffer;
+   VkFence Fence;
+   u64 Ring_End; // NOTE: Ring position just past the last byte it staged.
+
+   VkSemaphore Semaphore;
+   VkCommandBuffer Acquire_Command_Buffer; // NOTE: From the graphics command pool.
+   VkFence Acquire_Fence;
+   bool Acquiring;       // NOTE: Acquires have been recorded since it was opened.
+   bool Acquire_Pending; // NOTE: Acquires were submitted and may not have finished.
+} vulkan_staging_submission;
+
+// NOTE: Ring positions only ever increase, and are wrapped to the buffer's
+// size when used as offsets. Everything from Tail to Head may still be read by
+// a submission in flight, or by the open one.
+typedef struct {
+   vulkan_buffer Buffer; // NOTE: Persistently mapped.
+   u64 Head;
+   u64 Tail;
+
+   bool Open;
+   u64 Open_Head; // NOTE: Head when the open submission began.
+   bool Hand_Off; // NOTE: Set when uploads run on their own queue family.
+
+   int First_Pending; // NOTE: Oldest submission still in flight.
+   int Pending_Count;
+   vulkan_staging_submission Submissions[VULKAN_STAGING_SUBMISSION_COUNT];
+
+   u64 Submitted_Count;
+   u64 Retired_Count;
+   u64 Staged_Bytes; // NOTE: Ever reserved, for measuring throughput.
+} vulkan_staging_ring;
+
+// NOTE: Uploads are recorded in batches. Everything recorded between beginning
+// and ending a batch shares the ring's submissions, and ending it submits
+// them. On the graphics queue, a barrier makes the copies visible to vertex
+// input and shaders. On a transfer queue, each resource is handed off to the
+// graphics queue instead. Either way nothing submitted to the graphics queue
+// after the batch completes needs to wait for it. Batches bigger than a
+// quarter of the ring are still split across submissions as they're staged.
+//
+// Scenes are drawn from the first frame after their batch completes, so new
+// ones stream in while earlier ones keep rendering.
+//
+// A batch can be waited on or polled. Its throughput is logged when it's first
+// seen to be complete, timed from when it began, so polled batches include up
+// to a frame of latency.
+typedef struct {
+   double Start_Seconds;
+   u64 Start_Bytes;
+   u64 Bytes;
+
+   u64 Submission; // NOTE: Complete once this many submissions have retired.
+   bool Complete;
+} vulkan_upload_batch;
+
+// NOTE: A scene is uploaded as soon as the loader hands it over. All of its
+// glTF buffers are packed into a single device buffer, and its draws bind their
+// attributes and indices at offsets into it.
+//
+// Its images are created in the formats the baker compressed them to, and each
+// material gets a descriptor set for its base color texture. Materials without
+// one, and images the device can't sample, use a white texture instead.
+typedef struct {
+   char *Path;
+   gltf_scene *Source; // NOTE: Provides node transforms.
+
+   // NOTE: Every scene owns the arena its source was loaded into, and one
+   // sized for its tables.
+   arena Arena;
+   arena Tables;
+
+   vulkan_buffer Buffer;
+   vulkan_buffer Default_Vertex_Buffer;
+   vulkan_upload_batch Upload;
+
+   int Draw_Count;
+   vulkan_draw *Draws;
+
+   int Image_Count;
+   vulkan_image *Images; // NOTE: Unused ones have no image handle.
+   int Sampler_Count;
+   VkSampler *Samplers;
+
+   VkDescriptorPool Descriptor_Pool;
+   VkDescriptorSet *Material_Sets; // NOTE: One past the last is the default material.
+} vulkan_scene;
+
+// NOTE: A scene is reloaded in the background. Its file is loaded on the work
+// queue, then the new version is created and uploaded alongside the old one,
+// which it replaces once its upload batch completes. A file that changes again
+// while a reload is under way is reloaded once more afterwards, since the
+// first load may have read it halfway through being written.
+typedef enum {
+   VULKAN_RELOAD_IDLE,
+   VULKAN_RELOAD_LOADING,
+   VULKAN_RELOAD_UPLOADING,
+} vulkan_reload_stage;
+
+typedef struct {
+   vulkan_reload_stage Stage;
+   bool Changed_Again;
+
+   gltf_load Load;
+   u32 volatile Loaded; // NOTE: Set by the worker once Load.Scene is ready.
+
+   vulkan_scene Scene;
+} vulkan_scene_reload;
+
+// NOTE: Scenes and shaders are reloaded when their files change, and what they
+// replace is retired rather than destroyed, since frames still in flight may
+// be using it. Retired resources are destroyed once every frame submitted
+// before they were retired has finished.
+#define MAX_RETIRED_VULKAN_RESOURCE_COUNT 64
+
+typedef enum {
+   VULKAN_RETIRED_SCENE,
+   VULKAN_RETIRED_PIPELINE,
+   VULKAN_RETIRED_SHADER_MODULE,
+} vulkan_retired_type;
+
+typedef struct {
+   vulkan_retired_type Type;
+   u64 Frame; // NOTE: Frames submitted before this one may still use it.
+
+   vulkan_scene Scene;
+   VkPipeline Pipeline;
+   VkShaderModule Shader_Module;
+} vulkan_retired_resource;
+
+// NOTE: Each frame pushes its uniforms into a linear arena in a persistently
+// mapped buffer, bound through dynamic uniform descriptors, so one descriptor
+// set covers every slice and each bind only picks offsets. That's one slice for
+// the frame and one per draw. Slices are aligned to the device's
+// minUniformBufferOffsetAlignment. The arena is reset once the frame's fence
+// has signaled, when the GPU is done reading it, and grows then if the scenes
+// have more draws than it has room for.
+//
+// Build with -DVULKAN_FRAME_UNIFORM_SIZE=<bytes> to change the initial size.
+#if !defined(VULKAN_FRAME_UNIFORM_SIZE)
+#  define VULKAN_FRAME_UNIFORM_SIZE Kilobytes(256)
+#endif
+
+typedef struct {
+   vulkan_buffer Buffer;
+   VkDeviceSize Alignment;
+   VkDeviceSize Used;
+} vulkan_uniform_arena;
+
 typedef struct {
    VkSemaphore Image_Available_Semaphore;
    VkFence In_Flight_Fence;
@@ -46,7 +396,10 @@ typedef struct {
    VkDescriptorSet Descriptor_Set;
    VkCommandBuffer Command_Buffer;
 
-   vulkan_buffer Uniform;
+   vulkan_uniform_arena Uniforms;
+
+   VkQueryPool Timestamp_Pool; // NOTE: Brackets the frame's render pass.
+   bool Timestamps_Written;
 } vulkan_frame;
 
 typedef struct {
@@ -74,6 +427,18 @@ typedef struct {
    VkSemaphore Render_Finished_Semaphores[MAX_SWAPCHAIN_IMAGE_COUNT];
 } vulkan_swapchain;
 
+// NOTE: GPU time spent in the basic render pass is averaged over this many
+// frames and logged, for comparing vertex layouts and formats.
+#define GPU_TIMING_FRAME_COUNT 1024
+
+typedef struct {
+   int Frame_Count;
+   double Milliseconds;
+
+   u64 Drawn_Triangles;  // NOTE: After level of detail selection.
+   u64 Detail_Triangles; // NOTE: Had every draw used its finest level.
+} vulkan_gpu_timing;
+
 typedef struct {
    VkPhysicalDevice Handle;
    VkPhysicalDeviceFeatures Enabled_Features;
@@ -90,40 +455,54 @@ typedef struct {
    arena Permanent;
    arena Scratch;
 
-   gltf_scene Debug_Scene;
+   vulkan_memory_allocator *Memory;
+
+   gltf_loader Loader;
 
    vulkan_swapchain Swapchain;
 
    VkSampleCountFlagBits Multisample_Count;
 
    VkRenderPass Basic_Render_Pass;
-   vulkan_pipeline Basic_Graphics_Pipeline;
+   int Basic_Pipeline_Count;
+   basic_vertex_layout Basic_Vertex_Layouts[MAX_BASIC_PIPELINE_COUNT];
+   vulkan_pipeline Basic_Graphics_Pipelines[MAX_BASIC_PIPELINE_COUNT];
    // vulkan_pipeline Basic_Text_Pipeline;
 
-   VkDescriptorSetLayout Descriptor_Set_Layout;
+   VkDescriptorSetLayout Descriptor_Set_Layout; // NOTE: Set 0, the frame's uniforms.
+   VkDescriptorSetLayout Material_Set_Layout;   // NOTE: Set 1, a material's textures.
    VkDescriptorPool Descriptor_Pool;
 
-   vulkan_buffer Vertex_Positions;
-   vulkan_buffer Vertex_Normals;
-   vulkan_buffer Vertex_Colors;
-   vulkan_buffer Vertex_Texcoords;
-   vulkan_buffer Vertex_Indices;
+   int Scene_Count;
+   vulkan_scene *Scenes;
+   vulkan_scene_reload *Reloads; // NOTE: One per scene.
 
    VkSampler Texture_Sampler;
+   vulkan_image White_Texture;
    vulkan_image Debug_Texture;
    vulkan_image Debug_Text;
 
    VkCommandPool Command_Pool;
+   VkCommandPool Transfer_Command_Pool;
    vulkan_frame Frames[MAX_FRAMES_IN_FLIGHT];
+   vulkan_staging_ring Staging;
 
    u32 Compute_Queue_Family_Index;
    u32 Graphics_Queue_Family_Index;
    u32 Present_Queue_Family_Index;
+   u32 Transfer_Queue_Family_Index; // NOTE: The graphics family's, without a transfer-only one.
 
    VkQueue Compute_Queue;
    VkQueue Graphics_Queue;
    VkQueue Present_Queue;
+   VkQueue Transfer_Queue;
+
+   vulkan_gpu_timing GPU_Timing;
+
+   int Retired_Count;
+   vulkan_retired_resource Retired[MAX_RETIRED_VULKAN_RESOURCE_COUNT];
 
+   u64 Frame_Count; // NOTE: Frames submitted so far.
    u32 Frame_Index;
    bool Resize_Requested;
 } vulkan_context;